@@ -18,6 +18,7 @@
 
 //INCLUDES
 #include "boundingBoxBase.h"
+#include <algorithm>
 
 namespace tarsim {
 // FORWARD DECLARATIONS
@@ -58,4 +59,41 @@ void BoundingBoxBase::updateVertices(const Matrix4d &m)
     }
 }
 
+void BoundingBoxBase::setCollisionFilter(uint32_t group, uint32_t mask)
+{
+    m_collisionGroup = (group == 0) ? k_defaultCollisionGroup : group;
+    m_collisionMask = (mask == 0) ? k_defaultCollisionMask : mask;
+}
+
+uint32_t BoundingBoxBase::getCollisionGroup()
+{
+    return m_collisionGroup;
+}
+
+uint32_t BoundingBoxBase::getCollisionMask()
+{
+    return m_collisionMask;
+}
+
+bool BoundingBoxBase::canCollideWith(BoundingBoxBase* bb)
+{
+    return (m_collisionGroup & bb->getCollisionMask()) &&
+           (bb->getCollisionGroup() & m_collisionMask);
+}
+
+void BoundingBoxBase::getAabb(Vector3d &lower, Vector3d &upper)
+{
+    lower = Vector3d::Constant(1.0e9);
+    upper = Vector3d::Constant(-1.0e9);
+    for (size_t i = 0; i < m_globalVertices.size(); i++) {
+        for (int j = 0; j < 3; j++) {
+            lower(j) = std::min(lower(j), m_globalVertices[i](j));
+            upper(j) = std::max(upper(j), m_globalVertices[i](j));
+        }
+    }
+
+    lower -= Vector3d::Constant(m_collisionDetectionDistance);
+    upper += Vector3d::Constant(m_collisionDetectionDistance);
+}
+
 } // end of namespace tarsim
@@ -32,7 +32,8 @@ namespace tarsim {
 // FORWARD DECLARATIONS
 
 // TYPEDEFS AND DEFINES
-
+const uint32_t k_defaultCollisionGroup = 0x1;
+const uint32_t k_defaultCollisionMask = 0xFFFFFFFF;
 // ENUMS
 enum class BoundingBoxType
 {
@@ -60,6 +61,12 @@ public:
     std::vector<Vector4d>* getVertices();
     double getCollisionDetectionDistance();
     void updateVertices(const Matrix4d &m);
+
+    void setCollisionFilter(uint32_t group, uint32_t mask);
+    uint32_t getCollisionGroup();
+    uint32_t getCollisionMask();
+    bool canCollideWith(BoundingBoxBase* bb);
+    virtual void getAabb(Vector3d &lower, Vector3d &upper);
 protected:
     // FUNCTIONS
     // MEMBERS
@@ -69,6 +76,10 @@ protected:
 
     // Collision detection distance
     double m_collisionDetectionDistance = 0.0;
+
+    // Group bits of this volume and groups it may collide with
+    uint32_t m_collisionGroup = k_defaultCollisionGroup;
+    uint32_t m_collisionMask = k_defaultCollisionMask;
 };
 } // end of namespace tarsim
 // ENDIF
@@ -35,4 +35,16 @@ BoundingBoxCuboid::BoundingBoxCuboid(
 {
 }
 
+void BoundingBoxCuboid::getAabb(Vector3d &lower, Vector3d &upper)
+{
+    // Vertices are the plane center followed by its two half-edge vectors
+    Vector3d c = m_globalVertices.at(0).head<3>();
+    Vector3d e =
+            m_globalVertices.at(1).head<3>().cwiseAbs() +
+            m_globalVertices.at(2).head<3>().cwiseAbs() +
+            Vector3d::Constant(m_collisionDetectionDistance);
+    lower = c - e;
+    upper = c + e;
+}
+
 } // end of namespace tarsim
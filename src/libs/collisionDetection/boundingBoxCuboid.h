@@ -42,6 +42,8 @@ public:
         std::vector<Vector4d> vertices);
     virtual ~BoundingBoxCuboid() = default;
 
+    void getAabb(Vector3d &lower, Vector3d &upper) override;
+
     // MEMBERS
 protected:
     // FUNCTIONS
@@ -0,0 +1,98 @@
+/**
+ * @file: broadPhase.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Sweep-and-prune broad phase
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright [2017-2018] Kamran Shamaei .
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ */
+
+//INCLUDES
+#include "broadPhase.h"
+#include <algorithm>
+
+namespace tarsim {
+// FORWARD DECLARATIONS
+// TYPEDEFS AND DEFINES
+// ENUMS
+// NAMESPACES AND STRUCTS
+// CLASS DEFINITION
+void BroadPhase::clear()
+{
+    m_proxies.clear();
+    m_sorted.clear();
+}
+
+void BroadPhase::addProxy(int32_t owner, BoundingBoxBase* bb, bool isDynamic)
+{
+    BroadPhaseProxy proxy;
+    proxy.owner = owner;
+    proxy.isDynamic = isDynamic;
+    proxy.bb = bb;
+    bb->getAabb(proxy.lower, proxy.upper);
+    m_proxies.push_back(proxy);
+}
+
+void BroadPhase::findPairs(std::vector<std::pair<size_t, size_t>> &pairs)
+{
+    pairs.clear();
+
+    m_sorted.resize(m_proxies.size());
+    for (size_t i = 0; i < m_sorted.size(); i++) {
+        m_sorted[i] = i;
+    }
+
+    std::sort(m_sorted.begin(), m_sorted.end(),
+            [this](size_t a, size_t b) {
+                return m_proxies[a].lower(0) < m_proxies[b].lower(0);
+            });
+
+    // Sweep along x, only the proxies whose x interval is still open can
+    // overlap the current one
+    for (size_t i = 0; i < m_sorted.size(); i++) {
+        const BroadPhaseProxy &p1 = m_proxies[m_sorted[i]];
+        for (size_t j = i + 1; j < m_sorted.size(); j++) {
+            const BroadPhaseProxy &p2 = m_proxies[m_sorted[j]];
+            if (p2.lower(0) > p1.upper(0)) {
+                break;
+            }
+
+            if (p1.owner == p2.owner ||
+                (!p1.isDynamic && !p2.isDynamic)) {
+                continue;
+            }
+
+            if (p1.lower(1) > p2.upper(1) || p2.lower(1) > p1.upper(1) ||
+                p1.lower(2) > p2.upper(2) || p2.lower(2) > p1.upper(2)) {
+                continue;
+            }
+
+            if (!p1.bb->canCollideWith(p2.bb)) {
+                continue;
+            }
+
+            pairs.push_back(std::make_pair(m_sorted[i], m_sorted[j]));
+        }
+    }
+}
+
+const BroadPhaseProxy& BroadPhase::getProxy(size_t index) const
+{
+    return m_proxies.at(index);
+}
+
+size_t BroadPhase::size() const
+{
+    return m_proxies.size();
+}
+
+} // end of namespace tarsim
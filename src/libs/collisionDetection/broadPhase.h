@@ -0,0 +1,95 @@
+/**
+ *
+ * @file: broadPhase.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Sweep-and-prune broad phase that reduces a set of bounding
+ * volumes to the pairs whose axis-aligned boxes overlap
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright [2017-2018] Kamran Shamaei .
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ */
+
+// IFNDEF
+#ifndef BROAD_PHASE_H
+#define BROAD_PHASE_H
+
+//INCLUDES
+#include "boundingBoxBase.h"
+
+#include <vector>
+#include <utility>
+
+namespace tarsim {
+// FORWARD DECLARATIONS
+
+// TYPEDEFS AND DEFINES
+
+// ENUMS
+
+// NAMESPACES AND STRUCTS
+using namespace Eigen;
+
+struct BroadPhaseProxy
+{
+    // Index of the object or rigid body that owns the volume
+    int32_t owner = 0;
+
+    // Only pairs with at least one dynamic proxy are reported
+    bool isDynamic = false;
+
+    BoundingBoxBase* bb = nullptr;
+    Vector3d lower = Vector3d::Zero();
+    Vector3d upper = Vector3d::Zero();
+};
+
+// CLASS DEFINITION
+class BroadPhase
+{
+public:
+    // FUNCTIONS
+    BroadPhase() = default;
+    virtual ~BroadPhase() = default;
+
+    void clear();
+
+    /**
+     * @brief Adds a bounding volume whose global vertices are up to date
+     * @param owner Index of the owner, volumes of one owner are never paired
+     * @param bb Bounding volume
+     * @param isDynamic Whether the volume moves with the robot
+     */
+    void addProxy(int32_t owner, BoundingBoxBase* bb, bool isDynamic);
+
+    /**
+     * @brief Finds the proxy pairs whose boxes overlap, whose owners differ,
+     * whose collision groups and masks match and of which at least one is
+     * dynamic
+     * @param pairs Indices of the overlapping proxies
+     */
+    void findPairs(std::vector<std::pair<size_t, size_t>> &pairs);
+
+    const BroadPhaseProxy& getProxy(size_t index) const;
+    size_t size() const;
+
+    // MEMBERS
+protected:
+    // FUNCTIONS
+    // MEMBERS
+    std::vector<BroadPhaseProxy> m_proxies;
+
+    // Proxy indices sorted along the sweep axis
+    std::vector<size_t> m_sorted;
+};
+} // end of namespace tarsim
+// ENDIF
+#endif /* BROAD_PHASE_H */
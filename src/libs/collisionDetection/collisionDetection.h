@@ -27,6 +27,7 @@
 #include "boundingBoxCapsule.h"
 #include "boundingBoxSphere.h"
 #include "boundingBoxCuboid.h"
+#include "broadPhase.h"
 
 namespace tarsim {
 // FORWARD DECLARATIONS
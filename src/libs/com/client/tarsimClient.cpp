@@ -22,8 +22,13 @@
 #include "tarsimClient.h"
 #include <signal.h>
 #include "fileSystem.h"
+#include "latencyRecorder.h"
+#include "metricsRegistry.h"
 #include <chrono>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
 
 namespace tarsim {
 
@@ -31,6 +36,37 @@ namespace tarsim {
 // TYPEDEFS AND DEFINES
 // ENUMS
 // NAMESPACES AND STRUCTS
+namespace {
+/**
+ * Returns a callback that fulfills the promise with the reply, or fails it
+ * if the reply did not arrive in time
+ */
+template <typename Msg_t>
+std::function<void(bool, const Msg_t&)> fulfill(
+        std::shared_ptr<std::promise<Msg_t>> promise, const std::string &what)
+{
+    return [promise, what](bool isReceived, const Msg_t &msg) {
+        if (isReceived) {
+            promise->set_value(msg);
+        } else {
+            promise->set_exception(std::make_exception_ptr(
+                    std::runtime_error("Failed to get " + what + " in time")));
+        }
+    };
+}
+
+/**
+ * Fails the promise of a request that could not be sent
+ */
+template <typename Msg_t>
+void failToSend(
+        std::shared_ptr<std::promise<Msg_t>> promise, const std::string &what)
+{
+    promise->set_exception(std::make_exception_ptr(
+            std::runtime_error("Failed to send request to get " + what)));
+}
+} // end of anonymous namespace
+
 // CLASS DEFINITION
 TarsimClient::TarsimClient(int32_t index, int policy, int priority)
 {
@@ -39,11 +75,15 @@ TarsimClient::TarsimClient(int32_t index, int policy, int priority)
       process_index = FileSystem::getPid();
     }
 
+    m_index = process_index;
+
     std::string userAppReplyMsgQName = FileSystem::getMQNamePid(process_index);
     mq_unlink(("/" + userAppReplyMsgQName).c_str());
     m_eitOsMsgClientReceiver =
             new EitOsMsgClientReceiver(userAppReplyMsgQName, policy, priority);
     m_eitOsMsgClientSender = new EitOsMsgClientSender(process_index);
+    m_eitOsMsgClientSender->setLatencyRecorder(
+            m_eitOsMsgClientReceiver->getLatencyRecorder());
 }
 
 TarsimClient::~TarsimClient()
@@ -53,13 +93,36 @@ TarsimClient::~TarsimClient()
     }
 }
 
-bool TarsimClient::connect(unsigned int msgPriority)
+bool TarsimClient::connect(unsigned int msgPriority, TransportTypes transport)
 {
-    if (NO_ERR != m_eitOsMsgClientReceiver->start()) {
+    if (TRANSPORT_UNIX_SOCKET == transport || TRANSPORT_TCP == transport) {
+        // Nothing goes over message queues, so the client needs none
+        if (NO_ERR != m_eitOsMsgClientReceiver->startSocket(transport) ||
+            !m_eitOsMsgClientSender->useSocket(
+                    m_eitOsMsgClientReceiver->getSocket())) {
+            printf("Failed to connect to tarsim over a socket\n");
+            return false;
+        }
+    } else if (NO_ERR != m_eitOsMsgClientReceiver->start()) {
         printf("Failed to connect to tarsim\n");
         return false;
     }
 
+    if (TRANSPORT_SHARED_MEMORY == transport) {
+        std::string ringName = FileSystem::getMQNamePid(m_index);
+        if (NO_ERR != m_eitOsMsgClientReceiver->startSharedMemory(
+                ringName + "ToClient")) {
+            printf("Failed to create shared memory ring\n");
+            return false;
+        }
+
+        if (!m_eitOsMsgClientSender->useSharedMemory(
+                ringName + "ToServer", ringName + "ToClient", msgPriority)) {
+            printf("Failed to connect to tarsim over shared memory\n");
+            return false;
+        }
+    }
+
     SimulatorStatus_t out;
     out.msgCounter = getMsgStamp();
     if (!m_eitOsMsgClientSender->sendRequestSimulatorStatus(out)) {
@@ -108,7 +171,162 @@ bool TarsimClient::sendJointPositions(
         JointPositions_t &msg, unsigned int msgPriority)
 {
     msg.msgCounter = getMsgStamp();
-    return m_eitOsMsgClientSender->sendJointPositions(msg);
+    return m_eitOsMsgClientSender->sendJointPositions(msg, msgPriority);
+}
+
+bool TarsimClient::sendJointPositions(
+        const std::vector<int32_t> &indices,
+        const std::vector<float> &positions, unsigned int msgPriority)
+{
+    return m_eitOsMsgClientSender->sendJointPositions(
+            indices, positions, getMsgStamp(), msgPriority);
+}
+
+bool TarsimClient::step(
+        const JointPositions_t &robotPosition, StepResult_t &result,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    Step_t out;
+    out.msgCounter = getMsgStamp();
+    out.numJoints = std::min(MAX_JOINTS, robotPosition.numJoints);
+    std::copy(robotPosition.indices, robotPosition.indices + out.numJoints,
+            out.indices);
+    std::copy(robotPosition.positions, robotPosition.positions + out.numJoints,
+            out.positions);
+
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
+    if (!m_eitOsMsgClientSender->sendStep(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send step\n");
+        return false;
+    }
+
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get step result in time\n");
+        return false;
+    }
+    std::memcpy(&result, &reply.blobOfData, sizeof(result));
+    return true;
+}
+
+bool TarsimClient::uploadTrajectory(
+        int32_t trajectoryId, const std::vector<int32_t> &indices,
+        const std::vector<float> &times,
+        const std::vector<std::vector<float>> &positions,
+        TrajectoryInterpolations interpolation, TrajectoryStatus_t &status,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    int32_t numJoints = (int32_t)indices.size();
+    if (numJoints <= 0 || numJoints > MAX_JOINTS || times.empty() ||
+        times.size() != positions.size()) {
+        printf("Invalid trajectory\n");
+        return false;
+    }
+
+    for (const std::vector<float> &waypoint: positions) {
+        if ((int32_t)waypoint.size() != numJoints) {
+            printf("Every waypoint needs one position per joint\n");
+            return false;
+        }
+    }
+
+    // Each waypoint takes its time and one value per joint
+    int32_t numWaypoints = (int32_t)times.size();
+    int32_t waypointsPerChunk = MAX_TRAJECTORY_CHUNK_VALUES / (numJoints + 1);
+    TrajectoryChunk_t out;
+    out.trajectoryId = trajectoryId;
+    out.numChunks = (numWaypoints + waypointsPerChunk - 1) / waypointsPerChunk;
+    out.interpolation = interpolation;
+    out.numJoints = numJoints;
+    std::copy(indices.begin(), indices.end(), out.indices);
+
+    for (int32_t chunk = 0; chunk < out.numChunks; chunk++) {
+        int32_t first = chunk * waypointsPerChunk;
+        out.chunkIndex = chunk;
+        out.numWaypoints = std::min(waypointsPerChunk, numWaypoints - first);
+        float* values = out.values;
+        for (int32_t k = first; k < first + out.numWaypoints; k++) {
+            *values++ = times[k];
+            values = std::copy(positions[k].begin(), positions[k].end(), values);
+        }
+
+        // Only the last chunk is answered
+        out.msgCounter = getMsgStamp();
+        bool isLast = (chunk == out.numChunks - 1);
+        if (isLast) {
+            m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
+        }
+
+        if (!m_eitOsMsgClientSender->sendTrajectoryChunk(out, msgPriority)) {
+            if (isLast) {
+                m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+            }
+            printf("Failed to send trajectory\n");
+            return false;
+        }
+    }
+
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get trajectory status in time\n");
+        return false;
+    }
+    std::memcpy(&status, &reply.blobOfData, sizeof(status));
+    return TRAJECTORY_STATE_READY == status.state;
+}
+
+bool TarsimClient::startTrajectory(
+        int32_t trajectoryId, TrajectoryStatus_t &status,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    TrajectoryCommand_t out;
+    out.trajectoryId = trajectoryId;
+    out.command = TRAJECTORY_START;
+    if (!sendTrajectoryCommand(
+            out, status, timeout_period_us, msgPriority)) {
+        return false;
+    }
+    return TRAJECTORY_STATE_PLAYING == status.state;
+}
+
+bool TarsimClient::stopTrajectory(
+        TrajectoryStatus_t &status,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    TrajectoryCommand_t out;
+    out.command = TRAJECTORY_STOP;
+    return sendTrajectoryCommand(
+            out, status, timeout_period_us, msgPriority);
+}
+
+TrajectoryStatus_t TarsimClient::getTrajectoryStatus()
+{
+    return m_eitOsMsgClientReceiver->getTrajectoryStatus();
+}
+
+bool TarsimClient::sendTrajectoryCommand(
+        TrajectoryCommand_t &out, TrajectoryStatus_t &status,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    out.msgCounter = getMsgStamp();
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
+    if (!m_eitOsMsgClientSender->sendTrajectoryCommand(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send trajectory command\n");
+        return false;
+    }
+
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get trajectory status in time\n");
+        return false;
+    }
+    std::memcpy(&status, &reply.blobOfData, sizeof(status));
+    return true;
 }
 
 bool TarsimClient::sendJointPosition(
@@ -166,26 +384,21 @@ bool TarsimClient::getEndEffectorFrame(
 {
     RequestEndEffectorFrame_t out;
     out.msgCounter = getMsgStamp();
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
     if (!m_eitOsMsgClientSender->sendRequestEndEffectorFrame(out)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
         printf("Failed to send request to get joint values\n");
         return false;
     }
 
-    int counter = 0;
-    // Wait here until the message
-    while (true) {
-        msg = m_eitOsMsgClientReceiver->getEndEffectorFrame();
-        if (msg.msgCounter == out.msgCounter) {
-            break;
-        }
-
-        if (10 * counter > timeout_period_us) {
-            printf("Failed to get end-effector frame in time\n");
-            return false;
-        }
-        usleep(k_sleepTimeUs);
-        counter++;
+    // Wait here until the reply wakes us up
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get end-effector frame in time\n");
+        return false;
     }
+    std::memcpy(&msg, &reply.blobOfData, sizeof(msg));
     return true;
 }
 
@@ -204,26 +417,21 @@ bool TarsimClient::getRigidBodyFrame(
     out.msgCounter = getMsgStamp();
     out.indexRigidBody = indexRigidBody;
     out.indexFrame = indexFrame;
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
     if (!m_eitOsMsgClientSender->sendRequestRigidBodyFrame(out)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
         printf("Failed to send request to get joint values\n");
         return false;
     }
 
-    int counter = 0;
-    // Wait here until the message
-    while (true) {
-        msg = m_eitOsMsgClientReceiver->getRigidBodyFrame();
-        if (msg.msgCounter == out.msgCounter) {
-            break;
-        }
-
-        if (10 * counter > timeout_period_us) {
-            printf("Failed to get rigid body frame in time\n");
-            return false;
-        }
-        usleep(k_sleepTimeUs);
-        counter++;
+    // Wait here until the reply wakes us up
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get rigid body frame in time\n");
+        return false;
     }
+    std::memcpy(&msg, &reply.blobOfData, sizeof(msg));
     return true;
 }
 
@@ -241,26 +449,21 @@ bool TarsimClient::getObjectFrame(
     RequestObjectFrame_t out;
     out.indexObject = indexObject;
     out.msgCounter = getMsgStamp();
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
     if (!m_eitOsMsgClientSender->sendRequestObjectFrame(out)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
         printf("Failed to send request to get joint values\n");
         return false;
     }
 
-    int counter = 0;
-    // Wait here until the message
-    while (true) {
-        msg = m_eitOsMsgClientReceiver->getObjectFrame();
-        if (msg.msgCounter == out.msgCounter) {
-            break;
-        }
-
-        if (10 * counter > timeout_period_us) {
-            printf("Failed to get object frame in time\n");
-            return false;
-        }
-        usleep(k_sleepTimeUs);
-        counter++;
+    // Wait here until the reply wakes us up
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get object frame in time\n");
+        return false;
     }
+    std::memcpy(&msg, &reply.blobOfData, sizeof(msg));
     return true;
 }
 
@@ -288,29 +491,312 @@ bool TarsimClient::getJointValues(
 {
     RequestJointValues_t out;
     out.msgCounter = getMsgStamp();
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
     if (!m_eitOsMsgClientSender->sendRequestJointValues(out)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
         printf("Failed to send request to get joint values\n");
         return false;
     }
 
-    int counter = 0;
-    // Wait here until the message
-    while (true) {
-        msg = m_eitOsMsgClientReceiver->getJointValues();
-        if (msg.msgCounter == out.msgCounter) {
-            break;
+    // Wait here until the reply wakes us up
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us)) {
+        printf("Failed to get joint values in time\n");
+        return false;
+    }
+    std::memcpy(&msg, &reply.blobOfData, sizeof(msg));
+    return true;
+}
+
+bool TarsimClient::registerFrameSelection(
+        int32_t selectionId, const std::vector<FrameSelection_t> &items,
+        unsigned int msgPriority)
+{
+    if ((int32_t)items.size() > MAX_FRAME_SELECTION_ITEMS) {
+        printf("Frame selection can have at most %d frames\n",
+                MAX_FRAME_SELECTION_ITEMS);
+        return false;
+    }
+
+    RegisterFrameSelection_t out;
+    out.msgCounter = getMsgStamp();
+    out.selectionId = selectionId;
+    out.numItems = (int32_t)items.size();
+    std::copy(items.begin(), items.end(), out.items);
+    if (!m_eitOsMsgClientSender->sendRegisterFrameSelection(out, msgPriority)) {
+        printf("Failed to register frame selection\n");
+        return false;
+    }
+    return true;
+}
+
+bool TarsimClient::getFrames(
+        int32_t selectionId, std::vector<Frame_t> &frames,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    RequestFramesBatch_t out;
+    out.selectionId = selectionId;
+    return requestFramesBatch(out, frames, timeout_period_us, msgPriority);
+}
+
+bool TarsimClient::getFrames(
+        const std::vector<FrameSelection_t> &items,
+        std::vector<Frame_t> &frames,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    if (items.empty()) {
+        frames.clear();
+        return true;
+    }
+
+    if ((int32_t)items.size() > MAX_FRAME_SELECTION_ITEMS) {
+        printf("Frames batch can have at most %d frames\n",
+                MAX_FRAME_SELECTION_ITEMS);
+        return false;
+    }
+
+    RequestFramesBatch_t out;
+    out.numItems = (int32_t)items.size();
+    std::copy(items.begin(), items.end(), out.items);
+    return requestFramesBatch(out, frames, timeout_period_us, msgPriority);
+}
+
+bool TarsimClient::requestFramesBatch(
+        RequestFramesBatch_t &out, std::vector<Frame_t> &frames,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    out.msgCounter = getMsgStamp();
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
+    if (!m_eitOsMsgClientSender->sendRequestFramesBatch(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send request to get frames\n");
+        return false;
+    }
+
+    // Large batches arrive in several chunks, all with the same counter
+    std::vector<GenericData_t> replies;
+    if (!m_eitOsMsgClientReceiver->waitForReplies(
+            out.msgCounter, replies, timeout_period_us)) {
+        printf("Failed to get frames in time\n");
+        return false;
+    }
+
+    frames.clear();
+    for (const GenericData_t &reply: replies) {
+        FramesBatch_t in;
+        std::memcpy(&in, &reply.blobOfData, sizeof(in));
+        if (in.numItems < 0) {
+            printf("Frame selection %d is not registered\n", in.selectionId);
+            return false;
         }
 
-        if (10 * counter > timeout_period_us) {
-            printf("Failed to get joint values in time\n");
+        if (in.numFrames < 0) {
+            printf("Invalid frames batch reply\n");
             return false;
         }
-        usleep(k_sleepTimeUs);
-        counter++;
+
+        int32_t numFrames = std::min(in.numFrames, MAX_FRAMES_PER_BATCH);
+        for (int32_t k = 0; k < numFrames; k++) {
+            Frame_t frame;
+            frame.msgCounter = in.msgCounter;
+            frame.frameId = in.chunkIndex * MAX_FRAMES_PER_BATCH + k;
+            std::memcpy(frame.mij, in.mij[k], sizeof(frame.mij));
+            frames.push_back(frame);
+        }
     }
     return true;
 }
 
+bool TarsimClient::subscribe(
+        uint32_t topics, int32_t decimation, int32_t selectionId,
+        unsigned int msgPriority)
+{
+    Subscribe_t out;
+    out.msgCounter = getMsgStamp();
+    out.topics = topics;
+    out.decimation = decimation;
+    out.selectionId = selectionId;
+    if (!m_eitOsMsgClientSender->sendSubscribe(out, msgPriority)) {
+        printf("Failed to subscribe\n");
+        return false;
+    }
+    return true;
+}
+
+bool TarsimClient::unsubscribe(unsigned int msgPriority)
+{
+    return subscribe(0, 1, 0, msgPriority);
+}
+
+JointPositions_t TarsimClient::getLatestJointValues()
+{
+    return m_eitOsMsgClientReceiver->getJointValues();
+}
+
+Frame_t TarsimClient::getLatestEndEffectorFrame()
+{
+    return m_eitOsMsgClientReceiver->getEndEffectorFrame();
+}
+
+std::vector<Frame_t> TarsimClient::getLatestFrames()
+{
+    return m_eitOsMsgClientReceiver->getPublishedFrames();
+}
+
+std::future<Frame_t> TarsimClient::requestEndEffectorFrameAsync(
+        int timeout_period_us, unsigned int msgPriority)
+{
+    auto promise = std::make_shared<std::promise<Frame_t>>();
+    std::future<Frame_t> future = promise->get_future();
+    if (!requestEndEffectorFrameAsync(
+            fulfill(promise, "end-effector frame"),
+            timeout_period_us, msgPriority)) {
+        failToSend(promise, "end-effector frame");
+    }
+    return future;
+}
+
+bool TarsimClient::requestEndEffectorFrameAsync(
+        const FrameCallback_t &callback,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    RequestEndEffectorFrame_t out;
+    out.msgCounter = getMsgStamp();
+    expectFrame(out.msgCounter, callback, timeout_period_us);
+    if (!m_eitOsMsgClientSender->sendRequestEndEffectorFrame(
+            out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send request to get end-effector frame\n");
+        return false;
+    }
+    return true;
+}
+
+std::future<Frame_t> TarsimClient::requestRigidBodyFrameAsync(
+        int32_t indexRigidBody, int32_t indexFrame,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    auto promise = std::make_shared<std::promise<Frame_t>>();
+    std::future<Frame_t> future = promise->get_future();
+    if (!requestRigidBodyFrameAsync(
+            indexRigidBody, indexFrame, fulfill(promise, "rigid body frame"),
+            timeout_period_us, msgPriority)) {
+        failToSend(promise, "rigid body frame");
+    }
+    return future;
+}
+
+bool TarsimClient::requestRigidBodyFrameAsync(
+        int32_t indexRigidBody, int32_t indexFrame,
+        const FrameCallback_t &callback,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    RequestRigidBodyFrame_t out;
+    out.msgCounter = getMsgStamp();
+    out.indexRigidBody = indexRigidBody;
+    out.indexFrame = indexFrame;
+    expectFrame(out.msgCounter, callback, timeout_period_us);
+    if (!m_eitOsMsgClientSender->sendRequestRigidBodyFrame(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send request to get rigid body frame\n");
+        return false;
+    }
+    return true;
+}
+
+std::future<Frame_t> TarsimClient::requestObjectFrameAsync(
+        int32_t indexObject, int timeout_period_us, unsigned int msgPriority)
+{
+    auto promise = std::make_shared<std::promise<Frame_t>>();
+    std::future<Frame_t> future = promise->get_future();
+    if (!requestObjectFrameAsync(
+            indexObject, fulfill(promise, "object frame"),
+            timeout_period_us, msgPriority)) {
+        failToSend(promise, "object frame");
+    }
+    return future;
+}
+
+bool TarsimClient::requestObjectFrameAsync(
+        int32_t indexObject, const FrameCallback_t &callback,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    RequestObjectFrame_t out;
+    out.indexObject = indexObject;
+    out.msgCounter = getMsgStamp();
+    expectFrame(out.msgCounter, callback, timeout_period_us);
+    if (!m_eitOsMsgClientSender->sendRequestObjectFrame(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send request to get object frame\n");
+        return false;
+    }
+    return true;
+}
+
+std::future<JointPositions_t> TarsimClient::requestJointValuesAsync(
+        int timeout_period_us, unsigned int msgPriority)
+{
+    auto promise = std::make_shared<std::promise<JointPositions_t>>();
+    std::future<JointPositions_t> future = promise->get_future();
+    if (!requestJointValuesAsync(
+            fulfill(promise, "joint values"),
+            timeout_period_us, msgPriority)) {
+        failToSend(promise, "joint values");
+    }
+    return future;
+}
+
+bool TarsimClient::requestJointValuesAsync(
+        const JointValuesCallback_t &callback,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    RequestJointValues_t out;
+    out.msgCounter = getMsgStamp();
+    expectJointValues(out.msgCounter, callback, timeout_period_us);
+    if (!m_eitOsMsgClientSender->sendRequestJointValues(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to send request to get joint values\n");
+        return false;
+    }
+    return true;
+}
+
+void TarsimClient::expectFrame(
+        int32_t msgCounter, const FrameCallback_t &callback,
+        int timeout_period_us)
+{
+    // Fail whatever outstanding request has timed out since the last reply
+    m_eitOsMsgClientReceiver->expireReplies();
+    m_eitOsMsgClientReceiver->expectReply(
+        msgCounter,
+        [callback](bool isReceived, const GenericData_t &reply) {
+            Frame_t msg {};
+            if (isReceived) {
+                std::memcpy(&msg, &reply.blobOfData, sizeof(msg));
+            }
+            callback(isReceived, msg);
+        },
+        timeout_period_us);
+}
+
+void TarsimClient::expectJointValues(
+        int32_t msgCounter, const JointValuesCallback_t &callback,
+        int timeout_period_us)
+{
+    m_eitOsMsgClientReceiver->expireReplies();
+    m_eitOsMsgClientReceiver->expectReply(
+        msgCounter,
+        [callback](bool isReceived, const GenericData_t &reply) {
+            JointPositions_t msg {};
+            if (isReceived) {
+                std::memcpy(&msg, &reply.blobOfData, sizeof(msg));
+            }
+            callback(isReceived, msg);
+        },
+        timeout_period_us);
+}
+
 ErrorMessage_t TarsimClient::getErrorMessage(unsigned int msgPriority)
 {
     return m_eitOsMsgClientReceiver->getErrorMessage();
@@ -318,7 +804,10 @@ ErrorMessage_t TarsimClient::getErrorMessage(unsigned int msgPriority)
 
 int32_t TarsimClient::getMsgStamp()
 {
-    return ++m_counter;
+    // One atomic step, so concurrent requests never share a stamp. Stamps
+    // stay positive when the counter wraps, 0 and -1 answer no request.
+    uint32_t count = (uint32_t)m_counter.fetch_add(1);
+    return (int32_t)(count % (uint32_t)INT32_MAX) + 1;
 }
 
 bool TarsimClient::isSimulatorRunning(unsigned int msgPriority)
@@ -430,4 +919,122 @@ bool TarsimClient::setEndEffector(
   return true;
 }
 
+bool TarsimClient::getLatencyStatistics(
+        std::vector<LatencyStatistics_t> &client,
+        std::vector<LatencyStatistics_t> &server,
+        bool shouldReset, int timeout_period_us, unsigned int msgPriority)
+{
+    RequestLatencyStats_t out;
+    out.msgCounter = getMsgStamp();
+    out.shouldReset = shouldReset ? 1 : 0;
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
+    if (!m_eitOsMsgClientSender->sendRequestLatencyStats(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to request latency statistics\n");
+        return false;
+    }
+
+    // The statistics are kept aside, the reply only says they arrived
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us) ||
+        !m_eitOsMsgClientReceiver->takeServerLatencyStatistics(
+            out.msgCounter, server)) {
+        printf("Failed to get latency statistics in time\n");
+        return false;
+    }
+
+    LatencyRecorder* latency = m_eitOsMsgClientReceiver->getLatencyRecorder();
+    client = latency->getStatistics();
+    if (shouldReset) {
+        latency->reset();
+    }
+    return true;
+}
+
+bool TarsimClient::dumpLatencyStatistics(
+        const std::string &fileName, bool shouldReset,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    std::vector<LatencyStatistics_t> client;
+    std::vector<LatencyStatistics_t> server;
+    if (!getLatencyStatistics(
+            client, server, shouldReset, timeout_period_us, msgPriority)) {
+        return false;
+    }
+
+    return writeLatencyCsv(fileName, {{"client", client}, {"server", server}});
+}
+
+bool TarsimClient::getStatistics(
+        std::vector<MetricStatistics_t> &statistics,
+        bool shouldReset, int timeout_period_us, unsigned int msgPriority)
+{
+    RequestStatistics_t out;
+    out.msgCounter = getMsgStamp();
+    out.shouldReset = shouldReset ? 1 : 0;
+    m_eitOsMsgClientReceiver->expectReply(out.msgCounter);
+    if (!m_eitOsMsgClientSender->sendRequestStatistics(out, msgPriority)) {
+        m_eitOsMsgClientReceiver->cancelReply(out.msgCounter);
+        printf("Failed to request statistics\n");
+        return false;
+    }
+
+    // The statistics are kept aside, the reply only says they arrived
+    GenericData_t reply;
+    if (!m_eitOsMsgClientReceiver->waitForReply(
+            out.msgCounter, reply, timeout_period_us) ||
+        !m_eitOsMsgClientReceiver->takeServerStatistics(
+            out.msgCounter, statistics)) {
+        printf("Failed to get statistics in time\n");
+        return false;
+    }
+    return true;
+}
+
+bool TarsimClient::dumpStatistics(
+        const std::string &fileName, bool shouldReset,
+        int timeout_period_us, unsigned int msgPriority)
+{
+    std::vector<MetricStatistics_t> statistics;
+    if (!getStatistics(
+            statistics, shouldReset, timeout_period_us, msgPriority)) {
+        return false;
+    }
+
+    return writeMetricsCsv(fileName, statistics);
+}
+
+bool TarsimClient::startTrace(unsigned int msgPriority)
+{
+    TraceCommand_t out;
+    out.msgCounter = getMsgStamp();
+    out.command = TRACE_START;
+    if (!m_eitOsMsgClientSender->sendTraceCommand(out, msgPriority)) {
+        printf("Failed to request tracing\n");
+        return false;
+    }
+    return true;
+}
+
+bool TarsimClient::stopTrace(
+        const std::string &fileName, unsigned int msgPriority)
+{
+    if (fileName.size() >= (size_t)MAX_TRACE_FILE_NAME_SIZE) {
+        printf("Trace file name is longer than %d characters\n",
+                MAX_TRACE_FILE_NAME_SIZE - 1);
+        return false;
+    }
+
+    TraceCommand_t out;
+    out.msgCounter = getMsgStamp();
+    out.command = TRACE_STOP;
+    strncpy(out.fileName, fileName.c_str(), MAX_TRACE_FILE_NAME_SIZE - 1);
+    if (!m_eitOsMsgClientSender->sendTraceCommand(out, msgPriority)) {
+        printf("Failed to request the trace\n");
+        return false;
+    }
+    return true;
+}
+
 } // end of namespace tarsim
@@ -24,6 +24,10 @@
 
 //INCLUDES
 #include "simulatorMessages.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <vector>
 class EitOsMsgClientSender;
 class EitOsMsgClientReceiver;
 
@@ -32,6 +36,20 @@ namespace tarsim {
 class TarsimClient
 {
 public:
+    /**
+     * Called once with the reply to an asynchronous frame request. isReceived
+     * is false if the reply did not arrive in time.
+     */
+    typedef std::function<void(
+            bool isReceived, const Frame_t &msg)> FrameCallback_t;
+
+    /**
+     * Called once with the reply to an asynchronous joint values request.
+     * isReceived is false if the reply did not arrive in time.
+     */
+    typedef std::function<void(
+            bool isReceived, const JointPositions_t &msg)> JointValuesCallback_t;
+
     /**
      * Constructor
      * @param policy Server thread scheduling policy
@@ -50,9 +68,19 @@ public:
     /**
      * Connects to simulator, must be used before any other function only once
      * @param msgPriority Message priority
+     * @param transport TRANSPORT_MESSAGE_QUEUE uses POSIX message queues.
+     * TRANSPORT_SHARED_MEMORY exchanges messages through a pair of lock-free
+     * shared memory rings, which avoids a syscall per message and the small
+     * queue depth of message queues, e.g. for streaming joints at kHz rates.
+     * TRANSPORT_UNIX_SOCKET and TRANSPORT_TCP connect to the socket and the
+     * loopback port the simulator listens on, and use no message queue at
+     * all, e.g. for clients in another container that mounts the socket or
+     * shares the network namespace.
      * @return true if successful, false if it fails
      */
-    bool connect(unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+    bool connect(
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY,
+            TransportTypes transport = TRANSPORT_MESSAGE_QUEUE);
 
     /**
      * Sends all desired joint positions to the simulator
@@ -64,6 +92,94 @@ public:
             JointPositions_t &robotPosition,
             unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
 
+    /**
+     * Sends desired joint positions to the simulator, as many as the system
+     * has, without the MAX_JOINTS limit of JointPositions_t
+     * @param indices Indices of the joints
+     * @param positions Desired positions, one per index
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool sendJointPositions(
+            const std::vector<int32_t> &indices,
+            const std::vector<float> &positions,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Runs one control cycle with a single request: sets the desired joint
+     * positions, executes forward kinematics and collision detection, and
+     * waits for the outcome. It replaces sendJointPositions,
+     * executeForwardKinematics and getEndEffectorFrame.
+     * @param robotPosition desired joint positions
+     * @param result The joint limit error, end-effector pose, collision
+     * summary and cycle timing of the step
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool step(
+            const JointPositions_t &robotPosition,
+            StepResult_t &result,
+            int timeout_period_us = k_defaultTimeoutPeriodUs,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Uploads a trajectory for the simulator to play back on its own at the
+     * control cycle, instead of streaming every setpoint. Segments that would
+     * exceed the mate velocity or acceleration limits are slowed down.
+     * @param trajectoryId Id of the trajectory, used to start it
+     * @param indices Indices of the joints of the trajectory
+     * @param times Time of every waypoint in ms, strictly increasing
+     * @param positions Positions of every waypoint, one per joint in indices
+     * @param interpolation Spline used between waypoints
+     * @param status The reply, with the duration after slowing down
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if the trajectory is ready to play, false if it fails
+     */
+    bool uploadTrajectory(
+            int32_t trajectoryId,
+            const std::vector<int32_t> &indices,
+            const std::vector<float> &times,
+            const std::vector<std::vector<float>> &positions,
+            TrajectoryInterpolations interpolation,
+            TrajectoryStatus_t &status,
+            int timeout_period_us = k_defaultTimeoutPeriodUs,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Starts playing an uploaded trajectory. Progress is pushed every time
+     * playback reaches the next waypoint, see getTrajectoryStatus.
+     * @param trajectoryId Id of the trajectory
+     * @param status The reply
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if the trajectory started, false if it fails
+     */
+    bool startTrajectory(
+            int32_t trajectoryId,
+            TrajectoryStatus_t &status,
+            int timeout_period_us = k_defaultTimeoutPeriodUs,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Stops the trajectory playing, the robot stays where it is
+     * @param status The reply
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool stopTrajectory(
+            TrajectoryStatus_t &status,
+            int timeout_period_us = k_defaultTimeoutPeriodUs,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Gets the latest progress of the trajectory of this client
+     * @return the latest trajectory status
+     */
+    TrajectoryStatus_t getTrajectoryStatus();
+
     /**
      * Sends one desired joint position to the simulator
      * @param robotPosition desired joint position
@@ -193,6 +309,204 @@ public:
         int timeout_period_us = k_defaultTimeoutPeriodUs,
         unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
 
+    /**
+     * Registers a selection of rigid-body and object frames under an id of
+     * your choice, so that getFrames only needs to send the id on each cycle.
+     * Registering an id again replaces its selection.
+     * @param selectionId Id of the selection
+     * @param items Up to MAX_FRAME_SELECTION_ITEMS frames
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool registerFrameSelection(
+        int32_t selectionId,
+        const std::vector<FrameSelection_t> &items,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Gets all frames of a registered selection in world coordinate frame
+     * with one request
+     * @param selectionId Id of the selection
+     * @param frames The frames in the order of the selection. frameId is the
+     * position of the frame in the selection.
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails or the selection is not
+     * registered
+     */
+    bool getFrames(
+        int32_t selectionId, std::vector<Frame_t> &frames,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Gets the given frames in world coordinate frame with one request
+     * @param items Up to MAX_FRAME_SELECTION_ITEMS frames
+     * @param frames The frames in the order of items. frameId is the
+     * position of the frame in items.
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool getFrames(
+        const std::vector<FrameSelection_t> &items,
+        std::vector<Frame_t> &frames,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Subscribes to state the simulator pushes after every forward
+     * kinematics cycle, instead of requesting it. Replaces any previous
+     * subscription of this client.
+     * @param topics Bit mask of SubscriptionTopics
+     * @param decimation State is pushed every decimation cycles
+     * @param selectionId Registered frame selection published for
+     * TOPIC_FRAMES
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool subscribe(
+        uint32_t topics,
+        int32_t decimation = 1,
+        int32_t selectionId = 0,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Stops the state pushed by the simulator
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool unsubscribe(
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Gets the latest joint values, either published for TOPIC_JOINT_VALUES
+     * or received as a reply, without sending a request
+     * @return the latest joint values
+     */
+    JointPositions_t getLatestJointValues();
+
+    /**
+     * Gets the latest pose of the end-effector, either published for
+     * TOPIC_END_EFFECTOR or received as a reply, without sending a request
+     * @return the latest pose of the end-effector
+     */
+    Frame_t getLatestEndEffectorFrame();
+
+    /**
+     * Gets the frames last published for TOPIC_FRAMES, in the order of the
+     * subscribed selection. Fault status is published for TOPIC_FAULT_STATUS
+     * and read with getErrorMessage.
+     * @return the latest published frames
+     */
+    std::vector<Frame_t> getLatestFrames();
+
+    /**
+     * Requests the pose of the end-effector without waiting for the reply.
+     * Any number of asynchronous requests can be outstanding at once, so
+     * e.g. the frames of all links can be fetched in about one round trip.
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return The pose of the end-effector. get() throws std::runtime_error
+     * if the request could not be sent or the reply did not arrive in time
+     */
+    std::future<Frame_t> requestEndEffectorFrameAsync(
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests the pose of the end-effector and calls back with the reply.
+     * The callback runs on the receiver thread and should return quickly.
+     * @param callback Called once with the reply
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return true if the request was sent, false if it fails
+     */
+    bool requestEndEffectorFrameAsync(
+        const FrameCallback_t &callback,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests a frame of a rigid-body without waiting for the reply
+     * @param indexRigidBody The rigid body index
+     * @param indexFrame The frame index
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return The frame in world coordinate. get() throws std::runtime_error
+     * if the request could not be sent or the reply did not arrive in time
+     */
+    std::future<Frame_t> requestRigidBodyFrameAsync(
+        int32_t indexRigidBody, int32_t indexFrame,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests a frame of a rigid-body and calls back with the reply
+     * @param indexRigidBody The rigid body index
+     * @param indexFrame The frame index
+     * @param callback Called once with the reply on the receiver thread
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return true if the request was sent, false if it fails
+     */
+    bool requestRigidBodyFrameAsync(
+        int32_t indexRigidBody, int32_t indexFrame,
+        const FrameCallback_t &callback,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests a frame of an object without waiting for the reply
+     * @param indexObject The object index
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return The object frame in world coordinate. get() throws
+     * std::runtime_error if the request could not be sent or the reply did
+     * not arrive in time
+     */
+    std::future<Frame_t> requestObjectFrameAsync(
+        int32_t indexObject,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests a frame of an object and calls back with the reply
+     * @param indexObject The object index
+     * @param callback Called once with the reply on the receiver thread
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return true if the request was sent, false if it fails
+     */
+    bool requestObjectFrameAsync(
+        int32_t indexObject,
+        const FrameCallback_t &callback,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests the joint values without waiting for the reply
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return The joint values. get() throws std::runtime_error if the
+     * request could not be sent or the reply did not arrive in time
+     */
+    std::future<JointPositions_t> requestJointValuesAsync(
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Requests the joint values and calls back with the reply
+     * @param callback Called once with the reply on the receiver thread
+     * @param timeout_period_us How long the reply may take
+     * @param msgPriority Message priority
+     * @return true if the request was sent, false if it fails
+     */
+    bool requestJointValuesAsync(
+        const JointValuesCallback_t &callback,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
     /**
      * Gets the error message of the simulator
      * @param msgPriority Message priority
@@ -315,6 +629,97 @@ public:
         int32_t linkFrame,
         unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
 
+    /**
+     * Gets the latency percentiles of the messages of this client and of the
+     * simulator, by message id and stage. The client measures the transport
+     * of what it receives, how long sends kept it, and the round trip of
+     * requests. The simulator measures the transport of what it receives,
+     * the wait for and run of its handler, and kinematics and collision
+     * detection.
+     * @param client Statistics of this client
+     * @param server Statistics of the simulator
+     * @param shouldReset Starts the histograms of both sides over
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool getLatencyStatistics(
+        std::vector<LatencyStatistics_t> &client,
+        std::vector<LatencyStatistics_t> &server,
+        bool shouldReset = false,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Writes the latency statistics of this client and of the simulator to a
+     * CSV file, one line per side, message id and stage
+     * @param fileName File to write, replaced if it exists
+     * @param shouldReset Starts the histograms of both sides over
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool dumpLatencyStatistics(
+        const std::string &fileName,
+        bool shouldReset = false,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Gets the metrics of the simulator cycle: forward kinematics, collision
+     * detection and render times, the interval and jitter of the joint
+     * values, the depth of the control queue and the dropped messages. The
+     * simulator also publishes them to the TarsimStatistics shared memory
+     * page, which StatisticsPageReader reads without a message.
+     * @param statistics Statistics of every metric, by metric id
+     * @param shouldReset Starts the metrics over
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool getStatistics(
+        std::vector<MetricStatistics_t> &statistics,
+        bool shouldReset = false,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Writes the metrics of the simulator to a CSV file, one line per metric
+     * @param fileName File to write, replaced if it exists
+     * @param shouldReset Starts the metrics over
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool dumpStatistics(
+        const std::string &fileName,
+        bool shouldReset = false,
+        int timeout_period_us = k_defaultTimeoutPeriodUs,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Request the simulator to start tracing the spans of its cycle, e.g.
+     * message dispatch, kinematics, collision detection and rendering. The
+     * spans traced so far are discarded.
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool startTrace(
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Request the simulator to stop tracing and to write the trace as Chrome
+     * Trace JSON, which chrome://tracing and ui.perfetto.dev open
+     * @param fileName Name of the file the simulator writes, in traceTarsim of
+     * its home directory. Names with a '/' or starting with '.' are
+     * rejected, and nothing is written if empty.
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool stopTrace(
+        const std::string &fileName,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
 private:
     /**
      * Returns a time stamp for the message
@@ -322,6 +727,52 @@ private:
      */
     int32_t getMsgStamp();
 
+    /**
+     * Sends a trajectory command and waits for its status
+     * @param out The command
+     * @param status The reply
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if a reply arrived, false if it fails
+     */
+    bool sendTrajectoryCommand(
+            TrajectoryCommand_t &out, TrajectoryStatus_t &status,
+            int timeout_period_us, unsigned int msgPriority);
+
+    /**
+     * Sends a frames batch request and gathers the chunks of its reply
+     * @param out The request
+     * @param frames The frames of the reply
+     * @param timeout_period_us How long we should wait for a response
+     * @param msgPriority Message priority
+     * @return true if successful, false if it fails
+     */
+    bool requestFramesBatch(
+            RequestFramesBatch_t &out, std::vector<Frame_t> &frames,
+            int timeout_period_us, unsigned int msgPriority);
+
+    /**
+     * Opens a completion slot that hands the reply to a frame request to
+     * the callback
+     * @param msgCounter Counter of the request
+     * @param callback Called once with the reply
+     * @param timeout_period_us How long the reply may take
+     */
+    void expectFrame(
+            int32_t msgCounter, const FrameCallback_t &callback,
+            int timeout_period_us);
+
+    /**
+     * Opens a completion slot that hands the reply to a joint values request
+     * to the callback
+     * @param msgCounter Counter of the request
+     * @param callback Called once with the reply
+     * @param timeout_period_us How long the reply may take
+     */
+    void expectJointValues(
+            int32_t msgCounter, const JointValuesCallback_t &callback,
+            int timeout_period_us);
+
     /**
      * Sends request to get the end-effector pose
      * @param msgThe message request to the end-effector pose
@@ -373,11 +824,6 @@ private:
      */
     EitOsMsgClientSender* m_eitOsMsgClientSender = nullptr;
 
-    /**
-     * How long we sleep between every time we check if we received a response.
-     */
-    const int k_sleepTimeUs = 10;
-
     /**
      * Default timeout duration in us. It is used when we query data from
      * simulator and wait for a response
@@ -385,9 +831,15 @@ private:
     static const int k_defaultTimeoutPeriodUs = 100000;
 
     /**
-     * Number of messages sent
+     * Number of messages sent. Atomic since asynchronous requests may be
+     * issued from callbacks on the receiver thread.
+     */
+    std::atomic<int32_t> m_counter {0};
+
+    /**
+     * Index of this client, used to name its queue and rings
      */
-    int32_t m_counter = 0;
+    int32_t m_index = 0;
 };
 } // end of namespace tarsim
 // ENDIF
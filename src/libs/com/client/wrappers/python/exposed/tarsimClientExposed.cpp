@@ -17,6 +17,7 @@
  */
 
 //INCLUDES
+#include <algorithm>
 #include <cstdio>
 #include <stdexcept>
 #include "tarsimClientExposed.h"
@@ -81,6 +82,42 @@ bool isSimulatorRunning()
     return g_tarsimClientExposed->isSimulatorRunning();
 }
 
+bool startRecording()
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return g_tarsimClientExposed->startRecording();
+}
+
+bool stopRecording()
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return g_tarsimClientExposed->stopRecording();
+}
+
+bool startTrace()
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return g_tarsimClientExposed->startTrace();
+}
+
+bool stopTrace(const char* fileName)
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return g_tarsimClientExposed->stopTrace(fileName);
+}
+
 bool sendJointPositions(JointPositions_t &msg)
 {
     if (g_tarsimClientExposed == nullptr) {
@@ -191,6 +228,42 @@ bool getJointValues(JointPositions_t &msg, int timeout_period_us = 100000)
     return g_tarsimClientExposed->getJointValues(msg, timeout_period_us);
 }
 
+bool sendJointArray(
+        const int32_t* indices, const double* positions, int32_t numJoints)
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return g_tarsimClientExposed->sendJointArray(indices, positions, numJoints);
+}
+
+bool stepJointPositions(
+        const JointPositions_t &robotPosition, StepResult_t &result,
+        int timeout_period_us)
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return g_tarsimClientExposed->step(robotPosition, result, timeout_period_us);
+}
+
+int32_t stepBatch(
+        const int32_t* indices, const double* positions,
+        int32_t numConfigurations, int32_t numJoints,
+        double* frames, int32_t* numCollisions, int32_t* errorIds,
+        int timeout_period_us)
+{
+    if (g_tarsimClientExposed == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return 0;
+    }
+    return g_tarsimClientExposed->stepBatch(
+            indices, positions, numConfigurations, numJoints,
+            frames, numCollisions, errorIds, timeout_period_us);
+}
+
 ErrorMessage_t getErrorMessage()
 {
     return g_tarsimClientExposed->getErrorMessage();
@@ -296,6 +369,24 @@ bool TarsimClientExposed::stopRecording()
     return m_tarsimClient->stopRecording();
 }
 
+bool TarsimClientExposed::startTrace()
+{
+    if (m_tarsimClient == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return m_tarsimClient->startTrace();
+}
+
+bool TarsimClientExposed::stopTrace(const char* fileName)
+{
+    if (m_tarsimClient == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return m_tarsimClient->stopTrace(fileName);
+}
+
 bool TarsimClientExposed::isSimulatorRunning()
 {
     if (m_tarsimClient == nullptr) {
@@ -417,6 +508,65 @@ bool TarsimClientExposed::getJointValues(
     return m_tarsimClient->getJointValues(msg, timeout_period_us);
 }
 
+bool TarsimClientExposed::sendJointArray(
+        const int32_t* indices, const double* positions, int32_t numJoints)
+{
+    if (m_tarsimClient == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return m_tarsimClient->sendJointPositions(
+            std::vector<int32_t>(indices, indices + numJoints),
+            std::vector<float>(positions, positions + numJoints));
+}
+
+bool TarsimClientExposed::step(
+        const JointPositions_t &robotPosition, StepResult_t &result,
+        int timeout_period_us)
+{
+    if (m_tarsimClient == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return false;
+    }
+    return m_tarsimClient->step(robotPosition, result, timeout_period_us);
+}
+
+int32_t TarsimClientExposed::stepBatch(
+        const int32_t* indices, const double* positions,
+        int32_t numConfigurations, int32_t numJoints,
+        double* frames, int32_t* numCollisions, int32_t* errorIds,
+        int timeout_period_us)
+{
+    if (m_tarsimClient == nullptr) {
+        printf("TarsimClient was not initialized\n");
+        return 0;
+    }
+    if (numJoints > MAX_JOINTS) {
+        printf("A step can have at most %d joints\n", MAX_JOINTS);
+        return 0;
+    }
+
+    JointPositions_t robotPosition;
+    robotPosition.numJoints = numJoints;
+    std::copy(indices, indices + numJoints, robotPosition.indices);
+
+    StepResult_t result;
+    for (int32_t i = 0; i < numConfigurations; i++) {
+        const double* row = positions + (size_t)i * numJoints;
+        std::copy(row, row + numJoints, robotPosition.positions);
+        if (!m_tarsimClient->step(robotPosition, result, timeout_period_us)) {
+            return i;
+        }
+
+        std::copy(result.mij, result.mij + FRAME_INDICES,
+                frames + (size_t)i * FRAME_INDICES);
+        numCollisions[2 * i] = result.numSelfCollisions;
+        numCollisions[2 * i + 1] = result.numExternalCollisions;
+        errorIds[i] = result.errorId;
+    }
+    return numConfigurations;
+}
+
 ErrorMessage_t TarsimClientExposed::getErrorMessage()
 {
     return m_tarsimClient->getErrorMessage();
@@ -33,6 +33,8 @@ bool shutdown();
 bool isSimulatorRunning();
 bool startRecording();
 bool stopRecording();
+bool startTrace();
+bool stopTrace(const char* fileName);
 
 // Send functions
 bool sendJointPositions(JointPositions_t &robotPosition);
@@ -56,6 +58,27 @@ bool getObjectFrame(int32_t indexObject, Frame_t &msg);
 bool setObjectFrame(int32_t indexObject, Frame_t &msg);
 bool getJointValues(JointPositions_t &msg, int timeout_period_us);
 
+// Array functions, for callers holding contiguous buffers such as NumPy arrays
+bool sendJointArray(
+        const int32_t* indices, const double* positions, int32_t numJoints);
+bool stepJointPositions(
+        const JointPositions_t &robotPosition, StepResult_t &result,
+        int timeout_period_us);
+
+/**
+ * Steps through numConfigurations configurations of numJoints joints, one
+ * after the other, and writes the outcome of every step. positions is row
+ * major, a row per configuration; frames takes 16 values per configuration
+ * and numCollisions the self and external collision counts. It stops at the
+ * first step that fails.
+ * @return number of configurations stepped
+ */
+int32_t stepBatch(
+        const int32_t* indices, const double* positions,
+        int32_t numConfigurations, int32_t numJoints,
+        double* frames, int32_t* numCollisions, int32_t* errorIds,
+        int timeout_period_us);
+
 // Receive functions
 ErrorMessage_t getErrorMessage();
 
@@ -85,6 +108,8 @@ public:
     bool shutdown();
     bool startRecording();
     bool stopRecording();
+    bool startTrace();
+    bool stopTrace(const char* fileName);
     bool isSimulatorRunning();
 
     // Send functions
@@ -109,6 +134,17 @@ public:
     bool getJointValues(
         JointPositions_t &msg, int timeout_period_us);
 
+    bool sendJointArray(
+            const int32_t* indices, const double* positions, int32_t numJoints);
+    bool step(
+            const JointPositions_t &robotPosition, StepResult_t &result,
+            int timeout_period_us);
+    int32_t stepBatch(
+            const int32_t* indices, const double* positions,
+            int32_t numConfigurations, int32_t numJoints,
+            double* frames, int32_t* numCollisions, int32_t* errorIds,
+            int timeout_period_us);
+
     // Receive functions
     ErrorMessage_t getErrorMessage();
 
@@ -21,6 +21,12 @@ class Simulator():
     
     def stopRecording(self):
         return self.interface.stopRecording()
+
+    def startTrace(self):
+        return self.interface.startTrace()
+
+    def stopTrace(self, fileName):
+        return self.interface.stopTrace(fileName)
     
     def shutdown(self):
         return self.interface.shutdown()
@@ -90,6 +96,39 @@ class Simulator():
     def getErrorMessage(self):
         return self.interface.getErrorMessage()
 
+    # Array functions. They take NumPy arrays, or anything of the buffer
+    # protocol, without converting element by element. Arrays already of the
+    # right type and C contiguous are passed to the simulator as they are.
+    # The GIL is released while waiting for the simulator.
+    def sendJointArray(self, jointIndices, jointPositions):
+        return self.interface.sendJointArray(jointIndices, jointPositions)
+
+    def getJointArray(self, timeout_period_us=100000):
+        return self.interface.getJointArray(timeout_period_us)
+
+    def step(self, jointIndices, jointPositions, timeout_period_us=100000):
+        return self.interface.step(
+            jointIndices, jointPositions, timeout_period_us)
+
+    def stepBatch(self, jointIndices, configurations, timeout_period_us=100000):
+        return self.interface.stepBatch(
+            jointIndices, configurations, timeout_period_us)
+
+    def sendBaseFrameArray(self, frame):
+        return self.interface.sendBaseFrameArray(frame)
+
+    def setObjectFrameArray(self, indexObject, frame):
+        return self.interface.setObjectFrameArray(indexObject, frame)
+
+    def getEndEffectorFrameArray(self):
+        return self.interface.getEndEffectorFrameArray()
+
+    def getRigidBodyFrameArray(self, indexRigidBody, indexFrame):
+        return self.interface.getRigidBodyFrameArray(indexRigidBody, indexFrame)
+
+    def getObjectFrameArray(self, indexObject):
+        return self.interface.getObjectFrameArray(indexObject)
+
 
 
 
@@ -19,9 +19,11 @@
 //INCLUDES
 #include "Python.h"
 
+#include <algorithm>
 #include <cmath>
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 #include <numpy/ndarrayobject.h>
+#include <string>
 #include <vector>
 #include <wrappers/python/exposed/tarsimClientExposed.h>
 
@@ -61,9 +63,90 @@ PyObject* InterfaceError(std::string msg)
     return nullptr;
 }
 
+// Default time to wait for a reply of the simulator, in us
+static const int DEFAULT_TIMEOUT_PERIOD_US = 100000;
+
+// Owns a reference to an array until the end of a wrapper
+struct ArrayReference {
+    PyArrayObject* array = nullptr;
+    ~ArrayReference() { Py_XDECREF(array); }
+};
+
+// Takes obj as a C contiguous array of type with ndim dimensions. NumPy
+// arrays that already are one are used as they are, without a copy, and any
+// other object of the buffer protocol or sequence is converted once.
+static bool toArray(
+        PyObject* obj, int type, int ndim, ArrayReference &reference)
+{
+    reference.array = (PyArrayObject*)PyArray_FROM_OTF(
+            obj, type, NPY_ARRAY_IN_ARRAY);
+    if (reference.array == nullptr) {
+        InterfaceError("Bad data type in array.");
+        return false;
+    }
+
+    if (PyArray_NDIM(reference.array) != ndim) {
+        InterfaceError("Array has the wrong number of dimensions.");
+        return false;
+    }
+    return true;
+}
+
+// Returns the frame as a new 4x4 float64 array
+static PyObject* frameToArray(const float* mij)
+{
+    npy_intp dims[2] = {4, 4};
+    PyObject* array = PyArray_SimpleNew(2, dims, NPY_FLOAT64);
+    if (array == nullptr) {
+        return nullptr;
+    }
+    std::copy(mij, mij + FRAME_INDICES,
+            (double*)PyArray_DATA((PyArrayObject*)array));
+    return array;
+}
+
+// Takes a frame from a 4x4 float64 array
+static bool arrayToFrame(PyObject* obj, Frame_t &msg)
+{
+    ArrayReference frame;
+    if (!toArray(obj, NPY_FLOAT64, 2, frame)) {
+        return false;
+    }
+
+    if (PyArray_DIM(frame.array, 0) != 4 || PyArray_DIM(frame.array, 1) != 4) {
+        InterfaceError("Frame must be a 4x4 array.");
+        return false;
+    }
+
+    const double* mij = (const double*)PyArray_DATA(frame.array);
+    std::copy(mij, mij + FRAME_INDICES, msg.mij);
+    return true;
+}
+
+// Takes joint indices and positions as two arrays of the same length
+static bool toJointArrays(
+        PyObject* indicesObj, PyObject* positionsObj,
+        ArrayReference &indices, ArrayReference &positions)
+{
+    if (!toArray(indicesObj, NPY_INT32, 1, indices) ||
+        !toArray(positionsObj, NPY_FLOAT64, 1, positions)) {
+        return false;
+    }
+
+    if (PyArray_DIM(indices.array, 0) != PyArray_DIM(positions.array, 0)) {
+        InterfaceError("Joint indices and positions differ in length.");
+        return false;
+    }
+    return true;
+}
+
 static PyObject* initialize_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (!initialize()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = initialize();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to initialize network.");
     }
 
@@ -72,7 +155,11 @@ static PyObject* initialize_wrap(PyObject* /*self*/, PyObject* args)
 
 static PyObject* stop_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (!stop()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = stop();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to stop network.");
     }
 
@@ -81,7 +168,11 @@ static PyObject* stop_wrap(PyObject* /*self*/, PyObject* args)
 
 static PyObject* connect_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (!connect()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = connect();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to connect to simulator.");
     }
 
@@ -90,7 +181,11 @@ static PyObject* connect_wrap(PyObject* /*self*/, PyObject* args)
 
 static PyObject* shutdown_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (!shutdown()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = shutdown();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to shutdown simulator.");
     }
 
@@ -99,7 +194,11 @@ static PyObject* shutdown_wrap(PyObject* /*self*/, PyObject* args)
 
 static PyObject* isSimulatorRunning_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (isSimulatorRunning()) {
+    bool isRunning = false;
+    Py_BEGIN_ALLOW_THREADS
+    isRunning = isSimulatorRunning();
+    Py_END_ALLOW_THREADS
+    if (isRunning) {
         Py_RETURN_TRUE;
     }
 
@@ -108,7 +207,11 @@ static PyObject* isSimulatorRunning_wrap(PyObject* /*self*/, PyObject* args)
 
 static PyObject* startRecording_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (!startRecording()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = startRecording();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to start recording.");
     }
 
@@ -117,13 +220,48 @@ static PyObject* startRecording_wrap(PyObject* /*self*/, PyObject* args)
 
 static PyObject* stopRecording_wrap(PyObject* /*self*/, PyObject* args)
 {
-    if (!stopRecording()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = stopRecording();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to stop recording.");
     }
 
     Py_RETURN_TRUE;
 }
 
+static PyObject* startTrace_wrap(PyObject* /*self*/, PyObject* args)
+{
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = startTrace();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to start tracing.");
+    }
+
+    Py_RETURN_TRUE;
+}
+
+static PyObject* stopTrace_wrap(PyObject* /*self*/, PyObject* args)
+{
+    const char* fileName;
+    if (!PyArg_ParseTuple(args, "s", &fileName)) {
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = stopTrace(fileName);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to stop tracing.");
+    }
+
+    Py_RETURN_TRUE;
+}
+
 static PyObject* sendJointPositions_wrap(PyObject* /*self*/, PyObject* args)
 {
     int msgCounter = 0;
@@ -160,7 +298,11 @@ static PyObject* sendJointPositions_wrap(PyObject* /*self*/, PyObject* args)
         }
     }
 
-    if (!sendJointPositions(msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = sendJointPositions(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send joint positions.");
     }
 
@@ -202,7 +344,11 @@ static PyObject* getJointValues_wrap(PyObject* /*self*/, PyObject* args)
         }
     }
 
-    if (!getJointValues(msg, timeout_period_us)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getJointValues(msg, timeout_period_us);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send joint positions.");
     }
 
@@ -224,7 +370,11 @@ static PyObject* sendJointPosition_wrap(PyObject* /*self*/, PyObject* args)
     msg.position = position;
     msg.msgCounter = (int32_t)msgCounter;
 
-    if (!sendJointPosition(msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = sendJointPosition(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send joint positions.");
     }
 
@@ -264,7 +414,11 @@ static PyObject* sendBaseFrame_wrap(PyObject* /*self*/, PyObject* args)
     msg.mij[14] = 0.0;
     msg.mij[15] = 1.0;
 
-    if (!sendBaseFrame(msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = sendBaseFrame(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send base frame.");
     }
 
@@ -327,7 +481,11 @@ static PyObject* sendCamera_wrap(PyObject* /*self*/, PyObject* args)
         }
     }
 
-    if (!sendCamera(msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = sendCamera(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send base frame.");
     }
 
@@ -343,7 +501,11 @@ static PyObject* sendLockObjectToRigidBody_wrap(PyObject* /*self*/, PyObject* ar
         return InterfaceError("Failed to parse arguments.");
     }
 
-    if (!lockObjectToRigidBody(indexObject, indexRigidBody)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = lockObjectToRigidBody(indexObject, indexRigidBody);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send lock object.");
     }
 
@@ -359,7 +521,11 @@ static PyObject* sendUnlockObjectFromRigidBody_wrap(PyObject* /*self*/, PyObject
         return InterfaceError("Failed to parse arguments.");
     }
 
-    if (!unlockObjectFromRigidBody(indexObject)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = unlockObjectFromRigidBody(indexObject);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError("Failed to send lock object.");
     }
 
@@ -369,7 +535,11 @@ static PyObject* sendUnlockObjectFromRigidBody_wrap(PyObject* /*self*/, PyObject
 static PyObject* executeForwardKinematics_wrap(
         PyObject* /*self*/, PyObject* args)
 {
-    if (!executeForwardKinematics()) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = executeForwardKinematics();
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError(
                 "Failed to send request to execute forward kinematics.");
     }
@@ -382,7 +552,11 @@ static PyObject* getEndEffectorFrame_wrap(
 {
     Frame_t msg;
 
-    if (!getEndEffectorFrame(msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getEndEffectorFrame(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError(
                 "Failed to send request to get end-effector frame");
     }
@@ -400,7 +574,11 @@ static PyObject* getRigidBodyFrame_wrap(PyObject* /*self*/, PyObject* args)
     }
 
     Frame_t msg;
-    if (!getRigidBodyFrame((int32_t)indexRigidBody, (int32_t)indexFrame, msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getRigidBodyFrame((int32_t)indexRigidBody, (int32_t)indexFrame, msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError(
                 "Failed to send request to get rigid body frame.");
     }
@@ -420,7 +598,11 @@ static PyObject* getObjectFrame_wrap(
 
     Frame_t msg;
 
-    if (!getObjectFrame((int32_t)indexObject, msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getObjectFrame((int32_t)indexObject, msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError(
                 "Failed to send request to get object frame.");
     }
@@ -463,7 +645,11 @@ static PyObject* setObjectFrame_wrap(
     msg.mij[14] = 0.0;
     msg.mij[15] = 1.0;
 
-    if (!setObjectFrame((int32_t)indexObject, msg)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = setObjectFrame((int32_t)indexObject, msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError(
                 "Failed to send request to get object frame.");
     }
@@ -489,7 +675,11 @@ static PyObject* displayMessage_wrap(
         return InterfaceError("Failed to parse arguments.");
     }
 
-    if (!displayMessage(message, level)) {
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = displayMessage(message, level);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
         return InterfaceError(
                 "Failed to send request to get object frame.");
     }
@@ -497,6 +687,284 @@ static PyObject* displayMessage_wrap(
     Py_RETURN_TRUE;
 }
 
+static PyObject* sendJointArray_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* indicesObj;
+    PyObject* positionsObj;
+    if (!PyArg_ParseTuple(args, "OO", &indicesObj, &positionsObj)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    ArrayReference indices, positions;
+    if (!toJointArrays(indicesObj, positionsObj, indices, positions)) {
+        return nullptr;
+    }
+
+    const int32_t* indicesData = (const int32_t*)PyArray_DATA(indices.array);
+    const double* positionsData = (const double*)PyArray_DATA(positions.array);
+    int32_t numJoints = (int32_t)PyArray_DIM(indices.array, 0);
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = sendJointArray(indicesData, positionsData, numJoints);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to send joint positions.");
+    }
+
+    Py_RETURN_TRUE;
+}
+
+static PyObject* getJointArray_wrap(PyObject* /*self*/, PyObject* args)
+{
+    int timeout_period_us = DEFAULT_TIMEOUT_PERIOD_US;
+    if (!PyArg_ParseTuple(args, "|i", &timeout_period_us)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    JointPositions_t msg;
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getJointValues(msg, timeout_period_us);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to get joint values.");
+    }
+
+    npy_intp dims[1] = {std::min(std::max(msg.numJoints, 0), MAX_JOINTS)};
+    PyObject* indices = PyArray_SimpleNew(1, dims, NPY_INT32);
+    PyObject* positions = PyArray_SimpleNew(1, dims, NPY_FLOAT64);
+    if (indices == nullptr || positions == nullptr) {
+        Py_XDECREF(indices);
+        Py_XDECREF(positions);
+        return nullptr;
+    }
+    std::copy(msg.indices, msg.indices + dims[0],
+            (int32_t*)PyArray_DATA((PyArrayObject*)indices));
+    std::copy(msg.positions, msg.positions + dims[0],
+            (double*)PyArray_DATA((PyArrayObject*)positions));
+    return Py_BuildValue("NN", indices, positions);
+}
+
+static PyObject* step_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* indicesObj;
+    PyObject* positionsObj;
+    int timeout_period_us = DEFAULT_TIMEOUT_PERIOD_US;
+    if (!PyArg_ParseTuple(args, "OO|i",
+            &indicesObj, &positionsObj, &timeout_period_us)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    ArrayReference indices, positions;
+    if (!toJointArrays(indicesObj, positionsObj, indices, positions)) {
+        return nullptr;
+    }
+
+    JointPositions_t msg;
+    msg.numJoints = (int32_t)PyArray_DIM(indices.array, 0);
+    if (msg.numJoints > MAX_JOINTS) {
+        return InterfaceError("Too many joints for a step.");
+    }
+    const int32_t* indicesData = (const int32_t*)PyArray_DATA(indices.array);
+    const double* positionsData = (const double*)PyArray_DATA(positions.array);
+    std::copy(indicesData, indicesData + msg.numJoints, msg.indices);
+    std::copy(positionsData, positionsData + msg.numJoints, msg.positions);
+
+    StepResult_t result;
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = stepJointPositions(msg, result, timeout_period_us);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to step.");
+    }
+
+    PyObject* frame = frameToArray(result.mij);
+    if (frame == nullptr) {
+        return nullptr;
+    }
+    return Py_BuildValue("Niiii", frame, result.errorId, result.errorJoint,
+            result.numSelfCollisions, result.numExternalCollisions);
+}
+
+static PyObject* stepBatch_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* indicesObj;
+    PyObject* positionsObj;
+    int timeout_period_us = DEFAULT_TIMEOUT_PERIOD_US;
+    if (!PyArg_ParseTuple(args, "OO|i",
+            &indicesObj, &positionsObj, &timeout_period_us)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    ArrayReference indices, positions;
+    if (!toArray(indicesObj, NPY_INT32, 1, indices) ||
+        !toArray(positionsObj, NPY_FLOAT64, 2, positions)) {
+        return nullptr;
+    }
+
+    npy_intp numConfigurations = PyArray_DIM(positions.array, 0);
+    npy_intp numJoints = PyArray_DIM(indices.array, 0);
+    if (PyArray_DIM(positions.array, 1) != numJoints) {
+        return InterfaceError("Joint indices and positions differ in length.");
+    }
+    if (numJoints > MAX_JOINTS) {
+        return InterfaceError("Too many joints for a step.");
+    }
+
+    // The outcome is written straight into the arrays returned
+    npy_intp frameDims[3] = {numConfigurations, 4, 4};
+    npy_intp collisionDims[2] = {numConfigurations, 2};
+    ArrayReference frames, collisions, errorIds;
+    frames.array = (PyArrayObject*)PyArray_SimpleNew(3, frameDims, NPY_FLOAT64);
+    collisions.array = (PyArrayObject*)PyArray_SimpleNew(
+            2, collisionDims, NPY_INT32);
+    errorIds.array = (PyArrayObject*)PyArray_SimpleNew(
+            1, frameDims, NPY_INT32);
+    if (frames.array == nullptr || collisions.array == nullptr ||
+        errorIds.array == nullptr) {
+        return nullptr;
+    }
+
+    const int32_t* indicesData = (const int32_t*)PyArray_DATA(indices.array);
+    const double* positionsData = (const double*)PyArray_DATA(positions.array);
+    double* framesData = (double*)PyArray_DATA(frames.array);
+    int32_t* collisionsData = (int32_t*)PyArray_DATA(collisions.array);
+    int32_t* errorIdsData = (int32_t*)PyArray_DATA(errorIds.array);
+    int32_t numStepped = 0;
+    Py_BEGIN_ALLOW_THREADS
+    numStepped = stepBatch(indicesData, positionsData,
+            (int32_t)numConfigurations, (int32_t)numJoints,
+            framesData, collisionsData, errorIdsData, timeout_period_us);
+    Py_END_ALLOW_THREADS
+    if (numStepped != numConfigurations) {
+        return InterfaceError("Failed to step configuration " +
+                std::to_string(numStepped) + ".");
+    }
+
+    return Py_BuildValue("OOO",
+            frames.array, collisions.array, errorIds.array);
+}
+
+static PyObject* sendBaseFrameArray_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* frameObj;
+    if (!PyArg_ParseTuple(args, "O", &frameObj)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    Frame_t msg;
+    if (!arrayToFrame(frameObj, msg)) {
+        return nullptr;
+    }
+
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = sendBaseFrame(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to send base frame.");
+    }
+
+    Py_RETURN_TRUE;
+}
+
+static PyObject* setObjectFrameArray_wrap(PyObject* /*self*/, PyObject* args)
+{
+    int indexObject;
+    PyObject* frameObj;
+    if (!PyArg_ParseTuple(args, "iO", &indexObject, &frameObj)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    Frame_t msg;
+    if (!arrayToFrame(frameObj, msg)) {
+        return nullptr;
+    }
+
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = setObjectFrame((int32_t)indexObject, msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to set object frame.");
+    }
+
+    Py_RETURN_TRUE;
+}
+
+static PyObject* getEndEffectorFrameArray_wrap(
+        PyObject* /*self*/, PyObject* args)
+{
+    Frame_t msg;
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getEndEffectorFrame(msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to get end-effector frame.");
+    }
+
+    return frameToArray(msg.mij);
+}
+
+static PyObject* getRigidBodyFrameArray_wrap(
+        PyObject* /*self*/, PyObject* args)
+{
+    int indexRigidBody, indexFrame;
+    if (!PyArg_ParseTuple(args, "ii", &indexRigidBody, &indexFrame)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    Frame_t msg;
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getRigidBodyFrame(
+            (int32_t)indexRigidBody, (int32_t)indexFrame, msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to get rigid body frame.");
+    }
+
+    return frameToArray(msg.mij);
+}
+
+static PyObject* getObjectFrameArray_wrap(
+        PyObject* /*self*/, PyObject* args)
+{
+    int indexObject;
+    if (!PyArg_ParseTuple(args, "i", &indexObject)) {
+        PyErr_Print();
+        fflush(stderr);
+        return InterfaceError("Failed to parse arguments.");
+    }
+
+    Frame_t msg;
+    bool isSuccessful = false;
+    Py_BEGIN_ALLOW_THREADS
+    isSuccessful = getObjectFrame((int32_t)indexObject, msg);
+    Py_END_ALLOW_THREADS
+    if (!isSuccessful) {
+        return InterfaceError("Failed to get object frame.");
+    }
+
+    return frameToArray(msg.mij);
+}
+
 // An array specifying exactly which methods are wrappers.
 // The syntax for each item is:
 // {String for the method name when converted to python code,
@@ -522,6 +990,12 @@ static PyMethodDef TarsimClientInterface_methods[] = {
     {"stopRecording", stopRecording_wrap, METH_VARARGS,
     "Stop recording the simulator window"},
 
+    {"startTrace", startTrace_wrap, METH_VARARGS,
+    "Start tracing the spans of the simulator cycle"},
+
+    {"stopTrace", stopTrace_wrap, METH_VARARGS,
+    "Stop tracing and write the trace as Chrome Trace JSON, to a file of that name in ~/traceTarsim of the simulator machine"},
+
     {"isSimulatorRunning", isSimulatorRunning_wrap, METH_VARARGS,
     "Whether the simulator is running"},
 
@@ -567,6 +1041,33 @@ static PyMethodDef TarsimClientInterface_methods[] = {
     {"displayMessage", displayMessage_wrap, METH_VARARGS,
     "Displays a text message on the simulator fault scene"},
 
+    {"sendJointArray", sendJointArray_wrap, METH_VARARGS,
+    "Sends joint positions from an int32 array of indices and a float64 array of positions"},
+
+    {"getJointArray", getJointArray_wrap, METH_VARARGS,
+    "Gets current joint values as an int32 array of indices and a float64 array of positions"},
+
+    {"step", step_wrap, METH_VARARGS,
+    "Sets joint positions, executes forward kinematics and returns the 4x4 end-effector frame, error id, error joint and collision counts"},
+
+    {"stepBatch", stepBatch_wrap, METH_VARARGS,
+    "Steps through an NxJ float64 array of configurations and returns Nx4x4 end-effector frames, Nx2 collision counts and N error ids"},
+
+    {"sendBaseFrameArray", sendBaseFrameArray_wrap, METH_VARARGS,
+    "Sends base frame from a 4x4 float64 array"},
+
+    {"setObjectFrameArray", setObjectFrameArray_wrap, METH_VARARGS,
+    "Sets an object frame from a 4x4 float64 array"},
+
+    {"getEndEffectorFrameArray", getEndEffectorFrameArray_wrap, METH_VARARGS,
+    "Gets end-effector frame as a 4x4 float64 array"},
+
+    {"getRigidBodyFrameArray", getRigidBodyFrameArray_wrap, METH_VARARGS,
+    "Gets a rigid-body frame as a 4x4 float64 array"},
+
+    {"getObjectFrameArray", getObjectFrameArray_wrap, METH_VARARGS,
+    "Gets an object frame as a 4x4 float64 array"},
+
     {nullptr, nullptr, 0, nullptr}};
 
 #if PY_MAJOR_VERSION >= 3
@@ -621,6 +1122,7 @@ void initTarsimClientInterface(void)
 
     Py_INCREF(st->error);
     PyModule_AddObject(module, "error", st->error);
+    g_wrapperError = st->error;
 
 #if PY_MAJOR_VERSION >= 3
     return module;
@@ -20,12 +20,15 @@
 
 #include "eitOsMsgClientReceiver.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cstring>
+#include <chrono>
 #include "serverDefs.h"
 #include "ipcMessages.h"
 #include "eitErrors.h"
 #include "logClient.h"
+#include "metricsRegistry.h"
 
 namespace tarsim {
 /**
@@ -33,7 +36,9 @@ namespace tarsim {
  */
 EitOsMsgClientReceiver::EitOsMsgClientReceiver(
         const std::string &mqName, int policy, int priority):
-        MsgQServer(mqName, policy, priority)
+        MsgQServer(mqName, policy, priority),
+        m_policy(policy),
+        m_priority(priority)
 {
     ErrorMessage_t msg;
     msg.msgCounter = -1;
@@ -50,7 +55,30 @@ EitOsMsgClientReceiver::EitOsMsgClientReceiver(
  */
 EitOsMsgClientReceiver::~EitOsMsgClientReceiver()
 {
+    stopExpiring();
 
+    delete m_shmRingServer;
+    m_shmRingServer = nullptr;
+
+    delete m_socketClient;
+    m_socketClient = nullptr;
+
+    // Nobody will answer the requests still in flight
+    std::vector<ReplyCallback_t> failed;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+        for (auto &pending: m_pendingReplies) {
+            if (pending.second->callback) {
+                failed.push_back(pending.second->callback);
+            }
+        }
+        m_pendingReplies.clear();
+    }
+
+    GenericData_t none {};
+    for (auto &callback: failed) {
+        callback(false, none);
+    }
 }
 
 /**
@@ -59,9 +87,72 @@ EitOsMsgClientReceiver::~EitOsMsgClientReceiver()
 Errors EitOsMsgClientReceiver::start()
 {
     MsgQServer::start();
+
+    std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+    if (!m_isExpiring) {
+        m_isExpiring = true;
+        m_expiryThread = std::thread(&EitOsMsgClientReceiver::expiring, this);
+    }
     return NO_ERR;
 }
 
+/**
+ * @brief create the server to client ring and consume it on its own thread
+ * @param[in] ringName - name of the shared memory ring
+ */
+Errors EitOsMsgClientReceiver::startSharedMemory(const std::string &ringName)
+{
+    if (m_shmRingServer != nullptr) {
+        return NO_ERR;
+    }
+
+    ShmRingServer* server = new ShmRingServer(
+            ringName, true,
+            [this](const GenericData_t &data) { onMessage(data); },
+            m_policy, m_priority);
+
+    if (NO_ERR != server->start()) {
+        printf("Failed to start shared memory ring %s\n", ringName.c_str());
+        delete server;
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_shmRingServer = server;
+    return NO_ERR;
+}
+
+/**
+ * @brief connect to the server socket and receive on its own thread
+ * @param[in] transport - TRANSPORT_UNIX_SOCKET or TRANSPORT_TCP
+ */
+Errors EitOsMsgClientReceiver::startSocket(TransportTypes transport)
+{
+    if (m_socketClient != nullptr) {
+        return NO_ERR;
+    }
+
+    bool isTcp = (TRANSPORT_TCP == transport);
+    SocketClient* client = new SocketClient(
+            isTcp ? SOCKET_TCP : SOCKET_UNIX,
+            isTcp ? TarsimTcpAddress : TarsimSocketPath, TarsimTcpPort,
+            [this](const GenericData_t &data) { onMessage(data); },
+            m_policy, m_priority);
+
+    if (NO_ERR != client->start()) {
+        printf("Failed to connect to socket %s\n", client->getName().c_str());
+        delete client;
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_socketClient = client;
+    return NO_ERR;
+}
+
+SocketClient* EitOsMsgClientReceiver::getSocket()
+{
+    return m_socketClient;
+}
+
 /**
  * @process the incoming data to the EitOsMsgClientReceiver Server
  * supported message id:
@@ -69,6 +160,8 @@ Errors EitOsMsgClientReceiver::start()
  */
 void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
 {
+    m_latency.recordTransport(inComingData.simpleMsg);
+
     switch (inComingData.simpleMsg.msgId)
     {
         case END_EFFECTOR_FRAME:
@@ -76,6 +169,7 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
             Frame_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
             setEndEffectorFrame(in);
+            completeReply(inComingData);
         }
         break;
 
@@ -84,6 +178,7 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
             Frame_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
             setObjectFrame(in);
+            completeReply(inComingData);
         }
         break;
 
@@ -92,6 +187,7 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
             ErrorMessage_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
             setErrorMessage(in);
+            completeReply(inComingData);
         }
         break;
 
@@ -100,6 +196,7 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
             Frame_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
             setRigidBodyFrame(in);
+            completeReply(inComingData);
         }
         break;
 
@@ -108,6 +205,7 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
             JointPositions_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
             setJointValues(in);
+            completeReply(inComingData);
         }
         break;
 
@@ -116,6 +214,34 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
             SimulatorStatus_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
             setIsSimulatorRunning(in.isSimRunning);
+            completeReply(inComingData);
+        }
+        break;
+
+        case FRAMES_BATCH:
+        {
+            FramesBatch_t in;
+            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+            if (PUBLISHED_MSG_COUNTER == in.msgCounter) {
+                setPublishedFrames(in);
+            } else {
+                completeReply(inComingData, in.chunkIndex, in.numChunks);
+            }
+        }
+        break;
+
+        case STEP_RESULT:
+        {
+            completeReply(inComingData);
+        }
+        break;
+
+        case TRAJECTORY_STATUS:
+        {
+            TrajectoryStatus_t in;
+            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+            setTrajectoryStatus(in);
+            completeReply(inComingData);
         }
         break;
 
@@ -139,10 +265,17 @@ void EitOsMsgClientReceiver::onMessage(const GenericData_t &inComingData)
         {
             CollisionMessage_t in;
             std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            setCollisions(in);
+            int32_t numCollisions =
+                    std::max(0, std::min(in.numCollisions, MAX_JOINTS));
+            setCollisions(std::vector<Collision>(
+                    in.collisions, in.collisions + numCollisions));
         }
         break;
 
+        case FRAMED_MESSAGE:
+            onFramedMessage(inComingData);
+            break;
+
         default:
             break;
     }
@@ -273,28 +406,409 @@ std::vector<std::pair<int32_t, int32_t>> EitOsMsgClientReceiver::getExternalColl
     return externalCollisions;
 }
 
-void EitOsMsgClientReceiver::setCollisions(const CollisionMessage_t &msg)
+void EitOsMsgClientReceiver::onFramedMessage(
+        const GenericData_t &inComingData)
+{
+    FramedMessage_t in;
+    std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+
+    std::vector<uint8_t> payload;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexAssembler);
+        if (!m_assembler.add(in, payload)) {
+            return;
+        }
+    }
+
+    switch (in.payloadId)
+    {
+        case COLLISION:
+        {
+            std::vector<Collision> collisions;
+            if (!readCollisions(payload, collisions)) {
+                printf("Invalid collision payload of %zu bytes\n",
+                        payload.size());
+                break;
+            }
+            setCollisions(collisions);
+        }
+        break;
+
+        case LATENCY_STATS:
+        {
+            MessageReader reader(payload);
+            int32_t msgCounter = 0;
+            std::vector<LatencyStatistics_t> statistics;
+            if (!reader.read(msgCounter) ||
+                !readLatencyStatistics(reader, statistics)) {
+                printf("Invalid latency payload of %zu bytes\n",
+                        payload.size());
+                break;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutexServerLatency);
+                m_serverLatency[msgCounter].swap(statistics);
+
+                // Replies nobody waits for any more are not kept forever
+                while (m_serverLatency.size() > MAX_PENDING_ASSEMBLIES) {
+                    m_serverLatency.erase(m_serverLatency.begin());
+                }
+            }
+
+            // The waiting request only needs to know the payload is there
+            GenericData_t reply {};
+            reply.simpleMsg.msgId = LATENCY_STATS;
+            reply.simpleMsg.msgCounter = msgCounter;
+            reply.simpleMsg.receiveTimeNs = in.receiveTimeNs;
+            completeReply(reply);
+        }
+        break;
+
+        case STATISTICS:
+        {
+            MessageReader reader(payload);
+            int32_t msgCounter = 0;
+            std::vector<MetricStatistics_t> statistics;
+            if (!reader.read(msgCounter) ||
+                !readMetricStatistics(reader, statistics)) {
+                printf("Invalid statistics payload of %zu bytes\n",
+                        payload.size());
+                break;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutexServerStatistics);
+                m_serverStatistics[msgCounter].swap(statistics);
+                while (m_serverStatistics.size() > MAX_PENDING_ASSEMBLIES) {
+                    m_serverStatistics.erase(m_serverStatistics.begin());
+                }
+            }
+
+            GenericData_t reply {};
+            reply.simpleMsg.msgId = STATISTICS;
+            reply.simpleMsg.msgCounter = msgCounter;
+            reply.simpleMsg.receiveTimeNs = in.receiveTimeNs;
+            completeReply(reply);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+bool EitOsMsgClientReceiver::readCollisions(
+        const std::vector<uint8_t> &payload,
+        std::vector<Collision> &collisions)
+{
+    MessageReader reader(payload);
+    int32_t numLinks = 0;
+    if (!reader.read(numLinks) || numLinks < 0) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < numLinks; i++) {
+        Collision collision;
+        if (!reader.read(collision.robotLink) ||
+            !reader.read(collision.numCollisions) ||
+            collision.numCollisions < 0 ||
+            collision.numCollisions > MAX_COLLISIONS ||
+            !reader.read(collision.rigidBody, collision.numCollisions)) {
+            return false;
+        }
+
+        for (int32_t j = 0; j < collision.numCollisions; j++) {
+            uint8_t isSelfCollision = 0;
+            if (!reader.read(isSelfCollision)) {
+                return false;
+            }
+            collision.isSelfCollision[j] = (0 != isSelfCollision);
+        }
+        collisions.push_back(collision);
+    }
+    return true;
+}
+
+void EitOsMsgClientReceiver::setCollisions(
+        const std::vector<Collision> &collisions)
 {
     std::unique_lock<std::mutex> lock(m_mutexCollisions);
     m_selfCollisions.clear();
     m_externalCollisions.clear();
-    for (int32_t i = 0; i < msg.numCollisions; i++) {
-        for (int32_t j = 0; j < msg.collisions[i].numCollisions; j++) {
-            if (msg.collisions[i].isSelfCollision[j]) {
+    for (const Collision &collision: collisions) {
+        for (int32_t j = 0; j < collision.numCollisions &&
+                j < MAX_COLLISIONS; j++) {
+            if (collision.isSelfCollision[j]) {
                 m_selfCollisions.push_back(std::make_pair(
-                        msg.collisions[i].robotLink, msg.collisions[i].rigidBody[j]));
+                        collision.robotLink, collision.rigidBody[j]));
             } else {
                 m_externalCollisions.push_back(std::make_pair(
-                        msg.collisions[i].robotLink, msg.collisions[i].rigidBody[j]));
+                        collision.robotLink, collision.rigidBody[j]));
             }
 
         }
     }
 }
 
-} // end of namespace tarsim
+void EitOsMsgClientReceiver::setPublishedFrames(const FramesBatch_t &msg)
+{
+    std::unique_lock<std::mutex> lock(m_mutexPublishedFrames);
+    if (0 == msg.chunkIndex) {
+        m_framesPublishing.clear();
+    }
 
+    // A chunk out of order means one was lost, so drop the batch
+    if ((int32_t)m_framesPublishing.size() !=
+            msg.chunkIndex * MAX_FRAMES_PER_BATCH) {
+        m_framesPublishing.clear();
+        return;
+    }
 
+    for (int32_t k = 0; k < msg.numFrames && k < MAX_FRAMES_PER_BATCH; k++) {
+        Frame_t frame;
+        frame.msgCounter = msg.msgCounter;
+        frame.frameId = (int32_t)m_framesPublishing.size();
+        std::memcpy(frame.mij, msg.mij[k], sizeof(frame.mij));
+        m_framesPublishing.push_back(frame);
+    }
 
+    if (msg.chunkIndex == msg.numChunks - 1) {
+        m_framesPublished.swap(m_framesPublishing);
+        m_framesPublishing.clear();
+    }
+}
+
+std::vector<Frame_t> EitOsMsgClientReceiver::getPublishedFrames()
+{
+    std::unique_lock<std::mutex> lock(m_mutexPublishedFrames);
+    std::vector<Frame_t> frames = m_framesPublished;
+    return frames;
+}
+
+void EitOsMsgClientReceiver::setTrajectoryStatus(const TrajectoryStatus_t &msg)
+{
+    std::unique_lock<std::mutex> lock(m_mutexTrajectoryStatus);
+    m_trajectoryStatus = msg;
+}
 
+TrajectoryStatus_t EitOsMsgClientReceiver::getTrajectoryStatus()
+{
+    std::unique_lock<std::mutex> lock(m_mutexTrajectoryStatus);
+    TrajectoryStatus_t msg = m_trajectoryStatus;
+    return msg;
+}
+
+void EitOsMsgClientReceiver::expectReply(int32_t msgCounter)
+{
+    std::shared_ptr<PendingReply_t> pending =
+            std::make_shared<PendingReply_t>();
+    pending->startTimeNs = getMonotonicTimeNs();
+
+    std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+    m_pendingReplies[msgCounter] = pending;
+}
+
+bool EitOsMsgClientReceiver::waitForReply(
+        int32_t msgCounter, GenericData_t &reply, int timeoutUs)
+{
+    std::vector<GenericData_t> replies;
+    if (!waitForReplies(msgCounter, replies, timeoutUs)) {
+        return false;
+    }
+
+    reply = replies.front();
+    return true;
+}
+
+bool EitOsMsgClientReceiver::waitForReplies(
+        int32_t msgCounter, std::vector<GenericData_t> &replies,
+        int timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+    auto it = m_pendingReplies.find(msgCounter);
+    if (it == m_pendingReplies.end()) {
+        return false;
+    }
+
+    std::shared_ptr<PendingReply_t> pending = it->second;
+    bool isDone = pending->cv.wait_for(
+            lock, std::chrono::microseconds(timeoutUs),
+            [&pending]() { return pending->isDone; });
+
+    if (isDone) {
+        replies.swap(pending->chunks);
+    }
+    m_pendingReplies.erase(msgCounter);
+    return isDone;
+}
+
+void EitOsMsgClientReceiver::cancelReply(int32_t msgCounter)
+{
+    std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+    m_pendingReplies.erase(msgCounter);
+}
+
+void EitOsMsgClientReceiver::expectReply(
+        int32_t msgCounter, const ReplyCallback_t &callback, int timeoutUs)
+{
+    std::shared_ptr<PendingReply_t> pending =
+            std::make_shared<PendingReply_t>();
+    pending->callback = callback;
+    pending->deadline = std::chrono::steady_clock::now() +
+            std::chrono::microseconds(timeoutUs);
+    pending->startTimeNs = getMonotonicTimeNs();
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+        m_pendingReplies[msgCounter] = pending;
+    }
+    m_cvExpiry.notify_one();
+}
+
+void EitOsMsgClientReceiver::expiring()
+{
+    std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+    while (m_isExpiring) {
+        bool hasDeadline = false;
+        std::chrono::steady_clock::time_point deadline;
+        for (auto &pending: m_pendingReplies) {
+            if (pending.second->callback &&
+                (!hasDeadline || pending.second->deadline < deadline)) {
+                deadline = pending.second->deadline;
+                hasDeadline = true;
+            }
+        }
+
+        if (!hasDeadline) {
+            m_cvExpiry.wait(lock);
+            continue;
+        }
+
+        if (std::cv_status::timeout != m_cvExpiry.wait_until(lock, deadline)) {
+            continue;
+        }
 
+        // The callbacks may issue new requests, so they run unlocked
+        lock.unlock();
+        expireReplies();
+        lock.lock();
+    }
+}
+
+void EitOsMsgClientReceiver::stopExpiring()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+        m_isExpiring = false;
+    }
+    m_cvExpiry.notify_one();
+
+    if (m_expiryThread.joinable()) {
+        m_expiryThread.join();
+    }
+}
+
+void EitOsMsgClientReceiver::expireReplies()
+{
+    std::vector<ReplyCallback_t> expired;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = m_pendingReplies.begin();
+                it != m_pendingReplies.end();) {
+            if (it->second->callback && it->second->deadline < now) {
+                expired.push_back(it->second->callback);
+                it = m_pendingReplies.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Callbacks run without the lock so they may issue new requests
+    GenericData_t none {};
+    for (auto &callback: expired) {
+        callback(false, none);
+    }
+}
+
+void EitOsMsgClientReceiver::completeReply(
+        const GenericData_t &data, int32_t chunkIndex, int32_t numChunks)
+{
+    ReplyCallback_t callback;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPendingReplies);
+        auto it = m_pendingReplies.find(data.simpleMsg.msgCounter);
+        if (it != m_pendingReplies.end() &&
+            chunkIndex >= 0 && chunkIndex < numChunks &&
+            numChunks <= MAX_FRAME_SELECTION_ITEMS) {
+            PendingReply_t &pending = *it->second;
+            if (pending.chunks.empty()) {
+                pending.chunks.resize(numChunks);
+            }
+
+            // Empty chunks are zeroed, so a duplicate is not counted twice
+            if ((int32_t)pending.chunks.size() == numChunks &&
+                pending.chunks[chunkIndex].simpleMsg.msgId == 0) {
+                pending.chunks[chunkIndex] = data;
+                pending.numReceived++;
+            }
+
+            if (pending.numReceived == numChunks) {
+                m_latency.record(getLatencyMsgId(data.simpleMsg),
+                        LATENCY_ROUND_TRIP, pending.startTimeNs,
+                        data.simpleMsg.receiveTimeNs);
+                if (pending.callback) {
+                    callback = pending.callback;
+                    m_pendingReplies.erase(it);
+                } else {
+                    pending.isDone = true;
+                    pending.cv.notify_one();
+                }
+            }
+        }
+    }
+
+    // Asynchronous requests are only ever answered by a single message
+    if (callback) {
+        callback(true, data);
+    }
+
+    expireReplies();
+}
+
+LatencyRecorder* EitOsMsgClientReceiver::getLatencyRecorder()
+{
+    return &m_latency;
+}
+
+bool EitOsMsgClientReceiver::takeServerLatencyStatistics(
+        int32_t msgCounter, std::vector<LatencyStatistics_t> &statistics)
+{
+    std::unique_lock<std::mutex> lock(m_mutexServerLatency);
+    auto it = m_serverLatency.find(msgCounter);
+    if (it == m_serverLatency.end()) {
+        return false;
+    }
+
+    statistics.swap(it->second);
+    m_serverLatency.erase(it);
+    return true;
+}
+
+bool EitOsMsgClientReceiver::takeServerStatistics(
+        int32_t msgCounter, std::vector<MetricStatistics_t> &statistics)
+{
+    std::unique_lock<std::mutex> lock(m_mutexServerStatistics);
+    auto it = m_serverStatistics.find(msgCounter);
+    if (it == m_serverStatistics.end()) {
+        return false;
+    }
+
+    statistics.swap(it->second);
+    m_serverStatistics.erase(it);
+    return true;
+}
+
+} // end of namespace tarsim
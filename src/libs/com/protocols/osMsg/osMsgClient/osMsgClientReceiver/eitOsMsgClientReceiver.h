@@ -22,10 +22,20 @@
 #ifndef EIT_RECEIVER_H
 #define EIT_RECEIVER_H
 
+#include "latencyRecorder.h"
+#include "messageFraming.h"
 #include "msgQServer.h"
+#include "shmRingServer.h"
+#include "socketClient.h"
 #include "timerUtils.h"
 #include "simulatorMessages.h"
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <memory>
+#include <map>
+#include <thread>
 #include <vector>
 #include <utility>
 
@@ -33,6 +43,13 @@ namespace tarsim {
 class EitOsMsgClientReceiver : public MsgQServer
 {
 public:
+    /**
+    * Called with the reply to an asynchronous request, or with isReceived
+    * false if the reply did not arrive in time
+    */
+    typedef std::function<void(
+            bool isReceived, const GenericData_t &reply)> ReplyCallback_t;
+
     EitOsMsgClientReceiver(
             const std::string &mqName,
             int policy = DEFAULT_RT_THREAD_POLICY,
@@ -40,6 +57,21 @@ public:
 	virtual ~EitOsMsgClientReceiver();
 	virtual Errors start();
 
+    /**
+     * Creates the server to client ring and starts consuming it on its own
+     * thread, in addition to the message queue
+     * @param ringName Name of the ring
+     */
+    Errors startSharedMemory(const std::string &ringName);
+
+    /**
+     * Connects to the server over a socket instead of its message queue,
+     * replies and pushed messages then arrive on the socket thread
+     * @param transport TRANSPORT_UNIX_SOCKET or TRANSPORT_TCP
+     */
+    Errors startSocket(TransportTypes transport);
+    SocketClient* getSocket();
+
     void setEndEffectorFrame(const Frame_t &msg);
     void setRigidBodyFrame(const Frame_t &msg);
     void setObjectFrame(const Frame_t &msg);
@@ -61,9 +93,96 @@ public:
 	std::vector<std::pair<int32_t, int32_t>> getSelfCollisions();
 	std::vector<std::pair<int32_t, int32_t>> getExternalCollisions();
 
+    /**
+    * Returns the frames last published for the subscribed frame selection
+    */
+    std::vector<Frame_t> getPublishedFrames();
+
+    TrajectoryStatus_t getTrajectoryStatus();
+
+    /**
+    * Opens a completion slot for the reply to a request. It must be called
+    * before the request is sent so that a fast reply is not missed.
+    * @param msgCounter Counter of the request
+    */
+    void expectReply(int32_t msgCounter);
+
+    /**
+    * Blocks until the reply to a request arrives or the timeout expires. The
+    * slot is released either way.
+    * @param msgCounter Counter of the request
+    * @param reply The reply message
+    * @param timeoutUs How long to wait for the reply
+    * @return true if the reply arrived in time
+    */
+    bool waitForReply(
+            int32_t msgCounter, GenericData_t &reply, int timeoutUs);
+
+    /**
+    * Blocks until every chunk of a reply split over several messages arrives
+    * or the timeout expires. The slot is released either way.
+    * @param msgCounter Counter of the request
+    * @param replies The chunks of the reply, in chunk order
+    * @param timeoutUs How long to wait for the reply
+    * @return true if the whole reply arrived in time
+    */
+    bool waitForReplies(
+            int32_t msgCounter, std::vector<GenericData_t> &replies,
+            int timeoutUs);
+
+    /**
+    * Releases the slot of a request that will not be waited for
+    * @param msgCounter Counter of the request
+    */
+    void cancelReply(int32_t msgCounter);
+
+    /**
+    * Opens a completion slot for an asynchronous request. The callback runs on
+    * the receiver thread when the reply arrives, or with isReceived false on
+    * whichever thread expires the slot once the timeout has passed.
+    * @param msgCounter Counter of the request
+    * @param callback Called once with the outcome of the request
+    * @param timeoutUs How long the reply may take
+    */
+    void expectReply(
+            int32_t msgCounter, const ReplyCallback_t &callback, int timeoutUs);
+
+    /**
+    * Fails the asynchronous requests whose timeout has passed. A thread of
+    * the receiver does it as each timeout passes, with or without traffic.
+    */
+    void expireReplies();
+
+    /**
+    * Latency of the messages of this client, by message id and stage
+    */
+    LatencyRecorder* getLatencyRecorder();
+
+    /**
+    * Takes the simulator latency statistics that answered a request
+    * @param msgCounter Counter of the REQUEST_LATENCY_STATS request
+    * @param statistics The statistics of the simulator
+    * @return false if they did not arrive
+    */
+    bool takeServerLatencyStatistics(
+            int32_t msgCounter, std::vector<LatencyStatistics_t> &statistics);
+
+    /**
+    * Takes the simulator metrics that answered a request
+    * @param msgCounter Counter of the REQUEST_STATISTICS request
+    * @param statistics The statistics of the simulator metrics
+    * @return false if they did not arrive
+    */
+    bool takeServerStatistics(
+            int32_t msgCounter, std::vector<MetricStatistics_t> &statistics);
+
 private:
 	virtual void onMessage(const GenericData_t &inComingData) override;
 	TimerUtils *m_runTimer = nullptr;
+	ShmRingServer *m_shmRingServer = nullptr;
+	SocketClient *m_socketClient = nullptr;
+	int m_policy = DEFAULT_RT_THREAD_POLICY;
+	int m_priority = DEFAULT_RT_THREAD_PRIORITY;
 
     /**
     * Sets the value of m_isSimulatorRunning
@@ -72,13 +191,53 @@ private:
     */
     void setIsSimulatorRunning(bool isSimRunning);
 
-    void setCollisions(const CollisionMessage_t &msg);
+    void setCollisions(const std::vector<Collision> &collisions);
+
+    // Handles a payload once all its fragments arrived
+    void onFramedMessage(const GenericData_t &inComingData);
+    bool readCollisions(
+            const std::vector<uint8_t> &payload,
+            std::vector<Collision> &collisions);
 
     void setIncrementalCommand(
             IncrementalCommandTypes type, int32_t index, int32_t incCmd);
 
     void setSpeed(float speed);
 
+    /**
+    * Gathers the chunks of a published frames batch and swaps them in once
+    * the batch is complete
+    */
+    void setPublishedFrames(const FramesBatch_t &msg);
+
+    void setTrajectoryStatus(const TrajectoryStatus_t &msg);
+
+    /**
+    * Hands a reply, or one chunk of it, to the caller waiting on its
+    * msgCounter, if any
+    */
+    void completeReply(
+            const GenericData_t &data,
+            int32_t chunkIndex = 0, int32_t numChunks = 1);
+
+    /**
+    * Sleeps until the earliest timeout of the asynchronous requests and
+    * expires them, until the receiver is destroyed
+    */
+    void expiring();
+    void stopExpiring();
+
+    struct PendingReply_t
+    {
+        bool isDone = false;
+        std::vector<GenericData_t> chunks;
+        int32_t numReceived = 0;
+        std::condition_variable cv;
+        ReplyCallback_t callback;
+        std::chrono::steady_clock::time_point deadline;
+        int64_t startTimeNs = 0;
+    };
+
 	mutable std::mutex m_mutex;
 	Frame_t m_frameEndEffector {};
 	Frame_t m_frameRigidBody {};
@@ -92,6 +251,10 @@ private:
 
 	mutable std::mutex m_mutexIncCmd;
 
+	// Fragments come from the message queue and the shared memory threads
+	mutable std::mutex m_mutexAssembler;
+	MessageAssembler m_assembler;
+
 	mutable std::mutex m_mutexCollisions;
 	std::vector<std::pair<int32_t, int32_t>> m_selfCollisions;
 	std::vector<std::pair<int32_t, int32_t>> m_externalCollisions;
@@ -108,6 +271,71 @@ private:
     * Mutex for flag whether the simulator is running.
     */
     mutable std::mutex m_mutexIsSimRunning;
+
+    /**
+    * Frames of the published batch being received, and of the last
+    * complete one
+    */
+    std::vector<Frame_t> m_framesPublishing;
+    std::vector<Frame_t> m_framesPublished;
+
+    /**
+    * Mutex for the published frames
+    */
+    mutable std::mutex m_mutexPublishedFrames;
+
+    /**
+    * Latest progress of a trajectory, replied or published
+    */
+    TrajectoryStatus_t m_trajectoryStatus {};
+
+    /**
+    * Mutex for the trajectory progress
+    */
+    mutable std::mutex m_mutexTrajectoryStatus;
+
+    /**
+    * Completion slots of the requests waiting for a reply, by msgCounter
+    */
+    std::map<int32_t, std::shared_ptr<PendingReply_t>> m_pendingReplies;
+
+    /**
+    * Mutex for the completion slots
+    */
+    mutable std::mutex m_mutexPendingReplies;
+
+    /**
+    * Wakes the expiry thread when an asynchronous request is added or the
+    * receiver is destroyed, with m_mutexPendingReplies
+    */
+    std::condition_variable m_cvExpiry;
+    bool m_isExpiring = false;
+    std::thread m_expiryThread;
+
+    /**
+    * Latency of the messages received and sent, and of their round trips
+    */
+    LatencyRecorder m_latency;
+
+    /**
+    * Simulator latency statistics not taken yet, by msgCounter of the request
+    */
+    std::map<int32_t, std::vector<LatencyStatistics_t>> m_serverLatency;
+
+    /**
+    * Mutex for the simulator latency statistics
+    */
+    mutable std::mutex m_mutexServerLatency;
+
+    /**
+    * Simulator metrics not taken yet, by msgCounter of the request
+    */
+    std::map<int32_t, std::vector<MetricStatistics_t>> m_serverStatistics;
+
+    /**
+    * Mutex for the simulator metrics
+    */
+    mutable std::mutex m_mutexServerStatistics;
 };
 } // end of namespace tarsim
 #endif /* EIT_RECEIVER_H */
@@ -19,11 +19,13 @@
 
 
 #include "eitOsMsgClientSender.h"
+#include <algorithm>
 #include <cstdarg>
 #include "simulatorMessages.h"
 #include "serverDefs.h"
 #include "logClient.h"
 #include "fileSystem.h"
+#include <cstring>
 
 namespace tarsim {
 /**
@@ -39,7 +41,115 @@ EitOsMsgClientSender::EitOsMsgClientSender(int32_t index) : m_index(index),
  */
 EitOsMsgClientSender::~EitOsMsgClientSender()
 {
+    delete m_shmRing;
+    m_shmRing = nullptr;
+}
+
+bool EitOsMsgClientSender::useSharedMemory(
+        const std::string &ringToServer,
+        const std::string &ringToClient,
+        unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    if (ringToServer.size() >= MAX_SHM_NAME_SIZE ||
+        ringToClient.size() >= MAX_SHM_NAME_SIZE) {
+        printf("Shared memory ring names are too long\n");
+        return false;
+    }
+
+    ShmRing* ring = new ShmRing(ringToServer, true);
+    if (ring->open() != NO_ERR) {
+        printf("Failed to create shared memory ring %s\n", ringToServer.c_str());
+        delete ring;
+        return false;
+    }
+
+    // The request itself travels over the message queue, everything after
+    // it is queued in the ring until the server attaches to it
+    SharedMemoryConnect_t msg;
+    msg.msgId = SHARED_MEMORY_CONNECT;
+    msg.srcPid = m_index;
+    msg.msgCounter = 0;
+    msg.sendTimeNs = getMonotonicTimeNs();
+    memset(msg.ringToServer, 0, sizeof(msg.ringToServer));
+    memset(msg.ringToClient, 0, sizeof(msg.ringToClient));
+    strncpy(msg.ringToServer, ringToServer.c_str(), MAX_SHM_NAME_SIZE - 1);
+    strncpy(msg.ringToClient, ringToClient.c_str(), MAX_SHM_NAME_SIZE - 1);
 
+    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf("Failed to send data to RobotServer\n");
+        delete ring;
+        return false;
+    }
+
+    m_shmRing = ring;
+    return true;
+}
+
+bool EitOsMsgClientSender::useSocket(SocketClient* socket)
+{
+    if (socket == nullptr || !socket->isConnected()) {
+        printf("Failed: socket is not connected to RobotServer\n");
+        return false;
+    }
+
+    m_socket = socket;
+    return true;
+}
+
+void EitOsMsgClientSender::setLatencyRecorder(LatencyRecorder* latency)
+{
+    m_latency = latency;
+}
+
+Errors EitOsMsgClientSender::send(
+        void* data, const size_t size, unsigned int msgPriority)
+{
+    MessageHeader_t* header = static_cast<MessageHeader_t*>(data);
+    header->sendTimeNs = getMonotonicTimeNs();
+
+    Errors error = NO_ERR;
+    if (m_socket) {
+        error = m_socket->send(data, size);
+    } else if (m_shmRing) {
+        error = m_shmRing->push(data, size);
+    } else if (isQueryMessage(header->msgId) && isQueryLaneConnected()) {
+        error = m_querySender.send(data, size, msgPriority);
+    } else {
+        error = m_msgSender.send(data, size, msgPriority);
+    }
+
+    // How long the transport kept the caller, e.g. on a full queue
+    if (m_latency) {
+        m_latency->record(getLatencyMsgId(*header), LATENCY_SEND,
+                header->sendTimeNs, getMonotonicTimeNs());
+    }
+    return error;
+}
+
+Errors EitOsMsgClientSender::sendFramed(
+        const MessageWriter &writer, int32_t msgCounter,
+        unsigned int msgPriority)
+{
+    return writer.send(m_index, msgCounter,
+            [this, msgPriority](void* data, size_t size) {
+                return send(data, size, msgPriority); });
+}
+
+bool EitOsMsgClientSender::isQueryLaneConnected()
+{
+    if (m_querySender.isConnected() == NO_ERR) {
+        return true;
+    }
+
+    // Only tried once, an older server has no query lane
+    if (m_isQueryLaneTried) {
+        return false;
+    }
+    m_isQueryLaneTried = true;
+    return m_querySender.connect() == NO_ERR;
 }
 
 bool EitOsMsgClientSender::notifyDisconnect(unsigned int msgPriority)
@@ -49,8 +159,12 @@ bool EitOsMsgClientSender::notifyDisconnect(unsigned int msgPriority)
     SimpleMsg_t msg;
     msg.msgId = MSG_CLIENT_DISCONNECTED_EVENT;
     msg.srcPid = m_index;
+    msg.sendTimeNs = getMonotonicTimeNs();
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    // Over shared memory only application messages go through the ring
+    Errors error = m_socket ? m_socket->send(&msg, sizeof(msg)) :
+            m_msgSender.send(&msg, sizeof(msg), msgPriority);
+    if (error != NO_ERR)
     {
         printf("Failed to send data to RobotServer\n");
         return false;
@@ -61,6 +175,14 @@ bool EitOsMsgClientSender::notifyDisconnect(unsigned int msgPriority)
 
 bool EitOsMsgClientSender::isConnected()
 {
+    if (m_socket) {
+        if (!m_socket->isConnected()) {
+            printf ("Lost connection to RobotServer\n");
+            return false;
+        }
+        return true;
+    }
+
     if (m_msgSender.isConnected() != NO_ERR)
     {
         if (m_msgSender.connect() != NO_ERR)
@@ -75,11 +197,35 @@ bool EitOsMsgClientSender::isConnected()
 bool EitOsMsgClientSender::sendJointPositions(
         JointPositions_t &msg, unsigned int msgPriority)
 {
-    if (!isConnected()) {return false;}
     msg.msgId = ROBOT_JOINT_POSITIONS;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    int32_t numJoints = std::max(0, std::min(msg.numJoints, MAX_JOINTS));
+    return sendJointPositions(
+            std::vector<int32_t>(msg.indices, msg.indices + numJoints),
+            std::vector<float>(msg.positions, msg.positions + numJoints),
+            msg.msgCounter, msgPriority);
+}
+
+bool EitOsMsgClientSender::sendJointPositions(
+        const std::vector<int32_t> &indices,
+        const std::vector<float> &positions,
+        int32_t msgCounter, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+    if (indices.size() != positions.size()) {
+        printf("Failed: %zu joint indices for %zu positions\n",
+                indices.size(), positions.size());
+        return false;
+    }
+
+    // numJoints, then the indices, then the positions
+    MessageWriter writer(ROBOT_JOINT_POSITIONS);
+    writer.write((int32_t)indices.size());
+    writer.write(indices.data(), indices.size());
+    writer.write(positions.data(), positions.size());
+
+    if (sendFramed(writer, msgCounter, msgPriority) != NO_ERR)
     {
     	printf ("Failed to send data to RobotServer\n");
     	return false;
@@ -95,7 +241,7 @@ bool EitOsMsgClientSender::sendJointPosition(
     msg.msgId = ROBOT_JOINT_POSITION;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -111,7 +257,7 @@ bool EitOsMsgClientSender::sendBaseFrame(
     msg.msgId = ROBOT_BASE_POSE;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -127,7 +273,7 @@ bool EitOsMsgClientSender::sendCamera(
     msg.msgId = CAMERA_DATA;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -151,7 +297,7 @@ bool EitOsMsgClientSender::sendLockObjectToRigidBody(
     msg.msgId = LOCK_OBJECT_TO_RIGID_BODY;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -168,7 +314,7 @@ bool EitOsMsgClientSender::sendUnlockObjectFromRigidBody(
     msg.msgId = UNLOCK_OBJECT_FROM_RIGID_BODY;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -185,7 +331,7 @@ bool EitOsMsgClientSender::executeForwardKinematics(
     msg.msgId = REQUEST_EXECUTE_FORWARD_KINEMATICS;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -202,7 +348,7 @@ bool EitOsMsgClientSender::sendRequestEndEffectorFrame(
     msg.msgId = REQUEST_END_EFFECTOR_FRAME;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -219,7 +365,7 @@ bool EitOsMsgClientSender::sendRequestRigidBodyFrame(
     msg.msgId = REQUEST_RIGID_BODY_FRAME;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -236,7 +382,7 @@ bool EitOsMsgClientSender::sendRequestObjectFrame(
     msg.msgId = REQUEST_OBJECT_FRAME;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -253,7 +399,7 @@ bool EitOsMsgClientSender::sendObjectFrame(
     msg.msgId = OBJECT_FRAME;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -270,7 +416,7 @@ bool EitOsMsgClientSender::sendRequestJointValues(
     msg.msgId = REQUEST_JOINT_VALUES;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -287,7 +433,7 @@ bool EitOsMsgClientSender::sendRequestSimulatorStatus(
     msg.msgId = SIMULATOR_STATUS;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -304,7 +450,7 @@ bool EitOsMsgClientSender::sendShutdown(unsigned int msgPriority)
     msg.msgId = SHUTDOWN;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -326,7 +472,7 @@ bool EitOsMsgClientSender::sendRequestRecord(
 
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -343,7 +489,7 @@ bool EitOsMsgClientSender::sendFaultMessage(
     msg.msgId = GUI_STATUS_MESSAGE;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -360,7 +506,7 @@ bool EitOsMsgClientSender::sendRequestInstallTool(
     msg.msgId = INSTALL_TOOL;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
@@ -377,7 +523,176 @@ bool EitOsMsgClientSender::sendSetEndEffector(
     msg.msgId = SET_END_EFFECTOR;
     msg.srcPid = m_index;
 
-    if (m_msgSender.send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendRegisterFrameSelection(
+    RegisterFrameSelection_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    if (msg.numItems < 0 || msg.numItems > MAX_FRAME_SELECTION_ITEMS) {
+        printf ("Invalid number of frames in selection: %d\n", msg.numItems);
+        return false;
+    }
+
+    msg.msgId = REGISTER_FRAME_SELECTION;
+    msg.srcPid = m_index;
+
+    // Items are the last member, so the unused ones are not sent
+    size_t size = sizeof(msg) -
+            (MAX_FRAME_SELECTION_ITEMS - msg.numItems) * sizeof(FrameSelection_t);
+    if (send(&msg, size, msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendRequestFramesBatch(
+    RequestFramesBatch_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    if (msg.numItems < 0 || msg.numItems > MAX_FRAME_SELECTION_ITEMS) {
+        printf ("Invalid number of frames in request: %d\n", msg.numItems);
+        return false;
+    }
+
+    msg.msgId = REQUEST_FRAMES_BATCH;
+    msg.srcPid = m_index;
+
+    // A request by selection id carries no items at all
+    size_t size = sizeof(msg) -
+            (MAX_FRAME_SELECTION_ITEMS - msg.numItems) * sizeof(FrameSelection_t);
+    if (send(&msg, size, msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendSubscribe(
+    Subscribe_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = SUBSCRIBE;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendStep(
+    Step_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = STEP;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendTrajectoryChunk(
+    TrajectoryChunk_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = TRAJECTORY;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendTrajectoryCommand(
+    TrajectoryCommand_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = TRAJECTORY_COMMAND;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendRequestLatencyStats(
+    RequestLatencyStats_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = REQUEST_LATENCY_STATS;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendRequestStatistics(
+    RequestStatistics_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = REQUEST_STATISTICS;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
+    {
+        printf ("Failed to send data to RobotServer\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool EitOsMsgClientSender::sendTraceCommand(
+    TraceCommand_t &msg, unsigned int msgPriority)
+{
+    if (!isConnected()) {return false;}
+
+    msg.msgId = TRACE_COMMAND;
+    msg.srcPid = m_index;
+
+    if (send(&msg, sizeof(msg), msgPriority) != NO_ERR)
     {
         printf ("Failed to send data to RobotServer\n");
         return false;
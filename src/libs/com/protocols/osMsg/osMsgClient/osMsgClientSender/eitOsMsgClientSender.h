@@ -25,8 +25,13 @@
 #include "cstdarg"
 #include <string>
 #include <mutex>
+#include <vector>
 #include "eitErrors.h"
+#include "latencyRecorder.h"
+#include "messageFraming.h"
 #include "msgQClient.h"
+#include "shmRing.h"
+#include "socketClient.h"
 #include "simulatorMessages.h"
 #include "serverDefs.h"
 namespace tarsim {
@@ -39,9 +44,44 @@ public:
     bool notifyDisconnect(unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
     bool isConnected();
 
+    /**
+     * Creates the client to server ring and asks the server to attach to
+     * both rings. All messages but the disconnect notification use the ring
+     * from then on, queries included.
+     */
+    bool useSharedMemory(
+            const std::string &ringToServer,
+            const std::string &ringToClient,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Sends every message over a socket connected to the server instead of
+     * its message queues, the disconnect notification included
+     * @param socket Connection to the server, owned by the receiver
+     */
+    bool useSocket(SocketClient* socket);
+
+    /**
+     * Records how long every send kept the caller
+     * @param latency Recorder of the client, owned by the receiver
+     */
+    void setLatencyRecorder(LatencyRecorder* latency);
+
+    /**
+     * Joint positions are framed, only numJoints entries are sent
+     */
     bool sendJointPositions(
             JointPositions_t &robotPosition,
             unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    /**
+     * Sends any number of joint positions, in as many fragments as needed
+     */
+    bool sendJointPositions(
+            const std::vector<int32_t> &indices,
+            const std::vector<float> &positions,
+            int32_t msgCounter,
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
     bool sendJointPosition(
             JointPosition_t &robotPosition,
             unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
@@ -95,11 +135,63 @@ public:
     bool sendSetEndEffector(
         SetEndEffector_t &msg,
         unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendRegisterFrameSelection(
+        RegisterFrameSelection_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendRequestFramesBatch(
+        RequestFramesBatch_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendSubscribe(
+        Subscribe_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendStep(
+        Step_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendTrajectoryChunk(
+        TrajectoryChunk_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendTrajectoryCommand(
+        TrajectoryCommand_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendRequestLatencyStats(
+        RequestLatencyStats_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendRequestStatistics(
+        RequestStatistics_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+
+    bool sendTraceCommand(
+        TraceCommand_t &msg,
+        unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
 protected:
 
 private:
+    // Stamps the send time of the message before handing it over
+    Errors send(void* data, const size_t size, unsigned int msgPriority);
+    Errors sendFramed(
+            const MessageWriter &writer, int32_t msgCounter,
+            unsigned int msgPriority);
+
+    bool isQueryLaneConnected();
+
     MsgQClient m_msgSender = MsgQClient(RobotJointsReceiverThreadName);
+
+    // Queries go to their own lane so they never delay control messages.
+    // Servers without it get them on the control lane.
+    MsgQClient m_querySender = MsgQClient(RobotQueriesReceiverThreadName);
+    bool m_isQueryLaneTried = false;
     int32_t m_index = 0;
+    ShmRing* m_shmRing = nullptr;
+    SocketClient* m_socket = nullptr;
+    LatencyRecorder* m_latency = nullptr;
 };
 } // end of namespace tarsim
 #endif /* EIT_SENDER_H */
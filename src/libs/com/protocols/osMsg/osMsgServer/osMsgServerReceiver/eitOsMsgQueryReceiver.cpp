@@ -0,0 +1,454 @@
+/**
+ *
+ * @file: eitOsMsgQueryReceiver.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of EitOsMsgQueryReceiver
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#include "eitOsMsgQueryReceiver.h"
+
+#include <algorithm>
+#include <cstring>
+#include "serverDefs.h"
+#include "logClient.h"
+#include "simulatorMessages.h"
+#include "kinematics.h"
+#include "fileSystem.h"
+#include "messageDispatcher.h"
+#include "traceRecorder.h"
+
+namespace tarsim {
+
+namespace {
+void copyXfm(const Matrix4d &xfm, float* mij)
+{
+    Eigen::Matrix<float, 4, 4, Eigen::RowMajor>::Map(mij) = xfm.cast<float>();
+}
+
+bool getRigidBodyFrame(
+        const KinematicsSnapshot_t &snapshot,
+        int32_t indexRigidBody, int32_t indexFrame, Matrix4d &xfm)
+{
+    auto it = snapshot.rigidBodyFrames.find(indexRigidBody);
+    if (it == snapshot.rigidBodyFrames.end() || indexFrame < 0 ||
+        indexFrame >= (int32_t)it->second.size()) {
+        xfm = Matrix4d::Zero();
+        return false;
+    }
+
+    xfm = it->second[indexFrame];
+    return true;
+}
+
+bool getObjectFrame(
+        const KinematicsSnapshot_t &snapshot, int32_t indexObject,
+        Matrix4d &xfm)
+{
+    auto it = snapshot.objectFrames.find(indexObject);
+    if (it == snapshot.objectFrames.end()) {
+        xfm = Matrix4d::Zero();
+        return false;
+    }
+
+    xfm = it->second;
+    return true;
+}
+} // end of anonymous namespace
+
+/**
+ * @brief constructor for the EitOsMsgQueryReceiver. Its queue thread does not
+ * run in real time.
+ */
+EitOsMsgQueryReceiver::EitOsMsgQueryReceiver(
+        Kinematics* kin, unsigned int msgPriority, LatencyRecorder* latency,
+        int numWorkers):
+        MsgQServer(RobotQueriesReceiverThreadName, SCHED_OTHER, 0),
+        m_kinematics(kin),
+        m_msgPriority(msgPriority),
+        m_latency(latency),
+        m_numWorkers(std::max(1, numWorkers))
+{
+}
+
+EitOsMsgQueryReceiver::~EitOsMsgQueryReceiver()
+{
+    stopWorkers();
+
+    std::unique_lock<std::mutex> lock(m_mutexUsers);
+    for (auto pair: m_users) {
+        pair.second->sender->disconnect();
+    }
+    m_users.clear();
+}
+
+Errors EitOsMsgQueryReceiver::start()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexJobs);
+        m_isWorking = true;
+    }
+
+    for (int i = 0; i < m_numWorkers; i++) {
+        m_workers.push_back(std::thread(&EitOsMsgQueryReceiver::working, this));
+        pthread_setname_np(m_workers.back().native_handle(), "TarsimQueryWork");
+    }
+
+    return MsgQServer::start();
+}
+
+void EitOsMsgQueryReceiver::stopWorkers()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexJobs);
+        m_isWorking = false;
+        m_jobs.clear();
+    }
+    m_cvJobs.notify_all();
+    m_cvJobsSpace.notify_all();
+
+    for (std::thread &worker: m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+/**
+ * @brief hands a query to the workers, waiting for room if they are behind.
+ * Only this lane waits then, the control lane is not affected.
+ */
+void EitOsMsgQueryReceiver::onMessage(const GenericData_t &inComingData)
+{
+    if (!isQueryMessage(inComingData.simpleMsg.msgId)) {
+        LOG_WARNING("Message %d is not a query, send it to %s",
+                (int)inComingData.simpleMsg.msgId,
+                RobotJointsReceiverThreadName.c_str());
+        return;
+    }
+
+    // Registered here so a batch request right after it finds the selection
+    if (REGISTER_FRAME_SELECTION == inComingData.simpleMsg.msgId) {
+        processLaneQuery(nullptr, inComingData);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexJobs);
+        m_cvJobsSpace.wait(lock, [this]() {
+            return m_jobs.size() < MAX_QUERY_JOBS || !m_isWorking; });
+        if (!m_isWorking) {
+            return;
+        }
+        m_jobs.push_back(inComingData);
+    }
+    m_cvJobs.notify_one();
+}
+
+void EitOsMsgQueryReceiver::onExit()
+{
+    stopWorkers();
+}
+
+void EitOsMsgQueryReceiver::working()
+{
+    GenericData_t job;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutexJobs);
+            m_cvJobs.wait(lock, [this]() {
+                return !m_jobs.empty() || !m_isWorking; });
+            if (!m_isWorking) {
+                return;
+            }
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+        m_cvJobsSpace.notify_one();
+
+        std::shared_ptr<User_t> user = getUser(job.simpleMsg.srcPid);
+        if (nullptr == user) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(user->mutexSend);
+        processLaneQuery(user->sender.get(), job);
+    }
+}
+
+void EitOsMsgQueryReceiver::processLaneQuery(
+        EitOsMsgServerSender *sendUserReply, const GenericData_t &inComingData)
+{
+    TRACE_SCOPE("EitOsMsgQueryReceiver::processLaneQuery");
+    int64_t startNs = getMonotonicTimeNs();
+    processQuery(sendUserReply, inComingData);
+    if (nullptr == m_latency) {
+        return;
+    }
+
+    // Waiting for a worker counts as waiting for the handler
+    int32_t msgId = inComingData.simpleMsg.msgId;
+    m_latency->recordTransport(inComingData.simpleMsg);
+    m_latency->record(msgId, LATENCY_DISPATCH,
+            inComingData.simpleMsg.receiveTimeNs, startNs);
+    m_latency->record(msgId, LATENCY_HANDLER, startNs, getMonotonicTimeNs());
+}
+
+std::shared_ptr<EitOsMsgQueryReceiver::User_t> EitOsMsgQueryReceiver::getUser(
+        int32_t userPid)
+{
+    if (userPid < 0) {
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexUsers);
+    std::shared_ptr<User_t> &user = m_users[userPid];
+    if (nullptr == user) {
+        std::string mqName = FileSystem::getMQNamePid(userPid);
+        user = std::make_shared<User_t>();
+        user->sender.reset(new EitOsMsgServerSender(mqName, m_msgPriority));
+    }
+    return user;
+}
+
+void EitOsMsgQueryReceiver::removeUser(int32_t userPid)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrameSelections);
+        m_frameSelections.erase(userPid);
+    }
+
+    // A worker still answering the client keeps its connection alive
+    std::unique_lock<std::mutex> lock(m_mutexUsers);
+    m_users.erase(userPid);
+}
+
+void EitOsMsgQueryReceiver::processQuery(
+        EitOsMsgServerSender *sendUserReply, const GenericData_t &inComingData)
+{
+    int32_t msgCounter = inComingData.simpleMsg.msgCounter;
+
+    if (REGISTER_FRAME_SELECTION == inComingData.simpleMsg.msgId) {
+        registerFrameSelection(
+                messageView<RegisterFrameSelection_t>(inComingData));
+        return;
+    }
+
+    if (sendUserReply == nullptr) {
+        return;
+    }
+
+    std::shared_ptr<const KinematicsSnapshot_t> snapshot =
+            m_kinematics->getSnapshot();
+    if (nullptr == snapshot) {
+        LOG_WARNING("No pose is available yet");
+        return;
+    }
+
+    // Replies are built in their outbound slot, straight from the snapshot
+    switch (inComingData.simpleMsg.msgId)
+    {
+        case REQUEST_END_EFFECTOR_FRAME:
+        {
+            sendUserReply->sendInPlace<Frame_t>(END_EFFECTOR_FRAME, msgCounter,
+                    [&snapshot](Frame_t &out) {
+                        out.frameId = 0;
+                        copyXfm(snapshot->xfmEndEffector, out.mij);
+                    });
+        }
+        break;
+
+        case REQUEST_RIGID_BODY_FRAME:
+        {
+            const RequestRigidBodyFrame_t &in =
+                    messageView<RequestRigidBodyFrame_t>(inComingData);
+            Matrix4d xfm;
+            if (!getRigidBodyFrame(
+                    *snapshot, in.indexRigidBody, in.indexFrame, xfm)) {
+                LOG_WARNING("Failed to get rigid body frame");
+            }
+
+            sendUserReply->sendInPlace<Frame_t>(RIGID_BODY_FRAME, msgCounter,
+                    [&in, &xfm](Frame_t &out) {
+                        out.frameId = in.indexRigidBody;
+                        copyXfm(xfm, out.mij);
+                    });
+        }
+        break;
+
+        case REQUEST_OBJECT_FRAME:
+        {
+            const RequestObjectFrame_t &in =
+                    messageView<RequestObjectFrame_t>(inComingData);
+            Matrix4d xfm;
+            if (!getObjectFrame(*snapshot, in.indexObject, xfm)) {
+                LOG_WARNING("Failed to get object frame");
+            }
+
+            sendUserReply->sendInPlace<Frame_t>(OBJECT_FRAME, msgCounter,
+                    [&in, &xfm](Frame_t &out) {
+                        out.frameId = in.indexObject;
+                        copyXfm(xfm, out.mij);
+                    });
+        }
+        break;
+
+        case REQUEST_JOINT_VALUES:
+        {
+            sendUserReply->sendInPlace<JointPositions_t>(
+                    ROBOT_JOINT_POSITIONS, msgCounter,
+                    [&snapshot](JointPositions_t &out) {
+                        out.numJoints = std::min(MAX_JOINTS,
+                                (int32_t)snapshot->jointValues.size());
+                        int32_t index = 0;
+                        for (auto it = snapshot->jointValues.begin();
+                                it != snapshot->jointValues.end() &&
+                                index < out.numJoints; ++it) {
+                            out.indices[index] = it->first;
+                            out.positions[index] = it->second;
+                            index++;
+                        }
+                    });
+        }
+        break;
+
+        case SIMULATOR_STATUS:
+        {
+            sendUserReply->sendInPlace<SimulatorStatus_t>(
+                    SIMULATOR_STATUS, msgCounter,
+                    [](SimulatorStatus_t &out) { out.isSimRunning = true; });
+        }
+        break;
+
+        case REQUEST_FRAMES_BATCH:
+        {
+            sendFramesBatch(sendUserReply,
+                    messageView<RequestFramesBatch_t>(inComingData), *snapshot);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+void EitOsMsgQueryReceiver::registerFrameSelection(
+        const RegisterFrameSelection_t &msg)
+{
+    if (msg.numItems < 0 || msg.numItems > MAX_FRAME_SELECTION_ITEMS) {
+        LOG_FAILURE("Invalid number of frames %d in selection %d",
+                msg.numItems, msg.selectionId);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexFrameSelections);
+    m_frameSelections[msg.srcPid][msg.selectionId] =
+            std::vector<FrameSelection_t>(msg.items, msg.items + msg.numItems);
+}
+
+bool EitOsMsgQueryReceiver::getFrameSelection(
+        int32_t userPid, int32_t selectionId,
+        std::vector<FrameSelection_t> &selection) const
+{
+    std::unique_lock<std::mutex> lock(m_mutexFrameSelections);
+    auto user = m_frameSelections.find(userPid);
+    if (user == m_frameSelections.end()) {
+        return false;
+    }
+
+    auto it = user->second.find(selectionId);
+    if (it == user->second.end()) {
+        return false;
+    }
+
+    selection = it->second;
+    return true;
+}
+
+void EitOsMsgQueryReceiver::sendFramesBatch(
+        EitOsMsgServerSender *sendUserReply, const RequestFramesBatch_t &msg,
+        const KinematicsSnapshot_t &snapshot)
+{
+    FramesBatch_t out;
+    out.msgCounter = msg.msgCounter;
+    out.selectionId = msg.selectionId;
+
+    // Items carried by the request take precedence over a registered selection
+    std::vector<FrameSelection_t> selection;
+    const FrameSelection_t* items = msg.items;
+    int32_t numItems = msg.numItems;
+    if (0 == numItems) {
+        if (!getFrameSelection(msg.srcPid, msg.selectionId, selection)) {
+            LOG_WARNING("Frame selection %d of process %d is not registered",
+                    msg.selectionId, msg.srcPid);
+            out.numItems = -1;
+            out.numChunks = 1;
+            sendUserReply->sendFramesBatch(out);
+            return;
+        }
+
+        items = selection.data();
+        numItems = (int32_t)selection.size();
+    } else if (numItems < 0 || numItems > MAX_FRAME_SELECTION_ITEMS) {
+        LOG_FAILURE("Invalid number of frames %d in batch request", numItems);
+        out.numItems = -1;
+        out.numChunks = 1;
+        sendUserReply->sendFramesBatch(out);
+        return;
+    }
+
+    sendFrames(sendUserReply, msg.msgCounter, msg.selectionId, items, numItems,
+            snapshot);
+}
+
+void EitOsMsgQueryReceiver::sendFrames(
+        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+        int32_t selectionId, const FrameSelection_t* items, int32_t numItems,
+        const KinematicsSnapshot_t &snapshot)
+{
+    FramesBatch_t out;
+    out.msgCounter = msgCounter;
+    out.selectionId = selectionId;
+    out.numItems = numItems;
+    out.numChunks = std::max(1,
+            (numItems + MAX_FRAMES_PER_BATCH - 1) / MAX_FRAMES_PER_BATCH);
+    for (int32_t chunk = 0; chunk < out.numChunks; chunk++) {
+        int32_t first = chunk * MAX_FRAMES_PER_BATCH;
+        out.chunkIndex = chunk;
+        out.numFrames = std::min(MAX_FRAMES_PER_BATCH, numItems - first);
+
+        for (int32_t k = 0; k < out.numFrames; k++) {
+            const FrameSelection_t &item = items[first + k];
+            Matrix4d xfm;
+            if (FRAME_SELECTION_OBJECT == item.type) {
+                if (!getObjectFrame(snapshot, item.index, xfm)) {
+                    LOG_WARNING("Failed to get object frame");
+                }
+            } else if (!getRigidBodyFrame(
+                    snapshot, item.index, item.indexFrame, xfm)) {
+                LOG_WARNING("Failed to get rigid body frame");
+            }
+            copyXfm(xfm, out.mij[k]);
+        }
+
+        if (NO_ERR != sendUserReply->sendFramesBatch(out)) {
+            return;
+        }
+    }
+}
+
+} // end of namespace tarsim
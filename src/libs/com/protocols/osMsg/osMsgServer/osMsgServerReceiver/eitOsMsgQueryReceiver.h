@@ -0,0 +1,140 @@
+/**
+ *
+ * @file: eitOsMsgQueryReceiver.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Best-effort query lane of the simulator. It has its own message
+ * queue and answers frame and joint value queries from the latest pose
+ * snapshot with a pool of workers, so observers never delay the control lane.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_EIT_OS_MSG_QUERY_RECEIVER_H
+#define SRC_LIBS_EIT_OS_MSG_QUERY_RECEIVER_H
+
+#include "eitOsMsgServerSender.h"
+#include "latencyRecorder.h"
+#include "msgQServer.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tarsim {
+class Kinematics;
+struct KinematicsSnapshot_t;
+
+//consts------------------------------------------------------------------------
+static const int NUM_QUERY_WORKERS = 2; // threads answering queries
+static const size_t MAX_QUERY_JOBS = 64; // queries waiting for a worker
+
+class EitOsMsgQueryReceiver : public MsgQServer
+{
+public:
+    /**
+     * Constructor
+     * @param kin Kinematics whose snapshots answer the queries
+     * @param msgPriority Priority of the replies
+     * @param latency Records the latency of the queries of this lane, none
+     * if nullptr
+     * @param numWorkers Threads answering queries
+     */
+    EitOsMsgQueryReceiver(
+            Kinematics* kin, unsigned int msgPriority,
+            LatencyRecorder* latency = nullptr,
+            int numWorkers = NUM_QUERY_WORKERS);
+    virtual ~EitOsMsgQueryReceiver();
+    virtual Errors start() override;
+
+    /**
+     * Answers a query from the latest pose snapshot. The control lane uses it
+     * too, for clients whose queries arrive over shared memory.
+     * @param sendUserReply Connection to the client, not used concurrently
+     * @param inComingData The query
+     */
+    void processQuery(
+            EitOsMsgServerSender *sendUserReply,
+            const GenericData_t &inComingData);
+
+    /**
+     * Sends the frames of a selection, split in as many messages as needed
+     */
+    void sendFrames(
+            EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+            int32_t selectionId, const FrameSelection_t* items,
+            int32_t numItems, const KinematicsSnapshot_t &snapshot);
+
+    bool getFrameSelection(
+            int32_t userPid, int32_t selectionId,
+            std::vector<FrameSelection_t> &selection) const;
+
+    /**
+     * Forgets the selections and the connection of a client that left
+     */
+    void removeUser(int32_t userPid);
+
+private:
+    virtual void onMessage(const GenericData_t &inComingData) override;
+    virtual void onExit() override;
+
+    void working();
+
+    // Answers a query taken off this lane and records its latency
+    void processLaneQuery(
+            EitOsMsgServerSender *sendUserReply,
+            const GenericData_t &inComingData);
+    void stopWorkers();
+
+    void registerFrameSelection(const RegisterFrameSelection_t &msg);
+    void sendFramesBatch(
+            EitOsMsgServerSender *sendUserReply,
+            const RequestFramesBatch_t &msg,
+            const KinematicsSnapshot_t &snapshot);
+
+    // A client connection, sends of different workers take turns on it
+    struct User_t
+    {
+        std::unique_ptr<EitOsMsgServerSender> sender;
+        std::mutex mutexSend;
+    };
+
+    std::shared_ptr<User_t> getUser(int32_t userPid);
+
+    Kinematics* m_kinematics = nullptr;
+    unsigned int m_msgPriority = 0;
+    LatencyRecorder* m_latency = nullptr;
+    int m_numWorkers = NUM_QUERY_WORKERS;
+
+    mutable std::mutex m_mutexUsers;
+    std::map<int32_t, std::shared_ptr<User_t>> m_users;
+
+    // Frame selections registered by each client, by selection id
+    mutable std::mutex m_mutexFrameSelections;
+    std::map<int32_t, std::map<int32_t, std::vector<FrameSelection_t>>>
+            m_frameSelections;
+
+    // Queries waiting for a worker
+    std::mutex m_mutexJobs;
+    std::condition_variable m_cvJobs;
+    std::condition_variable m_cvJobsSpace;
+    std::deque<GenericData_t> m_jobs;
+    bool m_isWorking = false;
+    std::vector<std::thread> m_workers;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_EIT_OS_MSG_QUERY_RECEIVER_H */
@@ -33,11 +33,30 @@
 #include <algorithm>
 #include "fileSystem.h"
 #include "exitThread.h"
-#include <algorithm>
+#include "trajectoryPlayer.h"
+#include "eitOsMsgQueryReceiver.h"
+#include "traceRecorder.h"
+#include "metricsRegistry.h"
 
 using namespace std;
 
 namespace tarsim {
+namespace {
+typedef Eigen::Matrix<float, 4, 4, Eigen::RowMajor> FrameMatrix_t;
+
+// Socket clients are named by their connection, above any process id
+const int32_t SOCKET_USER_PID_BASE = 1 << 30;
+
+// Folder of the home directory traces are written to, clients only name
+// the file
+const std::string k_traceFolderName = "traceTarsim";
+
+void copyXfm(const Matrix4d &xfm, float* mij)
+{
+    FrameMatrix_t::Map(mij) = xfm.cast<float>();
+}
+} // end of anonymous namespace
+
 /**
  * @brief constructor for the EitOsMsgServerReceiver
  */
@@ -49,6 +68,9 @@ EitOsMsgServerReceiver::EitOsMsgServerReceiver(ConfigParser* cp, Kinematics* kin
     m_gui = gui;
     m_cp = cp;
     m_msgPriority = msgPriority;
+    m_policy = policy;
+    m_priority = priority;
+    addHandlers();
 }
 
 /**
@@ -56,15 +78,28 @@ EitOsMsgServerReceiver::EitOsMsgServerReceiver(ConfigParser* cp, Kinematics* kin
  */
 EitOsMsgServerReceiver::~EitOsMsgServerReceiver()
 {
+    // The player thread takes the message lock, so it is joined first
+    delete m_trajectoryPlayer;
+    m_trajectoryPlayer = nullptr;
+
+    delete m_queryReceiver;
+    m_queryReceiver = nullptr;
+
     delete m_runTimer;
     m_runTimer = nullptr;
+
+    for (auto pair: m_shmRingServers) {
+        delete pair.second;
+    }
+    m_shmRingServers.clear();
+
     EitOsMsgServerSender *sendUserReply;
-    for (auto i : m_listofUsers)
+    for (auto &i : m_listofUsers)
     {
         SimulatorStatus_t sts;
         sts.msgId = SIMULATOR_STATUS;
         sts.isSimRunning = false;
-        sendUserReply = i.second;
+        sendUserReply = i.second.get();
         if (sendUserReply->send(&sts, sizeof(sts), m_msgPriority) != NO_ERR)
         {
         	printf("Message queue %d not available\n", i.first);
@@ -72,12 +107,18 @@ EitOsMsgServerReceiver::~EitOsMsgServerReceiver()
 
         SimpleMsg_t out;
         out.msgId = MSG_EXIT_EVENT;
-        sendUserReply = i.second;
         if (sendUserReply->send(&out, sizeof(out), m_msgPriority) != NO_ERR)
         {
         	printf("Message queue %d not available\n", i.first);
         }
 	}
+
+    // Each sender flushes its queue, the messages above included, as it is
+    // deleted, before the socket server it may write to
+    m_listofUsers.clear();
+
+    delete m_socketServer;
+    m_socketServer = nullptr;
 }
 
 /**
@@ -85,7 +126,37 @@ EitOsMsgServerReceiver::~EitOsMsgServerReceiver()
  */
 Errors EitOsMsgServerReceiver::start()
 {
+    m_queryReceiver = new EitOsMsgQueryReceiver(
+            m_kinematics, m_msgPriority, &m_latency);
     MsgQServer::start();
+    if (NO_ERR != m_queryReceiver->start()) {
+        LOG_FAILURE("Failed to start query lane");
+    }
+
+    m_trajectoryPlayer = new TrajectoryPlayer(
+            [this](const Trajectory &trajectory,
+                    const std::vector<double> &positions,
+                    double time, int32_t segment, bool isDone) {
+                onTrajectoryCycle(trajectory, positions, time, segment, isDone);
+            },
+            m_policy, m_priority);
+    if (NO_ERR != m_trajectoryPlayer->start()) {
+        LOG_FAILURE("Failed to start trajectory player");
+    }
+
+    m_socketServer = new SocketServer(
+            TarsimSocketPath, TarsimTcpPort,
+            [this](int32_t connectionId, std::vector<GenericData_t> &data) {
+                onSocketMessages(connectionId, data);
+            },
+            [this](int32_t connectionId) { onSocketClosed(connectionId); },
+            m_policy, m_priority);
+    if (NO_ERR != m_socketServer->start()) {
+        LOG_FAILURE("Failed to listen on %s and port %d",
+                TarsimSocketPath.c_str(), TarsimTcpPort);
+    }
+
+    setDraining(m_cp->getRbs()->should_conflate_joint_values());
     return NO_ERR;
 }
 
@@ -99,9 +170,15 @@ EitOsMsgServerSender *EitOsMsgServerReceiver::getUserConnection(
 	if (m_listofUsers.find(userPid) == m_listofUsers.end())
 	{
 		std::string mqName = FileSystem::getMQNamePid(userPid);
-		m_listofUsers[userPid] = new EitOsMsgServerSender(mqName, m_msgPriority);
+		m_listofUsers[userPid].reset(
+		        new EitOsMsgServerSender(mqName, m_msgPriority));
+		if (userPid >= SOCKET_USER_PID_BASE)
+		{
+			m_listofUsers[userPid]->attachSocket(
+			        m_socketServer, userPid - SOCKET_USER_PID_BASE);
+		}
 	}
-    return m_listofUsers.at(userPid);
+    return m_listofUsers.at(userPid).get();
 }
 /**
  * @process the incoming data to the EitOsMsgServerReceiver Server
@@ -110,283 +187,966 @@ EitOsMsgServerSender *EitOsMsgServerReceiver::getUserConnection(
  */
 void EitOsMsgServerReceiver::onMessage(const GenericData_t &inComingData)
 {
+    // Ring threads are joined here, before taking the lock they contend for
+    if (MSG_CLIENT_DISCONNECTED_EVENT == inComingData.simpleMsg.msgId ||
+        SHARED_MEMORY_CONNECT == inComingData.simpleMsg.msgId) {
+        detachSharedMemory(inComingData.simpleMsg.srcPid);
+    }
+
+    // This message and the ones waiting behind it
+    MetricsRegistry::getInstance()->record(
+            METRIC_QUEUE_DEPTH, 1 + getNumPending());
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    processMessage(inComingData);
+}
+
+/**
+ * @process all the data that piled up in the queue. Joint setpoints are
+ * conflated so only the newest position of each joint is applied, but every
+ * other message is processed in order, after the setpoints before it.
+ * @param[in] inComingData -
+ */
+void EitOsMsgServerReceiver::onMessages(
+        const std::vector<GenericData_t> &inComingData)
+{
+    for (const GenericData_t &data: inComingData) {
+        if (MSG_CLIENT_DISCONNECTED_EVENT == data.simpleMsg.msgId ||
+            SHARED_MEMORY_CONNECT == data.simpleMsg.msgId) {
+            detachSharedMemory(data.simpleMsg.srcPid);
+        }
+    }
+
+    MetricsRegistry::getInstance()->record(
+            METRIC_QUEUE_DEPTH, (int64_t)inComingData.size());
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    processMessages(inComingData);
+}
+
+void EitOsMsgServerReceiver::processMessages(
+        const std::vector<GenericData_t> &inComingData)
+{
+    ConflatedSetpoints_t setpoints;
+    std::vector<uint8_t> payload;
+    for (const GenericData_t &data: inComingData) {
+        // Conflated setpoints are timed up to here, applying them is shared
+        // by the whole drain
+        if (ROBOT_JOINT_POSITIONS == data.simpleMsg.msgId ||
+            ROBOT_JOINT_POSITION == data.simpleMsg.msgId) {
+            recordReceived(data, getMonotonicTimeNs());
+            conflateSetpoints(data, setpoints);
+        } else if (FRAMED_MESSAGE == data.simpleMsg.msgId) {
+            recordReceived(data, getMonotonicTimeNs());
+
+            // Fragments only count once their payload is complete
+            int32_t payloadId = 0;
+            if (!assemblePayload(data, payloadId, payload)) {
+                continue;
+            }
+
+            std::vector<int32_t> indices;
+            std::vector<float> positions;
+            if (ROBOT_JOINT_POSITIONS == payloadId &&
+                readJointPositions(payload, indices, positions)) {
+                conflateSetpoints(data.simpleMsg.srcPid,
+                        data.simpleMsg.msgCounter, indices.data(),
+                        positions.data(), (int32_t)indices.size(), setpoints);
+            } else {
+                applySetpoints(setpoints);
+                m_msgCounter = data.simpleMsg.msgCounter;
+                processPayload(getUserConnection(data.simpleMsg.srcPid),
+                        data.simpleMsg.msgCounter, payloadId, payload);
+            }
+        } else {
+            applySetpoints(setpoints);
+            processMessage(data);
+        }
+    }
+    applySetpoints(setpoints);
+}
+
+/**
+ * @process the data received over a client shared memory ring. Connection
+ * management messages are only accepted over the message queue.
+ * @param[in] inComingData -
+ */
+void EitOsMsgServerReceiver::onSharedMemoryMessage(
+        const GenericData_t &inComingData)
+{
+    if (inComingData.simpleMsg.msgId < MSG_FIRST_APPLICATION ||
+        SHARED_MEMORY_CONNECT == inComingData.simpleMsg.msgId) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    processMessage(inComingData);
+}
+
+/**
+ * @process the data of one read of a socket connection. The connection names
+ * the client, since clients in other containers may share process ids.
+ * @param[in] connectionId - connection of the client
+ * @param[in] inComingData -
+ */
+void EitOsMsgServerReceiver::onSocketMessages(
+        int32_t connectionId, std::vector<GenericData_t> &inComingData)
+{
+    int32_t userPid = SOCKET_USER_PID_BASE + connectionId;
+    inComingData.erase(std::remove_if(inComingData.begin(), inComingData.end(),
+            [](const GenericData_t &data) {
+                return SHARED_MEMORY_CONNECT == data.simpleMsg.msgId ||
+                       (data.simpleMsg.msgId < MSG_FIRST_APPLICATION &&
+                        MSG_CLIENT_DISCONNECTED_EVENT != data.simpleMsg.msgId);
+            }), inComingData.end());
+    for (GenericData_t &data: inComingData) {
+        data.simpleMsg.srcPid = userPid;
+    }
+
+    MetricsRegistry::getInstance()->record(
+            METRIC_QUEUE_DEPTH, (int64_t)inComingData.size());
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    if (isDraining()) {
+        processMessages(inComingData);
+        return;
+    }
+
+    for (const GenericData_t &data: inComingData) {
+        processMessage(data);
+    }
+}
+
+/**
+ * @brief cleans up after a socket client that went away without saying so
+ * @param[in] connectionId - connection of the client
+ */
+void EitOsMsgServerReceiver::onSocketClosed(int32_t connectionId)
+{
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    int32_t userPid = SOCKET_USER_PID_BASE + connectionId;
+    auto it = m_listofUsers.find(userPid);
+    if (it == m_listofUsers.end()) {
+        return;
+    }
+
+    SimpleMsg_t msg;
+    msg.msgId = MSG_CLIENT_DISCONNECTED_EVENT;
+    msg.srcPid = userPid;
+    disconnectClient(it->second.get(), msg);
+}
+
+void EitOsMsgServerReceiver::processMessage(const GenericData_t &inComingData)
+{
+	TRACE_SCOPE("EitOsMsgServerReceiver::processMessage");
+
 	int32_t userPid = inComingData.simpleMsg.srcPid;
 
 	EitOsMsgServerSender *sendUserReply = getUserConnection(userPid);
 
 	m_msgCounter = inComingData.simpleMsg.msgCounter;
 
-	switch (inComingData.simpleMsg.msgId)
-    {
-        case MSG_CLIENT_DISCONNECTED_EVENT:
-        {
-          m_listofUsers.erase(inComingData.simpleMsg.srcPid);
-          if (sendUserReply != nullptr)
-          {
-            sendUserReply->disconnect();
-          }
+	int64_t startNs = getMonotonicTimeNs();
+	recordReceived(inComingData, startNs);
 
-          break;
-        }
-        case ROBOT_JOINT_POSITIONS:
-        {
-            JointPositions_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            updateRobotJointPositions(sendUserReply, in);
-        }
-        break;
+	m_dispatcher.dispatch(*this, sendUserReply, inComingData);
 
-        case ROBOT_JOINT_POSITION:
-        {
-            JointPosition_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            updateRobotJointPosition(sendUserReply, in);
-        }
-        break;
+	m_latency.record(getLatencyMsgId(inComingData.simpleMsg), LATENCY_HANDLER,
+	        startNs, getMonotonicTimeNs());
+}
 
-        case ROBOT_BASE_POSE:
-        {
-            Frame_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            Matrix4d m = Matrix4d::Identity();
-            m << in.mij[ 0], in.mij[ 1], in.mij[ 2], in.mij[ 3],
-                 in.mij[ 4], in.mij[ 5], in.mij[ 6], in.mij[ 7],
-                 in.mij[ 8], in.mij[ 9], in.mij[10], in.mij[11],
-                 in.mij[12], in.mij[13], in.mij[14], in.mij[15];
-
-            m_kinematics->getRoot()->setXfm(m);
-        }
-        break;
+void EitOsMsgServerReceiver::recordReceived(
+        const GenericData_t &inComingData, int64_t startNs)
+{
+    m_latency.recordTransport(inComingData.simpleMsg);
+    m_latency.record(getLatencyMsgId(inComingData.simpleMsg), LATENCY_DISPATCH,
+            inComingData.simpleMsg.receiveTimeNs, startNs);
+}
 
-        case CAMERA_DATA:
-        {
-            Camera_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            m_kinematics->getCameraDataQueue()->push(in);
+/**
+ * @brief registers the handler of every message the server accepts
+ */
+void EitOsMsgServerReceiver::addHandlers()
+{
+    typedef EitOsMsgServerReceiver R;
+
+    m_dispatcher.add<SimpleMsg_t, &R::disconnectClient>(
+            MSG_CLIENT_DISCONNECTED_EVENT);
+    m_dispatcher.add<SimpleMsg_t, &R::onTimerEvent>(MSG_TIMER_EVENT);
+
+    m_dispatcher.add<JointPositions_t, &R::updateRobotJointPositions>(
+            ROBOT_JOINT_POSITIONS);
+    m_dispatcher.add<JointPosition_t, &R::updateRobotJointPosition>(
+            ROBOT_JOINT_POSITION);
+    m_dispatcher.add<GenericData_t, &R::processFramed>(FRAMED_MESSAGE);
+    m_dispatcher.add<Frame_t, &R::setBaseFrame>(ROBOT_BASE_POSE);
+    m_dispatcher.add<Camera_t, &R::setCamera>(CAMERA_DATA);
+    m_dispatcher.add<LockObjectToRigidBody_t, &R::lockObjectToRigidBody>(
+            LOCK_OBJECT_TO_RIGID_BODY);
+    m_dispatcher.add<UnlockObjectFromRigidBody_t,
+            &R::unlockObjectFromRigidBody>(UNLOCK_OBJECT_FROM_RIGID_BODY);
+    m_dispatcher.add<SimpleMsg_t, &R::executeForwardKinematics>(
+            REQUEST_EXECUTE_FORWARD_KINEMATICS);
+    m_dispatcher.add<Frame_t, &R::setObjectFrame>(OBJECT_FRAME);
+    m_dispatcher.add<SimpleMsg_t, &R::startRecord>(REQUEST_START_RECORD);
+    m_dispatcher.add<SimpleMsg_t, &R::stopRecord>(REQUEST_STOP_RECORD);
+    m_dispatcher.add<GuiStatusMessage_t, &R::setGuiStatus>(GUI_STATUS_MESSAGE);
+    m_dispatcher.add<SimpleMsg_t, &R::shutdown>(SHUTDOWN);
+    m_dispatcher.add<RequestInstallTool_t, &R::installTool>(INSTALL_TOOL);
+    m_dispatcher.add<SetEndEffector_t, &R::setEndEffector>(SET_END_EFFECTOR);
+    m_dispatcher.add<Step_t, &R::step>(STEP);
+    m_dispatcher.add<TrajectoryChunk_t, &R::uploadTrajectory>(TRAJECTORY);
+    m_dispatcher.add<TrajectoryCommand_t, &R::commandTrajectory>(
+            TRAJECTORY_COMMAND);
+    m_dispatcher.add<Subscribe_t, &R::subscribe>(SUBSCRIBE);
+    m_dispatcher.add<SharedMemoryConnect_t, &R::attachSharedMemory>(
+            SHARED_MEMORY_CONNECT);
+    m_dispatcher.add<RequestLatencyStats_t, &R::sendLatencyStatistics>(
+            REQUEST_LATENCY_STATS);
+    m_dispatcher.add<RequestStatistics_t, &R::sendStatistics>(
+            REQUEST_STATISTICS);
+    m_dispatcher.add<TraceCommand_t, &R::commandTrace>(TRACE_COMMAND);
+
+    // Queries of clients on shared memory, or that do not use the query
+    // lane, are answered here the same way
+    for (int32_t msgId: {REQUEST_END_EFFECTOR_FRAME, REQUEST_RIGID_BODY_FRAME,
+            REQUEST_OBJECT_FRAME, REQUEST_JOINT_VALUES, SIMULATOR_STATUS,
+            REGISTER_FRAME_SELECTION, REQUEST_FRAMES_BATCH}) {
+        m_dispatcher.add<GenericData_t, &R::processQuery>(msgId);
+    }
+}
 
+void EitOsMsgServerReceiver::disconnectClient(
+        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg)
+{
+    // Deleted once disconnected, when this returns
+    std::unique_ptr<EitOsMsgServerSender> user;
+    auto it = m_listofUsers.find(msg.srcPid);
+    if (it != m_listofUsers.end()) {
+        user = std::move(it->second);
+        m_listofUsers.erase(it);
+    }
+    m_queryReceiver->removeUser(msg.srcPid);
+    m_subscriptions.erase(msg.srcPid);
+    m_trajectoryUploads.erase(msg.srcPid);
+    m_trajectories.erase(msg.srcPid);
+    m_assembler.remove(msg.srcPid);
+    if (m_trajectoryOwner == msg.srcPid) {
+        abortTrajectory();
+    }
+    if (sendUserReply != nullptr)
+    {
+        OutboundStatistics_t statistics =
+                sendUserReply->getOutboundStatistics();
+        if (statistics.numDropped > 0) {
+            LOG_WARNING("Process %d left with %d of %d replies dropped",
+                    (int)msg.srcPid,
+                    (int)statistics.numDropped,
+                    (int)statistics.numQueued);
         }
-        break;
+        sendUserReply->disconnect();
+    }
+}
 
-        case LOCK_OBJECT_TO_RIGID_BODY:
-        {
-            LockObjectToRigidBody_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            m_kinematics->lockObjectsToRb(in.indexObject, in.indexRigidBody);
+void EitOsMsgServerReceiver::onTimerEvent(
+        EitOsMsgServerSender * /*sendUserReply*/, const SimpleMsg_t & /*msg*/)
+{
+    LOG_INFO("Timer Event in RobotServer.....");
+}
 
-        }
-        break;
+void EitOsMsgServerReceiver::processFramed(
+        EitOsMsgServerSender *sendUserReply, const GenericData_t &inComingData)
+{
+    int32_t payloadId = 0;
+    std::vector<uint8_t> payload;
+    if (assemblePayload(inComingData, payloadId, payload)) {
+        processPayload(sendUserReply,
+                inComingData.simpleMsg.msgCounter, payloadId, payload);
+    }
+}
 
-        case UNLOCK_OBJECT_FROM_RIGID_BODY:
-        {
-            UnlockObjectFromRigidBody_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            m_kinematics->unlockObjectsFromRigidBody(in.indexObject);
+void EitOsMsgServerReceiver::processQuery(
+        EitOsMsgServerSender *sendUserReply, const GenericData_t &inComingData)
+{
+    m_queryReceiver->processQuery(sendUserReply, inComingData);
+}
 
-        }
-        break;
+void EitOsMsgServerReceiver::setBaseFrame(
+        EitOsMsgServerSender * /*sendUserReply*/, const Frame_t &msg)
+{
+    m_kinematics->setBaseFrame(FrameMatrix_t::Map(msg.mij).cast<double>());
+}
 
-        case REQUEST_EXECUTE_FORWARD_KINEMATICS:
-        {
-            GuiStatusMessage_t in;
-            std::map<int32_t, Collision> collisions;
-            if (NO_ERR != m_kinematics->executeForwardKinematics(in, collisions))
-            {
-                LOG_WARNING("Failed to execute forward kinematics");
-            }
+void EitOsMsgServerReceiver::setCamera(
+        EitOsMsgServerSender * /*sendUserReply*/, const Camera_t &msg)
+{
+    m_kinematics->getCameraDataQueue()->push(msg);
+}
 
-            if (in.faultLevel > FaultLevels::FAULT_LEVEL_NOFAULT) {
-                m_gui->setStatusMessage(in);
-            }
+void EitOsMsgServerReceiver::lockObjectToRigidBody(
+        EitOsMsgServerSender * /*sendUserReply*/,
+        const LockObjectToRigidBody_t &msg)
+{
+    m_kinematics->lockObjectsToRb(msg.indexObject, msg.indexRigidBody);
+}
 
-            sendCollision(collisions);
-        }
-        break;
+void EitOsMsgServerReceiver::unlockObjectFromRigidBody(
+        EitOsMsgServerSender * /*sendUserReply*/,
+        const UnlockObjectFromRigidBody_t &msg)
+{
+    m_kinematics->unlockObjectsFromRigidBody(msg.indexObject);
+}
 
-        case REQUEST_END_EFFECTOR_FRAME:
-        {
-            Matrix4d xfm = m_kinematics->getXfmEndEffector();
-            Frame_t out;
-            out.frameId = 0;
-            out.msgCounter = m_msgCounter;
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 4; j++) {
-                    int index = (i * 4) + j;
-                    out.mij[index] = xfm(i, j);
-                }
-            }
+void EitOsMsgServerReceiver::executeForwardKinematics(
+        EitOsMsgServerSender * /*sendUserReply*/, const SimpleMsg_t &msg)
+{
+    GuiStatusMessage_t in;
+    std::map<int32_t, Collision> collisions;
+    if (NO_ERR != executeForwardKinematics(msg.msgId, in, collisions))
+    {
+        LOG_WARNING("Failed to execute forward kinematics");
+    }
 
-            if (sendUserReply != nullptr)
-            {
-                sendUserReply->sendEndEffectorFrame(out);
-            }
-        }
-        break;
+    if (in.faultLevel > FaultLevels::FAULT_LEVEL_NOFAULT) {
+        m_gui->setStatusMessage(in);
+    }
 
-        case REQUEST_RIGID_BODY_FRAME:
-        {
-            RequestRigidBodyFrame_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            Matrix4d xfm = Matrix4d::Zero();
-            if (NO_ERR != m_kinematics->getRigidBodyFrame(
-                    (int)in.indexRigidBody, (int)in.indexFrame, xfm)) {
-                LOG_WARNING("Failed to get rigid body frame");
-            }
+    sendCollision(collisions);
+    publishState(in);
+}
 
-            Frame_t out;
-            out.frameId = in.indexRigidBody;
-            out.msgCounter = m_msgCounter;
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 4; j++) {
-                    int index = (i * 4) + j;
-                    out.mij[index] = xfm(i, j);
-                }
-            }
+Errors EitOsMsgServerReceiver::executeForwardKinematics(
+        int32_t msgId, GuiStatusMessage_t &status,
+        std::map<int32_t, Collision> &collisions)
+{
+    int64_t startNs = getMonotonicTimeNs();
+    Errors error = m_kinematics->executeForwardKinematics(status, collisions);
+    m_latency.record(msgId, LATENCY_KINEMATICS, startNs, getMonotonicTimeNs());
+
+    double collisionDuration = m_kinematics->getCollisionDuration();
+    if (collisionDuration > 0.0) {
+        m_latency.recordDuration(msgId, LATENCY_COLLISION,
+                (int64_t)(collisionDuration * 1e6));
+    }
+    return error;
+}
 
-            if (sendUserReply != nullptr)
-            {
-                sendUserReply->sendRigidBodyFrame(out);
-            }
+void EitOsMsgServerReceiver::setObjectFrame(
+        EitOsMsgServerSender * /*sendUserReply*/, const Frame_t &msg)
+{
+    Matrix4d xfm = FrameMatrix_t::Map(msg.mij).cast<double>();
+    if (NO_ERR != m_kinematics->setObjectFrame((int)msg.frameId, xfm)) {
+        LOG_WARNING("Failed to get object frame");
+    }
+}
+
+void EitOsMsgServerReceiver::startRecord(
+        EitOsMsgServerSender * /*sendUserReply*/, const SimpleMsg_t & /*msg*/)
+{
+    m_gui->setRecordRobotScene(true);
+}
+
+void EitOsMsgServerReceiver::stopRecord(
+        EitOsMsgServerSender * /*sendUserReply*/, const SimpleMsg_t & /*msg*/)
+{
+    m_gui->setRecordRobotScene(false);
+}
+
+void EitOsMsgServerReceiver::setGuiStatus(
+        EitOsMsgServerSender * /*sendUserReply*/, const GuiStatusMessage_t &msg)
+{
+    m_gui->setStatusMessage(msg);
+}
+
+void EitOsMsgServerReceiver::shutdown(
+        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg)
+{
+    disconnectClient(sendUserReply, msg);
+    m_gui->destroy();
+}
+
+void EitOsMsgServerReceiver::commandTrace(
+        EitOsMsgServerSender * /*sendUserReply*/, const TraceCommand_t &msg)
+{
+    if (TRACE_START == msg.command) {
+        TraceRecorder::setThreadName("server receiver");
+        TraceRecorder::start();
+        LOG_INFO("Tracing started");
+        return;
+    }
+
+    TraceRecorder::stop();
+    std::string name(msg.fileName,
+            strnlen(msg.fileName, MAX_TRACE_FILE_NAME_SIZE));
+    if (name.empty()) {
+        return;
+    }
+
+    if (std::string::npos != name.find('/') || '.' == name[0]) {
+        LOG_FAILURE("Trace file name %s is not a plain file name", name.c_str());
+        return;
+    }
+
+    std::string folderName =
+            FileSystem::homeDirectory() + "/" + k_traceFolderName;
+    FileSystem::recursiveMkDir(folderName.c_str());
+    std::string fileName = folderName + "/" + name;
+
+    size_t numEvents = 0;
+    if (!TraceRecorder::writeChromeTrace(fileName, numEvents)) {
+        LOG_FAILURE("Failed to write the trace to %s", fileName.c_str());
+        return;
+    }
+    LOG_INFO("Trace of %zu spans written to %s", numEvents, fileName.c_str());
+}
+
+void EitOsMsgServerReceiver::sendLatencyStatistics(
+        EitOsMsgServerSender *sendUserReply, const RequestLatencyStats_t &msg)
+{
+    if (sendUserReply == nullptr) {
+        return;
+    }
+
+    std::vector<LatencyStatistics_t> statistics = m_latency.getStatistics();
+    if (msg.shouldReset) {
+        m_latency.reset();
+    }
+
+    // Framed payloads carry counters of their own, so the request counter
+    // travels in the payload
+    MessageWriter out(LATENCY_STATS);
+    out.write(msg.msgCounter);
+    writeLatencyStatistics(out, statistics);
+    if (NO_ERR != sendUserReply->sendFramed(out)) {
+        LOG_WARNING("Failed to send latency statistics to process %d",
+                (int)msg.srcPid);
+    }
+}
+
+void EitOsMsgServerReceiver::sendStatistics(
+        EitOsMsgServerSender *sendUserReply, const RequestStatistics_t &msg)
+{
+    if (sendUserReply == nullptr) {
+        return;
+    }
+
+    MetricsRegistry* metrics = MetricsRegistry::getInstance();
+    std::vector<MetricStatistics_t> statistics = metrics->getStatistics();
+    if (msg.shouldReset) {
+        metrics->reset();
+    }
+
+    MessageWriter out(STATISTICS);
+    out.write(msg.msgCounter);
+    writeMetricStatistics(out, statistics);
+    if (NO_ERR != sendUserReply->sendFramed(out)) {
+        LOG_WARNING("Failed to send statistics to process %d",
+                (int)msg.srcPid);
+    }
+}
+
+void EitOsMsgServerReceiver::attachSharedMemory(
+        EitOsMsgServerSender *sendUserReply, const SharedMemoryConnect_t &msg)
+{
+    if (sendUserReply == nullptr) {
+        return;
+    }
+
+    std::string ringToServer(msg.ringToServer,
+            strnlen(msg.ringToServer, MAX_SHM_NAME_SIZE));
+    std::string ringToClient(msg.ringToClient,
+            strnlen(msg.ringToClient, MAX_SHM_NAME_SIZE));
+
+    if (NO_ERR != sendUserReply->attachSharedMemory(ringToClient)) {
+        LOG_FAILURE("Failed to attach to ring %s of process %d",
+                ringToClient.c_str(), msg.srcPid);
+        return;
+    }
+
+    ShmRingServer* server = new ShmRingServer(
+            ringToServer, false,
+            [this](const GenericData_t &data) { onSharedMemoryMessage(data); },
+            m_policy, m_priority);
+
+    if (NO_ERR != server->start()) {
+        LOG_FAILURE("Failed to attach to ring %s of process %d",
+                ringToServer.c_str(), msg.srcPid);
+        delete server;
+        return;
+    }
+
+    m_shmRingServers[msg.srcPid] = server;
+    LOG_INFO("Process %d is connected over shared memory", msg.srcPid);
+}
+
+void EitOsMsgServerReceiver::detachSharedMemory(const int32_t userPid)
+{
+    std::map<int32_t, ShmRingServer*>::iterator it =
+            m_shmRingServers.find(userPid);
+    if (it == m_shmRingServers.end()) {
+        return;
+    }
+
+    delete it->second;
+    m_shmRingServers.erase(it);
+}
+
+void EitOsMsgServerReceiver::getJointValues(JointPositions_t &msg)
+{
+    std::map<int, double> jointValues;
+    if (NO_ERR != m_kinematics->getJointValues(jointValues)) {
+        LOG_WARNING("Failed to get joint values from kinematics");
+    }
+
+    msg.numJoints = std::min(MAX_JOINTS, (int32_t)jointValues.size());
+    int index = 0;
+    for (std::map<int, double>::iterator it = jointValues.begin();
+            it != jointValues.end() && index < msg.numJoints; ++it) {
+        msg.indices[index] = it->first;
+        msg.positions[index] = it->second;
+        index++;
+    }
+}
 
+void EitOsMsgServerReceiver::getEndEffectorFrame(Frame_t &msg)
+{
+    msg.frameId = 0;
+    copyXfm(m_kinematics->getXfmEndEffector(), msg.mij);
+}
+
+void EitOsMsgServerReceiver::subscribe(
+        EitOsMsgServerSender * /*sendUserReply*/, const Subscribe_t &msg)
+{
+    if (0 == msg.topics) {
+        m_subscriptions.erase(msg.srcPid);
+        return;
+    }
+
+    Subscription_t subscription;
+    subscription.topics = msg.topics;
+    subscription.decimation = std::max(1, msg.decimation);
+    subscription.selectionId = msg.selectionId;
+    m_subscriptions[msg.srcPid] = subscription;
+}
+
+void EitOsMsgServerReceiver::publishState(const GuiStatusMessage_t &status)
+{
+    if (m_subscriptions.empty()) {
+        return;
+    }
+
+    // State is gathered once per cycle and only if somebody wants it
+    JointPositions_t jointValues;
+    Frame_t endEffector;
+    ErrorMessage_t fault;
+    bool isJointValuesReady = false;
+    bool isEndEffectorReady = false;
+    bool isFaultReady = false;
+    std::shared_ptr<const KinematicsSnapshot_t> snapshot;
+
+    for (auto &pair: m_subscriptions) {
+        Subscription_t &subscription = pair.second;
+        subscription.cycles++;
+        if (subscription.cycles < subscription.decimation) {
+            continue;
         }
-        break;
+        subscription.cycles = 0;
 
-        case REQUEST_OBJECT_FRAME:
-        {
-            RequestObjectFrame_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-            Matrix4d xfm = Matrix4d::Zero();
-            if (NO_ERR != m_kinematics->getObjectFrame((int)in.indexObject, xfm)) {
-                LOG_WARNING("Failed to get object frame");
+        EitOsMsgServerSender *sendUserReply = getUserConnection(pair.first);
+        if (sendUserReply == nullptr) {
+            continue;
+        }
+
+        if (subscription.topics & TOPIC_JOINT_VALUES) {
+            if (!isJointValuesReady) {
+                jointValues.msgCounter = PUBLISHED_MSG_COUNTER;
+                getJointValues(jointValues);
+                isJointValuesReady = true;
             }
 
-            Frame_t out;
-            out.frameId = in.indexObject;
-            out.msgCounter = m_msgCounter;
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 4; j++) {
-                    int index = (i * 4) + j;
-                    out.mij[index] = xfm(i, j);
-                }
+            if (NO_ERR != sendUserReply->sendJointValues(jointValues)) {
+                LOG_FAILURE("Failed to publish joint values to process %d",
+                        (int)pair.first);
             }
+        }
 
-            if (sendUserReply != nullptr)
-            {
-                sendUserReply->sendObjectFrame(out);
+        if (subscription.topics & TOPIC_END_EFFECTOR) {
+            if (!isEndEffectorReady) {
+                endEffector.msgCounter = PUBLISHED_MSG_COUNTER;
+                getEndEffectorFrame(endEffector);
+                isEndEffectorReady = true;
             }
 
+            if (NO_ERR != sendUserReply->sendEndEffectorFrame(endEffector)) {
+                LOG_FAILURE("Failed to publish end-effector to process %d",
+                        (int)pair.first);
+            }
         }
-        break;
 
-        case OBJECT_FRAME:
-        {
-            Frame_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
-
-            Matrix4d xfm = Matrix4d::Zero();
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 4; j++) {
-                    int index = (i * 4) + j;
-                    xfm(i, j) = in.mij[index];
-                }
+        if (subscription.topics & TOPIC_FAULT_STATUS) {
+            if (!isFaultReady) {
+                fault.msgCounter = PUBLISHED_MSG_COUNTER;
+                fault.errorId = (int32_t)status.faultType;
+                fault.msgLength = (int32_t)strnlen(
+                        status.statusMessage, LOG_MAX_DATA_SIZE - 1);
+                std::memcpy(fault.errorMsg, status.statusMessage,
+                        fault.msgLength);
+                fault.errorMsg[fault.msgLength] = '\0';
+                isFaultReady = true;
             }
 
-            if (NO_ERR != m_kinematics->setObjectFrame((int)in.frameId, xfm)) {
-                LOG_WARNING("Failed to get object frame");
+            if (NO_ERR != sendUserReply->sendErrorMessage(fault)) {
+                LOG_FAILURE("Failed to publish fault status to process %d",
+                        (int)pair.first);
             }
         }
-        break;
 
-        case REQUEST_JOINT_VALUES:
-        {
-            std::map<int, double> jointValues;
-            if (NO_ERR != m_kinematics->getJointValues(jointValues)) {
-                LOG_WARNING("Failed to get joint values from kinematics");
+        if (subscription.topics & TOPIC_FRAMES) {
+            std::vector<FrameSelection_t> selection;
+            if (!m_queryReceiver->getFrameSelection(
+                    pair.first, subscription.selectionId, selection)) {
+                continue;
             }
 
-            JointPositions_t out;
-            out.msgCounter = m_msgCounter;
-            out.numJoints = (int32_t)jointValues.size();
-            int index = 0;
-            for (std::map<int, double>::iterator it = jointValues.begin();
-                    it != jointValues.end(); ++it) {
-                out.indices[index] = it->first;
-                out.positions[index] = it->second;
-                index++;
+            if (nullptr == snapshot) {
+                snapshot = m_kinematics->getSnapshot();
             }
+            m_queryReceiver->sendFrames(sendUserReply, PUBLISHED_MSG_COUNTER,
+                    subscription.selectionId,
+                    selection.data(), (int32_t)selection.size(), *snapshot);
+        }
+    }
+}
 
+Errors EitOsMsgServerReceiver::setTargetJointValues(
+        const int32_t* indices, const float* positions, int32_t numJoints,
+        Errors &maxError, int32_t &jntIndex)
+{
+    maxError = NO_ERR;
+    jntIndex = 0;
+    for (int32_t i = 0; i < numJoints; i++) {
+        Node* node = m_cp->getNodeOfMate((int)indices[i]);
 
-            if (sendUserReply != nullptr)
-            {
-                sendUserReply->sendJointValues(out);
-            }
+        if (nullptr == node) {
+            LOG_FAILURE("Invalid joint index %d was received", indices[i]);
+            return ERR_INVALID;
+        }
+
+        Errors error = node->setTargetJointValue(positions[i]);
 
+        if (error > maxError) {
+            maxError = error;
+            jntIndex = indices[i];
         }
-        break;
+    }
+    return NO_ERR;
+}
 
-        case SIMULATOR_STATUS:
-        {
-            SimulatorStatus_t out;
-            out.msgCounter = m_msgCounter;
-            out.isSimRunning = true;
-            if (sendUserReply != nullptr)
-            {
-                sendUserReply->sendSimulatorStatus(out);
+void EitOsMsgServerReceiver::step(
+        EitOsMsgServerSender *sendUserReply, const Step_t &msg)
+{
+    Errors maxError = NO_ERR;
+    int32_t jntIndex = 0;
+    if (NO_ERR != setTargetJointValues(msg.indices, msg.positions,
+            std::min(msg.numJoints, MAX_JOINTS), maxError, jntIndex)) {
+        maxError = ERR_INVALID;
+    }
+
+    GuiStatusMessage_t status;
+    std::map<int32_t, Collision> collisions;
+    if (NO_ERR != executeForwardKinematics(msg.msgId, status, collisions))
+    {
+        LOG_WARNING("Failed to execute forward kinematics");
+    }
+
+    if (status.faultLevel > FaultLevels::FAULT_LEVEL_NOFAULT) {
+        m_gui->setStatusMessage(status);
+    }
+
+    int32_t numSelfCollisions = 0;
+    int32_t numExternalCollisions = 0;
+    for (auto &pair: collisions) {
+        for (int32_t j = 0; j < pair.second.numCollisions; j++) {
+            if (pair.second.isSelfCollision[j]) {
+                numSelfCollisions++;
+            } else {
+                numExternalCollisions++;
             }
         }
-        break;
+    }
 
-        case REQUEST_START_RECORD:
-        {
-            m_gui->setRecordRobotScene(true);
-        }
-        break;
+    double fkDuration = 0.0;
+    double jvDuration = 0.0;
+    m_kinematics->getCycleDurations(fkDuration, jvDuration);
+    Matrix4d xfm = m_kinematics->getXfmEndEffector();
+
+    if (sendUserReply != nullptr) {
+        sendUserReply->sendInPlace<StepResult_t>(STEP_RESULT, msg.msgCounter,
+                [&](StepResult_t &out) {
+                    out.errorId = (int32_t)maxError;
+                    out.errorJoint = (NO_ERR == maxError) ? -1 : jntIndex;
+                    copyXfm(xfm, out.mij);
+                    out.numSelfCollisions = numSelfCollisions;
+                    out.numExternalCollisions = numExternalCollisions;
+                    out.faultLevel = status.faultLevel;
+                    out.faultType = status.faultType;
+                    out.fkDuration = (float)fkDuration;
+                    out.jvDuration = (float)jvDuration;
+                });
+    }
 
-        case REQUEST_STOP_RECORD:
-        {
-            m_gui->setRecordRobotScene(false);
-        }
-        break;
+    // The stepping client has the collision summary in its reply already
+    sendCollision(collisions, msg.srcPid);
+    publishState(status);
+}
 
-        case GUI_STATUS_MESSAGE:
-        {
-            GuiStatusMessage_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+void EitOsMsgServerReceiver::uploadTrajectory(
+        EitOsMsgServerSender *sendUserReply, const TrajectoryChunk_t &msg)
+{
+    if (sendUserReply == nullptr) {
+        return;
+    }
 
-            m_gui->setStatusMessage(in);
-        }
-        break;
+    if (msg.numJoints <= 0 || msg.numJoints > MAX_JOINTS ||
+        msg.numWaypoints < 0 ||
+        msg.numWaypoints > MAX_TRAJECTORY_CHUNK_VALUES / (msg.numJoints + 1)) {
+        LOG_FAILURE("Invalid chunk %d of trajectory %d",
+                msg.chunkIndex, msg.trajectoryId);
+        m_trajectoryUploads.erase(msg.srcPid);
+        sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                TRAJECTORY_STATE_INVALID);
+        return;
+    }
 
-        case SHUTDOWN:
-        {
-            m_listofUsers.erase(inComingData.simpleMsg.srcPid);
-            m_gui->destroy();
+    if (0 == msg.chunkIndex) {
+        TrajectoryUpload_t upload;
+        upload.trajectory = std::make_shared<Trajectory>(
+                msg.trajectoryId, msg.interpolation,
+                std::vector<int32_t>(msg.indices, msg.indices + msg.numJoints));
+        upload.numChunks = msg.numChunks;
+        m_trajectoryUploads[msg.srcPid] = upload;
+    }
+
+    auto it = m_trajectoryUploads.find(msg.srcPid);
+    if (it == m_trajectoryUploads.end() ||
+        it->second.trajectory->getId() != msg.trajectoryId ||
+        it->second.nextChunk != msg.chunkIndex ||
+        it->second.numChunks != msg.numChunks) {
+        LOG_FAILURE("Chunk %d of trajectory %d is out of order",
+                msg.chunkIndex, msg.trajectoryId);
+        m_trajectoryUploads.erase(msg.srcPid);
+        sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                TRAJECTORY_STATE_INVALID);
+        return;
+    }
+
+    TrajectoryUpload_t &upload = it->second;
+    std::vector<double> positions(msg.numJoints);
+    for (int32_t k = 0; k < msg.numWaypoints; k++) {
+        const float* waypoint = &msg.values[k * (msg.numJoints + 1)];
+        std::copy(waypoint + 1, waypoint + 1 + msg.numJoints, positions.begin());
+        if (NO_ERR != upload.trajectory->addWaypoint(waypoint[0], positions)) {
+            LOG_FAILURE("Invalid waypoint in trajectory %d", msg.trajectoryId);
+            m_trajectoryUploads.erase(it);
+            sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                    TRAJECTORY_STATE_INVALID);
+            return;
         }
-        break;
+    }
 
-        case INSTALL_TOOL:
-        {
-            RequestInstallTool_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+    upload.nextChunk++;
+    if (upload.nextChunk < upload.numChunks) {
+        return;
+    }
 
-            installTool(in);
+    // Playback honors the mate limits by stretching the trajectory in time
+    std::shared_ptr<Trajectory> trajectory = upload.trajectory;
+    m_trajectoryUploads.erase(it);
+    std::vector<JointLimits_t> limits;
+    for (int32_t index: trajectory->getIndices()) {
+        Node* node = m_cp->getNodeOfMate((int)index);
+        if (nullptr == node) {
+            LOG_FAILURE("Invalid joint index %d in trajectory %d",
+                    index, msg.trajectoryId);
+            sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                    TRAJECTORY_STATE_INVALID);
+            return;
         }
-        break;
 
-        case SET_END_EFFECTOR:
-        {
-            SetEndEffector_t in;
-            std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+        const Mate* mate = node->getMateToParent();
+        JointLimits_t limit;
+        limit.isVelocityLimited = mate->is_velocity_limited();
+        limit.minVelocity = mate->min_velocity();
+        limit.maxVelocity = mate->max_velocity();
+        limit.isAccelerationLimited = mate->is_acceleration_limited();
+        limit.minAcceleration = mate->min_acceleration();
+        limit.maxAcceleration = mate->max_acceleration();
+        limits.push_back(limit);
+    }
+
+    if (NO_ERR != trajectory->finalize(limits)) {
+        LOG_FAILURE("Failed to finalize trajectory %d", msg.trajectoryId);
+        sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                TRAJECTORY_STATE_INVALID);
+        return;
+    }
+
+    m_trajectories[msg.srcPid] = trajectory;
+    sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+            TRAJECTORY_STATE_READY, trajectory.get());
+}
 
-            setEndEffector(in);
+void EitOsMsgServerReceiver::commandTrajectory(
+        EitOsMsgServerSender *sendUserReply, const TrajectoryCommand_t &msg)
+{
+    if (sendUserReply == nullptr) {
+        return;
+    }
+
+    if (TRAJECTORY_STOP == msg.command) {
+        TrajectoryStates state = TRAJECTORY_STATE_IDLE;
+        if (nullptr != m_trajectoryPlaying) {
+            abortTrajectory();
+            state = TRAJECTORY_STATE_ABORTED;
         }
-        break;
+        sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                state);
+        return;
+    }
 
-        case MSG_TIMER_EVENT:
-            LOG_INFO("Timer Event in RobotServer.....");
-            break;
+    auto it = m_trajectories.find(msg.srcPid);
+    if (it == m_trajectories.end() ||
+        it->second->getId() != msg.trajectoryId) {
+        LOG_WARNING("Trajectory %d of process %d is not uploaded",
+                msg.trajectoryId, msg.srcPid);
+        sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                TRAJECTORY_STATE_INVALID);
+        return;
+    }
 
-        default:
-            break;
+    if (nullptr != m_trajectoryPlaying) {
+        abortTrajectory();
+    }
+
+    double cycleMs = 1.0;
+    if (m_cp->getRbs()->control_cycle() > 0.0) {
+        cycleMs = m_cp->getRbs()->control_cycle();
+    }
+
+    if (nullptr == m_trajectoryPlayer ||
+        NO_ERR != m_trajectoryPlayer->play(it->second, cycleMs)) {
+        LOG_FAILURE("Failed to play trajectory %d", msg.trajectoryId);
+        sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+                TRAJECTORY_STATE_INVALID);
+        return;
+    }
+
+    m_trajectoryPlaying = it->second;
+    m_trajectoryOwner = msg.srcPid;
+    m_trajectorySegment = -1;
+    sendTrajectoryStatus(msg.srcPid, msg.msgCounter, msg.trajectoryId,
+            TRAJECTORY_STATE_PLAYING, it->second.get());
+}
+
+void EitOsMsgServerReceiver::abortTrajectory()
+{
+    if (nullptr == m_trajectoryPlaying) {
+        return;
+    }
+
+    if (nullptr != m_trajectoryPlayer) {
+        m_trajectoryPlayer->abort();
+    }
+
+    if (m_trajectoryOwner != -1) {
+        sendTrajectoryStatus(m_trajectoryOwner, PUBLISHED_MSG_COUNTER,
+                m_trajectoryPlaying->getId(), TRAJECTORY_STATE_ABORTED,
+                m_trajectoryPlaying.get(), std::max(0, m_trajectorySegment));
+    }
+
+    m_trajectoryPlaying.reset();
+    m_trajectoryOwner = -1;
+    m_trajectorySegment = -1;
+}
+
+void EitOsMsgServerReceiver::onTrajectoryCycle(
+        const Trajectory &trajectory, const std::vector<double> &positions,
+        double time, int32_t segment, bool isDone)
+{
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+
+    // A cycle may still be under way when the trajectory is stopped
+    if (&trajectory != m_trajectoryPlaying.get()) {
+        return;
+    }
+
+    const std::vector<int32_t> &indices = trajectory.getIndices();
+    int32_t numJoints =
+            (int32_t)std::min(indices.size(), positions.size());
+    std::vector<float> values(numJoints);
+    for (int32_t j = 0; j < numJoints; j++) {
+        values[j] = (float)positions[j];
+    }
+
+    Errors maxError = NO_ERR;
+    int32_t jntIndex = 0;
+    if (NO_ERR != setTargetJointValues(
+            indices.data(), values.data(), numJoints, maxError, jntIndex)) {
+        LOG_FAILURE("Failed to set joint values of trajectory %d",
+                trajectory.getId());
+    }
+
+    GuiStatusMessage_t status;
+    std::map<int32_t, Collision> collisions;
+    if (NO_ERR != m_kinematics->executeForwardKinematics(status, collisions))
+    {
+        LOG_WARNING("Failed to execute forward kinematics");
+    }
+
+    if (status.faultLevel > FaultLevels::FAULT_LEVEL_NOFAULT) {
+        m_gui->setStatusMessage(status);
+    }
+
+    sendCollision(collisions);
+    publishState(status);
+
+    // Progress is reported once per segment rather than every cycle
+    if (isDone || segment != m_trajectorySegment) {
+        m_trajectorySegment = segment;
+        sendTrajectoryStatus(m_trajectoryOwner, PUBLISHED_MSG_COUNTER,
+                trajectory.getId(),
+                isDone ? TRAJECTORY_STATE_DONE : TRAJECTORY_STATE_PLAYING,
+                &trajectory, segment, time);
+    }
+
+    if (isDone) {
+        m_trajectoryPlaying.reset();
+        m_trajectoryOwner = -1;
+        m_trajectorySegment = -1;
+    }
+}
+
+void EitOsMsgServerReceiver::sendTrajectoryStatus(
+        int32_t userPid, int32_t msgCounter, int32_t trajectoryId,
+        TrajectoryStates state, const Trajectory *trajectory,
+        int32_t segment, double time)
+{
+    EitOsMsgServerSender *sendUserReply = getUserConnection(userPid);
+    if (sendUserReply == nullptr) {
+        return;
+    }
+
+    TrajectoryStatus_t out;
+    out.msgCounter = msgCounter;
+    out.trajectoryId = trajectoryId;
+    out.state = state;
+    out.segment = segment;
+    out.time = (float)time;
+    if (nullptr != trajectory) {
+        out.numSegments = trajectory->getNumSegments();
+        out.duration = (float)trajectory->getDuration();
+    }
+
+    if (NO_ERR != sendUserReply->sendTrajectoryStatus(out)) {
+        LOG_FAILURE("Failed to send trajectory status to process %d",
+                (int)userPid);
     }
 }
 
@@ -395,47 +1155,178 @@ void EitOsMsgServerReceiver::updateRobotJointPositions(
 {
     Errors maxError = NO_ERR;
     int32_t jntIndex = 0;
-    for (int32_t i = 0; i < pos.numJoints; i++) {
-        Node* node = m_cp->getNodeOfMate((int)pos.indices[i]);
+    if (NO_ERR != setTargetJointValues(pos.indices, pos.positions,
+            std::min(pos.numJoints, MAX_JOINTS), maxError, jntIndex)) {
+        return;
+    }
+
+    sendJointError(sendUserReply, pos.msgCounter, maxError, jntIndex);
+}
+
+void EitOsMsgServerReceiver::updateRobotJointPositions(
+        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+        const std::vector<int32_t> &indices,
+        const std::vector<float> &positions)
+{
+    Errors maxError = NO_ERR;
+    int32_t jntIndex = 0;
+    if (NO_ERR != setTargetJointValues(indices.data(), positions.data(),
+            (int32_t)indices.size(), maxError, jntIndex)) {
+        return;
+    }
 
-        if (nullptr == node) {
-            LOG_FAILURE("Invalid joint index %d was received", pos.indices[i]);
-            return;
+    sendJointError(sendUserReply, msgCounter, maxError, jntIndex);
+}
+
+bool EitOsMsgServerReceiver::assemblePayload(
+        const GenericData_t &inComingData, int32_t &payloadId,
+        std::vector<uint8_t> &payload)
+{
+    FramedMessage_t in;
+    std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+    payloadId = in.payloadId;
+    return m_assembler.add(in, payload);
+}
+
+void EitOsMsgServerReceiver::processPayload(
+        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+        int32_t payloadId, const std::vector<uint8_t> &payload)
+{
+    switch (payloadId)
+    {
+        case ROBOT_JOINT_POSITIONS:
+        {
+            std::vector<int32_t> indices;
+            std::vector<float> positions;
+            if (!readJointPositions(payload, indices, positions)) {
+                LOG_FAILURE("Invalid joint positions payload of %d bytes",
+                        (int)payload.size());
+                break;
+            }
+            updateRobotJointPositions(
+                    sendUserReply, msgCounter, indices, positions);
         }
+        break;
 
-        Errors error = node->setTargetJointValue(pos.positions[i]);
+        default:
+            LOG_WARNING("Framed message %d is not supported", (int)payloadId);
+            break;
+    }
+}
 
-        if (error > maxError) {
-            maxError = error;
-            jntIndex = pos.indices[i];
+bool EitOsMsgServerReceiver::readJointPositions(
+        const std::vector<uint8_t> &payload,
+        std::vector<int32_t> &indices, std::vector<float> &positions)
+{
+    MessageReader reader(payload);
+    int32_t numJoints = 0;
+    return reader.read(numJoints) && numJoints >= 0 &&
+            reader.read(indices, (size_t)numJoints) &&
+            reader.read(positions, (size_t)numJoints);
+}
+
+void EitOsMsgServerReceiver::conflateSetpoints(
+        const GenericData_t &inComingData, ConflatedSetpoints_t &setpoints)
+{
+    if (ROBOT_JOINT_POSITIONS == inComingData.simpleMsg.msgId) {
+        JointPositions_t in;
+        std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+        conflateSetpoints(in.srcPid, in.msgCounter, in.indices, in.positions,
+                std::min(in.numJoints, MAX_JOINTS), setpoints);
+    } else {
+        JointPosition_t in;
+        std::memcpy(&in, &inComingData.blobOfData, sizeof(in));
+        conflateSetpoints(in.srcPid, in.msgCounter, &in.index, &in.position,
+                1, setpoints);
+    }
+}
+
+void EitOsMsgServerReceiver::conflateSetpoints(
+        int32_t userPid, int32_t msgCounter, const int32_t* indices,
+        const float* positions, int32_t numJoints,
+        ConflatedSetpoints_t &setpoints)
+{
+    std::set<int32_t> &joints = setpoints.joints[userPid];
+    for (int32_t i = 0; i < numJoints; i++) {
+        setpoints.positions[indices[i]] = positions[i];
+        joints.insert(indices[i]);
+    }
+
+    setpoints.msgCounters[userPid] = msgCounter;
+    setpoints.numMessages++;
+}
+
+void EitOsMsgServerReceiver::applySetpoints(ConflatedSetpoints_t &setpoints)
+{
+    if (0 == setpoints.numMessages) {
+        return;
+    }
+    MetricsRegistry::getInstance()->add(
+            METRIC_CONFLATED_SETPOINTS, setpoints.numMessages - 1);
+
+    // Every joint moves once, straight to its newest setpoint
+    std::map<int32_t, Errors> errors; // by joint index
+    for (const auto &pair: setpoints.positions) {
+        Node* node = m_cp->getNodeOfMate((int)pair.first);
+        if (nullptr == node) {
+            LOG_FAILURE("Invalid joint index %d was received", pair.first);
+            errors[pair.first] = ERR_INVALID;
+            continue;
         }
+        errors[pair.first] = node->setTargetJointValue(pair.second);
     }
 
-    // Send error back
-    if (sendUserReply != nullptr)
-    {
-        ErrorMessage_t out;
-        out.errorId = (int32_t)maxError;
-        out.msgCounter = pos.msgCounter;
-        memset(out.errorMsg, ' ', sizeof(char) * LOG_MAX_DATA_SIZE);
-        std::string message = "No faults";
-        if (ERR_JOINT_POSITION_LIMIT == maxError) {
-            message = "Fault: Position limit for joint #" + std::to_string(jntIndex);
-        } else if (ERR_JOINT_VELOCITY_LIMIT == maxError) {
-            message = "Fault: Velocity limit for joint #" + std::to_string(jntIndex);
-        } else if (ERR_JOINT_ACCELERATION_LIMIT == maxError) {
-            message = "Fault: Acceleration limit for joint #" + std::to_string(jntIndex);
+    // Each client hears back once, for its newest setpoint and about the
+    // joints it set only
+    for (const auto &pair: setpoints.msgCounters) {
+        Errors maxError = NO_ERR;
+        int32_t jntIndex = 0;
+        for (int32_t index: setpoints.joints[pair.first]) {
+            if (errors[index] > maxError) {
+                maxError = errors[index];
+                jntIndex = index;
+            }
         }
-        auto copy_len = std::min((int)message.size(), LOG_MAX_DATA_SIZE - 1);
-        out.errorMsg[copy_len] = 0;
-        out.errorMsg[LOG_MAX_DATA_SIZE - 1] = 0;
-        out.msgLength = copy_len;
-        std::copy(
-                message.begin(),
-                message.begin() + copy_len,
-                out.errorMsg);
-        sendUserReply->sendErrorMessage(out);
+
+        m_msgCounter = pair.second;
+        sendJointError(getUserConnection(pair.first), pair.second,
+                maxError, jntIndex);
     }
+
+    setpoints = ConflatedSetpoints_t();
+}
+
+void EitOsMsgServerReceiver::sendJointError(
+        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+        Errors error, int32_t jntIndex)
+{
+    if (sendUserReply == nullptr)
+    {
+        return;
+    }
+
+    std::string message = "No faults";
+    if (ERR_JOINT_POSITION_LIMIT == error) {
+        message = "Fault: Position limit for joint #" + std::to_string(jntIndex);
+    } else if (ERR_JOINT_VELOCITY_LIMIT == error) {
+        message = "Fault: Velocity limit for joint #" + std::to_string(jntIndex);
+    } else if (ERR_JOINT_ACCELERATION_LIMIT == error) {
+        message = "Fault: Acceleration limit for joint #" + std::to_string(jntIndex);
+    }
+
+    sendUserReply->sendInPlace<ErrorMessage_t>(FAULT_MESSAGE, msgCounter,
+            [error, &message](ErrorMessage_t &out) {
+                out.errorId = (int32_t)error;
+                auto copy_len =
+                        std::min((int)message.size(), LOG_MAX_DATA_SIZE - 1);
+                std::copy(
+                        message.begin(),
+                        message.begin() + copy_len,
+                        out.errorMsg);
+                out.errorMsg[copy_len] = 0;
+                out.errorMsg[LOG_MAX_DATA_SIZE - 1] = 0;
+                out.msgLength = copy_len;
+            });
 }
 
 
@@ -452,31 +1343,7 @@ void EitOsMsgServerReceiver::updateRobotJointPosition(
     Errors error = node->setTargetJointValue(pos.position);
     m_msgCounter = pos.msgCounter;
 
-    // Send error back
-    if (sendUserReply != nullptr)
-    {
-        ErrorMessage_t out;
-        out.errorId = (int32_t)error;
-        out.msgCounter = pos.msgCounter;
-        memset(out.errorMsg, ' ', sizeof(char) * LOG_MAX_DATA_SIZE);
-        std::string message = "No faults";
-        if (ERR_JOINT_POSITION_LIMIT == error) {
-            message = "Fault: Position limit for joint #" + std::to_string(pos.index);
-        } else if (ERR_JOINT_VELOCITY_LIMIT == error) {
-            message = "Fault: Velocity limit for joint #" + std::to_string(pos.index);
-        } else if (ERR_JOINT_ACCELERATION_LIMIT == error) {
-            message = "Fault: Acceleration limit for joint #" + std::to_string(pos.index);
-        }
-        auto copy_len = std::min((int)message.size(), LOG_MAX_DATA_SIZE - 1);
-        out.errorMsg[copy_len] = 0;
-        out.errorMsg[LOG_MAX_DATA_SIZE - 1] = 0;
-        out.msgLength = copy_len;
-        std::copy(
-                message.begin(),
-                message.begin() + copy_len,
-                out.errorMsg);
-        sendUserReply->sendErrorMessage(out);
-    }
+    sendJointError(sendUserReply, pos.msgCounter, error, pos.index);
 }
 
 Errors EitOsMsgServerReceiver::sendIncrementalCommand(int32_t incCmd)
@@ -484,7 +1351,9 @@ Errors EitOsMsgServerReceiver::sendIncrementalCommand(int32_t incCmd)
     IncrementalCommandMessage_t msg;
     msg.incCmd = incCmd;
     msg.type = INC_CMD_TYPE_CARTESIAN;
-    for (auto pair: m_listofUsers) {
+    // Sent from the GUI thread, clients come and go with messages
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    for (auto &pair: m_listofUsers) {
         if (NO_ERR != pair.second->sendIncrementalCommand(msg)) {
             LOG_FAILURE("Failed to send incremental command to process %d", (int)pair.first);
             return ERR_INVALID;
@@ -497,7 +1366,8 @@ Errors EitOsMsgServerReceiver::sendSpeed(float speed)
 {
     SpeedMessage_t msg;
     msg.speed = speed;
-    for (auto pair: m_listofUsers) {
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    for (auto &pair: m_listofUsers) {
         if (NO_ERR != pair.second->sendSpeed(msg)) {
             LOG_FAILURE("Failed to send speed rate to process %d", (int)pair.first);
             return ERR_INVALID;
@@ -513,7 +1383,8 @@ Errors EitOsMsgServerReceiver::sendJointIncrementalCommand(
     msg.incCmd = incCmd;
     msg.type = INC_CMD_TYPE_JOINT;
     msg.index = jntIndex;
-    for (auto pair: m_listofUsers) {
+    std::unique_lock<std::mutex> lock(m_mutexMessages);
+    for (auto &pair: m_listofUsers) {
         if (NO_ERR != pair.second->sendIncrementalCommand(msg)) {
             LOG_FAILURE("Failed to send incremental command to process %d", (int)pair.first);
             return ERR_INVALID;
@@ -523,23 +1394,28 @@ Errors EitOsMsgServerReceiver::sendJointIncrementalCommand(
 }
 
 Errors EitOsMsgServerReceiver::sendCollision(
-        const std::map<int32_t, Collision> &collisions)
+        const std::map<int32_t, Collision> &collisions, int32_t excludedPid)
 {
-    CollisionMessage_t msg;
-    int32_t numCollisions = std::min(MAX_COLLISIONS, (int32_t)collisions.size());
-    msg.numCollisions = numCollisions;
-
-    int index = 0;
-    for (auto pair: collisions) {
-        memcpy(&msg.collisions[index], &pair.second, sizeof(pair.second));
-        index++;
-        if (index == MAX_COLLISIONS) {
-            break;
+    // Only the links in collision are sent, each with only its collisions
+    MessageWriter msg(COLLISION);
+    msg.write((int32_t)collisions.size());
+    for (const auto &pair: collisions) {
+        int32_t numCollisions = std::max(0,
+                std::min(pair.second.numCollisions, MAX_COLLISIONS));
+        msg.write(pair.second.robotLink);
+        msg.write(numCollisions);
+        msg.write(pair.second.rigidBody, numCollisions);
+        for (int32_t j = 0; j < numCollisions; j++) {
+            msg.write((uint8_t)pair.second.isSelfCollision[j]);
         }
     }
 
-    for (auto pair: m_listofUsers) {
-        if (NO_ERR != pair.second->sendCollisions(msg)) {
+    for (auto &pair: m_listofUsers) {
+        if (pair.first == excludedPid) {
+            continue;
+        }
+
+        if (NO_ERR != pair.second->sendFramed(msg)) {
             LOG_FAILURE("Failed to send collision to process %d", (int)pair.first);
             return ERR_INVALID;
         }
@@ -547,14 +1423,17 @@ Errors EitOsMsgServerReceiver::sendCollision(
     return NO_ERR;
 }
 
-void EitOsMsgServerReceiver::installTool(RequestInstallTool_t &msg)
+void EitOsMsgServerReceiver::installTool(
+        EitOsMsgServerSender * /*sendUserReply*/,
+        const RequestInstallTool_t &msg)
 {
     if (m_gui->removeTool()) {
         LOG_FAILURE("Failed to remove tool");
         return;
     }
 
-    std::string toolName = std::string(msg.toolName);
+    std::string toolName = std::string(msg.toolName,
+            strnlen(msg.toolName, MAX_STATUS_TEXT_SIZE));
     if (NO_ERR != m_cp->loadTool(toolName)) {
         LOG_FAILURE("Failed to load tool %s", toolName.c_str());
         return;
@@ -580,7 +1459,8 @@ void EitOsMsgServerReceiver::installTool(RequestInstallTool_t &msg)
     m_kinematics->incCounter();
 }
 
-void EitOsMsgServerReceiver::setEndEffector(SetEndEffector_t &msg)
+void EitOsMsgServerReceiver::setEndEffector(
+        EitOsMsgServerSender * /*sendUserReply*/, const SetEndEffector_t &msg)
 {
   if (NO_ERR != m_kinematics->setEndEffector(msg.robotLink, msg.linkFrame)) {
       LOG_FAILURE("Failed to install tool in kinematics");
@@ -599,6 +1479,7 @@ void EitOsMsgServerReceiver::setEndEffector(SetEndEffector_t &msg)
   }
 
   sendCollision(collisions);
+  publishState(in);
 
   m_kinematics->incCounter();
 }
@@ -23,15 +23,27 @@
 #define SRC_LIBS_ROBOTCONTROL_SERVER_H
 
 #include "eitOsMsgServerSender.h"
+#include "latencyRecorder.h"
+#include "messageDispatcher.h"
+#include "messageFraming.h"
 #include "msgQServer.h"
+#include "shmRingServer.h"
+#include "socketServer.h"
 #include "timerUtils.h"
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace tarsim {
 class Kinematics;
 class Gui;
 class ConfigParser;
 class Node;
+class Trajectory;
+class TrajectoryPlayer;
+class EitOsMsgQueryReceiver;
 
 class EitOsMsgServerReceiver : public MsgQServer
 {
@@ -45,29 +57,222 @@ public:
     Errors sendIncrementalCommand(int32_t incCmd);
     Errors sendSpeed(float speed);
     Errors sendJointIncrementalCommand(int32_t jntIndex, int32_t incCmd);
-    Errors sendCollision(const std::map<int32_t, Collision> &collisions);
+    Errors sendCollision(
+            const std::map<int32_t, Collision> &collisions,
+            int32_t excludedPid = -1);
 
 private:
 	virtual void onMessage(const GenericData_t &inComingData) override;
+	virtual void onMessages(
+	        const std::vector<GenericData_t> &inComingData) override;
+	void onSharedMemoryMessage(const GenericData_t &inComingData);
+	void onSocketMessages(
+	        int32_t connectionId, std::vector<GenericData_t> &inComingData);
+	void onSocketClosed(int32_t connectionId);
+	void processMessage(const GenericData_t &inComingData);
+
+	// Records the transport of a message and its wait for a handler
+	void recordReceived(const GenericData_t &inComingData, int64_t startNs);
+
+	// Processes messages received at once, with m_mutexMessages held
+	void processMessages(const std::vector<GenericData_t> &inComingData);
+	void addHandlers();
+
+	// Handlers of the messages without a function of their own
+	void disconnectClient(
+	        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg);
+	void onTimerEvent(
+	        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg);
+	void processFramed(
+	        EitOsMsgServerSender *sendUserReply,
+	        const GenericData_t &inComingData);
+	void processQuery(
+	        EitOsMsgServerSender *sendUserReply,
+	        const GenericData_t &inComingData);
+	void setBaseFrame(
+	        EitOsMsgServerSender *sendUserReply, const Frame_t &msg);
+	void setCamera(EitOsMsgServerSender *sendUserReply, const Camera_t &msg);
+	void lockObjectToRigidBody(
+	        EitOsMsgServerSender *sendUserReply,
+	        const LockObjectToRigidBody_t &msg);
+	void unlockObjectFromRigidBody(
+	        EitOsMsgServerSender *sendUserReply,
+	        const UnlockObjectFromRigidBody_t &msg);
+	void executeForwardKinematics(
+	        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg);
+	void setObjectFrame(
+	        EitOsMsgServerSender *sendUserReply, const Frame_t &msg);
+	void startRecord(
+	        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg);
+	void stopRecord(
+	        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg);
+	void setGuiStatus(
+	        EitOsMsgServerSender *sendUserReply, const GuiStatusMessage_t &msg);
+	void shutdown(
+	        EitOsMsgServerSender *sendUserReply, const SimpleMsg_t &msg);
+	void sendLatencyStatistics(
+	        EitOsMsgServerSender *sendUserReply,
+	        const RequestLatencyStats_t &msg);
+	void sendStatistics(
+	        EitOsMsgServerSender *sendUserReply,
+	        const RequestStatistics_t &msg);
+	void commandTrace(
+	        EitOsMsgServerSender *sendUserReply, const TraceCommand_t &msg);
+
+	// Executes forward kinematics for a message, and records how long it
+	// and its collision detection took
+	Errors executeForwardKinematics(
+	        int32_t msgId, GuiStatusMessage_t &status,
+	        std::map<int32_t, Collision> &collisions);
+
+	// Adds a fragment, true once its payload is complete
+	bool assemblePayload(
+	        const GenericData_t &inComingData, int32_t &payloadId,
+	        std::vector<uint8_t> &payload);
+	void processPayload(
+	        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+	        int32_t payloadId, const std::vector<uint8_t> &payload);
+	bool readJointPositions(
+	        const std::vector<uint8_t> &payload,
+	        std::vector<int32_t> &indices, std::vector<float> &positions);
+
+	void attachSharedMemory(
+	        EitOsMsgServerSender *sendUserReply,
+	        const SharedMemoryConnect_t &msg);
+	void detachSharedMemory(const int32_t userPid);
 
 	EitOsMsgServerSender *getUserConnection(const int32_t userPid);
 
+	Errors setTargetJointValues(
+	        const int32_t* indices, const float* positions, int32_t numJoints,
+	        Errors &maxError, int32_t &jntIndex);
+
+	void step(EitOsMsgServerSender *sendUserReply, const Step_t &msg);
+
 	void updateRobotJointPositions(
 	        EitOsMsgServerSender *sendUserReply, const JointPositions_t& pos);
+	void updateRobotJointPositions(
+	        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+	        const std::vector<int32_t> &indices,
+	        const std::vector<float> &positions);
+
+	// Setpoints received in one drain of the queue, only the newest of
+	// every joint is applied
+	struct ConflatedSetpoints_t
+	{
+	    std::map<int32_t, float> positions; // by joint index
+	    std::map<int32_t, int32_t> msgCounters; // newest message of each client
+	    std::map<int32_t, std::set<int32_t>> joints; // joints each client set
+	    int32_t numMessages = 0;
+	};
+
+	void conflateSetpoints(
+	        const GenericData_t &inComingData, ConflatedSetpoints_t &setpoints);
+	void conflateSetpoints(
+	        int32_t userPid, int32_t msgCounter, const int32_t* indices,
+	        const float* positions, int32_t numJoints,
+	        ConflatedSetpoints_t &setpoints);
+	void applySetpoints(ConflatedSetpoints_t &setpoints);
+
+	void sendJointError(
+	        EitOsMsgServerSender *sendUserReply, int32_t msgCounter,
+	        Errors error, int32_t jntIndex);
 
 	void updateRobotJointPosition(
 	            EitOsMsgServerSender *sendUserReply, const JointPosition_t& pos);
 
-  void installTool(RequestInstallTool_t &msg);
-  void setEndEffector(SetEndEffector_t &msg);
+	void installTool(
+	        EitOsMsgServerSender *sendUserReply,
+	        const RequestInstallTool_t &msg);
+	void setEndEffector(
+	        EitOsMsgServerSender *sendUserReply, const SetEndEffector_t &msg);
+
+	void getJointValues(JointPositions_t &msg);
+	void getEndEffectorFrame(Frame_t &msg);
+
+	void subscribe(
+	        EitOsMsgServerSender *sendUserReply, const Subscribe_t &msg);
+
+	void uploadTrajectory(
+	        EitOsMsgServerSender *sendUserReply, const TrajectoryChunk_t &msg);
+	void commandTrajectory(
+	        EitOsMsgServerSender *sendUserReply, const TrajectoryCommand_t &msg);
+	void abortTrajectory();
+
+	// Runs on the trajectory player thread every control cycle
+	void onTrajectoryCycle(
+	        const Trajectory &trajectory, const std::vector<double> &positions,
+	        double time, int32_t segment, bool isDone);
+
+	void sendTrajectoryStatus(
+	        int32_t userPid, int32_t msgCounter, int32_t trajectoryId,
+	        TrajectoryStates state, const Trajectory *trajectory = nullptr,
+	        int32_t segment = 0, double time = 0.0);
+
+	// Pushes the subscribed state to clients after a kinematics cycle
+	void publishState(const GuiStatusMessage_t &status);
+
+	struct Subscription_t
+	{
+	    uint32_t topics = 0;
+	    int32_t decimation = 1;
+	    int32_t selectionId = 0;
+	    int32_t cycles = 0;
+	};
 
 	TimerUtils *m_runTimer = nullptr;
 	Kinematics* m_kinematics = nullptr;
 	Gui* m_gui = nullptr;
 	ConfigParser* m_cp = nullptr;
 	int32_t m_msgCounter = 0;
-	std::map <int32_t , EitOsMsgServerSender *> m_listofUsers;//list of participants,
+	std::map <int32_t , std::unique_ptr<EitOsMsgServerSender>> m_listofUsers;//list of participants,
 	unsigned int m_msgPriority = 0;
+	int m_policy = DEFAULT_RT_THREAD_POLICY;
+	int m_priority = DEFAULT_RT_THREAD_PRIORITY;
+
+	// Handler of each message id, called with a view into the receive buffer
+	MessageDispatcher<EitOsMsgServerReceiver, EitOsMsgServerSender*>
+	        m_dispatcher;
+
+	// Serializes messages of the message queue and shared memory threads
+	std::mutex m_mutexMessages;
+
+	// Framed payloads being received, by client and message
+	MessageAssembler m_assembler;
+
+	// Latency of the messages of every lane, by message id and stage
+	LatencyRecorder m_latency;
+
+	// Shared memory ring consumers, only touched by the message queue thread
+	std::map<int32_t, ShmRingServer*> m_shmRingServers;
+
+	// Connections of socket clients, all served by one thread
+	SocketServer *m_socketServer = nullptr;
+
+	// Best-effort lane answering queries, it owns the frame selections
+	EitOsMsgQueryReceiver *m_queryReceiver = nullptr;
+
+	// State subscriptions of each client
+	std::map<int32_t, Subscription_t> m_subscriptions;
+
+	struct TrajectoryUpload_t
+	{
+	    std::shared_ptr<Trajectory> trajectory;
+	    int32_t nextChunk = 0;
+	    int32_t numChunks = 0;
+	};
+
+	// Trajectories being uploaded, and uploaded ones ready to play, by client
+	std::map<int32_t, TrajectoryUpload_t> m_trajectoryUploads;
+	std::map<int32_t, std::shared_ptr<Trajectory>> m_trajectories;
+
+	// Plays trajectories back at the control cycle
+	TrajectoryPlayer *m_trajectoryPlayer = nullptr;
+
+	// Trajectory playing, the client that started it and its last segment
+	std::shared_ptr<const Trajectory> m_trajectoryPlaying;
+	int32_t m_trajectoryOwner = -1;
+	int32_t m_trajectorySegment = -1;
 };
 } // end of namespace tarsim
 #endif /* SRC_LIBS_ROBOTCONTROL_SERVER_H */
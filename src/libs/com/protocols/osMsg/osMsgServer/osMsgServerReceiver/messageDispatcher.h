@@ -0,0 +1,116 @@
+/**
+ *
+ * @file: messageDispatcher.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Table of message handlers indexed by message id. Handlers get a
+ * typed view into the receive buffer instead of a copy of the message.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_MESSAGE_DISPATCHER_H
+#define SRC_LIBS_MESSAGE_DISPATCHER_H
+
+//INCLUDES
+#include <array>
+#include <type_traits>
+#include "ipcMessages.h"
+#include "simulatorMessages.h"
+
+namespace tarsim {
+/**
+ * Views a received message as its type, without copying it. Whether the
+ * type fits the receive buffer is checked at compile time.
+ * @param data The receive buffer
+ * @return The message
+ */
+template<typename T>
+const T& messageView(const GenericData_t &data)
+{
+    static_assert(std::is_base_of<MessageHeader_t, T>::value,
+            "Messages start with a MessageHeader_t");
+    static_assert(std::is_trivially_copyable<T>::value,
+            "Messages are plain data");
+    static_assert(sizeof(T) <= sizeof(GenericData_t),
+            "Message does not fit the receive buffer");
+    static_assert(alignof(T) <= alignof(GenericData_t),
+            "Message is not aligned in the receive buffer");
+    return *reinterpret_cast<const T*>(&data);
+}
+
+/**
+ * Dispatches messages to member functions of Owner, one per message id.
+ * Handlers are called as (owner.*handler)(context, message).
+ */
+template<typename Owner, typename Context>
+class MessageDispatcher
+{
+public:
+    /**
+     * Registers the handler of a message, replacing the previous one
+     * @param T Type of the message, or GenericData_t for the raw buffer
+     * @param Handler Member function of Owner handling it
+     * @param msgId Message id
+     */
+    template<typename T, void (Owner::*Handler)(Context, const T&)>
+    void add(int32_t msgId)
+    {
+        if (msgId >= 0 && msgId < SIM_LAST_MSG) {
+            m_handlers[msgId] = &invoke<T, Handler>;
+        }
+    }
+
+    /**
+     * Calls the handler of a message
+     * @return false if the message has no handler
+     */
+    bool dispatch(
+            Owner &owner, Context context, const GenericData_t &data) const
+    {
+        int32_t msgId = data.simpleMsg.msgId;
+        if (msgId < 0 || msgId >= SIM_LAST_MSG ||
+            nullptr == m_handlers[msgId]) {
+            return false;
+        }
+        m_handlers[msgId](owner, context, data);
+        return true;
+    }
+
+private:
+    typedef void (*Invoker)(Owner&, Context, const GenericData_t&);
+
+    template<typename T>
+    static const T& view(const GenericData_t &data, std::true_type)
+    {
+        return data;
+    }
+
+    template<typename T>
+    static const T& view(const GenericData_t &data, std::false_type)
+    {
+        return messageView<T>(data);
+    }
+
+    template<typename T, void (Owner::*Handler)(Context, const T&)>
+    static void invoke(Owner &owner, Context context, const GenericData_t &data)
+    {
+        (owner.*Handler)(context, view<T>(data,
+                std::is_same<T, GenericData_t>()));
+    }
+
+    std::array<Invoker, SIM_LAST_MSG> m_handlers {};
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_MESSAGE_DISPATCHER_H */
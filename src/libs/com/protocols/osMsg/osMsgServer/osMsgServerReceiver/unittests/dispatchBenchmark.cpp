@@ -0,0 +1,301 @@
+/**
+ *
+ * @file: dispatchBenchmark.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Measures the per-message overhead of the server dispatch: a switch
+ * copying each message out of the receive buffer, against the handler table
+ * with views into it. Also times building a frame reply aside and copying it
+ * to its outbound slot, against building it in place.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <Eigen/Dense>
+#include "messageDispatcher.h"
+
+using namespace tarsim;
+
+namespace {
+static const int NUM_MESSAGES = 64; // messages in one round
+static const int DEFAULT_NUM_ROUNDS = 200000;
+
+typedef Eigen::Matrix<float, 4, 4, Eigen::RowMajor> FrameMatrix_t;
+
+/**
+ * Stands for the server receiver, its handlers only touch the messages
+ */
+class Receiver
+{
+public:
+    // Message handling as it was, a switch copying every message out
+    void processMessage(int context, const GenericData_t &inComingData)
+    {
+        switch (inComingData.simpleMsg.msgId)
+        {
+            case ROBOT_JOINT_POSITIONS:
+            {
+                JointPositions_t in;
+                std::memcpy(static_cast<void*>(&in), &inComingData.blobOfData,
+                        sizeof(in));
+                updateJointPositions(context, in);
+            }
+            break;
+
+            case ROBOT_JOINT_POSITION:
+            {
+                JointPosition_t in;
+                std::memcpy(static_cast<void*>(&in), &inComingData.blobOfData,
+                        sizeof(in));
+                updateJointPosition(context, in);
+            }
+            break;
+
+            case OBJECT_FRAME:
+            {
+                Frame_t in;
+                std::memcpy(static_cast<void*>(&in), &inComingData.blobOfData,
+                        sizeof(in));
+                setObjectFrame(context, in);
+            }
+            break;
+
+            case CAMERA_DATA:
+            {
+                Camera_t in;
+                std::memcpy(static_cast<void*>(&in), &inComingData.blobOfData,
+                        sizeof(in));
+                setCamera(context, in);
+            }
+            break;
+
+            case STEP:
+            {
+                Step_t in;
+                std::memcpy(static_cast<void*>(&in), &inComingData.blobOfData,
+                        sizeof(in));
+                step(context, in);
+            }
+            break;
+
+            case SUBSCRIBE:
+            {
+                Subscribe_t in;
+                std::memcpy(static_cast<void*>(&in), &inComingData.blobOfData,
+                        sizeof(in));
+                subscribe(context, in);
+            }
+            break;
+
+            default:
+                break;
+        }
+    }
+
+    void addHandlers(MessageDispatcher<Receiver, int> &dispatcher)
+    {
+        dispatcher.add<JointPositions_t, &Receiver::updateJointPositions>(
+                ROBOT_JOINT_POSITIONS);
+        dispatcher.add<JointPosition_t, &Receiver::updateJointPosition>(
+                ROBOT_JOINT_POSITION);
+        dispatcher.add<Frame_t, &Receiver::setObjectFrame>(OBJECT_FRAME);
+        dispatcher.add<Camera_t, &Receiver::setCamera>(CAMERA_DATA);
+        dispatcher.add<Step_t, &Receiver::step>(STEP);
+        dispatcher.add<Subscribe_t, &Receiver::subscribe>(SUBSCRIBE);
+    }
+
+    double m_sum = 0.0;
+
+private:
+    void updateJointPositions(int context, const JointPositions_t &msg)
+    {
+        for (int32_t i = 0; i < msg.numJoints && i < MAX_JOINTS; i++) {
+            m_sum += msg.positions[i] + context;
+        }
+    }
+
+    void updateJointPosition(int context, const JointPosition_t &msg)
+    {
+        m_sum += msg.position + context;
+    }
+
+    void setObjectFrame(int context, const Frame_t &msg)
+    {
+        m_sum += msg.mij[3] + msg.mij[7] + msg.mij[11] + context;
+    }
+
+    void setCamera(int context, const Camera_t &msg)
+    {
+        m_sum += msg.position[0] + context;
+    }
+
+    void step(int context, const Step_t &msg)
+    {
+        for (int32_t i = 0; i < msg.numJoints && i < MAX_JOINTS; i++) {
+            m_sum += msg.positions[i] + context;
+        }
+    }
+
+    void subscribe(int context, const Subscribe_t &msg)
+    {
+        m_sum += msg.decimation + context;
+    }
+};
+
+std::vector<GenericData_t> makeMessages()
+{
+    const int32_t msgIds[] = {ROBOT_JOINT_POSITIONS, ROBOT_JOINT_POSITION,
+            OBJECT_FRAME, CAMERA_DATA, STEP, SUBSCRIBE};
+    std::vector<GenericData_t> messages(NUM_MESSAGES);
+    for (int k = 0; k < NUM_MESSAGES; k++) {
+        GenericData_t &data = messages[k];
+        std::memset(&data, 0, sizeof(data));
+        int32_t msgId = msgIds[k % (sizeof(msgIds) / sizeof(msgIds[0]))];
+        switch (msgId)
+        {
+            case ROBOT_JOINT_POSITIONS:
+            {
+                JointPositions_t* msg = new (&data) JointPositions_t();
+                msg->numJoints = 6;
+                for (int32_t i = 0; i < msg->numJoints; i++) {
+                    msg->indices[i] = i;
+                    msg->positions[i] = 0.01f * (k + i);
+                }
+            }
+            break;
+
+            case ROBOT_JOINT_POSITION:
+                new (&data) JointPosition_t();
+                break;
+
+            case OBJECT_FRAME:
+            {
+                Frame_t* msg = new (&data) Frame_t();
+                FrameMatrix_t::Map(msg->mij) = FrameMatrix_t::Identity();
+            }
+            break;
+
+            case CAMERA_DATA:
+                new (&data) Camera_t();
+                break;
+
+            case STEP:
+            {
+                Step_t* msg = new (&data) Step_t();
+                msg->numJoints = 6;
+                for (int32_t i = 0; i < msg->numJoints; i++) {
+                    msg->indices[i] = i;
+                    msg->positions[i] = 0.02f * (k + i);
+                }
+            }
+            break;
+
+            case SUBSCRIBE:
+                new (&data) Subscribe_t();
+                break;
+        }
+        data.simpleMsg.msgId = msgId;
+    }
+    return messages;
+}
+
+template<typename Function>
+double measureNs(int numRounds, int numPerRound, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < numRounds; round++) {
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+            ((double)numRounds * numPerRound);
+}
+} // end of anonymous namespace
+
+/**
+ * @brief runs both dispatches and both ways of building replies on the same
+ * messages and prints the time per message
+ * @param argc - number of arguments
+ * @param argv - number of rounds, optional
+ * @return EXIT_SUCCESS if both dispatches handled the messages the same way
+ */
+int main(int argc, char **argv)
+{
+    int numRounds = (argc > 1) ? std::atoi(argv[1]) : DEFAULT_NUM_ROUNDS;
+    if (numRounds <= 0) {
+        printf("Usage: %s [number of rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<GenericData_t> messages = makeMessages();
+
+    Receiver legacy;
+    double switchNs = measureNs(numRounds, NUM_MESSAGES, [&]() {
+        for (const GenericData_t &data: messages) {
+            legacy.processMessage(1, data);
+        }
+    });
+
+    Receiver table;
+    MessageDispatcher<Receiver, int> dispatcher;
+    table.addHandlers(dispatcher);
+    double tableNs = measureNs(numRounds, NUM_MESSAGES, [&]() {
+        for (const GenericData_t &data: messages) {
+            dispatcher.dispatch(table, 1, data);
+        }
+    });
+
+    // Replies: a frame built aside and copied to its slot, or built in it
+    Eigen::Matrix4d xfm = Eigen::Matrix4d::Random();
+    GenericData_t slot;
+    volatile float sink = 0.0f;
+    double asideNs = measureNs(numRounds, 1, [&]() {
+        Frame_t out;
+        out.msgId = OBJECT_FRAME;
+        out.frameId = 0;
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                out.mij[(i * 4) + j] = xfm(i, j);
+            }
+        }
+        std::memcpy(&slot, &out, sizeof(out));
+        sink = sink + reinterpret_cast<const Frame_t&>(slot).mij[5];
+    });
+    double inPlaceNs = measureNs(numRounds, 1, [&]() {
+        Frame_t* out = new (&slot) Frame_t();
+        out->msgId = OBJECT_FRAME;
+        out->frameId = 0;
+        FrameMatrix_t::Map(out->mij) = xfm.cast<float>();
+        sink = sink + out->mij[5];
+    });
+
+    printf("Dispatch, switch with copies: %8.2f ns/message\n", switchNs);
+    printf("Dispatch, table with views:   %8.2f ns/message\n", tableNs);
+    printf("Frame reply, built aside:     %8.2f ns/reply\n", asideNs);
+    printf("Frame reply, built in place:  %8.2f ns/reply\n", inPlaceNs);
+
+    if (legacy.m_sum != table.m_sum) {
+        printf("Failed: dispatches disagree (%f vs %f)\n",
+                legacy.m_sum, table.m_sum);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,9 @@
 #include "simulatorMessages.h"
 #include "serverDefs.h"
 #include "logClient.h"
+#include "metricsRegistry.h"
+#include <algorithm>
+#include <cstring>
 
 namespace tarsim {
 
@@ -32,9 +35,11 @@ namespace tarsim {
  */
 
 EitOsMsgServerSender::EitOsMsgServerSender(
-        std::string &mqName, unsigned int msgPriority):
+        std::string &mqName, unsigned int msgPriority,
+        OutboundPolicies policy):
     MsgQClient(mqName, msgPriority, msgPriority),
-    m_msgPriority(msgPriority)
+    m_msgPriority(msgPriority),
+    m_policy(policy)
 {
 }
 
@@ -43,7 +48,221 @@ EitOsMsgServerSender::EitOsMsgServerSender(
  */
 EitOsMsgServerSender::~EitOsMsgServerSender()
 {
+    // What is queued (e.g. the exit event) still goes out unless the client
+    // is stuck
+    stopSending(true);
 
+    delete m_shmRing;
+    m_shmRing = nullptr;
+}
+
+Errors EitOsMsgServerSender::attachSharedMemory(const std::string &ringName)
+{
+    ShmRing* ring = new ShmRing(ringName, false);
+    if (NO_ERR != ring->open()) {
+        LOG_FAILURE("Failed to attach to shared memory ring %s", ringName.c_str());
+        delete ring;
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    delete m_shmRing;
+    m_shmRing = ring;
+    return NO_ERR;
+}
+
+Errors EitOsMsgServerSender::attachSocket(
+        SocketServer* socketServer, int32_t connectionId)
+{
+    if (socketServer == nullptr) {
+        return ERR_INVALID;
+    }
+
+    m_socketServer = socketServer;
+    m_connectionId = connectionId;
+    return NO_ERR;
+}
+
+Errors EitOsMsgServerSender::send(void* send_data,
+        const size_t sendDataSize, unsigned int msgPriority)
+{
+    static_cast<MessageHeader_t*>(send_data)->sendTimeNs = getMonotonicTimeNs();
+    if (m_socketServer) {
+        return m_socketServer->send(m_connectionId, send_data, sendDataSize);
+    }
+
+    // Generic events (e.g. exit) are meant for the client message queue thread
+    const MessageHeader_t* header =
+            static_cast<const MessageHeader_t*>(send_data);
+    if (m_shmRing && header->msgId >= MSG_FIRST_APPLICATION) {
+        return m_shmRing->push(send_data, sendDataSize);
+    }
+
+    if (MsgQClient::isConnected() != NO_ERR) {
+        // A disconnected client is not connected again
+        {
+            std::unique_lock<std::mutex> lock(m_mutexOutbound);
+            if (m_isStopped) {
+                return ERR_MQ_FAILED_SEND;
+            }
+        }
+        if (connect() != NO_ERR) {
+            return ERR_MQ_FAILED_OPEN;
+        }
+    }
+    return enqueue(send_data, sendDataSize, msgPriority);
+}
+
+Errors EitOsMsgServerSender::enqueue(const void* send_data,
+        const size_t sendDataSize, unsigned int msgPriority)
+{
+    if (sendDataSize > sizeof(GenericData_t)) {
+        return ERR_INVALID;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexOutbound);
+        OutboundMessage_t* message = reserveOutbound(sendDataSize, msgPriority);
+        if (nullptr == message) {
+            return ERR_MQ_FAILED_SEND;
+        }
+        std::memcpy(&message->data, send_data, sendDataSize);
+    }
+    m_cvOutbound.notify_one();
+    return NO_ERR;
+}
+
+EitOsMsgServerSender::OutboundMessage_t* EitOsMsgServerSender::reserveOutbound(
+        const size_t sendDataSize, unsigned int msgPriority)
+{
+    // Replies racing a disconnect, e.g. GUI broadcasts, are dropped
+    if (m_isStopped) {
+        return nullptr;
+    }
+
+    if (!m_isSending) {
+        m_isSending = true;
+        m_thread = std::thread(&EitOsMsgServerSender::sending, this);
+    }
+
+    if (m_outbound.size() >= OUTBOUND_QUEUE_SIZE) {
+        m_statistics.numDropped++;
+        MetricsRegistry::getInstance()->add(METRIC_DROPPED_REPLIES);
+        if (1 == m_statistics.numDropped % 1000) {
+            LOG_WARNING("Client is not reading its queue, %d replies "
+                    "were dropped", (int)m_statistics.numDropped);
+        }
+
+        if (OUTBOUND_DROP_NEWEST == m_policy) {
+            return nullptr;
+        }
+        m_outbound.pop_front();
+    }
+
+    m_outbound.emplace_back();
+    OutboundMessage_t &message = m_outbound.back();
+    message.size = sendDataSize;
+    message.msgPriority = msgPriority;
+    message.sequence = m_sequence++;
+    m_statistics.numQueued++;
+    m_statistics.maxDepth = std::max(m_statistics.maxDepth, m_outbound.size());
+    return &message;
+}
+
+void EitOsMsgServerSender::sending()
+{
+    OutboundMessage_t message;
+    int flushedUs = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutexOutbound);
+            m_cvOutbound.wait(lock, [this]() {
+                return !m_outbound.empty() || !m_isSending; });
+            if (m_outbound.empty() || (!m_isSending && !m_shouldFlush)) {
+                return;
+            }
+            message = m_outbound.front();
+        }
+
+        // The message stays queued until sent, so a full client is retried
+        // and the policy can still overwrite it
+        bool isTimedOut = false;
+        Errors error = MsgQClient::send(&message.data, message.size,
+                message.msgPriority, OUTBOUND_SEND_TIMEOUT_US, isTimedOut);
+
+        std::unique_lock<std::mutex> lock(m_mutexOutbound);
+        if (isTimedOut) {
+            // Stopping takes one short wait at most, flushing a little longer
+            if (!m_isSending && (!m_shouldFlush ||
+                    (flushedUs += OUTBOUND_SEND_TIMEOUT_US) >=
+                            OUTBOUND_FLUSH_TIMEOUT_US)) {
+                return;
+            }
+            continue;
+        }
+
+        if (NO_ERR == error) {
+            m_statistics.numSent++;
+        } else {
+            m_statistics.numFailed++;
+        }
+
+        if (!m_outbound.empty() &&
+            m_outbound.front().sequence == message.sequence) {
+            m_outbound.pop_front();
+        }
+    }
+}
+
+void EitOsMsgServerSender::stopSending(bool shouldFlush)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexOutbound);
+        m_isSending = false;
+        m_isStopped = true;
+        m_shouldFlush = shouldFlush;
+    }
+    m_cvOutbound.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexOutbound);
+    m_outbound.clear();
+}
+
+Errors EitOsMsgServerSender::disconnect()
+{
+    stopSending(false);
+    if (m_socketServer) {
+        m_socketServer->close(m_connectionId);
+        m_socketServer = nullptr;
+        return NO_ERR;
+    }
+    return MsgQClient::disconnect();
+}
+
+OutboundStatistics_t EitOsMsgServerSender::getOutboundStatistics() const
+{
+    OutboundStatistics_t statistics;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexOutbound);
+        statistics = m_statistics;
+    }
+
+    // Replies to a socket client wait in the socket server instead
+    if (m_socketServer) {
+        statistics.numDropped += m_socketServer->getNumDropped(m_connectionId);
+    }
+    return statistics;
+}
+
+Errors EitOsMsgServerSender::isConnected() const
+{
+    if (m_shmRing || m_socketServer) {
+        return NO_ERR;
+    }
+    return MsgQClient::isConnected();
 }
 
 Errors EitOsMsgServerSender::sendEndEffectorFrame(Frame_t &msg)
@@ -231,9 +450,79 @@ Errors EitOsMsgServerSender::sendSpeed(SpeedMessage_t &msg)
     return NO_ERR;
 }
 
-Errors EitOsMsgServerSender::sendCollisions(CollisionMessage_t &msg)
+Errors EitOsMsgServerSender::sendFramed(const MessageWriter &writer)
+{
+    if (isConnected() != NO_ERR)
+    {
+        if (connect() != NO_ERR)
+        {
+            LOG_FAILURE ("Failed to connect to client");
+            return Errors::ERR_MQ_FAILED_OPEN;
+        }
+    }
+
+    //nothing significant for the receiver to know about the source
+    Errors error = writer.send(-1, m_framedCounter++,
+            [this](void* data, size_t size) {
+                return send(data, size, m_msgPriority); });
+    if (error != NO_ERR)
+    {
+        LOG_FAILURE ("Failed to send data to client");
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    return NO_ERR;
+}
+
+Errors EitOsMsgServerSender::sendFramesBatch(FramesBatch_t &msg)
+{
+    if (isConnected() != NO_ERR)
+    {
+        if (connect() != NO_ERR)
+        {
+            LOG_FAILURE ("Failed to connect to client");
+            return Errors::ERR_MQ_FAILED_OPEN;
+        }
+    }
+    msg.msgId = FRAMES_BATCH;
+    msg.srcPid = -1 ; //nothing significant for the receiver to know
+
+    // Frames are the last member, so the unused ones are not sent
+    size_t size = sizeof(msg) -
+            (MAX_FRAMES_PER_BATCH - msg.numFrames) * sizeof(msg.mij[0]);
+    if (send(&msg, size, m_msgPriority) != NO_ERR)
+    {
+        LOG_FAILURE ("Failed to send data to client");
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    return NO_ERR;
+}
+
+Errors EitOsMsgServerSender::sendStepResult(StepResult_t &msg)
+{
+    if (isConnected() != NO_ERR)
+    {
+        if (connect() != NO_ERR)
+        {
+            LOG_FAILURE ("Failed to connect to client");
+            return Errors::ERR_MQ_FAILED_OPEN;
+        }
+    }
+    msg.msgId = STEP_RESULT;
+    msg.srcPid = -1 ; //nothing significant for the receiver to know
+
+    if (send(&msg, sizeof(msg), m_msgPriority) != NO_ERR)
+    {
+        LOG_FAILURE ("Failed to send data to client");
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    return NO_ERR;
+}
+
+Errors EitOsMsgServerSender::sendTrajectoryStatus(TrajectoryStatus_t &msg)
 {
-    bool connected;
     if (isConnected() != NO_ERR)
     {
         if (connect() != NO_ERR)
@@ -242,7 +531,7 @@ Errors EitOsMsgServerSender::sendCollisions(CollisionMessage_t &msg)
             return Errors::ERR_MQ_FAILED_OPEN;
         }
     }
-    msg.msgId = COLLISION;
+    msg.msgId = TRAJECTORY_STATUS;
     msg.srcPid = -1 ; //nothing significant for the receiver to know
 
     if (send(&msg, sizeof(msg), m_msgPriority) != NO_ERR)
@@ -27,14 +27,46 @@
 #include "cstdarg"
 #include <string>
 #include <mutex>
+#include <new>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <atomic>
 #include "eitErrors.h"
+#include "messageFraming.h"
 #include "msgQClient.h"
+#include "shmRing.h"
+#include "socketServer.h"
 #include "simulatorMessages.h"
 #include "serverDefs.h"
 
 namespace tarsim {
 
 //const & defines
+static const size_t OUTBOUND_QUEUE_SIZE = 64; // replies waiting for a client
+static const int OUTBOUND_SEND_TIMEOUT_US = 2000; // one wait for a full client, then the sender thread checks it is still running
+static const int OUTBOUND_FLUSH_TIMEOUT_US = 100000; // how long a stopping sender keeps trying a full client
+
+/**
+ * What to do with a reply when the outbound queue of a client is full
+ */
+enum OutboundPolicies
+{
+    OUTBOUND_DROP_NEWEST,
+    OUTBOUND_OVERWRITE_OLDEST
+};
+
+/**
+ * Counters of the outbound queue of a client
+ */
+struct OutboundStatistics_t
+{
+    uint64_t numQueued = 0;
+    uint64_t numSent = 0;
+    uint64_t numDropped = 0;
+    uint64_t numFailed = 0;
+    size_t maxDepth = 0;
+};
 
 
 //Macros used for application 
@@ -53,18 +85,157 @@ public:
     Errors sendSimulatorStatus(SimulatorStatus_t &msg);
     Errors sendIncrementalCommand(IncrementalCommandMessage_t &msg);
     Errors sendSpeed(SpeedMessage_t &msg);
-    Errors sendCollisions(CollisionMessage_t &msg);
+    /**
+     * Sends a variable-length payload, in as many fragments as it needs.
+     * Pushed payloads get a counter of this client so fragments of different
+     * payloads never mix.
+     */
+    Errors sendFramed(const MessageWriter &writer);
+    Errors sendFramesBatch(FramesBatch_t &msg);
+    Errors sendStepResult(StepResult_t &msg);
+    Errors sendTrajectoryStatus(TrajectoryStatus_t &msg);
 
     virtual ~EitOsMsgServerSender();
+
+    /**
+     * Constructor. Replies over the message queue are queued and sent by a
+     * thread of this client, so a client that stops reading never blocks
+     * the caller.
+     * @param mqName Message queue of the client
+     * @param msgPriority Message priority
+     * @param policy What to drop when the outbound queue is full
+     */
     EitOsMsgServerSender(
-            std::string &mqName, unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+            std::string &mqName, unsigned int msgPriority = DEFAULT_MSG_PRIORITY,
+            OutboundPolicies policy = OUTBOUND_OVERWRITE_OLDEST);
+
+    /**
+     * Routes every reply but generic events to the client's shared memory
+     * ring instead of its message queue
+     * @param ringName Name of the server to client ring
+     */
+    Errors attachSharedMemory(const std::string &ringName);
+
+    /**
+     * Routes every reply, generic events included, to a socket connection of
+     * the client instead of its message queue. The socket server holds what
+     * the client does not read yet, so the sender thread is not used.
+     * @param socketServer Server the client is connected to
+     * @param connectionId Connection of the client
+     */
+    Errors attachSocket(SocketServer* socketServer, int32_t connectionId);
+
+    /**
+     * Sends a message after stamping its send time
+     */
+    Errors send(void* send_data, const size_t sendDataSize,
+            unsigned int msgPriority);
+
+    /**
+     * Builds a reply straight in its outbound slot instead of building it
+     * aside and copying it there
+     * @param msgId Message id of the reply
+     * @param msgCounter Counter of the request it answers
+     * @param build Fills in the body of the reply, it runs with the outbound
+     * queue locked so it should only copy
+     */
+    template<typename T, typename Builder>
+    Errors sendInPlace(int32_t msgId, int32_t msgCounter, Builder build);
+    Errors isConnected() const;
+
+    /**
+     * Stops the sender thread, dropping what it did not send, and closes the
+     * message queue
+     */
+    Errors disconnect();
+
+    OutboundStatistics_t getOutboundStatistics() const;
 
 
 protected:
 
 private:
+    struct OutboundMessage_t
+    {
+        GenericData_t data;
+        size_t size = 0;
+        unsigned int msgPriority = 0;
+        uint64_t sequence = 0;
+    };
+
+    Errors enqueue(const void* send_data, const size_t sendDataSize,
+            unsigned int msgPriority);
+
+    // Appends a message to the outbound queue, with m_mutexOutbound held.
+    // nullptr if the policy dropped it.
+    OutboundMessage_t* reserveOutbound(
+            const size_t sendDataSize, unsigned int msgPriority);
+    void sending();
+    void stopSending(bool shouldFlush);
+
     int32_t qPid = -1; //initialize process id of recevier to -1
     unsigned int m_msgPriority = 0;
+    ShmRing* m_shmRing = nullptr;
+    SocketServer* m_socketServer = nullptr;
+    int32_t m_connectionId = -1;
+    std::atomic<int32_t> m_framedCounter {0};
+
+    // Replies waiting for the client, sent by m_thread
+    OutboundPolicies m_policy = OUTBOUND_OVERWRITE_OLDEST;
+    mutable std::mutex m_mutexOutbound;
+    std::condition_variable m_cvOutbound;
+    std::deque<OutboundMessage_t> m_outbound;
+    OutboundStatistics_t m_statistics;
+    uint64_t m_sequence = 0;
+    bool m_isSending = false;
+    bool m_isStopped = false; // once stopped, m_thread is never started again
+    bool m_shouldFlush = false;
+    std::thread m_thread;
 };
+
+template<typename T, typename Builder>
+Errors EitOsMsgServerSender::sendInPlace(
+        int32_t msgId, int32_t msgCounter, Builder build)
+{
+    static_assert(sizeof(T) <= sizeof(GenericData_t),
+            "Reply does not fit a message");
+
+    // The ring and the socket copy what they are given, so the reply is
+    // built aside
+    if (m_shmRing || m_socketServer) {
+        T msg;
+        msg.msgId = msgId;
+        msg.srcPid = -1;
+        msg.msgCounter = msgCounter;
+        build(msg);
+        msg.sendTimeNs = getMonotonicTimeNs();
+        return m_socketServer ?
+                m_socketServer->send(m_connectionId, &msg, sizeof(msg)) :
+                m_shmRing->push(&msg, sizeof(msg));
+    }
+
+    if (MsgQClient::isConnected() != NO_ERR) {
+        if (connect() != NO_ERR) {
+            return ERR_MQ_FAILED_OPEN;
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexOutbound);
+        OutboundMessage_t* message = reserveOutbound(sizeof(T), m_msgPriority);
+        if (nullptr == message) {
+            return ERR_MQ_FAILED_SEND;
+        }
+
+        T* msg = new (&message->data) T();
+        msg->msgId = msgId;
+        msg->srcPid = -1; //nothing significant for the receiver to know
+        msg->msgCounter = msgCounter;
+        build(*msg);
+        msg->sendTimeNs = getMonotonicTimeNs();
+    }
+    m_cvOutbound.notify_one();
+    return NO_ERR;
+}
 } // end of namespace tarsim
 #endif /* SRC_LIBS_EitOsMsgServerSender_H */
@@ -496,6 +496,7 @@ Errors ConfigParser::loadTool(const std::string &toolName)
     // Generate a new child (node)
     delete m_tool;
     m_tool = new Object(obj, m_configFolderName);
+    m_toolName = toolName;
 
     return NO_ERR;
 }
@@ -52,6 +52,7 @@ public:
     std::string getConfigFolderName() {return m_configFolderName;}
     Errors loadTool(const std::string &toolName);
     Object* getTool() {return m_tool;}
+    std::string getToolName() {return m_toolName;}
 
     // MEMBERS
 private:
@@ -76,6 +77,7 @@ private:
     // MEMBERS
     RigidBodySystem* m_rbs = nullptr;
     Object* m_tool = nullptr;
+    std::string m_toolName = "";
     Window* m_win = nullptr;
     Node* m_root = nullptr;
     Node* m_endEffectorNode = nullptr;
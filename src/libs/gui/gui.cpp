@@ -39,8 +39,6 @@
 #include "vtkTexturedButtonRepresentation2D.h"
 #include "vtkImageData.h"
 #include "vtkInteractorStyleTrackballCamera.h"
-#include "vtkWindowToImageFilter.h"
-#include "vtkPNGWriter.h"
 #include "fileSystem.h"
 #include <chrono>
 #include <ctime>
@@ -48,6 +46,10 @@
 #include "win.pb.h"
 #include "eitOsMsgServerReceiver.h"
 #include "cmake_defs.h"
+#include "traceRecorder.h"
+#include "metricsRegistry.h"
+#include "frameRecorder.h"
+#include <vtkVersionMacros.h>
 
 
 namespace tarsim {
@@ -62,11 +64,24 @@ const std::string k_productName = "Tarsim";
  * Company name
  */
 const std::string k_companyName = "Kamran Shamaei";
+
+/**
+ * Longest an offscreen gui waits for the pose to change before it checks
+ * whether it is destroyed
+ */
+const int k_offScreenWaitMs = 100;
+
+/**
+ * Size of an offscreen window whose config has none
+ */
+const int k_offScreenDefaultSize[2] = {1280, 720};
 // ENUMS
 // NAMESPACES AND STRUCTS
 // CLASS DEFINITION
-Gui::Gui(ConfigParser* cp, Kinematics* kin)
+Gui::Gui(ConfigParser* cp, Kinematics* kin, bool isOffScreen)
 {
+    m_isOffScreen = isOffScreen;
+
     if (cp == nullptr) {
         throw std::invalid_argument("No config parser was received");
     }
@@ -86,6 +101,7 @@ Gui::Gui(ConfigParser* cp, Kinematics* kin)
         throw std::invalid_argument("No window config was provided");
     }
     m_win = cp->getWin();
+    m_isOffScreen = m_isOffScreen || m_win->is_offscreen();
 
     if (cp->getRbs() == nullptr) {
         throw std::invalid_argument("No rbs config was provided");
@@ -142,6 +158,9 @@ Gui::Gui(ConfigParser* cp, Kinematics* kin)
 
 Gui::~Gui()
 {
+    // Writes the frames still queued
+    m_recorder.reset();
+
     for (unsigned int i = 0; i < m_scenes.size(); i++) {
         delete m_scenes.at(i);
         m_scenes.at(i) = nullptr;
@@ -171,6 +190,7 @@ void Gui::destroy()
 
 void Gui::update()
 {
+    TRACE_SCOPE("Gui::update");
     int* size = m_renderWindow->GetSize();
     bool dimsChanged = false;
     if ((m_windowSize[0] != size[0]) || (m_windowSize[1] != size[1])) {
@@ -179,26 +199,37 @@ void Gui::update()
         dimsChanged = true;
     }
 
-    for (unsigned int i = 0; i < m_scenes.size(); i++) {
-        if (NO_ERR != m_scenes.at(i)->update(dimsChanged)) {
-            LOG_FAILURE("Failed to update the scene %d", i);
-            // TODO: Show as a widget
-        }
-    }
-
+    bool isCameraChanged = false;
     if (m_cameraQueue != nullptr) {
         if (m_cameraQueue->size() > 0) {
             Camera_t c = m_cameraQueue->pop();
             m_scenes[ROBOT]->updateCamera(
                     c.position, c.focalPoint, c.viewUp, c.clippingRange);
+            isCameraChanged = true;
         }
     }
 
-    if (getRecordRobotScene()) {
-        if (NO_ERR != record()) {
-            LOG_FAILURE("Failed to record");
+    findDirtyScenes(dimsChanged, isCameraChanged);
+    for (unsigned int i = 0; i < m_scenes.size(); i++) {
+        if (!m_dirtyScenes.at(i)) {
+            continue;
+        }
+
+        if (NO_ERR != m_scenes.at(i)->update(dimsChanged)) {
+            LOG_FAILURE("Failed to update the scene %d", i);
+            // TODO: Show as a widget
+        }
+    }
+
+    // Frames are read once rendered, see vtkUpdate and renderOnDemand
+    if (!getRecordRobotScene() && m_isRecordingSetup) {
+        if (m_isLoggingPoses) {
+            m_kin->stopPoseLog();
+            m_isLoggingPoses = false;
+        } else {
+            // The encoders finish the queued frames on their own
+            m_recorder->stop();
         }
-    } else {
         m_isRecordingSetup = false;
     }
 
@@ -217,10 +248,158 @@ void Gui::vtkUpdate(
     }
 
     update();
-    m_renderWindow->Render();
+    render();
+
+    // The frame of the pose just rendered
+    if (getRecordRobotScene() && NO_ERR != record()) {
+        LOG_FAILURE("Failed to record");
+    }
     m_updateLock->Unlock();
 }
 
+void Gui::findDirtyScenes(bool dimsChanged, bool isCameraChanged)
+{
+    unsigned int kinCounter = m_kin->getCounter();
+    bool isPoseChanged = (m_sceneKinCounter != kinCounter);
+    m_sceneKinCounter = kinCounter;
+
+    // Objects and the base also move between forward kinematics cycles
+    unsigned int kinRevision = m_kin->getSceneRevision();
+    bool isObjectsChanged = (m_sceneKinRevision != kinRevision);
+    m_sceneKinRevision = kinRevision;
+
+    unsigned int viewRevision = m_viewRevision;
+    bool isViewChanged = (m_sceneViewRevision != viewRevision);
+    m_sceneViewRevision = viewRevision;
+
+    m_isEveryScene = dimsChanged || (0 == m_frameNumber);
+    m_dirtyScenes.assign(m_scenes.size(), m_isEveryScene);
+    if (m_isEveryScene) {
+        return;
+    }
+
+    // The buttons, six dof and speed scenes change with the window size
+    // only, their widgets render themselves when used
+    m_dirtyScenes[ROBOT] = isPoseChanged || isObjectsChanged ||
+            isViewChanged || isCameraChanged;
+    m_dirtyScenes[JOINT_VALUES] = isPoseChanged;
+    m_dirtyScenes[END_EFFECTOR] = isPoseChanged || isViewChanged;
+
+    for (unsigned int i = 0; i < m_scenes.size(); i++) {
+        if (m_scenes.at(i)->needsUpdate()) {
+            m_dirtyScenes[i] = true;
+        }
+    }
+}
+
+bool Gui::canRenderDirtyScenesOnly()
+{
+#if VTK_MAJOR_VERSION > 9 || (VTK_MAJOR_VERSION == 9 && VTK_MINOR_VERSION >= 1)
+    // A transparent scene does not clear its viewport, so it is rendered
+    // with the whole window when it or any scene under it changes
+    for (unsigned int i = 0; i < m_scenes.size(); i++) {
+        vtkRenderer* overlay = m_scenes.at(i)->getRenderer();
+        if (0 == overlay->GetLayer()) {
+            continue;
+        }
+
+        if (m_dirtyScenes[i]) {
+            return false;
+        }
+
+        for (unsigned int j = 0; j < m_scenes.size(); j++) {
+            if (m_dirtyScenes[j] &&
+                isOverlapping(overlay, m_scenes.at(j)->getRenderer())) {
+                return false;
+            }
+        }
+    }
+    return true;
+#else
+    // Older VTK renders straight into the back buffer, which does not hold
+    // the last frame once the buffers are swapped
+    return false;
+#endif
+}
+
+bool Gui::isOverlapping(vtkRenderer* a, vtkRenderer* b)
+{
+    double* va = a->GetViewport();
+    double* vb = b->GetViewport();
+    return (va[0] < vb[2]) && (vb[0] < va[2]) &&
+           (va[1] < vb[3]) && (vb[1] < va[3]);
+}
+
+void Gui::render()
+{
+    // Nothing changed, the window still shows the last frame
+    if (std::find(m_dirtyScenes.begin(), m_dirtyScenes.end(), true) ==
+            m_dirtyScenes.end()) {
+        return;
+    }
+
+    // The viewports of the other scenes keep the pixels of the last frame
+    bool isDirtyScenesOnly = !m_isEveryScene && canRenderDirtyScenesOnly();
+    if (isDirtyScenesOnly) {
+        m_emptyRenderer->DrawOff();
+        for (unsigned int i = 0; i < m_scenes.size(); i++) {
+            m_scenes.at(i)->getRenderer()->SetDraw(m_dirtyScenes[i]);
+        }
+    }
+
+    {
+        TRACE_SCOPE("vtkRenderWindow::Render");
+        int64_t startNs = getMonotonicTimeNs();
+        m_renderWindow->Render();
+        MetricsRegistry::getInstance()->record(
+                METRIC_RENDER_TIME, getMonotonicTimeNs() - startNs);
+    }
+
+    // The interactor renders every scene, e.g. while the camera is moved
+    if (isDirtyScenesOnly) {
+        m_emptyRenderer->DrawOn();
+        for (unsigned int i = 0; i < m_scenes.size(); i++) {
+            m_scenes.at(i)->getRenderer()->DrawOn();
+        }
+    }
+}
+
+void Gui::renderOnDemand()
+{
+    TraceRecorder::setThreadName("gui");
+    unsigned int counter = m_kin->getCounter();
+    unsigned int sceneRevision = m_kin->getSceneRevision();
+    while (true) {
+        m_updateLock->Lock();
+        if (m_isDestroying) {
+            m_updateLock->Unlock();
+            break;
+        }
+
+        update();
+        render();
+
+        // The frame of every step is recorded, waiting for the encoders
+        if (getRecordRobotScene() && NO_ERR != record()) {
+            LOG_FAILURE("Failed to record");
+        }
+        m_updateLock->Unlock();
+
+        // Renders again once the scene changed, as fast as it changes
+        while (!m_kin->waitForChange(counter, sceneRevision,
+                k_offScreenWaitMs) && !isDestroying()) {
+        }
+    }
+}
+
+bool Gui::isDestroying()
+{
+    m_updateLock->Lock();
+    bool isDestroying = m_isDestroying;
+    m_updateLock->Unlock();
+    return isDestroying;
+}
+
 Errors Gui::setupRecording()
 {
     time_t rawtime;
@@ -234,14 +413,81 @@ Errors Gui::setupRecording()
     m_dataFolder = FileSystem::homeDirectory() + "/record" + k_productName + "/"
             + m_cp->getRbs()->name() + "/" + str + "/";
 
-    if (!FileSystem::pathExists(m_dataFolder)) {
-        FileSystem::recursiveMkDir(m_dataFolder.c_str());
+    const SIM::Recording &recording = m_win->recording();
+    FrameRecorderConfig_t config;
+    switch (recording.format()) {
+        case SIM::Recording::RAW:
+            config.format = RECORDING_RAW;
+            break;
+        case SIM::Recording::Y4M:
+            config.format = RECORDING_Y4M;
+            break;
+        case SIM::Recording::POSE_LOG:
+            return setupPoseLog();
+        default:
+            config.format = RECORDING_PNG;
+            break;
+    }
+
+    config.output = recording.output();
+    if (config.output.empty()) {
+        if (!FileSystem::pathExists(m_dataFolder)) {
+            FileSystem::recursiveMkDir(m_dataFolder.c_str());
+        }
+        config.output = m_dataFolder;
+        if (RECORDING_RAW == config.format) {
+            config.output += "recording.rgb";
+        } else if (RECORDING_Y4M == config.format) {
+            config.output += "recording.y4m";
+        }
+    }
+
+    if (recording.queue_size() > 0) {
+        config.queueSize = recording.queue_size();
+    }
+    if (recording.num_encoders() > 0) {
+        config.numEncoders = recording.num_encoders();
+    }
+    if (recording.frame_rate() > 0) {
+        config.frameRate = recording.frame_rate();
+    } else if (m_win->graphics_cycle_ms() > 0) {
+        config.frameRate = std::max(1000 / m_win->graphics_cycle_ms(), 1);
+    }
+    if (recording.png_compression_level() > 0) {
+        config.pngCompressionLevel = recording.png_compression_level();
+    }
+
+    // The previous recording is flushed before the next one starts
+    m_recorder.reset();
+    m_recorder.reset(new FrameRecorder(config));
+    if (NO_ERR != m_recorder->start()) {
+        m_recorder.reset();
+        return ERR_INVALID;
     }
     return NO_ERR;
 }
 
+Errors Gui::setupPoseLog()
+{
+    std::string fileName = m_win->recording().output();
+    if (fileName.empty()) {
+        if (!FileSystem::pathExists(m_dataFolder)) {
+            FileSystem::recursiveMkDir(m_dataFolder.c_str());
+        }
+        fileName = m_dataFolder + "recording.poses";
+    }
+
+    // The kinematics logs every cycle, the frames are not read back
+    if (NO_ERR != m_kin->startPoseLog(fileName)) {
+        return ERR_INVALID;
+    }
+    m_isLoggingPoses = true;
+    return NO_ERR;
+}
+
 Errors Gui::record()
 {
+    TRACE_SCOPE("Gui::record");
     if (!m_isRecordingSetup) {
         if (NO_ERR != setupRecording()) {
             LOG_FAILURE("Failed to set up recording");
@@ -250,35 +496,54 @@ Errors Gui::record()
         m_isRecordingSetup = true;
     }
 
-    if (m_isRecordingSetup) {
-        unsigned int kinCounter = m_kin->getCounter();
-        if (m_kinCounter != kinCounter) {
-            m_kinCounter = kinCounter;
-
-            if (FileSystem::pathExists(m_dataFolder)) {
-                // Screenshot
-                vtkSmartPointer<vtkWindowToImageFilter> windowToImageFilter =
-                        vtkSmartPointer<vtkWindowToImageFilter>::New();
-                windowToImageFilter->SetInput(
-                    m_scenes[ROBOT]->getRenderer()->GetRenderWindow());
-                windowToImageFilter->SetViewport(
-                        m_scenes[ROBOT]->getRenderer()->GetViewport());
-                windowToImageFilter->SetInputBufferTypeToRGB();
-                windowToImageFilter->ReadFrontBufferOff();
-                windowToImageFilter->Update();
-
-                vtkSmartPointer<vtkPNGWriter> writer =
-                        vtkSmartPointer<vtkPNGWriter>::New();
-
-                std::string file =
-                    m_dataFolder + "frame_" + std::to_string(m_frameNumber) + ".png";
-
-                writer->SetFileName(file.c_str());
-                writer->SetInputConnection(windowToImageFilter->GetOutputPort());
-                writer->Write();
-            }
-        }
+    if (m_isLoggingPoses) {
+        return NO_ERR;
+    }
+
+    unsigned int kinCounter = m_kin->getCounter();
+    if (m_kinCounter == kinCounter) {
+        return NO_ERR;
     }
+    m_kinCounter = kinCounter;
+    return captureFrame(m_recorder.get(), m_isOffScreen);
+}
+
+Errors Gui::captureFrame(FrameRecorder* recorder, bool shouldWait)
+{
+    if (nullptr == recorder) {
+        return ERR_INVALID;
+    }
+
+    // The pixels of the robot scene viewport
+    int* size = m_renderWindow->GetSize();
+    double* viewport = m_scenes[ROBOT]->getRenderer()->GetViewport();
+    int x0 = (int)(viewport[0] * size[0] + 0.5);
+    int y0 = (int)(viewport[1] * size[1] + 0.5);
+    int x1 = (int)(viewport[2] * size[0] + 0.5) - 1;
+    int y1 = (int)(viewport[3] * size[1] + 0.5) - 1;
+    if ((x1 < x0) || (y1 < y0)) {
+        return NO_ERR;
+    }
+    int32_t width = x1 - x0 + 1;
+    int32_t height = y1 - y0 + 1;
+
+    // No free buffer means the encoders are behind, the frame is dropped
+    RecordedFrame_t* frame = recorder->acquire(width, height, shouldWait);
+    if (nullptr == frame) {
+        return NO_ERR;
+    }
+
+    // Read straight into the buffer of the frame, from the front buffer
+    // that holds the last frame rendered once the buffers are swapped
+    m_recordPixels->SetNumberOfComponents(3);
+    m_recordPixels->SetArray(frame->pixels.data(), frame->pixels.size(), 1);
+    if (VTK_OK != m_renderWindow->GetPixelData(
+            x0, y0, x1, y1, 1, m_recordPixels)) {
+        recorder->release(frame);
+        return ERR_INVALID;
+    }
+    frame->frameNumber = m_frameNumber;
+    recorder->submit(frame);
     return NO_ERR;
 }
 
@@ -287,6 +552,21 @@ Errors Gui::createRenderWindow()
     m_renderWindow = vtkSmartPointer<vtkRenderWindow>::New();
     m_renderWindow->SetNumberOfLayers(2);
 
+    // Needs no screen, the size is the one in the config
+    if (m_isOffScreen) {
+        m_renderWindow->SetOffScreenRendering(1);
+        if (m_win->window_size().width() > 0 &&
+            m_win->window_size().height() > 0) {
+            m_renderWindow->SetSize(
+                m_win->window_size().width(),
+                m_win->window_size().height());
+        } else {
+            m_renderWindow->SetSize(
+                k_offScreenDefaultSize[0], k_offScreenDefaultSize[1]);
+        }
+        return NO_ERR;
+    }
+
     int* screenSize = m_renderWindow->GetScreenSize();
 
     if (!screenSize) {
@@ -353,9 +633,9 @@ Errors Gui::populateRenderWindow()
     m_scenes.push_back(sceneSpeed);
 
     // Add an emty endrer to layer 0 to avoid reflections
-    vtkSmartPointer<vtkRenderer> emptyRender = vtkSmartPointer<vtkRenderer>::New();
-    emptyRender->SetBackground(1.0, 1.0, 1.0);
-    m_renderWindow->AddRenderer(emptyRender);
+    m_emptyRenderer = vtkSmartPointer<vtkRenderer>::New();
+    m_emptyRenderer->SetBackground(1.0, 1.0, 1.0);
+    m_renderWindow->AddRenderer(m_emptyRenderer);
     for (unsigned int i = 0; i < m_scenes.size(); i++) {
         m_renderWindow->AddRenderer(m_scenes.at(i)->getRenderer());
     }
@@ -365,6 +645,13 @@ Errors Gui::populateRenderWindow()
 
 void Gui::startRenderWindowInteractor()
 {
+    // Without a screen, there are no events to wait for
+    if (m_isOffScreen) {
+        renderOnDemand();
+        return;
+    }
+
+    TraceRecorder::setThreadName("gui");
     m_renderWindowInteractor->SetRenderWindow(m_renderWindow);
     m_renderWindowInteractor->Initialize();
 
@@ -449,6 +736,7 @@ Errors Gui::updateView()
         LOG_FAILURE("Failed to update camera");
         return ERR_INVALID;
     }
+    m_viewRevision++;
     return NO_ERR;
 }
 
@@ -457,6 +745,7 @@ void Gui::setFramesVisibility(bool framesVisibility)
     m_framesVisibilityLock->Lock();
     m_framesVisibility = framesVisibility;
     m_framesVisibilityLock->Unlock();
+    m_viewRevision++;
 }
 
 bool Gui::getFramesVisibility()
@@ -472,6 +761,7 @@ void Gui::setPlanesVisibility(bool planesVisibility)
     m_planesVisibilityLock->Lock();
     m_planesVisibility = planesVisibility;
     m_planesVisibilityLock->Unlock();
+    m_viewRevision++;
 }
 
 bool Gui::getPlanesVisibility()
@@ -487,6 +777,7 @@ void Gui::setLinesVisibility(bool framesVisibility)
     m_linesVisibilityLock->Lock();
     m_linesVisibility = framesVisibility;
     m_linesVisibilityLock->Unlock();
+    m_viewRevision++;
 }
 
 bool Gui::getLinesVisibility()
@@ -502,6 +793,7 @@ void Gui::setPointsVisibility(bool framesVisibility)
     m_pointsVisibilityLock->Lock();
     m_pointsVisibility = framesVisibility;
     m_pointsVisibilityLock->Unlock();
+    m_viewRevision++;
 }
 
 bool Gui::getPointsVisibility()
@@ -517,6 +809,7 @@ void Gui::setCadVisibility(bool framesVisibility)
     m_cadVisibilityLock->Lock();
     m_cadVisibility = framesVisibility;
     m_cadVisibilityLock->Unlock();
+    m_viewRevision++;
 }
 
 bool Gui::getCadVisibility()
@@ -532,6 +825,7 @@ void Gui::setPathVisibility(bool visibility)
     m_pathVisibilityLock->Lock();
     m_pathVisibility = visibility;
     m_pathVisibilityLock->Unlock();
+    m_viewRevision++;
 }
 
 bool Gui::getPathVisibility()
@@ -575,6 +869,12 @@ void Gui::setStatusMessage(const GuiStatusMessage_t &m)
     }
 }
 
+bool Gui::hasStatusMessages()
+{
+    std::unique_lock<std::mutex> lock(m_mutexStatusMessage);
+    return !m_mapStatusMessages.empty();
+}
+
 GuiStatusMessage_t Gui::getHighestPriorityStatusMessage()
 {
     std::unique_lock<std::mutex> lock(m_mutexStatusMessage);
@@ -641,6 +941,7 @@ Errors Gui::installTool(Object* tool)
         return ERR_INVALID;
     }
 
+    m_viewRevision++;
     m_updateLock->Unlock();
 
     return NO_ERR;
@@ -654,6 +955,7 @@ Errors Gui::removeTool()
         return ERR_INVALID;
     }
 
+    m_viewRevision++;
     m_updateLock->Unlock();
     return NO_ERR;
 }
@@ -32,8 +32,11 @@
 #include <vtkRenderWindowInteractor.h>
 #include <vtkSmartPointer.h>
 #include <vtkMutexLock.h>
+#include <vtkUnsignedCharArray.h>
+#include <atomic>
 #include <vector>
 #include <map>
+#include <memory>
 #include <mutex>
 
 namespace SIM {
@@ -50,6 +53,7 @@ class Kinematics;
 template<typename Type> class ThreadQueue;
 class EitOsMsgServerReceiver;
 class Object;
+class FrameRecorder;
 
 // TYPEDEFS AND DEFINES
 
@@ -71,9 +75,19 @@ class Gui
 {
 public:
     // FUNCTIONS
-    Gui(ConfigParser* cp, Kinematics* kin);
+    /**
+     * @param isOffScreen Whether to render to an offscreen buffer of the
+     * window size in the config instead of a window on the screen. The
+     * window config can ask for it too.
+     */
+    Gui(ConfigParser* cp, Kinematics* kin, bool isOffScreen = false);
     virtual ~Gui();
 
+    /**
+     * Renders until destroyed, a blocking call. On the screen, the scenes
+     * that changed every graphics cycle; offscreen, every time the pose
+     * changes.
+     */
     void startRenderWindowInteractor();
 
     void update();
@@ -125,6 +139,7 @@ public:
 
     void setStatusMessage(const GuiStatusMessage_t &m);
     GuiStatusMessage_t getHighestPriorityStatusMessage();
+    bool hasStatusMessages();
     unsigned int getFrameNumber() {return m_frameNumber;}
 
     EitOsMsgServerReceiver* getEitOsMsgServerReceiver();
@@ -132,13 +147,27 @@ public:
 
     Errors installTool(Object* tool);
     Errors removeTool();
+
+    /**
+     * Reads the robot scene, as last rendered, into a frame of the recorder
+     * and submits it
+     * @param shouldWait Whether to wait for a free frame rather than drop it
+     */
+    Errors captureFrame(FrameRecorder* recorder, bool shouldWait = false);
     // MEMBERS
 
 private:
     // FUNCTIONS
     Errors record();
+    void findDirtyScenes(bool dimsChanged, bool isCameraChanged);
+    bool canRenderDirtyScenesOnly();
+    bool isOverlapping(vtkRenderer* a, vtkRenderer* b);
+    void render();
+    void renderOnDemand();
+    bool isDestroying();
     Errors createRenderWindow();
     Errors setupRecording();
+    Errors setupPoseLog();
     Errors populateRenderWindow();
     Errors createTreeActors();
     Errors createObjectActors();
@@ -164,6 +193,21 @@ private:
 
     std::vector<SceneBase*> m_scenes {};
 
+    // Clears the window behind the scenes
+    vtkSmartPointer<vtkRenderer> m_emptyRenderer;
+
+    // Scenes to update and render in this frame, found by update. Only they
+    // are rendered unless the window is resized.
+    std::vector<bool> m_dirtyScenes {};
+    bool m_isEveryScene = true;
+    unsigned int m_sceneKinCounter = 0;
+    unsigned int m_sceneKinRevision = 0;
+
+    // Increased on changes of the robot scene other than the pose, e.g. its
+    // visibilities or tool
+    std::atomic<unsigned int> m_viewRevision {0};
+    unsigned int m_sceneViewRevision = 0;
+
     vtkSmartPointer<vtkMutexLock> m_framesVisibilityLock =
             vtkSmartPointer<vtkMutexLock>::New();
     bool m_framesVisibility = true;
@@ -201,6 +245,14 @@ private:
 
     std::string m_dataFolder = "";
     bool m_isRecordingSetup = false;
+    bool m_isLoggingPoses = false;
+    bool m_isOffScreen = false;
+
+    // Frames are read back into the buffers of the recorder, which encodes
+    // them in the background
+    std::unique_ptr<FrameRecorder> m_recorder;
+    vtkSmartPointer<vtkUnsignedCharArray> m_recordPixels =
+        vtkSmartPointer<vtkUnsignedCharArray>::New();
 
     unsigned int m_kinCounter = 0;
 
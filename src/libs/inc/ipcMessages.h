@@ -22,6 +22,7 @@
 #ifndef SRC_LIBS_INC_IPCMESSAGES_H_
 #define SRC_LIBS_INC_IPCMESSAGES_H_
 
+#include <sched.h>
 #include <time.h>
 #include "cstdint"
 
@@ -40,8 +41,22 @@ struct MessageHeader_t
 	int32_t srcPid;         // From what process the message was initiated.
 	int32_t msgId;          // Every message will have a message id
 	int32_t msgCounter;     // Every message will have a message id
+	int64_t sendTimeNs;     // Monotonic time the sender handed it to the transport
+	int64_t receiveTimeNs;  // Monotonic time the receiver took it from the transport
 };
 
+/**
+ * Time of the clock the message timestamps are taken from. It is shared by
+ * all processes of a machine, so the send time of one process and the
+ * receive time of another can be subtracted.
+ */
+inline int64_t getMonotonicTimeNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
 // Log  Related data
 struct LogData_t : MessageHeader_t
 {
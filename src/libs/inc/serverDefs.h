@@ -45,7 +45,16 @@ const std::string EtherCATDataServerThreadName =      "EtherCATDataServer";
 const std::string RecoveryServerThreadName =          "RecoveryServer";            // Recovery Server Thread
 const std::string DDSServerThreadName =               "DDSServer";                 // DDS Server
 const std::string RobotJointsReceiverThreadName =     "TarsimRobotServer";         // Robot COntrol
+const std::string RobotQueriesReceiverThreadName =    "TarsimQueryServer";         // Robot frame and joint value queries
 const std::string UserAppThreadName =                 "UserAppSrvr";               // UserApp Server
+
+// Socket transport of the robot server, the TCP port only listens on loopback
+const std::string TarsimSocketPath =                  "/tmp/tarsim.sock";          // Unix domain socket
+const std::string TarsimTcpAddress =                  "127.0.0.1";                 // TCP address clients connect to
+const int TarsimTcpPort =                             47011;                       // TCP port
+
+// Shared memory page of the simulator metrics, see StatisticsPage_t
+const std::string TarsimStatisticsPageName =          "TarsimStatistics";          // /dev/shm/TarsimStatistics
 }; // end of namespace tarsim
 
 #endif /* SRC_LIBS_INC_SERVERDEFS_H_ */
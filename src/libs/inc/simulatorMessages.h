@@ -53,7 +53,9 @@ struct ErrorMessage_t : MessageHeader_t
 const int32_t MAX_COLLISIONS = 5;
 
 /**
- * Message type used for communication of all robot joint values
+ * Message type used for communication of all robot joint values. Clients
+ * send it as a FRAMED_MESSAGE payload instead: numJoints, then numJoints
+ * indices, then numJoints positions, with no MAX_JOINTS limit.
  */
 struct JointPositions_t : MessageHeader_t
 {
@@ -273,7 +275,10 @@ struct Collision
 /**
  * Message type used for communication of a collision. indices provides the
  * indices of robot's links (rigid bodies) that are in collision with another
- * robot link or an object
+ * robot link or an object. The simulator sends it as a FRAMED_MESSAGE
+ * payload instead: the number of links, then for each link robotLink,
+ * numCollisions, numCollisions rigidBody and numCollisions isSelfCollision
+ * bytes.
  */
 struct CollisionMessage_t : MessageHeader_t
 {
@@ -281,6 +286,391 @@ struct CollisionMessage_t : MessageHeader_t
     Collision collisions[MAX_JOINTS];
 };
 
+/**
+ * Maximum length of a shared memory ring name
+ */
+const int32_t MAX_SHM_NAME_SIZE = 64;
+
+/**
+ * Transports a client can use to talk to the simulator
+ */
+enum TransportTypes
+{
+    TRANSPORT_MESSAGE_QUEUE,
+    TRANSPORT_SHARED_MEMORY,
+    TRANSPORT_UNIX_SOCKET,
+    TRANSPORT_TCP,
+};
+
+/**
+ * Message type used to ask the simulator to move a client onto shared memory.
+ * The client creates both rings before sending it over the message queue.
+ */
+struct SharedMemoryConnect_t : MessageHeader_t
+{
+    char ringToServer[MAX_SHM_NAME_SIZE];
+    char ringToClient[MAX_SHM_NAME_SIZE];
+};
+
+/**
+ * Maximum number of frames in a frame selection
+ */
+const int32_t MAX_FRAME_SELECTION_ITEMS = 64;
+
+/**
+ * Maximum number of frames carried by one chunk of a frames batch
+ */
+const int32_t MAX_FRAMES_PER_BATCH = 15;
+
+/**
+ * Kinds of frames that can be part of a frame selection
+ */
+enum FrameSelectionTypes
+{
+    FRAME_SELECTION_RIGID_BODY,
+    FRAME_SELECTION_OBJECT,
+};
+
+/**
+ * One frame of a frame selection. indexFrame is only used by rigid bodies.
+ */
+struct FrameSelection_t
+{
+    FrameSelectionTypes type = FRAME_SELECTION_RIGID_BODY;
+    int32_t index = 0;
+    int32_t indexFrame = 0;
+};
+
+/**
+ * Message type used to register a frame selection once under an id chosen by
+ * the client, so that later batch requests only carry the id. Only the first
+ * numItems items are sent.
+ */
+struct RegisterFrameSelection_t : MessageHeader_t
+{
+    int32_t selectionId = 0;
+    int32_t numItems = 0;
+    FrameSelection_t items[MAX_FRAME_SELECTION_ITEMS];
+};
+
+/**
+ * Message type used for requesting many frames at once. If numItems is zero
+ * the frames of the registered selection selectionId are returned, otherwise
+ * the frames of the items carried by the request. Only the first numItems
+ * items are sent.
+ */
+struct RequestFramesBatch_t : MessageHeader_t
+{
+    int32_t selectionId = 0;
+    int32_t numItems = 0;
+    FrameSelection_t items[MAX_FRAME_SELECTION_ITEMS];
+};
+
+/**
+ * Message type used for communication of a chunk of a frames batch. A batch
+ * of numItems frames is split into chunks of up to MAX_FRAMES_PER_BATCH
+ * frames, all sharing the msgCounter of the request. numItems is -1 if the
+ * selection is unknown.
+ */
+struct FramesBatch_t : MessageHeader_t
+{
+    int32_t selectionId = 0;
+    int32_t numItems = 0;
+    int32_t chunkIndex = 0;
+    int32_t numChunks = 0;
+    int32_t numFrames = 0;
+    float mij[MAX_FRAMES_PER_BATCH][FRAME_INDICES];
+};
+
+static_assert(sizeof(FramesBatch_t) <= MAX_MSG_SIZE,
+        "A chunk of a frames batch must fit in one message");
+static_assert(sizeof(RequestFramesBatch_t) <= MAX_MSG_SIZE,
+        "A frames batch request must fit in one message");
+
+/**
+ * State a client can subscribe to. Topics are combined as a bit mask.
+ */
+enum SubscriptionTopics
+{
+    TOPIC_JOINT_VALUES = 0x1,
+    TOPIC_END_EFFECTOR = 0x2,
+    TOPIC_FRAMES = 0x4,
+    TOPIC_FAULT_STATUS = 0x8,
+};
+
+/**
+ * Counter of the messages the simulator publishes on its own, so they can
+ * not be mistaken for the reply to a request
+ */
+const int32_t PUBLISHED_MSG_COUNTER = -1;
+
+/**
+ * Message type used to subscribe to state the simulator pushes after every
+ * forward kinematics cycle. It is published every decimation cycles.
+ * TOPIC_FRAMES publishes the frames of the registered frame selection
+ * selectionId. A subscription replaces the previous one of the client, and
+ * topics of zero unsubscribes.
+ */
+struct Subscribe_t : MessageHeader_t
+{
+    uint32_t topics = 0;
+    int32_t decimation = 1;
+    int32_t selectionId = 0;
+};
+
+/**
+ * Message type used to run one control cycle with a single message: set the
+ * joint positions, execute forward kinematics and collision detection, and
+ * reply with a StepResult_t
+ */
+struct Step_t : MessageHeader_t
+{
+    int32_t numJoints = 0;
+    int32_t indices [MAX_JOINTS];
+    float positions [MAX_JOINTS];
+};
+
+/**
+ * Message type used for communication of the outcome of a step. errorId is
+ * the worst joint limit error of errorJoint, as sent in ErrorMessage_t. The
+ * durations are those of forward kinematics and of the time since the
+ * previous joint values, in ms.
+ */
+struct StepResult_t : MessageHeader_t
+{
+    int32_t errorId = 0;
+    int32_t errorJoint = -1;
+    float mij[FRAME_INDICES];
+    int32_t numSelfCollisions = 0;
+    int32_t numExternalCollisions = 0;
+    FaultLevels faultLevel = FaultLevels::FAULT_LEVEL_NOFAULT;
+    FaultTypes faultType = FaultTypes::FAULT_TYPE_NOFAULT;
+    float fkDuration = 0.0;
+    float jvDuration = 0.0;
+};
+
+/**
+ * Maximum number of values carried by one chunk of a trajectory
+ */
+const int32_t MAX_TRAJECTORY_CHUNK_VALUES = 200;
+
+/**
+ * How a trajectory is interpolated between its waypoints
+ */
+enum TrajectoryInterpolations
+{
+    INTERPOLATION_CUBIC,
+    INTERPOLATION_QUINTIC,
+};
+
+/**
+ * Message type used to upload a chunk of a trajectory. A trajectory is a list
+ * of timestamped waypoints of the joints in indices, split over numChunks
+ * chunks. values holds numWaypoints waypoints, each made of its time in ms
+ * followed by numJoints joint positions. The simulator replies to the last
+ * chunk with a TrajectoryStatus_t.
+ */
+struct TrajectoryChunk_t : MessageHeader_t
+{
+    int32_t trajectoryId = 0;
+    int32_t chunkIndex = 0;
+    int32_t numChunks = 0;
+    TrajectoryInterpolations interpolation = INTERPOLATION_CUBIC;
+    int32_t numJoints = 0;
+    int32_t indices[MAX_JOINTS];
+    int32_t numWaypoints = 0;
+    float values[MAX_TRAJECTORY_CHUNK_VALUES];
+};
+
+static_assert(sizeof(TrajectoryChunk_t) <= MAX_MSG_SIZE,
+        "A chunk of a trajectory must fit in one message");
+
+/**
+ * Commands to play an uploaded trajectory
+ */
+enum TrajectoryCommands
+{
+    TRAJECTORY_START,
+    TRAJECTORY_STOP,
+};
+
+/**
+ * Message type used to start or stop playing an uploaded trajectory
+ */
+struct TrajectoryCommand_t : MessageHeader_t
+{
+    int32_t trajectoryId = 0;
+    TrajectoryCommands command = TRAJECTORY_STOP;
+};
+
+/**
+ * States of a trajectory
+ */
+enum TrajectoryStates
+{
+    TRAJECTORY_STATE_IDLE,
+    TRAJECTORY_STATE_LOADING,
+    TRAJECTORY_STATE_READY,
+    TRAJECTORY_STATE_PLAYING,
+    TRAJECTORY_STATE_DONE,
+    TRAJECTORY_STATE_ABORTED,
+    TRAJECTORY_STATE_INVALID,
+};
+
+/**
+ * Message type used for communication of the progress of a trajectory. It is
+ * the reply to uploads and commands, and is published every time playback
+ * moves to the next segment. time and duration are in ms, and duration
+ * includes any stretching needed to honor the mate limits.
+ */
+struct TrajectoryStatus_t : MessageHeader_t
+{
+    int32_t trajectoryId = 0;
+    TrajectoryStates state = TRAJECTORY_STATE_IDLE;
+    int32_t segment = 0;
+    int32_t numSegments = 0;
+    float time = 0.0;
+    float duration = 0.0;
+};
+
+/**
+ * Stages of the life of a message whose latency is measured
+ */
+enum LatencyStages
+{
+    LATENCY_TRANSPORT,  // From sent to received, queueing in the transport included
+    LATENCY_SEND,       // Time the sender was kept by the transport, e.g. on a full queue
+    LATENCY_DISPATCH,   // From received to its handler starting
+    LATENCY_HANDLER,    // Handler run, sending the replies included
+    LATENCY_KINEMATICS, // Forward kinematics run by the handler, collision detection included
+    LATENCY_COLLISION,  // Collision detection run by the handler
+    LATENCY_ROUND_TRIP, // From the request sent to its reply received
+    NUM_LATENCY_STAGES
+};
+
+/**
+ * Latency percentiles of one stage of one message id, in ns. Percentiles are
+ * the upper bound of their histogram bucket, within 1/16 of the value.
+ */
+struct LatencyStatistics_t
+{
+    int32_t msgId = 0;
+    int32_t stage = LATENCY_TRANSPORT;
+    int64_t count = 0;
+    int64_t p50Ns = 0;
+    int64_t p99Ns = 0;
+    int64_t p999Ns = 0;
+    int64_t maxNs = 0;
+};
+
+/**
+ * Message type used to request the latency histograms of the simulator.
+ * The simulator replies with a LATENCY_STATS payload in FRAMED_MESSAGE
+ * fragments: msgCounter of the request, the number of entries, then every
+ * LatencyStatistics_t field by field.
+ */
+struct RequestLatencyStats_t : MessageHeader_t
+{
+    int32_t shouldReset = 0; // Starts the histograms over once read
+};
+
+const int32_t MAX_TRACE_FILE_NAME_SIZE = 256;
+
+/**
+ * Commands to trace the spans of the simulator cycle
+ */
+enum TraceCommands
+{
+    TRACE_START, // Starts tracing over
+    TRACE_STOP,  // Stops tracing and writes the trace to fileName, if any
+};
+
+/**
+ * Message type used to start or stop tracing. The trace is written by the
+ * simulator as Chrome Trace JSON, so fileName is a file name in traceTarsim of
+ * its home directory, with no folder.
+ */
+struct TraceCommand_t : MessageHeader_t
+{
+    TraceCommands command = TRACE_STOP;
+    char fileName[MAX_TRACE_FILE_NAME_SIZE] = {0};
+};
+
+/**
+ * Metrics of the simulator cycle, kept by the simulator from its start
+ */
+enum MetricIds
+{
+    METRIC_FK_TIME,               // Forward kinematics run, collision detection included, in ns
+    METRIC_COLLISION_TIME,        // Collision detection run, in ns
+    METRIC_JOINT_VALUES_INTERVAL, // Time between two forward kinematics runs, in ns
+    METRIC_JOINT_VALUES_JITTER,   // Distance of that interval from the control cycle, in ns
+    METRIC_QUEUE_DEPTH,           // Control messages queued as one is received, all of the backlog when draining
+    METRIC_RENDER_TIME,           // Render of the window, in ns
+    METRIC_DROPPED_REPLIES,       // Replies dropped since their client did not read them
+    METRIC_CONFLATED_SETPOINTS,   // Joint setpoint messages superseded by newer ones before being applied
+    METRIC_DROPPED_FRAMES,        // Recorded frames dropped since the encoders fell behind
+    NUM_METRICS
+};
+
+/**
+ * Kinds of metrics
+ */
+enum MetricKinds
+{
+    METRIC_HISTOGRAM, // Distribution of the samples recorded
+    METRIC_COUNTER,   // Running total, in count
+};
+
+/**
+ * Statistics of one metric. A counter only has its total in count.
+ * Percentiles are the upper bound of their histogram bucket, within 1/16 of
+ * the value.
+ */
+struct MetricStatistics_t
+{
+    int32_t metricId = METRIC_FK_TIME;
+    int32_t kind = METRIC_HISTOGRAM;
+    int64_t count = 0;
+    int64_t mean = 0;
+    int64_t p50 = 0;
+    int64_t p90 = 0;
+    int64_t p99 = 0;
+    int64_t p999 = 0;
+    int64_t max = 0;
+};
+
+/**
+ * Message type used to request the metrics of the simulator. The simulator
+ * replies with a STATISTICS payload in FRAMED_MESSAGE fragments: msgCounter
+ * of the request, the number of metrics, then every MetricStatistics_t field
+ * by field.
+ */
+struct RequestStatistics_t : MessageHeader_t
+{
+    int32_t shouldReset = 0; // Starts the metrics over once read
+};
+
+const uint32_t STATISTICS_PAGE_MAGIC = 0x54535450; // "TSTP"
+const int32_t STATISTICS_PAGE_VERSION = 1;
+
+/**
+ * Layout of the shared memory page the simulator publishes its metrics to,
+ * for tools to poll without a message. The simulator makes sequence odd
+ * while it writes the page, so a reader copies the page between two equal
+ * even reads of sequence.
+ */
+struct StatisticsPage_t
+{
+    uint32_t magic = STATISTICS_PAGE_MAGIC;
+    int32_t version = STATISTICS_PAGE_VERSION;
+    uint64_t sequence = 0;
+    int64_t publishTimeNs = 0; // Monotonic time of the last publish
+    int32_t periodMs = 0;      // Period of the publishes
+    int32_t numMetrics = NUM_METRICS;
+    MetricStatistics_t metrics[NUM_METRICS];
+};
+
 /**
  * Union of all data structure
  */
@@ -329,6 +719,45 @@ enum SimulatorMessageId_t
     SHUTDOWN,
     INSTALL_TOOL,
     SET_END_EFFECTOR,
+    SHARED_MEMORY_CONNECT,
+    REGISTER_FRAME_SELECTION,
+    REQUEST_FRAMES_BATCH,
+    FRAMES_BATCH,
+    SUBSCRIBE,
+    STEP,
+    STEP_RESULT,
+    TRAJECTORY,
+    TRAJECTORY_COMMAND,
+    TRAJECTORY_STATUS,
+    FRAMED_MESSAGE, // A fragment of a variable-length payload
+    REQUEST_LATENCY_STATS,
+    LATENCY_STATS, // Payload id of the reply to REQUEST_LATENCY_STATS
+    TRACE_COMMAND,
+    REQUEST_STATISTICS,
+    STATISTICS, // Payload id of the reply to REQUEST_STATISTICS
+
+    SIM_LAST_MSG // Not a message, the number of message ids
 };
+
+/**
+ * Whether a message is a query, served by the best-effort query lane
+ * (RobotQueriesReceiverThreadName) instead of the control lane
+ */
+inline bool isQueryMessage(int32_t msgId)
+{
+    switch (msgId)
+    {
+        case REQUEST_END_EFFECTOR_FRAME:
+        case REQUEST_RIGID_BODY_FRAME:
+        case REQUEST_OBJECT_FRAME:
+        case REQUEST_JOINT_VALUES:
+        case SIMULATOR_STATUS:
+        case REGISTER_FRAME_SELECTION:
+        case REQUEST_FRAMES_BATCH:
+            return true;
+        default:
+            return false;
+    }
+}
 } // end of namespace tarsim
 #endif /* SRC_LIBS_INC_SIMULATOR_MESSAGES_H_ */
@@ -0,0 +1,178 @@
+/**
+ * @file: batchKinematics.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of BatchKinematics
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "batchKinematics.h"
+#include <algorithm>
+#include <thread>
+#include "logClient.h"
+
+namespace tarsim {
+
+BatchKinematics::BatchKinematics(
+        const std::string &configFolderName, int numThreads)
+{
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Every thread moves a tree of its own
+    m_workers.resize(numThreads);
+    for (Worker_t &worker: m_workers) {
+        worker.cp.reset(new ConfigParser(configFolderName));
+        worker.kinematics.reset(new Kinematics(worker.cp.get()));
+    }
+
+    RigidBodySystem* rbs = m_workers.front().cp->getRbs();
+    for (int i = 0; i < rbs->mates_size(); i++) {
+        m_jointIndices.push_back(rbs->mates(i).index());
+    }
+    std::sort(m_jointIndices.begin(), m_jointIndices.end());
+
+    for (Worker_t &worker: m_workers) {
+        for (int32_t index: m_jointIndices) {
+            Node* node = worker.cp->getNodeOfMate(index);
+            if (nullptr == node) {
+                throw std::invalid_argument("At least one mate is undefined");
+            }
+            worker.nodes.push_back(node);
+        }
+    }
+}
+
+BatchKinematics::~BatchKinematics()
+{
+}
+
+const std::vector<int32_t>& BatchKinematics::getJointIndices() const
+{
+    return m_jointIndices;
+}
+
+Errors BatchKinematics::forwardKinematics(
+        const double* positions, size_t numConfigurations,
+        double* frames, int32_t* errorIds)
+{
+    return run(positions, numConfigurations, frames, nullptr, errorIds);
+}
+
+Errors BatchKinematics::detectCollisions(
+        const double* positions, size_t numConfigurations,
+        int32_t* numCollisions, int32_t* errorIds)
+{
+    return run(positions, numConfigurations, nullptr, numCollisions, errorIds);
+}
+
+Errors BatchKinematics::run(
+        const double* positions, size_t numConfigurations,
+        double* frames, int32_t* numCollisions, int32_t* errorIds)
+{
+    std::unique_lock<std::mutex> lock(m_mutexWorkers);
+
+    // Contiguous shares, so that no two workers write next to each other
+    size_t numWorkers = std::min(m_workers.size(), numConfigurations);
+    if (0 == numWorkers) {
+        return NO_ERR;
+    }
+    size_t share = (numConfigurations + numWorkers - 1) / numWorkers;
+
+    std::vector<Errors> errors(numWorkers, NO_ERR);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numWorkers; i++) {
+        size_t begin = i * share;
+        size_t end = std::min(numConfigurations, begin + share);
+        threads.push_back(std::thread([=, &errors]() {
+            errors[i] = evaluate(m_workers[i], positions, begin, end,
+                    frames, numCollisions, errorIds);
+        }));
+    }
+
+    // The caller takes the first share
+    errors[0] = evaluate(m_workers[0], positions, 0,
+            std::min(numConfigurations, share),
+            frames, numCollisions, errorIds);
+
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    for (Errors error: errors) {
+        if (NO_ERR != error) {
+            return error;
+        }
+    }
+    return NO_ERR;
+}
+
+Errors BatchKinematics::evaluate(
+        Worker_t &worker, const double* positions,
+        size_t begin, size_t end,
+        double* frames, int32_t* numCollisions, int32_t* errorIds)
+{
+    size_t numJoints = m_jointIndices.size();
+    bool shouldDetectCollisions = (nullptr != numCollisions);
+    Matrix4d xfm;
+    std::map<int32_t, Collision> collisions;
+    for (size_t c = begin; c < end; c++) {
+        const double* row = positions + c * numJoints;
+        Errors errorId = NO_ERR;
+        for (size_t j = 0; j < numJoints; j++) {
+            Errors error = worker.nodes[j]->setTargetJointValue(row[j], false);
+            if (NO_ERR != error) {
+                errorId = error;
+            }
+        }
+        errorIds[c] = errorId;
+
+        if (NO_ERR != worker.kinematics->evaluate(
+                xfm, shouldDetectCollisions, collisions)) {
+            LOG_FAILURE("Failed to evaluate configuration %zu", c);
+            return ERR_INVALID;
+        }
+
+        if (nullptr != frames) {
+            double* frame = frames + c * FRAME_INDICES;
+            for (int r = 0; r < 4; r++) {
+                for (int k = 0; k < 4; k++) {
+                    frame[4 * r + k] = xfm(r, k);
+                }
+            }
+        }
+
+        if (shouldDetectCollisions) {
+            int32_t numSelf = 0;
+            int32_t numExternal = 0;
+            for (const auto &pair: collisions) {
+                for (int32_t k = 0; k < pair.second.numCollisions; k++) {
+                    if (pair.second.isSelfCollision[k]) {
+                        numSelf++;
+                    } else {
+                        numExternal++;
+                    }
+                }
+            }
+            numCollisions[2 * c] = numSelf;
+            numCollisions[2 * c + 1] = numExternal;
+        }
+    }
+    return NO_ERR;
+}
+
+} // end of namespace tarsim
@@ -0,0 +1,109 @@
+/**
+ *
+ * @file: batchKinematics.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Forward kinematics and collision detection of many configurations
+ * in the caller's process, without the GUI or a running simulator. The rigid
+ * body system of a config folder is loaded once per thread, and a batch is
+ * split between the threads.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef BATCH_KINEMATICS_H
+#define BATCH_KINEMATICS_H
+
+//INCLUDES
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "kinematics.h"
+
+namespace tarsim {
+class BatchKinematics
+{
+public:
+    /**
+     * Constructor
+     * @param configFolderName Config folder, as given to the simulator
+     * @param numThreads Threads sharing a batch, one per core if not positive
+     */
+    BatchKinematics(const std::string &configFolderName, int numThreads = 0);
+    virtual ~BatchKinematics();
+
+    /**
+     * @return mate indices of the joints, in the order of the joint values
+     * of a configuration
+     */
+    const std::vector<int32_t>& getJointIndices() const;
+
+    /**
+     * Calculates the end-effector frame of every configuration
+     * @param positions Joint values, a row of getJointIndices().size() values
+     * per configuration
+     * @param numConfigurations Number of configurations
+     * @param frames 16 values per configuration, the frame in row major order
+     * @param errorIds ERR_JOINT_POSITION_LIMIT per configuration that had a
+     * joint value beyond its limits, and was calculated at the limit, NO_ERR
+     * otherwise
+     * @return NO_ERR if successful
+     */
+    Errors forwardKinematics(
+            const double* positions, size_t numConfigurations,
+            double* frames, int32_t* errorIds);
+
+    /**
+     * Detects the collisions of every configuration
+     * @param positions Joint values, a row of getJointIndices().size() values
+     * per configuration
+     * @param numConfigurations Number of configurations
+     * @param numCollisions Number of self and of external collisions per
+     * configuration
+     * @param errorIds As for forwardKinematics
+     * @return NO_ERR if successful
+     */
+    Errors detectCollisions(
+            const double* positions, size_t numConfigurations,
+            int32_t* numCollisions, int32_t* errorIds);
+
+private:
+    // Rigid body system of one thread
+    struct Worker_t
+    {
+        std::unique_ptr<ConfigParser> cp;
+        std::unique_ptr<Kinematics> kinematics;
+        std::vector<Node*> nodes; // by joint, in the order of m_jointIndices
+    };
+
+    // Splits the configurations between the workers. frames or
+    // numCollisions is null when not asked for.
+    Errors run(
+            const double* positions, size_t numConfigurations,
+            double* frames, int32_t* numCollisions, int32_t* errorIds);
+
+    Errors evaluate(
+            Worker_t &worker, const double* positions,
+            size_t begin, size_t end,
+            double* frames, int32_t* numCollisions, int32_t* errorIds);
+
+    std::vector<int32_t> m_jointIndices;
+
+    // One batch at a time, as every worker keeps its pose in its nodes
+    mutable std::mutex m_mutexWorkers;
+    std::vector<Worker_t> m_workers;
+};
+} // end of namespace tarsim
+#endif /* BATCH_KINEMATICS_H */
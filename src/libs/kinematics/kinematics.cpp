@@ -22,7 +22,11 @@
 #include <map>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
 #include "logClient.h"
+#include "traceRecorder.h"
+#include "metricsRegistry.h"
+#include "poseLogWriter.h"
 
 
 namespace tarsim {
@@ -72,10 +76,12 @@ Kinematics::Kinematics(ConfigParser* cp)
     {
         throw std::invalid_argument("Failed to calculate initial object xfms");
     }
+    updateSnapshot();
 }
 
 Kinematics::~Kinematics()
 {
+    stopPoseLog();
     for (auto pair: m_mapObjects) {
         delete pair.second;
         pair.second = nullptr;
@@ -86,23 +92,41 @@ Errors Kinematics::executeForwardKinematics(
         GuiStatusMessage_t &statusMessage,
         std::map<int32_t, Collision> &collisions)
 {
-    incCounter();
+    TRACE_SCOPE("Kinematics::executeForwardKinematics");
+    // Waiters are only woken once the pose of this counter is complete
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCounter);
+        m_counter++;
+    }
     using namespace std::chrono;
     high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
     Matrix4d m = Matrix4d::Zero();
-    if (NO_ERR != calculateChildrenXfm(m_root, m)) {
-	    LOG_FAILURE("Failed to calculate forward kinematics");
-	    return ERR_INVALID;
-	  }
+    {
+        TRACE_SCOPE("Kinematics::calculateChildrenXfm");
+        if (NO_ERR != calculateChildrenXfm(m_root, m)) {
+            LOG_FAILURE("Failed to calculate forward kinematics");
+            return ERR_INVALID;
+        }
+    }
 
-    if (NO_ERR != calculateObjectsXfm()) {
-        LOG_FAILURE("Failed to calculate objects xfm");
-        return ERR_INVALID;
+    {
+        TRACE_SCOPE("Kinematics::calculateObjectsXfm");
+        if (NO_ERR != calculateObjectsXfm()) {
+            LOG_FAILURE("Failed to calculate objects xfm");
+            return ERR_INVALID;
+        }
     }
 
+    double collisionDuration = 0.0;
     if (m_cp->getRbs()->collision_detection().is_active() && getCounter() > 1) {
-        if (!isCollisionDetected()) {
+        high_resolution_clock::time_point t3 = high_resolution_clock::now();
+        bool isDetected = isCollisionDetected();
+        collisionDuration = 1000.0 * duration_cast<duration<double>>(
+                high_resolution_clock::now() - t3).count();
+        MetricsRegistry::getInstance()->record(
+                METRIC_COLLISION_TIME, (int64_t)(collisionDuration * 1e6));
+        if (!isDetected) {
             updateCurrentJointValues(m_root);
             updateCurrentXfms(m_root);
             m_collisions.clear();
@@ -134,20 +158,78 @@ Errors Kinematics::executeForwardKinematics(
     time_span = duration_cast<duration<double>>(t1 - m_timePreviousJointValues);
     double jvDuration = 1000.0 * time_span.count();
 
+    // Metrics are kept in ns, the status text and faults stay in ms
+    MetricsRegistry* metrics = MetricsRegistry::getInstance();
+    metrics->record(METRIC_FK_TIME, (int64_t)(fkDuration * 1e6));
+    if (getCounter() > 1) {
+        metrics->record(METRIC_JOINT_VALUES_INTERVAL,
+                (int64_t)(jvDuration * 1e6));
+        if (m_cp->getRbs()->control_cycle() > 0.0) {
+            metrics->record(METRIC_JOINT_VALUES_JITTER,
+                    (int64_t)(fabs(jvDuration - m_controlCycle) * 1e6));
+        }
+    }
+
     statusMessage = extractStatusMessage(jvDuration, fkDuration);
 
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCycleDurations);
+        m_fkDuration = fkDuration;
+        m_jvDuration = jvDuration;
+        m_collisionDuration = collisionDuration;
+    }
+
     m_timePreviousJointValues = t1;
+
+    updateSnapshot();
+    publishCounter();
+    logPose();
 	  return NO_ERR;
 }
 
+Errors Kinematics::evaluate(
+        Matrix4d &xfmEndEffector,
+        bool shouldDetectCollisions,
+        std::map<int32_t, Collision> &collisions)
+{
+    xfmEndEffector = Matrix4d::Zero();
+    if (NO_ERR != calculateChildrenXfm(m_root, xfmEndEffector)) {
+        LOG_FAILURE("Failed to calculate forward kinematics");
+        return ERR_INVALID;
+    }
+
+    collisions.clear();
+    if (shouldDetectCollisions) {
+        // Objects locked to rigid bodies move with the candidate pose
+        if (NO_ERR != calculateObjectsXfm()) {
+            LOG_FAILURE("Failed to calculate objects xfm");
+            return ERR_INVALID;
+        }
+        isCollisionDetected();
+        collisions = m_collisions;
+    }
+    return NO_ERR;
+}
+
 bool Kinematics::isCollisionDetected()
 {
+    TRACE_SCOPE("Kinematics::isCollisionDetected");
     bool isCollisionDetected = false;
 
     clearCollisions(m_root);
     m_collisions.clear();
-    if (NO_ERR != detectCollisionNode(m_root, isCollisionDetected)) {
-        LOG_WARNING("Failed to execute collision detection algorithm");
+    {
+        TRACE_SCOPE("Kinematics::detectCollisionNode");
+        if (NO_ERR != detectCollisionNode(m_root, isCollisionDetected)) {
+            LOG_WARNING("Failed to execute collision detection algorithm");
+        }
+    }
+
+    if (m_cp->getRbs()->collision_detection().object_collisions()) {
+        TRACE_SCOPE("Kinematics::detectCollisionObjectObjects");
+        if (NO_ERR != detectCollisionObjectObjects(isCollisionDetected)) {
+            LOG_WARNING("Failed to execute object collision detection algorithm");
+        }
     }
 
     return isCollisionDetected;
@@ -193,6 +275,9 @@ Errors Kinematics::detectCollisionNodeObjects(
         for (auto pair: m_mapObjects) {
             for (size_t j = 0; j < pair.second->getBbs()->size(); j++) {
                 BoundingBoxBase* bb2 =  pair.second->getBbs()->at(j);
+                if (!bb1->canCollideWith(bb2)) {
+                    continue;
+                }
                 // Update xfm of vertices
                 bb2->updateVertices(m_mapObjects[pair.first]->getXfm());
 
@@ -205,23 +290,8 @@ Errors Kinematics::detectCollisionNodeObjects(
                 if (result) {
                     isCollisionDetected = result;
                     node->setIsCollisionDetected(result);
-
-                    int32_t robotLink = node->getRigidBody()->index();
-                    if (m_collisions.find(robotLink) == m_collisions.end()) {
-                        Collision collision;
-                        collision.robotLink = robotLink;
-                        collision.rigidBody[0] = pair.first;
-                        collision.isSelfCollision[0] = false;
-                        collision.numCollisions = 1;
-                        m_collisions[robotLink] = collision;
-                    } else {
-                        Collision collision = m_collisions[robotLink];
-                        size_t ind = std::min((size_t)collision.numCollisions, (size_t)(MAX_COLLISIONS));
-                        collision.rigidBody[ind] = pair.first;
-                        collision.isSelfCollision[ind] = false;
-                        collision.numCollisions++;
-                        m_collisions[robotLink] = collision;
-                    }
+                    addCollision(
+                            node->getRigidBody()->index(), pair.first, false);
                 }
             }
         }
@@ -266,6 +336,9 @@ Errors Kinematics::detectCollisionNodeNode(
         // Check for self-collisions
         for (size_t j = 0; j < node2->getBbs()->size(); j++) {
             BoundingBoxBase* bb2 =  node2->getBbs()->at(j);
+            if (!bb1->canCollideWith(bb2)) {
+                continue;
+            }
 
             // Update xfm of vertices
             bb1->updateVertices(node1->getTargetXfm());
@@ -281,29 +354,115 @@ Errors Kinematics::detectCollisionNodeNode(
                 isCollision = result;
                 node1->setIsCollisionDetected(result);
                 node2->setIsCollisionDetected(result);
+                addCollision(
+                        node1->getRigidBody()->index(),
+                        node2->getRigidBody()->index(),
+                        true);
+            }
+        }
+    }
+    return NO_ERR;
+}
 
-                int32_t robotLink = node1->getRigidBody()->index();
-                if (m_collisions.find(robotLink) == m_collisions.end()) {
-                    Collision collision;
-                    collision.robotLink = robotLink;
-                    collision.rigidBody[0] = node2->getRigidBody()->index();
-                    collision.isSelfCollision[0] = true;
-                    collision.numCollisions = 1;
-                    m_collisions[robotLink] = collision;
-                } else {
-                    Collision collision = m_collisions[robotLink];
-                    size_t ind = std::min((size_t)collision.numCollisions, (size_t)(MAX_COLLISIONS));
-                    collision.rigidBody[ind] = node2->getRigidBody()->index();
-                    collision.isSelfCollision[ind] = true;
-                    collision.numCollisions++;
-                    m_collisions[robotLink] = collision;
-                }
+Errors Kinematics::detectCollisionObjectObjects(bool &isCollisionDetected)
+{
+    std::unique_lock<std::mutex> lock(m_mutexObjects);
+
+    // Only objects held by a rigid body move, so nothing to check otherwise
+    bool isAnyObjectLocked = false;
+    for (auto pair: m_mapObjects) {
+        int indexRigidBody = 0;
+        if (pair.second->getIsLocked(indexRigidBody)) {
+            isAnyObjectLocked = true;
+            break;
+        }
+    }
+
+    if (!isAnyObjectLocked) {
+        return NO_ERR;
+    }
+
+    m_broadPhase.clear();
+    for (auto pair: m_mapObjects) {
+        int indexRigidBody = 0;
+        bool isLocked = pair.second->getIsLocked(indexRigidBody);
+
+        // Held objects are checked at the pose the rigid body is moving to
+        Matrix4d xfm = pair.second->getXfm();
+        if (isLocked) {
+            Node* node = m_cp->getNodeOfRigidBody(indexRigidBody);
+            if (nullptr == node) {
+                LOG_FAILURE("Failed to find rigid body %d", indexRigidBody);
+                return ERR_INVALID;
             }
+            xfm = node->getTargetXfm() * pair.second->getXfmObjectToRb();
         }
+
+        for (size_t i = 0; i < pair.second->getBbs()->size(); i++) {
+            BoundingBoxBase* bb = pair.second->getBbs()->at(i);
+            bb->updateVertices(xfm);
+            m_broadPhase.addProxy(pair.first, bb, isLocked);
+        }
+    }
+
+    {
+        TRACE_SCOPE("BroadPhase::findPairs");
+        m_broadPhase.findPairs(m_broadPhasePairs);
     }
+
+    for (size_t i = 0; i < m_broadPhasePairs.size(); i++) {
+        const BroadPhaseProxy &p1 =
+                m_broadPhase.getProxy(m_broadPhasePairs[i].first);
+        const BroadPhaseProxy &p2 =
+                m_broadPhase.getProxy(m_broadPhasePairs[i].second);
+
+        bool result = false;
+        if (NO_ERR != m_cd.check(p1.bb, p2.bb, result)) {
+            LOG_FAILURE("Failed to check for collisions");
+            return ERR_INVALID;
+        }
+
+        if (!result) {
+            continue;
+        }
+
+        isCollisionDetected = true;
+
+        // Report the collision on the rigid body holding each moving object
+        const BroadPhaseProxy* proxies[2] = {&p1, &p2};
+        for (size_t j = 0; j < 2; j++) {
+            if (!proxies[j]->isDynamic) {
+                continue;
+            }
+            int indexRigidBody = 0;
+            m_mapObjects[proxies[j]->owner]->getIsLocked(indexRigidBody);
+            Node* node = m_cp->getNodeOfRigidBody(indexRigidBody);
+            node->setIsCollisionDetected(true);
+            addCollision(indexRigidBody, proxies[1 - j]->owner, false);
+        }
+    }
+
     return NO_ERR;
 }
 
+void Kinematics::addCollision(
+        int32_t robotLink, int32_t rigidBody, bool isSelfCollision)
+{
+    if (m_collisions.find(robotLink) == m_collisions.end()) {
+        Collision collision;
+        collision.robotLink = robotLink;
+        collision.numCollisions = 0;
+        m_collisions[robotLink] = collision;
+    }
+
+    Collision &collision = m_collisions[robotLink];
+    if (collision.numCollisions < MAX_COLLISIONS) {
+        collision.rigidBody[collision.numCollisions] = rigidBody;
+        collision.isSelfCollision[collision.numCollisions] = isSelfCollision;
+        collision.numCollisions++;
+    }
+}
+
 bool Kinematics::isInCollisionDetectionList(Node* node)
 {
     for (size_t i = 0; i < m_cp->getRbs()->collision_detection().self_collisions().size(); i++) {
@@ -337,25 +496,19 @@ void Kinematics::updateCurrentJointValues(Node* node)
 GuiStatusMessage_t Kinematics::extractStatusMessage(
         double jvDuration, double fkDuration)
 {
-    static double sumTime = 0.0;
-
-    if (m_minKinematicsCycle > fkDuration) {
-        m_minKinematicsCycle = fkDuration;
-    }
-
-    if (m_maxKinematicsCycle < fkDuration) {
-        m_maxKinematicsCycle = fkDuration;
-    }
-
-    sumTime += fkDuration;
-
-    m_avgKinematicsCycle = sumTime / getCounter();
+    // Kept here rather than read from the registry, whose percentiles take
+    // the histogram locks; clients get those with REQUEST_STATISTICS
+    m_minKinematicsCycle = std::min(m_minKinematicsCycle, fkDuration);
+    m_maxKinematicsCycle = std::max(m_maxKinematicsCycle, fkDuration);
+    m_sumKinematicsCycle += fkDuration;
+    m_numKinematicsCycles++;
 
     GuiStatusMessage_t statusMessage;
     statusMessage.faultLevel = FAULT_LEVEL_NOFAULT;
     statusMessage.faultType = FAULT_TYPE_NOFAULT;
     std::ostringstream avg, min, max;
-    avg << std::fixed << std::setprecision(2) << m_avgKinematicsCycle;
+    avg << std::fixed << std::setprecision(2) <<
+            m_sumKinematicsCycle / (double)m_numKinematicsCycles;
     min << std::fixed << std::setprecision(2) << m_minKinematicsCycle;
     max << std::fixed << std::setprecision(2) << m_maxKinematicsCycle;
 
@@ -588,36 +741,43 @@ Errors Kinematics::initializeObjectsXfms()
 
 Errors Kinematics::lockObjectsToRb(int indexObject, int indexRb)
 {
-    std::unique_lock<std::mutex> lock(m_mutexObjects);
+    {
+        std::unique_lock<std::mutex> lock(m_mutexObjects);
 
-    std::map<int, Object*>::iterator it = m_mapObjects.find(indexObject);
+        std::map<int, Object*>::iterator it = m_mapObjects.find(indexObject);
 
-    if (it == m_mapObjects.end()) {
-        LOG_FAILURE("Failed to find object %d", indexObject);
-        return ERR_INVALID;
-    }
+        if (it == m_mapObjects.end()) {
+            LOG_FAILURE("Failed to find object %d", indexObject);
+            return ERR_INVALID;
+        }
 
-    it->second->setIsLocked(true, indexRb);
+        it->second->setIsLocked(true, indexRb);
 
-    Matrix4d xfm_rb_world = m_cp->getNodeOfRigidBody(indexRb)->getXfm().inverse();
-    it->second->setXfmObjectToRb(xfm_rb_world * it->second->getXfm());
+        Matrix4d xfm_rb_world =
+                m_cp->getNodeOfRigidBody(indexRb)->getXfm().inverse();
+        it->second->setXfmObjectToRb(xfm_rb_world * it->second->getXfm());
+    }
 
+    publishSceneChange();
     return NO_ERR;
 }
 
 Errors Kinematics::unlockObjectsFromRigidBody(int indexObject)
 {
-    std::unique_lock<std::mutex> lock(m_mutexObjects);
+    {
+        std::unique_lock<std::mutex> lock(m_mutexObjects);
 
-    std::map<int, Object*>::iterator it = m_mapObjects.find(indexObject);
+        std::map<int, Object*>::iterator it = m_mapObjects.find(indexObject);
 
-    if (it == m_mapObjects.end()) {
-        LOG_FAILURE("Failed to find object %d", indexObject);
-        return ERR_INVALID;
-    }
+        if (it == m_mapObjects.end()) {
+            LOG_FAILURE("Failed to find object %d", indexObject);
+            return ERR_INVALID;
+        }
 
-    it->second->setIsLocked(false, 0);
+        it->second->setIsLocked(false, 0);
+    }
 
+    publishSceneChange();
     return NO_ERR;
 }
 
@@ -637,15 +797,27 @@ Errors Kinematics::getObjectFrame(int indexObject, Matrix4d &xfm)
 
 Errors Kinematics::setObjectFrame(int indexObject, const Matrix4d &xfm)
 {
-    std::unique_lock<std::mutex> lock(m_mutexObjects);
-    std::map<int, Object*>::iterator it = m_mapObjects.find(indexObject);
+    {
+        std::unique_lock<std::mutex> lock(m_mutexObjects);
+        std::map<int, Object*>::iterator it = m_mapObjects.find(indexObject);
 
-    if (it == m_mapObjects.end()) {
-        LOG_FAILURE("Failed to find object %d", indexObject);
-        return ERR_INVALID;
+        if (it == m_mapObjects.end()) {
+            LOG_FAILURE("Failed to find object %d", indexObject);
+            return ERR_INVALID;
+        }
+
+        it->second->setXfm(xfm);
     }
 
-    it->second->setXfm(xfm);
+    // Queries and the GUI see the object moved at once
+    publishSceneChange();
+    return NO_ERR;
+}
+
+Errors Kinematics::setBaseFrame(const Matrix4d &xfm)
+{
+    m_root->setXfm(xfm);
+    publishSceneChange();
     return NO_ERR;
 }
 
@@ -702,17 +874,189 @@ unsigned int Kinematics::getCounter()
 
 void Kinematics::setCounter(unsigned int counter)
 {
-    std::unique_lock<std::mutex> lock(m_mutexCounter);
-    m_counter = counter;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCounter);
+        m_counter = counter;
+    }
+    publishCounter();
 }
 
 void Kinematics::incCounter()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCounter);
+        m_counter++;
+    }
+    publishCounter();
+}
+
+void Kinematics::publishCounter()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCounter);
+        m_publishedCounter = m_counter;
+    }
+    m_cvCounter.notify_all();
+}
+
+unsigned int Kinematics::getSceneRevision()
+{
+    std::unique_lock<std::mutex> lock(m_mutexCounter);
+    return m_sceneRevision;
+}
+
+void Kinematics::publishSceneChange()
+{
+    updateSnapshot();
+    {
+        std::unique_lock<std::mutex> lock(m_mutexCounter);
+        m_sceneRevision++;
+    }
+    m_cvCounter.notify_all();
+}
+
+bool Kinematics::waitForChange(
+        unsigned int &counter, unsigned int &sceneRevision, int timeoutMs)
 {
     std::unique_lock<std::mutex> lock(m_mutexCounter);
-    m_counter++;
+    bool isChanged = m_cvCounter.wait_for(lock,
+            std::chrono::milliseconds(timeoutMs),
+            [this, counter, sceneRevision]() {
+                return m_publishedCounter != counter ||
+                       m_sceneRevision != sceneRevision; });
+    counter = m_publishedCounter;
+    sceneRevision = m_sceneRevision;
+    return isChanged;
 }
 
 
+void Kinematics::updateSnapshot()
+{
+    // Buffers are reused once no reader holds them; the current one is also
+    // held by m_snapshot. With the same joints, bodies and objects every
+    // cycle, refilling one allocates nothing. The GUI thread also runs
+    // forward kinematics, hence the lock.
+    std::unique_lock<std::mutex> lockBuffers(m_mutexSnapshotBuffers);
+    std::shared_ptr<KinematicsSnapshot_t> snapshot;
+    for (auto &buffer: m_snapshotBuffers) {
+        if (buffer.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            snapshot = buffer;
+            break;
+        }
+    }
+    if (nullptr == snapshot) {
+        snapshot = std::make_shared<KinematicsSnapshot_t>();
+        m_snapshotBuffers.push_back(snapshot);
+    }
+
+    snapshot->counter = getCounter();
+    getJointValues(snapshot->jointValues);
+    snapshot->xfmEndEffector = getXfmEndEffector();
+
+    Matrix4d xfm;
+    for (int i = 0; i < m_cp->getRbs()->rigid_bodies_size(); i++) {
+        int index = m_cp->getRbs()->rigid_bodies(i).index();
+        Node* node = m_cp->getNodeOfRigidBody(index);
+        if (nullptr == node) {
+            continue;
+        }
+
+        std::vector<Matrix4d> &frames = snapshot->rigidBodyFrames[index];
+        frames.clear();
+        for (unsigned int k = 0; NO_ERR == node->getFrame(k, xfm); k++) {
+            frames.push_back(xfm);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexObjects);
+        if (snapshot->objectFrames.size() != m_mapObjects.size() ||
+                !std::equal(m_mapObjects.begin(), m_mapObjects.end(),
+                    snapshot->objectFrames.begin(),
+                    [](const std::pair<const int, Object*> &a,
+                       const std::pair<const int, Matrix4d> &b) {
+                        return a.first == b.first;
+                    })) {
+            snapshot->objectFrames.clear();
+        }
+        for (auto pair: m_mapObjects) {
+            snapshot->objectFrames[pair.first] = pair.second->getXfm();
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexSnapshot);
+    m_snapshot = snapshot;
+}
+
+void Kinematics::logPose()
+{
+    std::unique_lock<std::mutex> lock(m_mutexPoseLog);
+    if (!m_poseLog) {
+        return;
+    }
+
+    // Rigid body frames follow from the joint values and are left out
+    std::shared_ptr<const KinematicsSnapshot_t> snapshot = getSnapshot();
+    std::shared_ptr<PoseRecord_t> record = std::make_shared<PoseRecord_t>();
+    record->timeNs = getMonotonicTimeNs();
+    record->counter = snapshot->counter;
+    record->jointValues = snapshot->jointValues;
+    record->objectFrames = snapshot->objectFrames;
+    if (nullptr != m_tool) {
+        record->toolName = m_cp->getToolName();
+    }
+    record->collisions = m_collisions;
+    m_poseLog->append(record);
+}
+
+Errors Kinematics::startPoseLog(const std::string &fileName)
+{
+    stopPoseLog();
+
+    std::unique_ptr<PoseLogWriter> poseLog(new PoseLogWriter(fileName));
+    if (NO_ERR != poseLog->start()) {
+        LOG_FAILURE("Failed to start the pose log %s", fileName.c_str());
+        return ERR_INVALID;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexPoseLog);
+    m_poseLog = std::move(poseLog);
+    return NO_ERR;
+}
+
+void Kinematics::stopPoseLog()
+{
+    // The writer is flushed without holding up the kinematics cycle
+    std::unique_ptr<PoseLogWriter> poseLog;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPoseLog);
+        poseLog = std::move(m_poseLog);
+    }
+    if (poseLog) {
+        poseLog->stop();
+    }
+}
+
+std::shared_ptr<const KinematicsSnapshot_t> Kinematics::getSnapshot() const
+{
+    std::unique_lock<std::mutex> lock(m_mutexSnapshot);
+    return m_snapshot;
+}
+
+void Kinematics::getCycleDurations(double &fkDuration, double &jvDuration)
+{
+    std::unique_lock<std::mutex> lock(m_mutexCycleDurations);
+    fkDuration = m_fkDuration;
+    jvDuration = m_jvDuration;
+}
+
+double Kinematics::getCollisionDuration()
+{
+    std::unique_lock<std::mutex> lock(m_mutexCycleDurations);
+    return m_collisionDuration;
+}
+
 Errors Kinematics::getJointValues(std::map<int, double> &jointValues)
 {
     if (NO_ERR != getNodeJointValue(m_root, jointValues)) {
@@ -726,8 +1070,8 @@ Errors Kinematics::getNodeJointValue(
         Node* node, std::map<int, double> &jointValues)
 {
     if (node != m_root) {
-        jointValues.insert(std::pair<int, double>(
-            node->getMateToParent()->index(), node->getCurrentJointValue()));
+        jointValues[node->getMateToParent()->index()] =
+                node->getCurrentJointValue();
     }
 
     for (unsigned int i = 0; i < node->getChildren().size(); i++) {
@@ -25,6 +25,11 @@
 //INCLUDES
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <stdexcept>
 #include <Eigen/Dense>
 
@@ -40,12 +45,26 @@
 
 namespace tarsim {
 // FORWARD DECLARATIONS
+class PoseLogWriter;
 // TYPEDEFS AND DEFINES
 // ENUMS
 // NAMESPACES AND STRUCTS
 
 using namespace Eigen;
 
+/**
+ * Pose of the whole system at the end of a forward kinematics cycle. It is
+ * not modified while anyone holds it, so readers need no lock to use it.
+ */
+struct KinematicsSnapshot_t
+{
+    unsigned int counter = 0;
+    std::map<int, double> jointValues;
+    Matrix4d xfmEndEffector = Matrix4d::Identity();
+    std::map<int, std::vector<Matrix4d>> rigidBodyFrames; // by rigid body index
+    std::map<int, Matrix4d> objectFrames; // by object index
+};
+
 // CLASS DEFINITION
 class Kinematics
 {
@@ -57,13 +76,53 @@ public:
     Errors executeForwardKinematics(
             GuiStatusMessage_t &statusMessage,
             std::map<int32_t, Collision> &collisions);
+
+    /**
+     * Calculates the end-effector frame of the target joint values, and
+     * their collisions if asked, without making them the current pose or
+     * counting a cycle. For offline queries on a Kinematics of their own.
+     * @param xfmEndEffector End-effector frame in world coordinate frame
+     * @param shouldDetectCollisions Whether to detect collisions, whether or
+     * not collision detection is active in the config
+     * @param collisions Collisions by robot link, empty if not detected
+     */
+    Errors evaluate(
+            Matrix4d &xfmEndEffector,
+            bool shouldDetectCollisions,
+            std::map<int32_t, Collision> &collisions);
     Node* getRoot();
+
+    /**
+     * Moves the robot base. Rigid bodies follow at the next forward
+     * kinematics cycle.
+     */
+    Errors setBaseFrame(const Matrix4d &xfm);
+
     ThreadQueue<Camera_t>* getCameraDataQueue();
 
     unsigned int getCounter();
     void setCounter(unsigned int counter);
     void incCounter();
 
+    /**
+     * Gets the revision of what moves without forward kinematics, i.e. the
+     * object frames and locks and the robot base
+     */
+    unsigned int getSceneRevision();
+
+    /**
+     * Waits for the counter of the last complete pose or the scene revision
+     * to differ from the ones given, i.e. for the scene to change. The
+     * counter is increased as forward kinematics starts, but waiters are
+     * woken once it ends.
+     * @param counter The counter seen last, updated
+     * @param sceneRevision The scene revision seen last, updated
+     * @param timeoutMs Longest wait
+     * @return false if the wait timed out
+     */
+    bool waitForChange(
+            unsigned int &counter, unsigned int &sceneRevision, int timeoutMs);
+
     Errors lockObjectsToRb(int indexObject, int indexRb);
     Errors unlockObjectsFromRigidBody(int indexObject);
 
@@ -75,10 +134,35 @@ public:
 
     Errors getJointValues(std::map<int, double> &jointValues);
 
+    void getCycleDurations(double &fkDuration, double &jvDuration);
+
+    /**
+     * Gets how long collision detection took in the latest forward
+     * kinematics cycle, in ms. Zero if it did not run.
+     */
+    double getCollisionDuration();
+
+    /**
+     * Gets the pose published by the latest forward kinematics cycle
+     */
+    std::shared_ptr<const KinematicsSnapshot_t> getSnapshot() const;
+
     std::map<int, Object*> getObjects();
 
     Errors installTool();
     Errors setEndEffector(int32_t robotLink, int32_t linkFrame);
+
+    /**
+     * Logs the pose of every forward kinematics cycle to a pose log, until
+     * stopPoseLog. The cycle only queues its record to the log's thread.
+     * @param fileName Pose log to write, replaced if it exists
+     */
+    Errors startPoseLog(const std::string &fileName);
+
+    /**
+     * Writes the poses still queued and closes the pose log
+     */
+    void stopPoseLog();
     // MEMBERS
 private:
     // FUNCTIONS
@@ -88,6 +172,7 @@ private:
     Errors calculateChildrenXfm(Node* node, Matrix4d &xfmEndEffector);
     Errors calculateNodeToParentXfm(Node* node, Matrix4d &xfmNodeToParent);
     Errors calculateObjectsXfm();
+    void publishCounter();
 
     Errors calculateXfmRevoluteJoint(
             Matrix4d &xfmCurrentJointToParentJoint, Node* node);
@@ -110,10 +195,16 @@ private:
     Errors detectCollisionNodeCluster(
             Node* node, Node* cluster, bool &isCollisionDetected);
     Errors detectCollisionNodeNode(Node* node1, Node* node2, bool &isCollision);
+    Errors detectCollisionObjectObjects(bool &isCollisionDetected);
     bool isInCollisionDetectionList(Node* node);
+    void addCollision(
+            int32_t robotLink, int32_t rigidBody, bool isSelfCollision);
 
     void updateCurrentXfms(Node* node);
     void updateCurrentJointValues(Node* node);
+    void updateSnapshot();
+    void publishSceneChange();
+    void logPose();
 
     // MEMBERS
     ConfigParser* m_cp = nullptr;
@@ -123,14 +214,18 @@ private:
     Matrix4d m_xfmEndEffector = Matrix4d::Zero();
 
     unsigned int m_counter = 0;
+    unsigned int m_publishedCounter = 0;
+    unsigned int m_sceneRevision = 0;
     mutable std::mutex m_mutexCounter;
+    std::condition_variable m_cvCounter;
 
     ThreadQueue<Camera_t> m_cameraDataQueue;
 
     mutable std::mutex m_mutexObjects;
     std::map<int, Object*> m_mapObjects;
 
-    double m_avgKinematicsCycle = 0.0;
+    double m_sumKinematicsCycle = 0.0;
+    uint64_t m_numKinematicsCycles = 0;
     double m_minKinematicsCycle = 1e6;
     double m_maxKinematicsCycle = -1e6;
     double m_controlCycle = 1.0;
@@ -140,11 +235,26 @@ private:
     std::chrono::high_resolution_clock::time_point m_timePreviousJointValues =
             std::chrono::high_resolution_clock::now();
 
+    double m_fkDuration = 0.0;
+    double m_jvDuration = 0.0;
+    double m_collisionDuration = 0.0;
+    mutable std::mutex m_mutexCycleDurations;
+
+    mutable std::mutex m_mutexSnapshot;
+    std::shared_ptr<const KinematicsSnapshot_t> m_snapshot;
+    std::mutex m_mutexSnapshotBuffers;
+    std::vector<std::shared_ptr<KinematicsSnapshot_t>> m_snapshotBuffers;
+
     CollisionDetection m_cd;
+    BroadPhase m_broadPhase;
+    std::vector<std::pair<size_t, size_t>> m_broadPhasePairs;
 
     std::map<int32_t, Collision> m_collisions;
 
     Object* m_tool = nullptr;
+
+    std::unique_ptr<PoseLogWriter> m_poseLog;
+    mutable std::mutex m_mutexPoseLog;
 };
 } // end of namespace tarsim
 // ENDIF
@@ -0,0 +1,329 @@
+/**
+ * @file: kinematicsInterface.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Python extension running BatchKinematics on NumPy arrays. The
+ * GIL is released while a batch runs.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "Python.h"
+
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/ndarrayobject.h>
+#include <stdexcept>
+#include <string>
+#include "batchKinematics.h"
+
+namespace tarsim {
+extern "C" {
+
+static PyObject* g_kinematicsError = nullptr;
+static const char* k_capsuleName = "tarsim.kinematics.BatchKinematics";
+
+// Function that wraps python exception throwing
+static PyObject* KinematicsError(const std::string &msg)
+{
+    if (g_kinematicsError == nullptr) {
+        printf("Exceptions not initialized.");
+        fflush(stdout);
+        return nullptr;
+    }
+
+    PyErr_SetString(g_kinematicsError, msg.c_str());
+    return nullptr;
+}
+
+static void deleteKinematics(PyObject* capsule)
+{
+    delete (BatchKinematics*)PyCapsule_GetPointer(capsule, k_capsuleName);
+}
+
+static BatchKinematics* toKinematics(PyObject* capsule)
+{
+    BatchKinematics* kinematics =
+            (BatchKinematics*)PyCapsule_GetPointer(capsule, k_capsuleName);
+    if (kinematics == nullptr) {
+        KinematicsError("Kinematics was not loaded.");
+    }
+    return kinematics;
+}
+
+// Takes the configurations as a C contiguous float64 array of a row per
+// configuration, without a copy if it already is one
+static PyArrayObject* toConfigurations(
+        PyObject* obj, const BatchKinematics* kinematics)
+{
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROM_OTF(
+            obj, NPY_FLOAT64, NPY_ARRAY_IN_ARRAY);
+    if (array == nullptr) {
+        KinematicsError("Configurations must be a float64 array.");
+        return nullptr;
+    }
+
+    npy_intp numJoints = (npy_intp)kinematics->getJointIndices().size();
+    if (PyArray_NDIM(array) != 2 || PyArray_DIM(array, 1) != numJoints) {
+        Py_DECREF(array);
+        KinematicsError("Configurations must be an array of N x " +
+                std::to_string(numJoints) + " joint values.");
+        return nullptr;
+    }
+    return array;
+}
+
+static PyObject* load_wrap(PyObject* /*self*/, PyObject* args)
+{
+    const char* configFolderName;
+    int numThreads = 0;
+    if (!PyArg_ParseTuple(args, "s|i", &configFolderName, &numThreads)) {
+        return KinematicsError("Failed to parse arguments.");
+    }
+
+    std::string folder(configFolderName);
+    BatchKinematics* kinematics = nullptr;
+    std::string error;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        kinematics = new BatchKinematics(folder, numThreads);
+    } catch (const std::exception &e) {
+        error = e.what();
+    } catch (...) {
+        error = "Unknown fault occurred";
+    }
+    Py_END_ALLOW_THREADS
+    if (kinematics == nullptr) {
+        return KinematicsError("Failed to load " + folder + ": " + error);
+    }
+
+    PyObject* capsule = PyCapsule_New(
+            kinematics, k_capsuleName, deleteKinematics);
+    if (capsule == nullptr) {
+        delete kinematics;
+    }
+    return capsule;
+}
+
+static PyObject* jointIndices_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* capsule;
+    if (!PyArg_ParseTuple(args, "O", &capsule)) {
+        return KinematicsError("Failed to parse arguments.");
+    }
+
+    BatchKinematics* kinematics = toKinematics(capsule);
+    if (kinematics == nullptr) {
+        return nullptr;
+    }
+
+    const std::vector<int32_t> &indices = kinematics->getJointIndices();
+    npy_intp dims[1] = {(npy_intp)indices.size()};
+    PyObject* array = PyArray_SimpleNew(1, dims, NPY_INT32);
+    if (array == nullptr) {
+        return nullptr;
+    }
+    std::copy(indices.begin(), indices.end(),
+            (int32_t*)PyArray_DATA((PyArrayObject*)array));
+    return array;
+}
+
+static PyObject* fkBatch_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* capsule;
+    PyObject* positionsObj;
+    if (!PyArg_ParseTuple(args, "OO", &capsule, &positionsObj)) {
+        return KinematicsError("Failed to parse arguments.");
+    }
+
+    BatchKinematics* kinematics = toKinematics(capsule);
+    if (kinematics == nullptr) {
+        return nullptr;
+    }
+
+    PyArrayObject* positions = toConfigurations(positionsObj, kinematics);
+    if (positions == nullptr) {
+        return nullptr;
+    }
+
+    npy_intp frameDims[3] = {PyArray_DIM(positions, 0), 4, 4};
+    PyObject* frames = PyArray_SimpleNew(3, frameDims, NPY_FLOAT64);
+    PyObject* errorIds = PyArray_SimpleNew(1, frameDims, NPY_INT32);
+    if (frames == nullptr || errorIds == nullptr) {
+        Py_DECREF(positions);
+        Py_XDECREF(frames);
+        Py_XDECREF(errorIds);
+        return nullptr;
+    }
+
+    const double* positionsData = (const double*)PyArray_DATA(positions);
+    double* framesData = (double*)PyArray_DATA((PyArrayObject*)frames);
+    int32_t* errorIdsData = (int32_t*)PyArray_DATA((PyArrayObject*)errorIds);
+    Errors error = NO_ERR;
+    std::string exception;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        error = kinematics->forwardKinematics(positionsData, frameDims[0],
+                framesData, errorIdsData);
+    } catch (const std::exception &e) {
+        exception = e.what();
+    } catch (...) {
+        exception = "Unknown fault occurred";
+    }
+    Py_END_ALLOW_THREADS
+    Py_DECREF(positions);
+    if (!exception.empty()) {
+        Py_DECREF(frames);
+        Py_DECREF(errorIds);
+        return KinematicsError(
+                "Failed to calculate forward kinematics: " + exception);
+    }
+    if (NO_ERR != error) {
+        Py_DECREF(frames);
+        Py_DECREF(errorIds);
+        return KinematicsError("Failed to calculate forward kinematics.");
+    }
+
+    return Py_BuildValue("NN", frames, errorIds);
+}
+
+static PyObject* collideBatch_wrap(PyObject* /*self*/, PyObject* args)
+{
+    PyObject* capsule;
+    PyObject* positionsObj;
+    if (!PyArg_ParseTuple(args, "OO", &capsule, &positionsObj)) {
+        return KinematicsError("Failed to parse arguments.");
+    }
+
+    BatchKinematics* kinematics = toKinematics(capsule);
+    if (kinematics == nullptr) {
+        return nullptr;
+    }
+
+    PyArrayObject* positions = toConfigurations(positionsObj, kinematics);
+    if (positions == nullptr) {
+        return nullptr;
+    }
+
+    npy_intp collisionDims[2] = {PyArray_DIM(positions, 0), 2};
+    PyObject* numCollisions = PyArray_SimpleNew(2, collisionDims, NPY_INT32);
+    PyObject* errorIds = PyArray_SimpleNew(1, collisionDims, NPY_INT32);
+    if (numCollisions == nullptr || errorIds == nullptr) {
+        Py_DECREF(positions);
+        Py_XDECREF(numCollisions);
+        Py_XDECREF(errorIds);
+        return nullptr;
+    }
+
+    const double* positionsData = (const double*)PyArray_DATA(positions);
+    int32_t* numCollisionsData =
+            (int32_t*)PyArray_DATA((PyArrayObject*)numCollisions);
+    int32_t* errorIdsData = (int32_t*)PyArray_DATA((PyArrayObject*)errorIds);
+    Errors error = NO_ERR;
+    std::string exception;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        error = kinematics->detectCollisions(positionsData, collisionDims[0],
+                numCollisionsData, errorIdsData);
+    } catch (const std::exception &e) {
+        exception = e.what();
+    } catch (...) {
+        exception = "Unknown fault occurred";
+    }
+    Py_END_ALLOW_THREADS
+    Py_DECREF(positions);
+    if (!exception.empty()) {
+        Py_DECREF(numCollisions);
+        Py_DECREF(errorIds);
+        return KinematicsError("Failed to detect collisions: " + exception);
+    }
+    if (NO_ERR != error) {
+        Py_DECREF(numCollisions);
+        Py_DECREF(errorIds);
+        return KinematicsError("Failed to detect collisions.");
+    }
+
+    return Py_BuildValue("NN", numCollisions, errorIds);
+}
+
+// An array specifying exactly which methods are wrappers.
+// The syntax for each item is:
+// {String for the method name when converted to python code,
+//  Name of C++ wrapper method,
+//  METH_VARARGS,
+//  String which will go into the methods' docstrings in python}
+static PyMethodDef KinematicsInterface_methods[] = {
+    {"load", load_wrap, METH_VARARGS,
+    "Loads a config folder once per thread"},
+
+    {"jointIndices", jointIndices_wrap, METH_VARARGS,
+    "Mate indices of the columns of a configuration"},
+
+    {"fkBatch", fkBatch_wrap, METH_VARARGS,
+    "End-effector frames (N x 4 x 4) and error ids (N) of N configurations"},
+
+    {"collideBatch", collideBatch_wrap, METH_VARARGS,
+    "Self and external collision counts (N x 2) and error ids (N) of N configurations"},
+
+    {nullptr, nullptr, 0, nullptr}};
+
+#if PY_MAJOR_VERSION >= 3
+
+// Define module info. Note: See python docs for syntax.
+static struct PyModuleDef moduledef = {PyModuleDef_HEAD_INIT,
+                                         "_kinematics",
+                                         nullptr, // Documention.
+                                         -1,
+                                         KinematicsInterface_methods,
+                                         nullptr,
+                                         nullptr,
+                                         nullptr,
+                                         nullptr};
+
+#define INITERROR return NULL
+PyMODINIT_FUNC PyInit__kinematics(void)
+#else
+#define INITERROR return
+void init_kinematics(void)
+#endif
+{
+    import_array();
+
+#if PY_MAJOR_VERSION >= 3
+    PyObject* module = PyModule_Create(&moduledef);
+#else
+    PyObject *module = Py_InitModule("_kinematics", KinematicsInterface_methods);
+#endif
+
+    if (module == nullptr)
+        INITERROR;
+
+    char errorString[] = "tarsim.kinematics.Error";
+    g_kinematicsError = PyErr_NewException(errorString, nullptr, nullptr);
+    if (g_kinematicsError == nullptr) {
+        Py_DECREF(module);
+        INITERROR;
+    }
+
+    Py_INCREF(g_kinematicsError);
+    PyModule_AddObject(module, "error", g_kinematicsError);
+
+#if PY_MAJOR_VERSION >= 3
+    return module;
+#endif
+}
+
+} //extern "C"
+
+} // end of namespace tarsim
@@ -0,0 +1,36 @@
+"""
+Forward kinematics and collision detection of many configurations, in this
+process and without the simulator running.
+
+    from tarsim import kinematics
+    model = kinematics.Kinematics('/path/to/config')
+    frames, errorIds = model.fk_batch(q)
+    numCollisions, errorIds = model.collide_batch(q)
+
+q holds a configuration per row, its columns are the joints of
+model.joint_indices. frames is N x 4 x 4, numCollisions is N x 2 with the
+self and external collisions, and errorIds is ERR_JOINT_POSITION_LIMIT for
+configurations calculated at the limits of a joint, 0 otherwise.
+"""
+
+import numpy
+
+from tarsim import _kinematics
+
+error = _kinematics.error
+
+
+class Kinematics():
+    def __init__(self, configFolder, num_threads=0):
+        self.handle = _kinematics.load(configFolder, num_threads)
+        self.joint_indices = _kinematics.jointIndices(self.handle)
+
+    @property
+    def dof(self):
+        return len(self.joint_indices)
+
+    def fk_batch(self, q):
+        return _kinematics.fkBatch(self.handle, numpy.atleast_2d(q))
+
+    def collide_batch(self, q):
+        return _kinematics.collideBatch(self.handle, numpy.atleast_2d(q))
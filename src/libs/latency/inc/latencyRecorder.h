@@ -0,0 +1,153 @@
+/**
+ *
+ * @file: latencyRecorder.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Latency histograms of the messages, by message id and stage. The
+ * durations come from the monotonic timestamps of the message header and
+ * from the stages timed by the receiver. A histogram keeps 16 buckets per
+ * power of two, so its percentiles are within 1/16 of the value at any
+ * scale while it stays the same size however many samples it takes.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_LATENCYRECORDER_INC_H_
+#define SRC_LIBS_LATENCYRECORDER_INC_H_
+
+//INCLUDES
+#include <array>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ipcMessages.h"
+#include "messageFraming.h"
+#include "simulatorMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int LATENCY_SUB_BUCKET_BITS = 4; // 16 buckets per power of two
+static const int LATENCY_MAX_EXPONENT = 40; // 2^41 ns (36 minutes) or more is clamped
+static const int LATENCY_NUM_BUCKETS = (1 << LATENCY_SUB_BUCKET_BITS) *
+        (LATENCY_MAX_EXPONENT - LATENCY_SUB_BUCKET_BITS + 2);
+
+/**
+ * Message id a latency is recorded under. A fragment counts for the payload
+ * it carries, so that every variable-length message has its own histogram.
+ */
+inline int32_t getLatencyMsgId(const MessageHeader_t &header)
+{
+    if (FRAMED_MESSAGE == header.msgId) {
+        return static_cast<const FramedMessage_t&>(header).payloadId;
+    }
+    return header.msgId;
+}
+
+/**
+ * @return name of a stage, as written in the CSV
+ */
+const char* getLatencyStageName(int32_t stage);
+
+class LatencyHistogram
+{
+public:
+    void record(int64_t durationNs);
+    void reset();
+
+    int64_t getCount() const;
+    int64_t getMax() const;
+
+    /**
+     * @param fraction Fraction of the samples at or below the value, e.g. 0.99
+     * @return upper bound of the bucket holding the percentile, never more
+     * than the max
+     */
+    int64_t getPercentile(double fraction) const;
+
+    static int getBucket(int64_t durationNs);
+    static int64_t getBucketUpperBound(int bucket);
+
+private:
+    std::array<uint64_t, LATENCY_NUM_BUCKETS> m_buckets {};
+    int64_t m_count = 0;
+    int64_t m_max = 0;
+};
+
+class LatencyRecorder
+{
+public:
+    /**
+     * Records the time from start to end of a stage. Messages of the
+     * messaging layer (e.g. timer and exit events) and unset or out of
+     * order timestamps are ignored.
+     * @param msgId Message id, see getLatencyMsgId
+     * @param stage Stage timed
+     * @param startNs Monotonic time the stage started
+     * @param endNs Monotonic time the stage ended
+     */
+    void record(
+            int32_t msgId, LatencyStages stage, int64_t startNs, int64_t endNs);
+
+    /**
+     * Records the duration of a stage timed by other means
+     */
+    void recordDuration(
+            int32_t msgId, LatencyStages stage, int64_t durationNs);
+
+    /**
+     * Records how long the transport took to deliver a message
+     */
+    void recordTransport(const MessageHeader_t &header);
+
+    /**
+     * @return percentiles of every message id and stage recorded so far
+     */
+    std::vector<LatencyStatistics_t> getStatistics() const;
+    void reset();
+
+private:
+    mutable std::mutex m_mutexHistograms;
+    std::map<std::pair<int32_t, int32_t>, LatencyHistogram> m_histograms;
+};
+
+/**
+ * Writes latency statistics to a LATENCY_STATS payload: the number of
+ * entries, then every field of each entry
+ */
+void writeLatencyStatistics(
+        MessageWriter &writer,
+        const std::vector<LatencyStatistics_t> &statistics);
+
+/**
+ * Reads latency statistics written by writeLatencyStatistics
+ * @return false if the payload is too short
+ */
+bool readLatencyStatistics(
+        MessageReader &reader, std::vector<LatencyStatistics_t> &statistics);
+
+/**
+ * Writes latency statistics as CSV, one line per message id and stage of
+ * each side, e.g. the client and the simulator
+ * @param fileName File to write, replaced if it exists
+ * @param sides Name of each side and its statistics
+ * @return false if the file could not be written
+ */
+bool writeLatencyCsv(
+        const std::string &fileName,
+        const std::vector<std::pair<std::string,
+                std::vector<LatencyStatistics_t>>> &sides);
+} // end of namespace tarsim
+#endif /* SRC_LIBS_LATENCYRECORDER_INC_H_ */
@@ -0,0 +1,240 @@
+/**
+ * @file: latencyRecorder.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of LatencyRecorder
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "latencyRecorder.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+namespace tarsim {
+
+const char* getLatencyStageName(int32_t stage)
+{
+    switch (stage) {
+        case LATENCY_TRANSPORT: return "transport";
+        case LATENCY_SEND: return "send";
+        case LATENCY_DISPATCH: return "dispatch";
+        case LATENCY_HANDLER: return "handler";
+        case LATENCY_KINEMATICS: return "kinematics";
+        case LATENCY_COLLISION: return "collision";
+        case LATENCY_ROUND_TRIP: return "round_trip";
+        default: return "unknown";
+    }
+}
+
+int LatencyHistogram::getBucket(int64_t durationNs)
+{
+    const int numSubBuckets = 1 << LATENCY_SUB_BUCKET_BITS;
+    if (durationNs < numSubBuckets) {
+        return (int)std::max<int64_t>(durationNs, 0);
+    }
+
+    // The leading bit picks the power of two, the bits after it the bucket
+    int exponent = 63 - __builtin_clzll((uint64_t)durationNs);
+    if (exponent > LATENCY_MAX_EXPONENT) {
+        return LATENCY_NUM_BUCKETS - 1;
+    }
+    int shift = exponent - LATENCY_SUB_BUCKET_BITS;
+    int subBucket = (int)(durationNs >> shift) - numSubBuckets;
+    return (shift + 1) * numSubBuckets + subBucket;
+}
+
+int64_t LatencyHistogram::getBucketUpperBound(int bucket)
+{
+    const int numSubBuckets = 1 << LATENCY_SUB_BUCKET_BITS;
+    if (bucket < numSubBuckets) {
+        return bucket;
+    }
+
+    int shift = bucket / numSubBuckets - 1;
+    int64_t subBucket = bucket % numSubBuckets;
+    return ((numSubBuckets + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t durationNs)
+{
+    m_buckets[getBucket(durationNs)]++;
+    m_count++;
+    m_max = std::max(m_max, durationNs);
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+int64_t LatencyHistogram::getCount() const
+{
+    return m_count;
+}
+
+int64_t LatencyHistogram::getMax() const
+{
+    return m_max;
+}
+
+int64_t LatencyHistogram::getPercentile(double fraction) const
+{
+    if (0 == m_count) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)std::ceil(fraction * m_count);
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t numSamples = 0;
+    for (int i = 0; i < LATENCY_NUM_BUCKETS; i++) {
+        numSamples += m_buckets[i];
+        if (numSamples >= rank) {
+            return std::min(getBucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+void LatencyRecorder::record(
+        int32_t msgId, LatencyStages stage, int64_t startNs, int64_t endNs)
+{
+    if (startNs <= 0 || endNs < startNs) {
+        return;
+    }
+    recordDuration(msgId, stage, endNs - startNs);
+}
+
+void LatencyRecorder::recordDuration(
+        int32_t msgId, LatencyStages stage, int64_t durationNs)
+{
+    if (msgId < MSG_FIRST_APPLICATION || durationNs < 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexHistograms);
+    m_histograms[std::make_pair(msgId, (int32_t)stage)].record(durationNs);
+}
+
+void LatencyRecorder::recordTransport(const MessageHeader_t &header)
+{
+    record(getLatencyMsgId(header), LATENCY_TRANSPORT,
+            header.sendTimeNs, header.receiveTimeNs);
+}
+
+std::vector<LatencyStatistics_t> LatencyRecorder::getStatistics() const
+{
+    std::unique_lock<std::mutex> lock(m_mutexHistograms);
+    std::vector<LatencyStatistics_t> statistics;
+    statistics.reserve(m_histograms.size());
+    for (const auto &pair: m_histograms) {
+        const LatencyHistogram &histogram = pair.second;
+        LatencyStatistics_t entry;
+        entry.msgId = pair.first.first;
+        entry.stage = pair.first.second;
+        entry.count = histogram.getCount();
+        entry.p50Ns = histogram.getPercentile(0.5);
+        entry.p99Ns = histogram.getPercentile(0.99);
+        entry.p999Ns = histogram.getPercentile(0.999);
+        entry.maxNs = histogram.getMax();
+        statistics.push_back(entry);
+    }
+    return statistics;
+}
+
+void LatencyRecorder::reset()
+{
+    std::unique_lock<std::mutex> lock(m_mutexHistograms);
+    m_histograms.clear();
+}
+
+void writeLatencyStatistics(
+        MessageWriter &writer,
+        const std::vector<LatencyStatistics_t> &statistics)
+{
+    writer.write((int32_t)statistics.size());
+    for (const LatencyStatistics_t &entry: statistics) {
+        writer.write(entry.msgId);
+        writer.write(entry.stage);
+        writer.write(entry.count);
+        writer.write(entry.p50Ns);
+        writer.write(entry.p99Ns);
+        writer.write(entry.p999Ns);
+        writer.write(entry.maxNs);
+    }
+}
+
+bool readLatencyStatistics(
+        MessageReader &reader, std::vector<LatencyStatistics_t> &statistics)
+{
+    int32_t numEntries = 0;
+    if (!reader.read(numEntries) || numEntries < 0) {
+        return false;
+    }
+
+    statistics.clear();
+    for (int32_t i = 0; i < numEntries; i++) {
+        LatencyStatistics_t entry;
+        if (!reader.read(entry.msgId) ||
+            !reader.read(entry.stage) ||
+            !reader.read(entry.count) ||
+            !reader.read(entry.p50Ns) ||
+            !reader.read(entry.p99Ns) ||
+            !reader.read(entry.p999Ns) ||
+            !reader.read(entry.maxNs)) {
+            return false;
+        }
+        statistics.push_back(entry);
+    }
+    return true;
+}
+
+bool writeLatencyCsv(
+        const std::string &fileName,
+        const std::vector<std::pair<std::string,
+                std::vector<LatencyStatistics_t>>> &sides)
+{
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (nullptr == file) {
+        printf("Failed to open %s\n", fileName.c_str());
+        return false;
+    }
+
+    fprintf(file, "side,msg_id,stage,count,p50_ns,p99_ns,p99_9_ns,max_ns\n");
+    for (const auto &side: sides) {
+        for (const LatencyStatistics_t &entry: side.second) {
+            fprintf(file, "%s,%d,%s,%" PRId64 ",%" PRId64 ",%" PRId64
+                    ",%" PRId64 ",%" PRId64 "\n",
+                    side.first.c_str(), (int)entry.msgId,
+                    getLatencyStageName(entry.stage), entry.count,
+                    entry.p50Ns, entry.p99Ns, entry.p999Ns, entry.maxNs);
+        }
+    }
+
+    bool isWritten = !ferror(file);
+    if (0 != fclose(file)) {
+        isWritten = false;
+    }
+    if (!isWritten) {
+        printf("Failed to write %s\n", fileName.c_str());
+    }
+    return isWritten;
+}
+
+} // end of namespace tarsim
@@ -30,6 +30,7 @@
 #include <mutex>
 #include "msgQClient.h"
 #include "serverDefs.h"
+#include "logRing.h"
 
 namespace tarsim {
 //const & defines
@@ -81,7 +82,40 @@ public:
         DEBUG         ///< Info useful to developers for debugging the
                       ///< application, not useful during operations.
     };
-    void log(LogLevels logLevel,const char *fileNanme,const char *functionName, int lineNumber,const char *fmt,... );
+    /**
+     * Logs a message. When a log server runs in this process, the call only
+     * copies its arguments into the ring of the calling thread, without a
+     * lock or a system call, and the log server formats it later. Otherwise
+     * the message is formatted and sent to the log server queue right away.
+     * @param[in] fmt - format as supported by printf, must be a literal
+     */
+    template<typename... Args>
+    void log(LogLevels logLevel, const char *fileName, const char *functionName,
+            int lineNumber, const char *fmt, const Args&... args)
+    {
+        if (LogRingRegistry::getInstance()->isDrained()) {
+            LogRing* ring = LogRingRegistry::getThreadRing();
+            LogRecord_t* record = ring->reserve();
+            if (nullptr == record) {
+                return;
+            }
+            fillRecord(*record, logLevel, fileName, functionName, lineNumber, fmt);
+            encodeLogArgs(*record, args...);
+            ring->commit();
+            return;
+        }
+
+        LogRecord_t record;
+        fillRecord(record, logLevel, fileName, functionName, lineNumber, fmt);
+        encodeLogArgs(record, args...);
+        send(record);
+    }
+
+    /**
+     * Formats a record as level, caller and message
+     * @return length of the text, at most size - 1
+     */
+    static size_t format(const LogRecord_t &record, char* buffer, size_t size);
 
 public:
     static LogClient * getInstance();
@@ -98,7 +132,21 @@ protected:
     LogClient& operator=(LogClient &&) = delete;      // Move assign
 private:
     static LogClient *m_instance ;
-    std::string convertLogLevelString(LogLevels logLevel);
+    static std::string convertLogLevelString(LogLevels logLevel);
+    static void fillRecord(LogRecord_t &record, LogLevels logLevel,
+            const char *fileName, const char *functionName, int lineNumber,
+            const char *fmt)
+    {
+        record.timeStamp = readLogTimeStamp();
+        record.format = fmt;
+        record.fileName = fileName;
+        record.functionName = functionName;
+        record.lineNumber = lineNumber;
+        record.logLevel = logLevel;
+        record.numArgs = 0;
+        record.stringSize = 0;
+    }
+    void send(const LogRecord_t &record);
     MsgQClient          m_msgSender = MsgQClient(LogServerThreadName);
     static std::mutex   m_mtx;          // used for thread synchronization.
 
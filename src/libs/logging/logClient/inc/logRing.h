@@ -0,0 +1,317 @@
+/**
+ *
+ * @file: logRing.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Binary log records and the per-thread rings that carry them to
+ * the log server of the process. A record holds the format string, the raw
+ * arguments and a time stamp counter, and is only formatted by the log
+ * server thread. A thread writes its records into a single producer single
+ * consumer ring of its own, so logging never takes a lock or a system call.
+ * A full ring drops the record and counts it.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_LOGRING_INC_H_
+#define SRC_LIBS_LOGRING_INC_H_
+
+//INCLUDES
+#include <time.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int LOG_RECORD_MAX_ARGS = 12; // arguments kept by a record
+static const int LOG_RECORD_STRING_SIZE = 96; // bytes of string arguments in a record
+static const uint32_t LOG_RING_NUM_RECORDS = 1024; // records a ring holds, power of two
+
+//enums-------------------------------------------------------------------------
+enum LogArgTypes : uint8_t
+{
+    LOG_ARG_INT,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STRING,  // offset of the string in the strings of the record
+    LOG_ARG_POINTER
+};
+
+//structs-----------------------------------------------------------------------
+union LogArg_t
+{
+    int64_t i;
+    double d;
+    const void* p;
+};
+
+/**
+ * A log call as made. The format, file and function names are string
+ * literals, so only their pointers are kept. String arguments may not live
+ * long enough and are copied, as far as LOG_RECORD_STRING_SIZE allows.
+ */
+struct LogRecord_t
+{
+    uint64_t timeStamp = 0;
+    const char* format = nullptr;
+    const char* fileName = nullptr;
+    const char* functionName = nullptr;
+    int32_t lineNumber = 0;
+    int32_t logLevel = 0;
+    uint8_t numArgs = 0;
+    uint8_t stringSize = 0;
+    LogArgTypes argTypes[LOG_RECORD_MAX_ARGS];
+    LogArg_t args[LOG_RECORD_MAX_ARGS];
+    char strings[LOG_RECORD_STRING_SIZE];
+};
+
+//functions---------------------------------------------------------------------
+/**
+ * @return time stamp counter of the core, nanoseconds of CLOCK_MONOTONIC
+ * where there is none
+ */
+inline uint64_t readLogTimeStamp()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+inline void addLogArg(LogRecord_t &record, LogArgTypes type, LogArg_t arg)
+{
+    if (record.numArgs < LOG_RECORD_MAX_ARGS) {
+        record.argTypes[record.numArgs] = type;
+        record.args[record.numArgs] = arg;
+        record.numArgs++;
+    }
+}
+
+inline void encodeLogArg(LogRecord_t &record, const char* value)
+{
+    LogArg_t arg;
+    arg.i = record.stringSize;
+    size_t size = 0;
+    if (nullptr == value) {
+        value = "(null)";
+    }
+    size_t available = LOG_RECORD_STRING_SIZE - 1 - record.stringSize;
+    while (size < available && '\0' != value[size]) {
+        size++;
+    }
+    std::memcpy(record.strings + record.stringSize, value, size);
+    record.stringSize += size;
+    record.strings[record.stringSize] = '\0';
+    if (record.stringSize < LOG_RECORD_STRING_SIZE - 1) {
+        record.stringSize++;
+    }
+    addLogArg(record, LOG_ARG_STRING, arg);
+}
+
+inline void encodeLogArg(LogRecord_t &record, char* value)
+{
+    encodeLogArg(record, (const char*)value);
+}
+
+template<typename T>
+inline typename std::enable_if<
+        std::is_integral<T>::value || std::is_enum<T>::value>::type
+encodeLogArg(LogRecord_t &record, T value)
+{
+    LogArg_t arg;
+    arg.i = (int64_t)value;
+    addLogArg(record, LOG_ARG_INT, arg);
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+encodeLogArg(LogRecord_t &record, T value)
+{
+    LogArg_t arg;
+    arg.d = (double)value;
+    addLogArg(record, LOG_ARG_DOUBLE, arg);
+}
+
+template<typename T>
+inline void encodeLogArg(LogRecord_t &record, const T* value)
+{
+    LogArg_t arg;
+    arg.p = value;
+    addLogArg(record, LOG_ARG_POINTER, arg);
+}
+
+inline void encodeLogArgs(LogRecord_t &/*record*/)
+{
+}
+
+template<typename T, typename... Args>
+inline void encodeLogArgs(LogRecord_t &record, const T &value, const Args&... args)
+{
+    encodeLogArg(record, value);
+    encodeLogArgs(record, args...);
+}
+
+/**
+ * Formats the message of a record as printf would have, the arguments taken
+ * as the types they were logged with
+ * @return length of the message, at most size - 1
+ */
+size_t formatLogMessage(const LogRecord_t &record, char* buffer, size_t size);
+
+//classes-----------------------------------------------------------------------
+/**
+ * Records of one thread, written by that thread and read by the log server
+ */
+class LogRing
+{
+public:
+    /**
+     * @return slot of the next record, null if the ring is full, in which
+     * case the record is counted as dropped
+     */
+    LogRecord_t* reserve()
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= LOG_RING_NUM_RECORDS) {
+            m_numDropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &m_records[head & (LOG_RING_NUM_RECORDS - 1)];
+    }
+
+    /**
+     * Hands the reserved record over to the log server
+     */
+    void commit()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+    }
+
+    /**
+     * @return oldest record, null if there is none
+     */
+    const LogRecord_t* front() const
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_records[tail & (LOG_RING_NUM_RECORDS - 1)];
+    }
+
+    void pop()
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+    }
+
+    uint64_t getNumDropped() const
+    {
+        return m_numDropped.load(std::memory_order_relaxed);
+    }
+
+    // Set once the thread ended, the ring goes once it is drained
+    std::atomic<bool> isOrphaned {false};
+
+private:
+    // The producer and the consumer each write a cache line of their own
+    alignas(64) std::atomic<uint64_t> m_head {0};
+    std::atomic<uint64_t> m_numDropped {0};
+    alignas(64) std::atomic<uint64_t> m_tail {0};
+    alignas(64) LogRecord_t m_records[LOG_RING_NUM_RECORDS];
+};
+
+/**
+ * The rings of all threads of the process
+ */
+class LogRingRegistry
+{
+public:
+    static LogRingRegistry* getInstance();
+
+    /**
+     * @return ring of the calling thread, registered on its first call
+     */
+    static LogRing* getThreadRing();
+
+    /**
+     * Whether a log server of this process drains the rings. If not, records
+     * are formatted and sent to the log server queue right away.
+     */
+    bool isDrained() const
+    {
+        return m_isDrained.load(std::memory_order_acquire);
+    }
+    void setIsDrained(bool isDrained);
+
+    /**
+     * Hands every record of every ring to callback, oldest first per ring
+     * @return number of records drained
+     */
+    size_t drain(const std::function<void(const LogRecord_t&)> &callback);
+
+    /**
+     * @return records dropped by all rings, since the start of the process
+     */
+    uint64_t getNumDropped() const;
+
+private:
+    LogRingRegistry() = default;
+    std::shared_ptr<LogRing> addRing();
+
+    std::atomic<bool> m_isDrained {false};
+
+    // Taken once per thread and by the log server, never per record
+    mutable std::mutex m_mutexRings;
+    std::vector<std::shared_ptr<LogRing>> m_rings;
+    uint64_t m_numDroppedRemoved = 0;
+};
+
+/**
+ * Converts time stamps of readLogTimeStamp to CLOCK_REALTIME, once
+ * calibrated
+ */
+class LogClock
+{
+public:
+    /**
+     * Measures the rate of the time stamp counter over periodUs
+     */
+    void calibrate(int periodUs = 20000);
+    /**
+     * Moves the reference to the current time stamp and real time, and
+     * refines the rate over the time since the previous reference
+     */
+    void reanchor();
+    struct timespec toRealTime(uint64_t timeStamp) const;
+
+private:
+    uint64_t m_timeStamp = 0;
+    int64_t m_realTimeNs = 0;
+    double m_nsPerTick = 1.0;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_LOGRING_INC_H_ */
@@ -20,7 +20,6 @@
 
 
 #include "logClient.h"
-#include <cstdarg>
 #include "ipcMessages.h"
 #include "serverDefs.h"
 #include "ctime"
@@ -28,6 +27,7 @@
 #include <stdio.h>
 #include <iostream>
 #include <string.h>
+#include <algorithm>
 namespace tarsim {
 
 //namespace
@@ -77,62 +77,45 @@ LogClient* LogClient::getInstance()
 
 /**
  *
- * @param[in] logLevel - tyep of log message (info, warning, failure)
- * @param[in] fileName - caller source code file name
- * @param[in] functionName caller source code function name
- * @param[in] lineNumber - caller source code line number
- * @param[in] format - formatted string as supported in printf function
+ * @param[in] record - log call, its arguments as logged
+ * @param[out] buffer - level, caller source code file name, function name,
+ * line number and the formatted message
+ * @param[in] size - size of buffer
  */
-void LogClient::log(LogLevels logLevel,const char *fileName,const char *functionName, int lineNumber,const char *format,... )
+size_t LogClient::format(const LogRecord_t &record, char* buffer, size_t size)
 {
-
     const int c_lookupChar = '/';
 
-    char header[LOG_MAX_DATA_SIZE];
-    char buffer[LOG_MAX_DATA_SIZE];
-    LogData_t msg;
-    struct timespec currentTime;
+    if (0 == size) {
+        return 0;
+    }
 
+    const char *fileNamewithNoPath = strrchr(record.fileName, c_lookupChar);//Do Reverse Lookup.
+    fileNamewithNoPath = (nullptr == fileNamewithNoPath) ?
+            record.fileName : fileNamewithNoPath + 1;
+    std::string levelString = convertLogLevelString((LogLevels)record.logLevel);
+    int result = snprintf(buffer, size, "%s(%s:%s:%d)", levelString.c_str(),
+            fileNamewithNoPath, record.functionName, record.lineNumber);
+    if (result < 0) {
+        buffer[0] = 0;
+        return 0;
+    }
+    size_t length = std::min((size_t)result, size - 1);
+    return length + formatLogMessage(record, buffer + length, size - length);
+}
+
+/**
+ * @brief formats a record on the calling thread and sends it to the log
+ * server queue
+ * @param[in] record - log call, its arguments as logged
+ */
+void LogClient::send(const LogRecord_t &record)
+{
+    LogData_t msg;
     msg.msgId = MSG_LOG_CMD;
     clock_gettime(CLOCK_REALTIME, &msg.threadtime);
+    format(record, msg.data, LOG_MAX_DATA_SIZE);
 
-    va_list argptr;
-    va_start(argptr, format);
-    vsnprintf(buffer, LOG_MAX_DATA_SIZE - 1, format, argptr);
-    va_end(argptr);
-
-
-    const char *fileNamewithNoPath = strrchr(fileName,c_lookupChar)+1;//Do Reverse Lookup.
-    int result = snprintf(header,LOG_MAX_DATA_SIZE/2,"(%s:%s:%d)",fileNamewithNoPath,functionName,lineNumber);
-    if (result >= (LOG_MAX_DATA_SIZE/2) || result < 0) // Give some space for logLevel
-    {
-        std::cout << "***************** BUFFER OVER FLOW " << header << std::endl;
-        std::cout << fileName << " " << functionName << " " << lineNumber ;
-        return;
-    }
-    std::string levelString = convertLogLevelString(logLevel);
-
-    // determine the length to copy, it will be the min of MAX_STRING_SIZE-1
-    // or test.size.  This will ensure that even if the string it shorter than
-    // the MAX_STRING_SIZE, that it will copy properly -- without reading past the
-    // array bounds of the string.
-    auto copy_len = std::min((int) levelString.size(), LOG_MAX_DATA_SIZE - 1);
-    std::copy(
-            levelString.begin(),
-            levelString.begin() + copy_len,
-            msg.data);
-    msg.data[copy_len] =0;
-    strncat(msg.data,header,LOG_MAX_DATA_SIZE/2);
-    strncat(msg.data, buffer,LOG_MAX_DATA_SIZE-1);
-    msg.data[LOG_MAX_DATA_SIZE - 1] = 0; // ensure null termination at the end
-    if (strlen(msg.data) >= LOG_MAX_DATA_SIZE)
-    {
-        std::cout << "***************** BUFFER OVER FLOW " << buffer << std::endl;
-        std::cout << fileName << " " << functionName << " " << lineNumber ;
-        return;
-    }
-
-    bool connected;
     if (m_msgSender.isConnected() != NO_ERR)
     {
         if (m_msgSender.connect() != NO_ERR)
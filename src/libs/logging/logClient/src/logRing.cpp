@@ -0,0 +1,273 @@
+/**
+ *
+ * @file: logRing.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the log rings, their registry and the lazy
+ * formatting of log records
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "logRing.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+
+namespace tarsim {
+namespace {
+// Largest relative change of the rate accepted when reanchoring
+const double c_maxRateChange = 0.02;
+
+/**
+ * Owns the ring of a thread and hands it over to the registry when the
+ * thread ends, so that its last records are still written
+ */
+struct ThreadRing
+{
+    std::shared_ptr<LogRing> ring;
+    ~ThreadRing()
+    {
+        if (ring) {
+            ring->isOrphaned.store(true, std::memory_order_release);
+        }
+    }
+};
+
+// Appends to buffer what still fits, always terminated
+void append(char* buffer, size_t size, size_t &length, const char* fmt, ...)
+        __attribute__((format(printf, 4, 5)));
+void append(char* buffer, size_t size, size_t &length, const char* fmt, ...)
+{
+    if (length + 1 >= size) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buffer + length, size - length, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        length = std::min(size - 1, length + n);
+    }
+}
+} // end of anonymous namespace
+
+size_t formatLogMessage(const LogRecord_t &record, char* buffer, size_t size)
+{
+    if (0 == size) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    if (nullptr == record.format) {
+        return 0;
+    }
+
+    size_t length = 0;
+    int argIndex = 0;
+    const char* p = record.format;
+    while ('\0' != *p && length + 1 < size) {
+        if ('%' != *p) {
+            buffer[length++] = *p++;
+            continue;
+        }
+        if ('%' == p[1]) {
+            buffer[length++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Flags, width and precision are kept, the length is replaced by the
+        // one of the stored argument
+        char spec[32] = {'%'};
+        size_t specLength = 1;
+        const char* q = p + 1;
+        while ('\0' != *q && nullptr != strchr("-+ #0123456789.*", *q)) {
+            if ('*' != *q && specLength < sizeof(spec) - 4) {
+                spec[specLength++] = *q;
+            }
+            q++;
+        }
+        while ('\0' != *q && nullptr != strchr("hlLqjzt", *q)) {
+            q++;
+        }
+        char conversion = *q;
+        if ('\0' == conversion) {
+            break;
+        }
+        p = q + 1;
+
+        if (argIndex >= record.numArgs) {
+            append(buffer, size, length, "%%%c", conversion);
+            continue;
+        }
+        LogArgTypes type = record.argTypes[argIndex];
+        const LogArg_t &arg = record.args[argIndex];
+        argIndex++;
+
+        switch (type) {
+        case LOG_ARG_INT:
+            if (nullptr != strchr("diouxXc", conversion)) {
+                spec[specLength++] = 'l';
+                spec[specLength++] = 'l';
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                append(buffer, size, length, spec, (long long)arg.i);
+            } else {
+                append(buffer, size, length, "%lld", (long long)arg.i);
+            }
+            break;
+        case LOG_ARG_DOUBLE:
+            if (nullptr != strchr("fFeEgGaA", conversion)) {
+                spec[specLength++] = conversion;
+                spec[specLength] = '\0';
+                append(buffer, size, length, spec, arg.d);
+            } else {
+                append(buffer, size, length, "%f", arg.d);
+            }
+            break;
+        case LOG_ARG_STRING:
+            spec[specLength++] = 's';
+            spec[specLength] = '\0';
+            append(buffer, size, length, spec, record.strings + arg.i);
+            break;
+        case LOG_ARG_POINTER:
+            append(buffer, size, length, "%p", arg.p);
+            break;
+        }
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+LogRingRegistry* LogRingRegistry::getInstance()
+{
+    // Never destroyed, threads may log until the process exits
+    static LogRingRegistry* instance = new LogRingRegistry();
+    return instance;
+}
+
+LogRing* LogRingRegistry::getThreadRing()
+{
+    static thread_local ThreadRing threadRing;
+    if (!threadRing.ring) {
+        threadRing.ring = getInstance()->addRing();
+    }
+    return threadRing.ring.get();
+}
+
+std::shared_ptr<LogRing> LogRingRegistry::addRing()
+{
+    std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+    std::lock_guard<std::mutex> lock(m_mutexRings);
+    m_rings.push_back(ring);
+    return ring;
+}
+
+void LogRingRegistry::setIsDrained(bool isDrained)
+{
+    m_isDrained.store(isDrained, std::memory_order_release);
+}
+
+size_t LogRingRegistry::drain(
+        const std::function<void(const LogRecord_t&)> &callback)
+{
+    std::lock_guard<std::mutex> lock(m_mutexRings);
+    size_t numDrained = 0;
+    for (auto it = m_rings.begin(); it != m_rings.end();) {
+        LogRing* ring = it->get();
+        // Read before the records, so that none is written after it
+        bool isOrphaned = ring->isOrphaned.load(std::memory_order_acquire);
+        for (const LogRecord_t* record = ring->front(); nullptr != record;
+                record = ring->front()) {
+            callback(*record);
+            ring->pop();
+            numDrained++;
+        }
+
+        if (isOrphaned) {
+            m_numDroppedRemoved += ring->getNumDropped();
+            it = m_rings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return numDrained;
+}
+
+uint64_t LogRingRegistry::getNumDropped() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexRings);
+    uint64_t numDropped = m_numDroppedRemoved;
+    for (const std::shared_ptr<LogRing> &ring: m_rings) {
+        numDropped += ring->getNumDropped();
+    }
+    return numDropped;
+}
+
+void LogClock::calibrate(int periodUs)
+{
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_REALTIME, &start);
+    uint64_t startTimeStamp = readLogTimeStamp();
+    usleep(periodUs);
+    clock_gettime(CLOCK_REALTIME, &end);
+    uint64_t endTimeStamp = readLogTimeStamp();
+
+    int64_t startNs = (int64_t)start.tv_sec * 1000000000LL + start.tv_nsec;
+    int64_t endNs = (int64_t)end.tv_sec * 1000000000LL + end.tv_nsec;
+    if (endTimeStamp > startTimeStamp && endNs > startNs) {
+        m_nsPerTick = (double)(endNs - startNs) /
+                (double)(endTimeStamp - startTimeStamp);
+    }
+    m_timeStamp = endTimeStamp;
+    m_realTimeNs = endNs;
+}
+
+void LogClock::reanchor()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t timeStamp = readLogTimeStamp();
+
+    int64_t ns = (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+    if (timeStamp > m_timeStamp && ns > m_realTimeNs) {
+        double nsPerTick = (double)(ns - m_realTimeNs) /
+                (double)(timeStamp - m_timeStamp);
+        // A step of the real time clock is not a change of rate
+        if (std::fabs(nsPerTick - m_nsPerTick) < c_maxRateChange * m_nsPerTick) {
+            m_nsPerTick = nsPerTick;
+        }
+    }
+    m_timeStamp = timeStamp;
+    m_realTimeNs = ns;
+}
+
+struct timespec LogClock::toRealTime(uint64_t timeStamp) const
+{
+    int64_t ns = m_realTimeNs + (int64_t)(
+            ((double)(int64_t)(timeStamp - m_timeStamp)) * m_nsPerTick);
+    struct timespec t;
+    t.tv_sec = ns / 1000000000LL;
+    t.tv_nsec = ns % 1000000000LL;
+    if (t.tv_nsec < 0) {
+        t.tv_sec--;
+        t.tv_nsec += 1000000000LL;
+    }
+    return t;
+}
+} // end of namespace tarsim
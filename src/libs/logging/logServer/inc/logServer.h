@@ -22,28 +22,74 @@
 #ifndef SRC_LIBS_LOGSERVER_INC_LOGSERVER_H_
 #define SRC_LIBS_LOGSERVER_INC_LOGSERVER_H_
 
-#include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "msgQServer.h"
+#include "logRing.h"
 
 namespace tarsim {
 
-using std::fstream;
-
+/**
+ * Where the log goes and how much of it is kept. The log is rotated into
+ * files named after the time of rotation, e.g. /tmp/eitLog-2026-10-19-12-43-17-615.txt.gz,
+ * so that the disk holds at most (numRetainedFiles + 1) * maxFileSize.
+ */
+struct LogServerConfig_t
+{
+    std::string fileName = "/tmp/eitLog.txt";
+    size_t maxFileSize = 64 * 1024 * 1024;  // [bytes] rotates once the file is larger
+    int32_t rotationPeriod = 24 * 3600;     // [s] rotates once the file is older, 0 for never
+    int32_t numRetainedFiles = 10;          // rotated files kept, the oldest are removed
+    bool isCompressed = true;               // gzips rotated files in the background
+};
 
 class LogServer : public MsgQServer
 {
 private:
-    std::string filename = "";
-    fstream outf;
+    LogServerConfig_t m_config;
+
+    // Lines are collected and appended to the file in batches
+    std::mutex m_mutexFile; // the queue and the rings are written from two threads
+    int m_fd = -1;
+    size_t m_fileSize = 0;
+    time_t m_fileOpenTime = 0;
+    std::vector<char> m_buffer;
+
+    // Formats the records that threads of this process log into their rings,
+    // and appends what was written to the file
+    std::thread m_drainThread;
+    std::atomic<bool> m_isDraining {false};
+    LogClock m_logClock;
+    uint64_t m_numDroppedReported = 0;
+
+    // Compresses rotated files and removes the oldest ones
+    std::thread m_compressionThread;
+    std::mutex m_mutexRotatedFiles;
+    std::condition_variable m_cvRotatedFiles;
+    std::deque<std::string> m_rotatedFiles;
+    bool m_isCompressing = false;
 
 public:
-	LogServer();
+	LogServer(const LogServerConfig_t &config = LogServerConfig_t());
 	virtual ~LogServer();
 
 private:
 	virtual void onMessage(const GenericData_t &inComingData);
 	virtual void onExit();
+	void write(const struct timespec &logTime, const char* data);
+	void drain();
+	size_t drainRings();
+	void flush();
+	bool openFile();
+	void rotate();
+	void compress();
+	bool compressFile(const std::string &fileName);
+	void removeOldFiles();
 };
 } // end of namespace tarsim
 #endif /* SRC_LIBS_LOGSERVER_INC_LOGSERVER_H_ */
@@ -24,27 +24,57 @@
 #include "ipcMessages.h"
 #include <iostream>
 #include "eitErrors.h"
+#include "logClient.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
 
 namespace tarsim {
 
 using namespace std;
 
-const long c_maxSize = 10000000000;//10 Gig
+const int c_drainPeriodUs = 1000; // sleep of the drain thread once the rings are empty
+const std::chrono::seconds c_reanchorPeriod(1); // log clock follows the real time
+const size_t c_bufferSize = 64 * 1024; // lines collected before they are appended
+const int c_compressionNice = 19; // compression yields to every other thread
+const char* c_compressedExtension = ".gz";
+
 /**
  * @brief constructor for the log server
+ * @param[in] config - log file, its rotation and retention
  */
-LogServer::LogServer() :
-    MsgQServer(LogServerThreadName, SCHED_OTHER, 0)
+LogServer::LogServer(const LogServerConfig_t &config) :
+    MsgQServer(LogServerThreadName, SCHED_OTHER, 0),
+    m_config(config)
 {
-    filename = "/tmp/eitLog.txt";
-	//open with append mode if possible
-	outf.open(filename, std::fstream::in | std::fstream::out | std::fstream::trunc);
-	// If file does not exist, Create new file
-	if (!outf )
-	{
-		cout << "Failed to create new file " << filename;
-	}
+    m_buffer.reserve(c_bufferSize + LOG_MAX_DATA_SIZE + 64);
+
+    m_isCompressing = true;
+    m_compressionThread = std::thread(&LogServer::compress, this);
+
+    // The log of the previous run is kept as a rotated file
+    struct stat s;
+    if (stat(m_config.fileName.c_str(), &s) == 0 && s.st_size > 0) {
+        rotate();
+    }
+    if (!openFile())
+    {
+        cout << "Failed to create new file " << m_config.fileName;
+    }
+
+	// From now on threads of this process log into their rings
+	m_logClock.calibrate();
+	m_isDraining = true;
+	m_drainThread = std::thread(&LogServer::drain, this);
+	LogRingRegistry::getInstance()->setIsDrained(true);
 }
 
 /**
@@ -52,13 +82,88 @@ LogServer::LogServer() :
  */
 LogServer::~LogServer()
 {
+    LogRingRegistry::getInstance()->setIsDrained(false);
+    m_isDraining = false;
+    if (m_drainThread.joinable()) {
+        m_drainThread.join();
+    }
+    drainRings();
     onExit();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexRotatedFiles);
+        m_isCompressing = false;
+    }
+    m_cvRotatedFiles.notify_all();
+    if (m_compressionThread.joinable()) {
+        m_compressionThread.join();
+    }
 }
 
 void LogServer::onExit()
 {
-    outf.close();
+    std::lock_guard<std::mutex> lock(m_mutexFile);
+    flush();
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+/**
+ * @brief writes the records of the rings until the log server is destroyed,
+ * and appends what was written to the file at least once per period. The log
+ * clock is reanchored every second so time stamps follow the real time
+ */
+void LogServer::drain()
+{
+    std::chrono::steady_clock::time_point anchorTime =
+            std::chrono::steady_clock::now();
+    while (m_isDraining) {
+        std::chrono::steady_clock::time_point now =
+                std::chrono::steady_clock::now();
+        if (now - anchorTime >= c_reanchorPeriod) {
+            m_logClock.reanchor();
+            anchorTime = now;
+        }
+        size_t numDrained = drainRings();
+        {
+            std::lock_guard<std::mutex> lock(m_mutexFile);
+            flush();
+        }
+        if (0 == numDrained) {
+            usleep(c_drainPeriodUs);
+        }
+    }
 }
+
+/**
+ * @brief formats and writes the records of all rings, and how many records
+ * were dropped since the last call, if any
+ * @return number of records written
+ */
+size_t LogServer::drainRings()
+{
+    LogRingRegistry* registry = LogRingRegistry::getInstance();
+    char data[LOG_MAX_DATA_SIZE];
+    size_t numDrained = registry->drain([&](const LogRecord_t &record) {
+        LogClient::format(record, data, sizeof(data));
+        write(m_logClock.toRealTime(record.timeStamp), data);
+    });
+
+    uint64_t numDropped = registry->getNumDropped();
+    if (numDropped > m_numDroppedReported) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        snprintf(data, sizeof(data),
+                "WARNING(logServer.cpp:drainRings) %llu log records were dropped",
+                (unsigned long long)(numDropped - m_numDroppedReported));
+        write(now, data);
+        m_numDroppedReported = numDropped;
+    }
+    return numDrained;
+}
+
 /**
  * @process the incoming data to the log server
  * supported message id MSG_LOG_CNTL
@@ -70,47 +175,283 @@ void LogServer::onMessage(const GenericData_t &inComingData)
 {
     if (MSG_LOG_CMD == inComingData.logData.msgId)
     {
-        char tsBuf[64], tmbuf[64];
-        struct tm* tsTm;
-        std::string outputFormat   = "%Y-%m-%d %H:%M:%S";
+        write(inComingData.logData.threadtime, inComingData.logData.data);
+    }
+    else
+    {
+        printf( "Unexpected message of logServer %d", inComingData.logData.msgId);
+    }
+}
 
+/**
+ * @brief adds a message with its time stamp to the lines to append, which
+ * are appended once there are enough of them or by the drain thread
+ * @param[in] logTime - time the message was logged
+ * @param[in] data - formatted message
+ */
+void LogServer::write(const struct timespec &logTime, const char* data)
+{
+    std::lock_guard<std::mutex> lock(m_mutexFile);
+    if (m_fd < 0)
+    {
+        return;
+    }
 
-        tsTm = localtime(&inComingData.logData.threadtime.tv_sec);  // convert calendar time to local time
-        strftime(tmbuf, sizeof tmbuf, outputFormat.c_str(), tsTm);
-        snprintf(tsBuf, sizeof tsBuf, "%s:%03ld", tmbuf, inComingData.logData.threadtime.tv_nsec/1000000);
+    char tsBuf[64], tmbuf[64];
+    struct tm tsTm;
+    std::string outputFormat   = "%Y-%m-%d %H:%M:%S";
 
+    localtime_r(&logTime.tv_sec, &tsTm);  // convert calendar time to local time
+    strftime(tmbuf, sizeof tmbuf, outputFormat.c_str(), &tsTm);
+    int n = snprintf(tsBuf, sizeof tsBuf, "[%s:%03ld] ", tmbuf, logTime.tv_nsec/1000000);
+    m_buffer.insert(m_buffer.end(), tsBuf, tsBuf + std::max(0, n));
+    m_buffer.insert(m_buffer.end(), data, data + strnlen(data, LOG_MAX_DATA_SIZE));
+    m_buffer.push_back('\n');
 
-//        cout << '[' << tsBuf << "] " ;
-//        cout << inComingData.logData.data  << endl <<  std::flush;
-        outf << '[' << tsBuf << "] " ;
-        outf << inComingData.logData.data  << endl <<  std::flush;
-        long fsize = outf.tellg();
-        if (fsize > c_maxSize)
+    if (m_buffer.size() >= c_bufferSize)
+    {
+        flush();
+    }
+}
+
+/**
+ * @brief appends the collected lines to the file and rotates it once it is
+ * too large or too old. The caller holds m_mutexFile.
+ */
+void LogServer::flush()
+{
+    if (m_fd < 0)
+    {
+        m_buffer.clear();
+        return;
+    }
+
+    size_t offset = 0;
+    while (offset < m_buffer.size())
+    {
+        ssize_t n = ::write(m_fd, m_buffer.data() + offset, m_buffer.size() - offset);
+        if (n < 0)
         {
-           outf.close();
-           std::string fileNameFormat   = "%Y-%m-%d-%H-%M-%S ";
-           time_t rawtime;
-           struct tm * timeinfo;
-           time (&rawtime);
-           timeinfo = localtime (&rawtime);
-           strftime(tmbuf, sizeof tmbuf, fileNameFormat.c_str(), timeinfo);
-           printf("File size is larger %ld %s %s\n", fsize,tmbuf,  (tmbuf+filename).c_str() );
-           int result= rename( filename.c_str() , (tmbuf+filename).c_str() );
-           if ( 0 == result )
-           {
-               std::cout << "Renamed successfully\n";
-           }
-           else
-           {
-               perror( "Error renaming file" );
-           }
-           outf.open(filename, std::fstream::in | std::fstream::out | std::fstream::app);
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            perror("Failed to write log file");
+            break;
         }
+        offset += n;
     }
-    else
+    m_fileSize += offset;
+    m_buffer.clear();
+
+    bool isTooLarge = m_fileSize >= m_config.maxFileSize;
+    bool isTooOld = m_config.rotationPeriod > 0 && m_fileSize > 0 &&
+            time(nullptr) - m_fileOpenTime >= m_config.rotationPeriod;
+    if (isTooLarge || isTooOld)
     {
-        printf( "Unexpected message of logServer %d", inComingData.logData.msgId);
+        close(m_fd);
+        m_fd = -1;
+        rotate();
+        if (!openFile())
+        {
+            cout << "Failed to create new file " << m_config.fileName;
+        }
     }
 }
-} // end of namespace tarsim
 
+/**
+ * @brief opens the log file to append to it
+ * @return true if successful
+ */
+bool LogServer::openFile()
+{
+    m_fd = open(m_config.fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        perror("Error opening log file");
+        return false;
+    }
+
+    struct stat s;
+    m_fileSize = (fstat(m_fd, &s) == 0) ? s.st_size : 0;
+    m_fileOpenTime = time(nullptr);
+    return true;
+}
+
+/**
+ * @brief renames the closed log file after the current time and hands it
+ * over to the compression thread
+ */
+void LogServer::rotate()
+{
+    // /tmp/eitLog.txt is rotated into /tmp/eitLog-<time>.txt
+    std::string base = m_config.fileName;
+    std::string extension;
+    size_t dot = base.rfind('.');
+    if (dot != std::string::npos && dot > base.rfind('/') + 1)
+    {
+        extension = base.substr(dot);
+        base = base.substr(0, dot);
+    }
+
+    char tmbuf[64];
+    struct timespec now;
+    struct tm timeinfo;
+    clock_gettime(CLOCK_REALTIME, &now);
+    localtime_r(&now.tv_sec, &timeinfo);
+    strftime(tmbuf, sizeof tmbuf, "%Y-%m-%d-%H-%M-%S", &timeinfo);
+    std::string rotatedName = base + "-" + tmbuf + "-" +
+            std::to_string(now.tv_nsec / 1000000 + 1000).substr(1) + extension;
+
+    if (0 != rename(m_config.fileName.c_str(), rotatedName.c_str()))
+    {
+        perror( "Error renaming file" );
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexRotatedFiles);
+        m_rotatedFiles.push_back(rotatedName);
+    }
+    m_cvRotatedFiles.notify_one();
+}
+
+/**
+ * @brief compresses rotated files and removes the oldest ones, at the
+ * lowest priority, until the log server is destroyed
+ */
+void LogServer::compress()
+{
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), c_compressionNice);
+
+    std::unique_lock<std::mutex> lock(m_mutexRotatedFiles);
+    while (true)
+    {
+        m_cvRotatedFiles.wait(lock, [this]() {
+            return !m_isCompressing || !m_rotatedFiles.empty();
+        });
+        if (m_rotatedFiles.empty())
+        {
+            return;
+        }
+
+        std::string fileName = m_rotatedFiles.front();
+        m_rotatedFiles.pop_front();
+        lock.unlock();
+        if (m_config.isCompressed)
+        {
+            compressFile(fileName);
+        }
+        removeOldFiles();
+        lock.lock();
+    }
+}
+
+/**
+ * @brief replaces a file by its gzip
+ * @param[in] fileName - file to compress
+ * @return true if successful
+ */
+bool LogServer::compressFile(const std::string &fileName)
+{
+    std::string compressedName = fileName + c_compressedExtension;
+    std::string partialName = compressedName + ".part";
+
+    int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        perror("Error opening rotated log file");
+        return false;
+    }
+    gzFile gz = gzopen(partialName.c_str(), "wb");
+    if (nullptr == gz)
+    {
+        printf("Failed to create %s\n", partialName.c_str());
+        close(fd);
+        return false;
+    }
+
+    std::vector<char> buffer(c_bufferSize);
+    bool isSuccessful = true;
+    ssize_t n;
+    while ((n = read(fd, buffer.data(), buffer.size())) != 0)
+    {
+        if (n < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            isSuccessful = false;
+            break;
+        }
+        if (gzwrite(gz, buffer.data(), n) != n)
+        {
+            isSuccessful = false;
+            break;
+        }
+    }
+    close(fd);
+    isSuccessful = (Z_OK == gzclose(gz)) && isSuccessful;
+
+    if (!isSuccessful || 0 != rename(partialName.c_str(), compressedName.c_str()))
+    {
+        printf("Failed to compress %s\n", fileName.c_str());
+        unlink(partialName.c_str());
+        return false;
+    }
+    unlink(fileName.c_str());
+    return true;
+}
+
+/**
+ * @brief removes the oldest rotated files, compressed or not, beyond
+ * numRetainedFiles
+ */
+void LogServer::removeOldFiles()
+{
+    std::string directory = ".";
+    std::string base = m_config.fileName;
+    size_t slash = base.rfind('/');
+    if (slash != std::string::npos)
+    {
+        directory = base.substr(0, std::max<size_t>(1, slash));
+        base = base.substr(slash + 1);
+    }
+    size_t dot = base.rfind('.');
+    if (dot != std::string::npos && dot > 0)
+    {
+        base = base.substr(0, dot);
+    }
+    std::string prefix = base + "-";
+
+    DIR* dir = opendir(directory.c_str());
+    if (nullptr == dir)
+    {
+        return;
+    }
+
+    // Names hold the time of rotation, so they sort from the oldest
+    std::vector<std::string> rotatedNames;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string name = entry->d_name;
+        if (name.size() > prefix.size() &&
+                0 == name.compare(0, prefix.size(), prefix) &&
+                isdigit(name[prefix.size()]) &&
+                std::string::npos == name.find(".part"))
+        {
+            rotatedNames.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    std::sort(rotatedNames.begin(), rotatedNames.end());
+    size_t numRetained = std::max(0, m_config.numRetainedFiles);
+    for (size_t i = 0; i + numRetained < rotatedNames.size(); i++)
+    {
+        unlink((directory + "/" + rotatedNames[i]).c_str());
+    }
+}
+} // end of namespace tarsim
@@ -0,0 +1,170 @@
+/**
+ *
+ * @file: messageFraming.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Variable-length messages. A payload is written field by field,
+ * only as long as its content, and travels in FRAMED_MESSAGE fragments that
+ * each carry their length. Payloads larger than one transport message are
+ * split and reassembled on the other side.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_MESSAGEFRAMING_INC_H_
+#define SRC_LIBS_MESSAGEFRAMING_INC_H_
+
+//INCLUDES
+#include <cstring>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+#include "eitErrors.h"
+#include "ipcMessages.h"
+#include "simulatorMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int32_t MAX_FRAGMENT_SIZE =
+        MAX_MSG_SIZE - (int32_t)sizeof(MessageHeader_t) - 4 * (int32_t)sizeof(int32_t);
+static const int32_t MAX_FRAMED_PAYLOAD_SIZE = 1 << 20; // largest payload accepted
+static const size_t MAX_PENDING_ASSEMBLIES = 16; // partial payloads kept at once
+
+//structs-----------------------------------------------------------------------
+/**
+ * One fragment of a payload. Only its first length bytes of payload are
+ * sent.
+ */
+struct FramedMessage_t : MessageHeader_t
+{
+    int32_t payloadId = 0; // Message id of the payload
+    int32_t totalSize = 0; // Size of the whole payload in bytes
+    int32_t offset = 0;    // Where this fragment starts in the payload
+    int32_t length = 0;    // Bytes of payload in this fragment
+    uint8_t payload[MAX_FRAGMENT_SIZE];
+};
+static_assert(sizeof(FramedMessage_t) <= MAX_MSG_SIZE,
+        "FramedMessage_t must fit in a message");
+
+/**
+ * Builds a payload field by field
+ */
+class MessageWriter
+{
+public:
+    explicit MessageWriter(int32_t payloadId);
+
+    template<typename T> void write(const T &value)
+    {
+        write(&value, 1);
+    }
+
+    template<typename T> void write(const T* values, size_t count)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+        m_payload.insert(m_payload.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    int32_t getPayloadId() const;
+    const std::vector<uint8_t>& getPayload() const;
+
+    /**
+     * Splits the payload in fragments and hands each one to send
+     * @param srcPid Source of the message
+     * @param msgCounter Counter shared by all fragments
+     * @param send Sends one fragment of the given size, it may stamp its
+     * header
+     */
+    Errors send(
+            int32_t srcPid, int32_t msgCounter,
+            const std::function<Errors(void*, size_t)> &send) const;
+
+private:
+    int32_t m_payloadId = 0;
+    std::vector<uint8_t> m_payload;
+};
+
+/**
+ * Reads a payload back in the order it was written. Reads past its end fail
+ * and leave the value untouched.
+ */
+class MessageReader
+{
+public:
+    explicit MessageReader(const std::vector<uint8_t> &payload);
+
+    template<typename T> bool read(T &value)
+    {
+        return read(&value, 1);
+    }
+
+    template<typename T> bool read(T* values, size_t count)
+    {
+        size_t size = count * sizeof(T);
+        if (size > m_payload.size() - m_position) {
+            return false;
+        }
+        std::memcpy(values, m_payload.data() + m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    template<typename T> bool read(std::vector<T> &values, size_t count)
+    {
+        if (count * sizeof(T) > m_payload.size() - m_position) {
+            return false;
+        }
+        values.resize(count);
+        return read(values.data(), count);
+    }
+
+private:
+    const std::vector<uint8_t> &m_payload;
+    size_t m_position = 0;
+};
+
+/**
+ * Puts the fragments of payloads back together, by source and counter
+ */
+class MessageAssembler
+{
+public:
+    /**
+     * Adds a fragment
+     * @param msg The fragment
+     * @param payload The whole payload, once complete
+     * @return true if the fragment completed its payload
+     */
+    bool add(const FramedMessage_t &msg, std::vector<uint8_t> &payload);
+
+    /**
+     * Drops the partial payloads of a source, e.g. when it disconnects
+     */
+    void remove(int32_t srcPid);
+
+private:
+    struct Assembly_t
+    {
+        std::vector<uint8_t> payload;
+        std::vector<bool> received; // by fragment
+        size_t numReceived = 0; // fragments
+        uint64_t order = 0;
+    };
+
+    std::map<std::pair<int32_t, int32_t>, Assembly_t> m_assemblies;
+    uint64_t m_order = 0;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_MESSAGEFRAMING_INC_H_ */
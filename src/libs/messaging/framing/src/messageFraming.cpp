@@ -0,0 +1,156 @@
+/**
+ *
+ * @file: messageFraming.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the message framing
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "messageFraming.h"
+#include <algorithm>
+
+namespace tarsim {
+
+MessageWriter::MessageWriter(int32_t payloadId):
+        m_payloadId(payloadId)
+{
+}
+
+int32_t MessageWriter::getPayloadId() const
+{
+    return m_payloadId;
+}
+
+const std::vector<uint8_t>& MessageWriter::getPayload() const
+{
+    return m_payload;
+}
+
+Errors MessageWriter::send(
+        int32_t srcPid, int32_t msgCounter,
+        const std::function<Errors(void*, size_t)> &send) const
+{
+    if (m_payload.size() > (size_t)MAX_FRAMED_PAYLOAD_SIZE) {
+        return ERR_INVALID;
+    }
+
+    FramedMessage_t msg;
+    msg.msgId = FRAMED_MESSAGE;
+    msg.srcPid = srcPid;
+    msg.msgCounter = msgCounter;
+    msg.payloadId = m_payloadId;
+    msg.totalSize = (int32_t)m_payload.size();
+
+    // An empty payload still takes one fragment
+    int32_t offset = 0;
+    do {
+        msg.offset = offset;
+        msg.length = std::min(MAX_FRAGMENT_SIZE, msg.totalSize - offset);
+        std::memcpy(msg.payload, m_payload.data() + offset, msg.length);
+
+        Errors error = send(&msg,
+                sizeof(msg) - (MAX_FRAGMENT_SIZE - msg.length));
+        if (NO_ERR != error) {
+            return error;
+        }
+        offset += msg.length;
+    } while (offset < msg.totalSize);
+    return NO_ERR;
+}
+
+MessageReader::MessageReader(const std::vector<uint8_t> &payload):
+        m_payload(payload)
+{
+}
+
+bool MessageAssembler::add(
+        const FramedMessage_t &msg, std::vector<uint8_t> &payload)
+{
+    if (msg.totalSize < 0 || msg.totalSize > MAX_FRAMED_PAYLOAD_SIZE ||
+        msg.length < 0 || msg.length > MAX_FRAGMENT_SIZE || msg.offset < 0 ||
+        msg.offset > msg.totalSize - msg.length) {
+        return false;
+    }
+
+    // Most payloads fit in one fragment and never need an assembly
+    if (0 == msg.offset && msg.length == msg.totalSize) {
+        payload.assign(msg.payload, msg.payload + msg.length);
+        return true;
+    }
+
+    // Fragments are cut at multiples of MAX_FRAGMENT_SIZE, anything else
+    // could overlap the ones already received
+    if (0 != msg.offset % MAX_FRAGMENT_SIZE ||
+        msg.length != std::min(MAX_FRAGMENT_SIZE, msg.totalSize - msg.offset)) {
+        return false;
+    }
+
+    std::pair<int32_t, int32_t> key(msg.srcPid, msg.msgCounter);
+    auto it = m_assemblies.find(key);
+    if (it == m_assemblies.end()) {
+        // The oldest partial payload lost a fragment for good
+        if (m_assemblies.size() >= MAX_PENDING_ASSEMBLIES) {
+            auto oldest = std::min_element(
+                    m_assemblies.begin(), m_assemblies.end(),
+                    [](const std::pair<const std::pair<int32_t, int32_t>,
+                                    Assembly_t> &a,
+                       const std::pair<const std::pair<int32_t, int32_t>,
+                                    Assembly_t> &b) {
+                        return a.second.order < b.second.order; });
+            m_assemblies.erase(oldest);
+        }
+
+        it = m_assemblies.insert(std::make_pair(key, Assembly_t())).first;
+        it->second.payload.resize(msg.totalSize);
+        it->second.received.resize(
+                (msg.totalSize + MAX_FRAGMENT_SIZE - 1) / MAX_FRAGMENT_SIZE);
+        it->second.order = m_order++;
+    } else if ((int32_t)it->second.payload.size() != msg.totalSize) {
+        return false;
+    }
+
+    // A repeated fragment is dropped, it must not count twice
+    Assembly_t &assembly = it->second;
+    size_t index = (size_t)(msg.offset / MAX_FRAGMENT_SIZE);
+    if (assembly.received[index]) {
+        return false;
+    }
+    assembly.received[index] = true;
+
+    std::memcpy(assembly.payload.data() + msg.offset, msg.payload, msg.length);
+    assembly.numReceived++;
+    if (assembly.numReceived < assembly.received.size()) {
+        return false;
+    }
+
+    payload.swap(assembly.payload);
+    m_assemblies.erase(it);
+    return true;
+}
+
+void MessageAssembler::remove(int32_t srcPid)
+{
+    for (auto it = m_assemblies.begin(); it != m_assemblies.end();) {
+        if (it->first.first == srcPid) {
+            it = m_assemblies.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // end of namespace tarsim
@@ -0,0 +1,273 @@
+/**
+ *
+ * @file: messageAssemblerTest.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Checks that the message assembler puts payloads back together
+ * whatever the order of their fragments, drops repeated and invalid
+ * fragments, and forgets partial payloads that were abandoned
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "messageFraming.h"
+
+using namespace tarsim;
+
+namespace {
+static const int32_t SRC_PID = 1234;
+static const int32_t PAYLOAD_ID = 77;
+static const size_t PAYLOAD_SIZE = 3 * MAX_FRAGMENT_SIZE + MAX_FRAGMENT_SIZE / 2;
+
+int g_numFailures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        printf("Failed: %s\n", what);
+        g_numFailures++;
+    }
+}
+
+std::vector<uint8_t> makePayload(size_t size, uint8_t seed)
+{
+    std::vector<uint8_t> payload(size);
+    for (size_t i = 0; i < size; i++) {
+        payload[i] = (uint8_t)(seed + i * 7);
+    }
+    return payload;
+}
+
+/**
+ * Splits a payload in the fragments a MessageWriter sends
+ */
+std::vector<FramedMessage_t> makeFragments(
+        const std::vector<uint8_t> &payload, int32_t srcPid, int32_t msgCounter)
+{
+    MessageWriter writer(PAYLOAD_ID);
+    writer.write(payload.data(), payload.size());
+
+    std::vector<FramedMessage_t> fragments;
+    Errors error = writer.send(srcPid, msgCounter,
+            [&fragments](void* msg, size_t size) {
+                fragments.push_back(FramedMessage_t());
+                std::memcpy(static_cast<void*>(&fragments.back()), msg, size);
+                return NO_ERR;
+            });
+    check(NO_ERR == error, "writer sends the fragments");
+    return fragments;
+}
+
+/**
+ * Adds the fragments in the given order
+ * @return number of payloads completed, the last one in payload
+ */
+int addAll(MessageAssembler &assembler,
+        const std::vector<FramedMessage_t> &fragments,
+        const std::vector<size_t> &order, std::vector<uint8_t> &payload)
+{
+    int numCompleted = 0;
+    for (size_t i: order) {
+        if (assembler.add(fragments[i], payload)) {
+            numCompleted++;
+        }
+    }
+    return numCompleted;
+}
+
+std::vector<size_t> inOrder(size_t size)
+{
+    std::vector<size_t> order(size);
+    for (size_t i = 0; i < size; i++) {
+        order[i] = i;
+    }
+    return order;
+}
+
+void checkInOrder()
+{
+    MessageAssembler assembler;
+    std::vector<uint8_t> expected = makePayload(PAYLOAD_SIZE, 1);
+    std::vector<FramedMessage_t> fragments = makeFragments(expected, SRC_PID, 1);
+    check(4 == fragments.size(), "in order, number of fragments");
+
+    std::vector<uint8_t> payload;
+    check(1 == addAll(assembler, fragments, inOrder(fragments.size()), payload),
+            "in order, completed once");
+    check(expected == payload, "in order, payload unchanged");
+
+    // A payload of one fragment, even an empty one, completes at once
+    for (size_t size: {(size_t)0, (size_t)10}) {
+        expected = makePayload(size, 2);
+        fragments = makeFragments(expected, SRC_PID, 2);
+        check(1 == fragments.size() && assembler.add(fragments[0], payload) &&
+                expected == payload, "single fragment");
+    }
+}
+
+void checkOutOfOrder()
+{
+    MessageAssembler assembler;
+    std::vector<uint8_t> expected = makePayload(PAYLOAD_SIZE, 3);
+    std::vector<FramedMessage_t> fragments = makeFragments(expected, SRC_PID, 3);
+
+    std::vector<size_t> order = inOrder(fragments.size());
+    std::reverse(order.begin(), order.end());
+    std::vector<uint8_t> payload;
+    check(1 == addAll(assembler, fragments, order, payload),
+            "reversed, completed once");
+    check(expected == payload, "reversed, payload unchanged");
+
+    // Two payloads of the same counter from two sources, interleaved
+    std::vector<uint8_t> other = makePayload(PAYLOAD_SIZE, 4);
+    std::vector<FramedMessage_t> otherFragments =
+            makeFragments(other, SRC_PID + 1, 3);
+    fragments = makeFragments(expected, SRC_PID, 3);
+    int numCompleted = 0;
+    bool isUnchanged = true;
+    for (size_t i: {2, 0, 3, 1}) {
+        if (assembler.add(fragments[i], payload)) {
+            numCompleted++;
+            isUnchanged = isUnchanged && expected == payload;
+        }
+        if (assembler.add(otherFragments[3 - i], payload)) {
+            numCompleted++;
+            isUnchanged = isUnchanged && other == payload;
+        }
+    }
+    check(2 == numCompleted && isUnchanged, "interleaved sources");
+}
+
+void checkDuplicates()
+{
+    MessageAssembler assembler;
+    std::vector<uint8_t> expected = makePayload(PAYLOAD_SIZE, 5);
+    std::vector<FramedMessage_t> fragments = makeFragments(expected, SRC_PID, 5);
+
+    // A repeated fragment must not stand in for a missing one
+    std::vector<uint8_t> payload;
+    check(0 == addAll(assembler, fragments, {0, 1, 1, 2, 2, 0}, payload),
+            "duplicates, not completed");
+    check(1 == addAll(assembler, fragments, {3, 3}, payload),
+            "duplicates, completed by the last fragment");
+    check(expected == payload, "duplicates, payload unchanged");
+}
+
+void checkInvalid()
+{
+    MessageAssembler assembler;
+    std::vector<uint8_t> expected = makePayload(PAYLOAD_SIZE, 6);
+    std::vector<FramedMessage_t> fragments = makeFragments(expected, SRC_PID, 6);
+    std::vector<uint8_t> payload;
+
+    FramedMessage_t msg = fragments[0];
+    msg.totalSize = MAX_FRAMED_PAYLOAD_SIZE + 1;
+    check(!assembler.add(msg, payload), "payload too large refused");
+
+    msg = fragments[0];
+    msg.length = MAX_FRAGMENT_SIZE + 1;
+    check(!assembler.add(msg, payload), "fragment too large refused");
+
+    msg = fragments[3];
+    msg.offset += 1;
+    check(!assembler.add(msg, payload), "fragment past the payload refused");
+
+    msg = fragments[1];
+    msg.offset -= 1;
+    check(!assembler.add(msg, payload), "misaligned fragment refused");
+
+    msg = fragments[1];
+    msg.length -= 1;
+    check(!assembler.add(msg, payload), "short fragment refused");
+
+    msg = fragments[0];
+    msg.totalSize = -1;
+    check(!assembler.add(msg, payload), "negative size refused");
+
+    // A fragment that disagrees on the size of its payload
+    check(!assembler.add(fragments[0], payload), "first fragment");
+    msg = fragments[1];
+    msg.totalSize += MAX_FRAGMENT_SIZE;
+    check(!assembler.add(msg, payload), "fragment of another size refused");
+    check(1 == addAll(assembler, fragments, {1, 2, 3}, payload) &&
+            expected == payload, "completed after invalid fragments");
+
+    MessageWriter writer(PAYLOAD_ID);
+    std::vector<uint8_t> large(MAX_FRAMED_PAYLOAD_SIZE + 1);
+    writer.write(large.data(), large.size());
+    check(ERR_INVALID == writer.send(SRC_PID, 7,
+            [](void*, size_t) { return NO_ERR; }),
+            "writer refuses a payload too large");
+}
+
+void checkAbandoned()
+{
+    MessageAssembler assembler;
+    std::vector<uint8_t> payload;
+
+    // One partial payload more than is kept, the oldest is forgotten
+    std::vector<std::vector<FramedMessage_t>> fragments;
+    std::vector<std::vector<uint8_t>> expected;
+    for (size_t i = 0; i <= MAX_PENDING_ASSEMBLIES; i++) {
+        expected.push_back(makePayload(PAYLOAD_SIZE, (uint8_t)i));
+        fragments.push_back(makeFragments(expected.back(), SRC_PID, 10 + i));
+        assembler.add(fragments.back()[0], payload);
+    }
+    check(0 == addAll(assembler, fragments[0], {1, 2, 3}, payload),
+            "oldest partial payload forgotten");
+
+    bool isCompleted = true;
+    for (size_t i = 2; i <= MAX_PENDING_ASSEMBLIES; i++) {
+        isCompleted = isCompleted &&
+                1 == addAll(assembler, fragments[i], {1, 2, 3}, payload) &&
+                expected[i] == payload;
+    }
+    check(isCompleted, "newer partial payloads kept");
+
+    // The partial payloads of a source that left are dropped
+    std::vector<uint8_t> other = makePayload(PAYLOAD_SIZE, 8);
+    std::vector<FramedMessage_t> otherFragments =
+            makeFragments(other, SRC_PID + 1, 8);
+    check(!assembler.add(otherFragments[0], payload), "other source, first");
+    assembler.remove(SRC_PID + 1);
+    check(0 == addAll(assembler, otherFragments, {1, 2, 3}, payload),
+            "removed source, not completed");
+}
+} // end of anonymous namespace
+
+/**
+ * @brief feeds fragments to message assemblers in various orders
+ * @return EXIT_SUCCESS if every check passed
+ */
+int main()
+{
+    checkInOrder();
+    checkOutOfOrder();
+    checkDuplicates();
+    checkInvalid();
+    checkAbandoned();
+
+    if (0 != g_numFailures) {
+        printf("%d checks failed\n", g_numFailures);
+        return EXIT_FAILURE;
+    }
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
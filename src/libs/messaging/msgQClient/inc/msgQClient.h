@@ -39,6 +39,13 @@ public:
     virtual ~MsgQClient();
     Errors send(const void* send_data, const size_t sendDataSize,
             unsigned int msgPriority) const;
+
+    /**
+     * Sends, waiting at most timeoutUs for room in the queue. A timeout is
+     * not reported as a failure on stdio.
+     */
+    Errors send(const void* send_data, const size_t sendDataSize,
+            unsigned int msgPriority, int timeoutUs, bool &isTimedOut) const;
     Errors connect();
     Errors disconnect();
     Errors isConnected() const;
@@ -28,6 +28,8 @@
 #include <stdio.h>
 
 #include <cstring>
+#include <ctime>
+#include <errno.h>
 
 namespace tarsim {
 
@@ -132,6 +134,7 @@ Errors MsgQClient::isConnected() const
  * @brief send data to the message q. server
  * @param send_data - the buffer data to be sent
  * @param sendDataSize - size of buffer to send
+ * @param msgPriority - higher priorities are received first
  * @return NO_ERR if data was sent successfylly otherwise returns ERR_MQ_FAILED_SEND
  */
 Errors MsgQClient::send(const void* send_data, const size_t sendDataSize,
@@ -148,7 +151,7 @@ Errors MsgQClient::send(const void* send_data, const size_t sendDataSize,
         return ERR_MQ_FAILED_SEND;
 
     }
-    int result = mq_send(m_qId,(char *)send_data, sendDataSize, m_priority);
+    int result = mq_send(m_qId,(char *)send_data, sendDataSize, msgPriority);
     if (result == -1)
     {
         if (m_printingStdio)
@@ -162,6 +165,43 @@ Errors MsgQClient::send(const void* send_data, const size_t sendDataSize,
 
 }
 
+Errors MsgQClient::send(const void* send_data, const size_t sendDataSize,
+        unsigned int msgPriority, int timeoutUs, bool &isTimedOut) const
+{
+    isTimedOut = false;
+    if ((mqd_t)-1 == m_qId)
+    {
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutUs / 1000000;
+    deadline.tv_nsec += (long)(timeoutUs % 1000000) * 1000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_nsec -= 1000000000L;
+        deadline.tv_sec++;
+    }
+
+    int result = mq_timedsend(m_qId, (char *)send_data, sendDataSize,
+            msgPriority, &deadline);
+    if (result == -1)
+    {
+        if (ETIMEDOUT == errno)
+        {
+            isTimedOut = true;
+        }
+        else if (m_printingStdio)
+        {
+            printf("Failed to send to receiver %s message queue, errno(%d)=%s\n",
+                    m_qName.c_str(),errno, strerror(errno));
+        }
+        return ERR_MQ_FAILED_SEND;
+    }
+    return NO_ERR;
+}
+
 Errors MsgQClient::sendMessage(const void* send_data,
                                     const size_t sendDataSize,
                                     const char *fileStr, const int &lineNumber)
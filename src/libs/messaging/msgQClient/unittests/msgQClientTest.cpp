@@ -0,0 +1,123 @@
+/**
+ *
+ * @file: msgQClientTest.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Checks that the priority given to each send decides the order in
+ * which messages are received, for plain and timed sends
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <string>
+#include <unistd.h>
+#include "msgQClient.h"
+
+using namespace tarsim;
+
+namespace {
+static const unsigned int LOW_PRIORITY = 1;
+static const unsigned int HIGH_PRIORITY = 20;
+static const int SEND_TIMEOUT_US = 100000;
+
+int g_numFailures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        printf("Failed: %s\n", what);
+        g_numFailures++;
+    }
+}
+
+/**
+ * Sends a low then a high priority message and checks the high one is
+ * received first
+ */
+void checkOrder(mqd_t qId, MsgQClient &client, bool isTimed)
+{
+    int32_t low = 1;
+    int32_t high = 2;
+    if (isTimed) {
+        bool isTimedOut = false;
+        check(NO_ERR == client.send(&low, sizeof(low), LOW_PRIORITY,
+                SEND_TIMEOUT_US, isTimedOut), "timed send, low priority");
+        check(NO_ERR == client.send(&high, sizeof(high), HIGH_PRIORITY,
+                SEND_TIMEOUT_US, isTimedOut), "timed send, high priority");
+    } else {
+        check(NO_ERR == client.send(&low, sizeof(low), LOW_PRIORITY),
+                "send, low priority");
+        check(NO_ERR == client.send(&high, sizeof(high), HIGH_PRIORITY),
+                "send, high priority");
+    }
+
+    int32_t first = 0;
+    int32_t second = 0;
+    unsigned int priority = 0;
+    check(sizeof(first) == mq_receive(qId, (char*)&first, sizeof(first),
+            &priority), "receive first");
+    check(HIGH_PRIORITY == priority && high == first,
+            isTimed ? "timed, high priority first" : "high priority first");
+    check(sizeof(second) == mq_receive(qId, (char*)&second, sizeof(second),
+            &priority), "receive second");
+    check(LOW_PRIORITY == priority && low == second,
+            isTimed ? "timed, low priority second" : "low priority second");
+}
+} // end of anonymous namespace
+
+/**
+ * @brief sends through a MsgQClient to a private queue and reads it back
+ * @return EXIT_SUCCESS if every check passed
+ */
+int main()
+{
+    std::string qName = "msgQClientTest" + std::to_string(getpid());
+    std::string path = "/" + qName;
+
+    struct mq_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = 4;
+    attr.mq_msgsize = sizeof(int32_t);
+    mqd_t qId = mq_open(path.c_str(), O_CREAT | O_RDONLY | O_NONBLOCK,
+            0600, &attr);
+    if ((mqd_t)-1 == qId) {
+        printf("Failed to create %s, errno(%d)=%s\n",
+                path.c_str(), errno, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    {
+        MsgQClient client(qName);
+        check(NO_ERR == client.connect(), "connect");
+        checkOrder(qId, client, false);
+        checkOrder(qId, client, true);
+    }
+
+    mq_close(qId);
+    mq_unlink(path.c_str());
+
+    if (0 != g_numFailures) {
+        printf("%d checks failed\n", g_numFailures);
+        return EXIT_FAILURE;
+    }
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
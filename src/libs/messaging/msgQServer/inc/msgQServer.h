@@ -29,6 +29,8 @@
 #include <string>
 #include "eitErrors.h"
 #include <thread>
+#include <vector>
+#include <atomic>
 #include <mutex>              // std::mutex, std::unique_lock
 #include <condition_variable> // std::condition_variable
 
@@ -57,10 +59,30 @@ protected:
     virtual void onMessage(const GenericData_t &inComingData);
     virtual void onExit();
 
+    /**
+     * Called instead of onMessage when draining is enabled and more than one
+     * message was waiting in the queue, with all of them in arrival order.
+     * By default every message is handed to onMessage.
+     */
+    virtual void onMessages(const std::vector<GenericData_t> &inComingData);
+
+    /**
+     * When draining, every message waiting in the queue is received at once
+     * so a child class can coalesce the stale ones
+     */
+    void setDraining(bool isDraining) { m_isDraining = isDraining; };
+    bool isDraining() const { return m_isDraining; };
+
+    /**
+     * Number of messages still waiting in the queue
+     */
+    int64_t getNumPending() const;
+
 //private-----------------------------------------------------------------------
 private:
     Errors cleanup();
     Errors running();
+    bool receivePending(GenericData_t &data);
     void endAndExit();
     static void* threadFunctionHelper(void* void_ptr_to_this_threaded_object);
     std::string         m_qName;        // Queue Name
@@ -76,6 +98,9 @@ private:
 
     std::unique_ptr<pthread_t> m_pthread;
 
+    std::atomic<bool>   m_isDraining {false}; // receive all waiting messages at once
+    std::vector<GenericData_t> m_pending; // messages drained in one wake up
+
     int m_threadPolicy = 0;
     int m_threadPriority = 0;
 
@@ -25,6 +25,7 @@
 #include "logClient.h"
 #include <errno.h>
 #include <cstring>
+#include <ctime>
 #include <iostream>
 
 
@@ -52,6 +53,7 @@ MsgQServer::MsgQServer(
     m_attr.mq_msgsize = MAX_MSG_SIZE;
     m_runforEver = true;
     m_ready = false;
+    m_pending.reserve(MAX_QUEUE_SIZE);
     m_printingStdio = m_qName.compare(LogServerThreadName) == 0;
     m_printingStdio = true;
 }
@@ -184,6 +186,7 @@ Errors MsgQServer::running()
     {
         ssize_t bytesRead;
         bytesRead = mq_receive(m_qId, (char *)&data, MAX_MSG_SIZE, NULL);
+        data.simpleMsg.receiveTimeNs = getMonotonicTimeNs();
         if (bytesRead <= 0)
         {
             if (m_printingStdio)
@@ -193,6 +196,39 @@ Errors MsgQServer::running()
 
             }
         }
+        else if (m_isDraining)
+        {
+            // Take everything that piled up, up to an exit event
+            m_pending.clear();
+            m_pending.push_back(data);
+            while ((MSG_EXIT_EVENT != data.simpleMsg.msgId) &&
+                   ((int32_t)m_pending.size() < MAX_QUEUE_SIZE) &&
+                   receivePending(data))
+            {
+                m_pending.push_back(data);
+            }
+
+            m_runforEver = (MSG_EXIT_EVENT != data.simpleMsg.msgId);
+            if (!m_runforEver)
+            {
+                m_pending.pop_back();
+            }
+
+            if (1 == m_pending.size())
+            {
+                onMessage(m_pending.front());
+            }
+            else if (!m_pending.empty())
+            {
+                onMessages(m_pending);
+            }
+
+            if (!m_runforEver)
+            {
+                onExit();
+                cleanup();
+            }
+        }
         else
         {
         	m_runforEver = (MSG_EXIT_EVENT != data.simpleMsg.msgId);
@@ -211,6 +247,22 @@ Errors MsgQServer::running()
     return Errors::NO_ERR;
 }
 
+/**
+ * @brief - receives a message only if one is already waiting
+ * @param data - the message received
+ * @return true if a message was received
+ */
+bool MsgQServer::receivePending(GenericData_t &data)
+{
+    // A timeout in the past makes the receive return at once
+    struct timespec now = {0, 0};
+    if (mq_timedreceive(m_qId, (char *)&data, MAX_MSG_SIZE, NULL, &now) <= 0) {
+        return false;
+    }
+    data.simpleMsg.receiveTimeNs = getMonotonicTimeNs();
+    return true;
+}
+
 void MsgQServer::onExit()
 {
 	//allow cleanup for the child if needed
@@ -224,6 +276,24 @@ void MsgQServer::onMessage(const GenericData_t &inComingData)
 {
 }
 
+int64_t MsgQServer::getNumPending() const
+{
+    struct mq_attr attr;
+    if ((mqd_t)-1 == m_qId || 0 != mq_getattr(m_qId, &attr))
+    {
+        return 0;
+    }
+    return (int64_t)attr.mq_curmsgs;
+}
+
+void MsgQServer::onMessages(const std::vector<GenericData_t> &inComingData)
+{
+    for (const GenericData_t &data: inComingData)
+    {
+        onMessage(data);
+    }
+}
+
 
 /**
  * @brief       Close the message queue
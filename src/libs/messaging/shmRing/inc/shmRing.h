@@ -0,0 +1,98 @@
+/**
+ *
+ * @file: shmRing.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Single-producer single-consumer lock-free ring buffer in POSIX
+ * shared memory. The consumer sleeps on a futex when the ring is empty and
+ * the producer only issues the wake syscall when the consumer is asleep.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_SHMRING_INC_H_
+#define SRC_LIBS_SHMRING_INC_H_
+
+//INCLUDES
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "eitErrors.h"
+#include "ipcMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const uint32_t SHM_RING_DEFAULT_SLOTS = 256; // number of messages the ring holds
+static const int SHM_RING_SPIN_COUNT = 2000; // polls before the consumer sleeps
+
+//structs-----------------------------------------------------------------------
+struct ShmRingHeader_t;
+
+class ShmRing
+{
+public:
+    /**
+     * Constructor
+     * @param name Shared memory object name (without the leading '/')
+     * @param isOwner The owner creates, initializes and unlinks the ring
+     * @param numSlots Number of slots, rounded up to a power of two
+     */
+    ShmRing(const std::string &name, bool isOwner,
+            uint32_t numSlots = SHM_RING_DEFAULT_SLOTS);
+    virtual ~ShmRing();
+
+    Errors open();
+    Errors close();
+    bool isOpen() const;
+
+    /**
+     * Copies a message into the ring, never blocks
+     * @return ERR_MQ_FAILED_SEND if the ring is full or not open
+     */
+    Errors push(const void* data, const size_t size);
+
+    /**
+     * Copies the oldest message out of the ring
+     * @param data Buffer of at least MAX_MSG_SIZE bytes
+     * @param size Size of the message
+     * @param timeoutUs How long to wait for a message, negative waits forever
+     * @return ERR_MQ_FAILED_RECEIVE if no message arrived in time
+     */
+    Errors pop(void* data, size_t &size, int timeoutUs = -1);
+
+    /**
+     * Wakes the consumer up without a message, e.g. to stop its thread
+     */
+    void wakeConsumer();
+
+    uint64_t getNumDropped() const;
+    const std::string& getName() const;
+
+private:
+    void wake();
+
+    std::string m_name;
+    bool m_isOwner = false;
+    uint32_t m_numSlots = 0;
+    size_t m_mapSize = 0;
+    int m_fd = -1;
+    ShmRingHeader_t* m_header = nullptr;
+    uint8_t* m_slots = nullptr;
+    std::atomic<uint64_t> m_numDropped {0};
+
+    // Serializes producers of this process, the ring itself has one producer
+    std::mutex m_mutexProducer;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_SHMRING_INC_H_ */
@@ -0,0 +1,75 @@
+/**
+ *
+ * @file: shmRingServer.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Thread that consumes a shared memory ring and hands every message
+ * to a callback, the shared memory counterpart of MsgQServer
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_SHMRINGSERVER_INC_H_
+#define SRC_LIBS_SHMRINGSERVER_INC_H_
+
+//INCLUDES
+#include <pthread.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "shmRing.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int SHM_RING_SERVER_POLL_US = 100000; // how often the thread checks for stop
+
+class ShmRingServer
+{
+public:
+    typedef std::function<void(const GenericData_t&)> Callback;
+
+    /**
+     * Constructor
+     * @param name Name of the ring to consume
+     * @param isOwner Whether this side creates the ring
+     * @param callback Called on the server thread for every message
+     * @param policy Server thread scheduling policy
+     * @param priority Server thread priority
+     */
+    ShmRingServer(
+            const std::string &name,
+            bool isOwner,
+            Callback callback,
+            int policy = DEFAULT_RT_THREAD_POLICY,
+            int priority = DEFAULT_RT_THREAD_PRIORITY);
+    virtual ~ShmRingServer();
+
+    Errors start();
+    Errors stop();
+
+    ShmRing* getRing();
+
+private:
+    static void* threadFunctionHelper(void* object);
+    void running();
+
+    ShmRing m_ring;
+    Callback m_callback;
+    int m_threadPolicy = 0;
+    int m_threadPriority = 0;
+    std::atomic<bool> m_runForEver {false};
+    std::unique_ptr<pthread_t> m_pthread;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_SHMRINGSERVER_INC_H_ */
@@ -0,0 +1,294 @@
+/**
+ * @file: shmRing.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of ShmRing
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "shmRing.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <new>
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const uint32_t k_shmRingMagic = 0x54535352; // "TSSR"
+static const size_t k_cacheLineSize = 64;
+
+// Every slot holds the message size followed by the message itself
+static const size_t k_slotStride =
+        ((sizeof(uint32_t) + MAX_MSG_SIZE + k_cacheLineSize - 1) /
+                k_cacheLineSize) * k_cacheLineSize;
+
+//structs-----------------------------------------------------------------------
+struct ShmRingHeader_t
+{
+    uint32_t magic;
+    uint32_t numSlots;
+
+    // Producer and consumer indices live on separate cache lines
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) std::atomic<uint32_t> isConsumerWaiting;
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(int),
+        "futex requires 32 bit atomics");
+
+static int futex(std::atomic<uint32_t>* addr, int op, uint32_t val,
+        const struct timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<int*>(addr), op, val, timeout,
+            nullptr, 0);
+}
+
+/**
+ * @brief initialize the ring data members, nothing is mapped until open()
+ */
+ShmRing::ShmRing(const std::string &name, bool isOwner, uint32_t numSlots):
+        m_name(name),
+        m_isOwner(isOwner)
+{
+    m_numSlots = 1;
+    while (m_numSlots < numSlots) {
+        m_numSlots <<= 1;
+    }
+}
+
+ShmRing::~ShmRing()
+{
+    close();
+}
+
+/**
+ * @brief creates (owner) or attaches to (non-owner) the shared memory ring
+ * @return NO_ERR if successful, ERR_MQ_FAILED_OPEN otherwise
+ */
+Errors ShmRing::open()
+{
+    if (isOpen()) {
+        return NO_ERR;
+    }
+
+    std::string shmName = "/" + m_name;
+    // Both ends write to the ring, so the peer needs the user or group of
+    // its owner; other local users may not inject messages
+    if (m_isOwner) {
+        shm_unlink(shmName.c_str());
+        m_fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    } else {
+        m_fd = shm_open(shmName.c_str(), O_RDWR, 0);
+    }
+
+    if (m_fd < 0) {
+        printf("Failed to open shared memory ring %s, errno(%d)=%s\n",
+                shmName.c_str(), errno, strerror(errno));
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    if (m_isOwner) {
+        m_mapSize = sizeof(ShmRingHeader_t) + m_numSlots * k_slotStride;
+        if (ftruncate(m_fd, m_mapSize) != 0) {
+            printf("Failed to size shared memory ring %s, errno(%d)=%s\n",
+                    shmName.c_str(), errno, strerror(errno));
+            close();
+            return ERR_MQ_FAILED_OPEN;
+        }
+    } else {
+        struct stat st;
+        if (fstat(m_fd, &st) != 0 ||
+            (size_t)st.st_size < sizeof(ShmRingHeader_t)) {
+            printf("Shared memory ring %s is not initialized\n", shmName.c_str());
+            close();
+            return ERR_MQ_FAILED_OPEN;
+        }
+        m_mapSize = st.st_size;
+    }
+
+    void* p = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (MAP_FAILED == p) {
+        printf("Failed to map shared memory ring %s, errno(%d)=%s\n",
+                shmName.c_str(), errno, strerror(errno));
+        m_mapSize = 0;
+        close();
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_header = static_cast<ShmRingHeader_t*>(p);
+    m_slots = static_cast<uint8_t*>(p) + sizeof(ShmRingHeader_t);
+
+    if (m_isOwner) {
+        new (m_header) ShmRingHeader_t();
+        m_header->numSlots = m_numSlots;
+        m_header->head.store(0);
+        m_header->tail.store(0);
+        m_header->isConsumerWaiting.store(0);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = k_shmRingMagic;
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_header->magic != k_shmRingMagic ||
+            m_mapSize < sizeof(ShmRingHeader_t) +
+                m_header->numSlots * k_slotStride) {
+            printf("Shared memory ring %s is corrupted\n", shmName.c_str());
+            close();
+            return ERR_MQ_FAILED_OPEN;
+        }
+        m_numSlots = m_header->numSlots;
+    }
+
+    return NO_ERR;
+}
+
+/**
+ * @brief unmaps the ring, the owner also removes it from /dev/shm
+ */
+Errors ShmRing::close()
+{
+    Errors errCode = NO_ERR;
+    if (m_header) {
+        if (munmap(m_header, m_mapSize) != 0) {
+            errCode = ERR_MQ_FAILED_CLOSE;
+        }
+        m_header = nullptr;
+        m_slots = nullptr;
+    }
+
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        if (m_isOwner) {
+            shm_unlink(("/" + m_name).c_str());
+        }
+    }
+    return errCode;
+}
+
+bool ShmRing::isOpen() const
+{
+    return m_header != nullptr;
+}
+
+Errors ShmRing::push(const void* data, const size_t size)
+{
+    if (!isOpen() || size > (size_t)MAX_MSG_SIZE) {
+        printf("Failed to push %zu bytes to shared memory ring %s\n",
+                size, m_name.c_str());
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexProducer);
+    uint32_t head = m_header->head.load(std::memory_order_relaxed);
+    uint32_t tail = m_header->tail.load(std::memory_order_acquire);
+    if (head - tail >= m_numSlots) {
+        m_numDropped++;
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    uint8_t* slot = m_slots + (head & (m_numSlots - 1)) * k_slotStride;
+    uint32_t slotSize = (uint32_t)size;
+    memcpy(slot, &slotSize, sizeof(slotSize));
+    memcpy(slot + sizeof(slotSize), data, size);
+
+    // Publishing head and reading the waiting flag must not be reordered,
+    // otherwise a consumer going to sleep could miss this message
+    m_header->head.store(head + 1, std::memory_order_seq_cst);
+    if (m_header->isConsumerWaiting.load(std::memory_order_seq_cst)) {
+        wake();
+    }
+    return NO_ERR;
+}
+
+Errors ShmRing::pop(void* data, size_t &size, int timeoutUs)
+{
+    if (!isOpen()) {
+        return ERR_MQ_FAILED_RECEIVE;
+    }
+
+    uint32_t tail = m_header->tail.load(std::memory_order_relaxed);
+
+    // Spin for a short while, a message is usually on its way
+    bool isAvailable = false;
+    for (int i = 0; i < SHM_RING_SPIN_COUNT; i++) {
+        if (m_header->head.load(std::memory_order_acquire) != tail) {
+            isAvailable = true;
+            break;
+        }
+    }
+
+    if (!isAvailable) {
+        m_header->isConsumerWaiting.store(1, std::memory_order_seq_cst);
+        uint32_t head = m_header->head.load(std::memory_order_seq_cst);
+        if (head == tail) {
+            struct timespec ts;
+            struct timespec* timeout = nullptr;
+            if (timeoutUs >= 0) {
+                ts.tv_sec = timeoutUs / 1000000;
+                ts.tv_nsec = (timeoutUs % 1000000) * 1000;
+                timeout = &ts;
+            }
+            futex(&m_header->head, FUTEX_WAIT, head, timeout);
+        }
+        m_header->isConsumerWaiting.store(0, std::memory_order_relaxed);
+
+        if (m_header->head.load(std::memory_order_acquire) == tail) {
+            // Timed out or woken up by wakeConsumer()
+            return ERR_MQ_FAILED_RECEIVE;
+        }
+    }
+
+    const uint8_t* slot = m_slots + (tail & (m_numSlots - 1)) * k_slotStride;
+    uint32_t slotSize = 0;
+    memcpy(&slotSize, slot, sizeof(slotSize));
+    size = std::min((size_t)slotSize, (size_t)MAX_MSG_SIZE);
+    memcpy(data, slot + sizeof(slotSize), size);
+    m_header->tail.store(tail + 1, std::memory_order_release);
+    return NO_ERR;
+}
+
+void ShmRing::wakeConsumer()
+{
+    if (isOpen()) {
+        wake();
+    }
+}
+
+void ShmRing::wake()
+{
+    futex(&m_header->head, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+uint64_t ShmRing::getNumDropped() const
+{
+    return m_numDropped.load();
+}
+
+const std::string& ShmRing::getName() const
+{
+    return m_name;
+}
+
+} // end of namespace tarsim
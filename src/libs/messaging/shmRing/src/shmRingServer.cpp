@@ -0,0 +1,138 @@
+/**
+ * @file: shmRingServer.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of ShmRingServer
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "shmRingServer.h"
+#include <cstdio>
+
+namespace tarsim {
+
+ShmRingServer::ShmRingServer(
+        const std::string &name, bool isOwner, Callback callback,
+        int policy, int priority):
+        m_ring(name, isOwner),
+        m_callback(callback),
+        m_threadPolicy(policy),
+        m_threadPriority(priority)
+{
+}
+
+ShmRingServer::~ShmRingServer()
+{
+    stop();
+}
+
+/**
+ * @brief opens the ring and spawns the consumer thread, real-time if allowed
+ * @return NO_ERR if successful
+ */
+Errors ShmRingServer::start()
+{
+    if (nullptr != m_pthread.get()) {
+        printf("Failed: Thread already exists\n");
+        return ERR_INVALID;
+    }
+
+    if (NO_ERR != m_ring.open()) {
+        printf("Failed to open shared memory ring %s\n",
+                m_ring.getName().c_str());
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_runForEver = true;
+    m_pthread = std::unique_ptr<pthread_t>(new pthread_t);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setschedpolicy(&attr, m_threadPolicy);
+    struct sched_param param;
+    param.sched_priority = m_threadPriority;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    int ret = pthread_create(
+            m_pthread.get(), &attr, ShmRingServer::threadFunctionHelper, this);
+    if (ret) {
+        ret = pthread_create(
+                m_pthread.get(), nullptr, ShmRingServer::threadFunctionHelper, this);
+        if (ret) {
+            printf("Failed to create thread for ring %s (error = %d)\n",
+                    m_ring.getName().c_str(), ret);
+            pthread_attr_destroy(&attr);
+            m_pthread.reset();
+            m_runForEver = false;
+            return ERR_FAILED_SPAWNED;
+        }
+        printf("Create non-realtime thread %s\n", m_ring.getName().c_str());
+    }
+    pthread_attr_destroy(&attr);
+
+    // Thread names are limited to 16 characters
+    pthread_setname_np(*m_pthread.get(), m_ring.getName().substr(0, 15).c_str());
+    return NO_ERR;
+}
+
+/**
+ * @brief stops and joins the consumer thread
+ */
+Errors ShmRingServer::stop()
+{
+    if (nullptr == m_pthread.get()) {
+        return NO_ERR;
+    }
+
+    m_runForEver = false;
+    m_ring.wakeConsumer();
+    pthread_join(*m_pthread.get(), nullptr);
+    m_pthread.reset();
+    return m_ring.close();
+}
+
+ShmRing* ShmRingServer::getRing()
+{
+    return &m_ring;
+}
+
+void* ShmRingServer::threadFunctionHelper(void* object)
+{
+    static_cast<ShmRingServer*>(object)->running();
+    return nullptr;
+}
+
+void ShmRingServer::running()
+{
+    GenericData_t data;
+    while (m_runForEver) {
+        size_t size = 0;
+        if (NO_ERR != m_ring.pop(&data, size, SHM_RING_SERVER_POLL_US)) {
+            continue;
+        }
+
+        if (size < sizeof(MessageHeader_t)) {
+            continue;
+        }
+
+        data.simpleMsg.receiveTimeNs = getMonotonicTimeNs();
+        m_callback(data);
+    }
+}
+
+} // end of namespace tarsim
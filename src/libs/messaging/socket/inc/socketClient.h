@@ -0,0 +1,104 @@
+/**
+ *
+ * @file: socketClient.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Connection to a SocketServer over a Unix domain socket or TCP.
+ * Messages are sent on the caller thread and received on a thread of the
+ * connection that hands every one of them to a callback.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_SOCKETCLIENT_INC_H_
+#define SRC_LIBS_SOCKETCLIENT_INC_H_
+
+//INCLUDES
+#include <pthread.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "socketTransport.h"
+
+namespace tarsim {
+class SocketClient
+{
+public:
+    typedef std::function<void(const GenericData_t&)> Callback;
+
+    /**
+     * Constructor
+     * @param type Unix domain or TCP
+     * @param address Path of the Unix domain socket, or host of the server
+     * @param port Port of the server, TCP only
+     * @param callback Called on the receive thread for every message
+     * @param policy Receive thread scheduling policy
+     * @param priority Receive thread priority
+     */
+    SocketClient(
+            SocketTypes type,
+            const std::string &address,
+            int port,
+            Callback callback,
+            int policy = DEFAULT_RT_THREAD_POLICY,
+            int priority = DEFAULT_RT_THREAD_PRIORITY);
+    virtual ~SocketClient();
+
+    /**
+     * Connects to the server and spawns the receive thread
+     */
+    Errors start();
+    Errors stop();
+
+    /**
+     * Sends a message, blocking until the socket takes all of it
+     */
+    Errors send(const void* data, size_t size);
+
+    /**
+     * @return false once the server closed the connection
+     */
+    bool isConnected() const;
+
+    std::string getName() const;
+
+private:
+    Errors connectToServer();
+    static void* threadFunctionHelper(void* object);
+    void running();
+
+    // Reads what arrived, false once the connection is closed
+    bool receiveMessages(std::vector<GenericData_t> &messages);
+    bool receiveStream(std::vector<GenericData_t> &messages);
+
+    SocketTypes m_type = SOCKET_UNIX;
+    std::string m_address;
+    int m_port = 0;
+    Callback m_callback;
+    int m_threadPolicy = 0;
+    int m_threadPriority = 0;
+    int m_fd = -1;
+    std::atomic<bool> m_isConnected {false};
+    std::atomic<bool> m_runForEver {false};
+    std::unique_ptr<pthread_t> m_pthread;
+
+    // Messages are written whole, one caller at a time
+    mutable std::mutex m_mutexSend;
+
+    // Bytes of a TCP stream not yet making a whole message
+    std::vector<uint8_t> m_stream;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_SOCKETCLIENT_INC_H_ */
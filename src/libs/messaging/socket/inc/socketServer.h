@@ -0,0 +1,157 @@
+/**
+ *
+ * @file: socketServer.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Accepts SocketClient connections on a Unix domain socket and on a
+ * loopback TCP port. One epoll thread serves all of them, so tens of clients
+ * do not take tens of threads. Messages are handed to a callback in batches,
+ * as many as one read took. Replies are written straight to the socket and
+ * held for the thread to finish only when the client is not reading fast
+ * enough, so a slow client never blocks the caller.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_SOCKETSERVER_INC_H_
+#define SRC_LIBS_SOCKETSERVER_INC_H_
+
+//INCLUDES
+#include <pthread.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "socketTransport.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int SOCKET_MAX_EVENTS = 64; // events taken by one epoll_wait
+static const size_t SOCKET_MAX_PENDING_SIZE = 256 * 1024; // bytes held for a slow client
+
+class SocketServer
+{
+public:
+    /**
+     * Called on the server thread with the messages of one read of a
+     * connection. They may be modified in place.
+     */
+    typedef std::function<void(
+            int32_t connectionId, std::vector<GenericData_t> &messages)> Callback;
+
+    /**
+     * Called on the server thread once a connection is closed
+     */
+    typedef std::function<void(int32_t connectionId)> CloseCallback;
+
+    /**
+     * Constructor
+     * @param path Path of the Unix domain socket, none if empty
+     * @param port Loopback TCP port, none if not positive
+     * @param callback Called for the messages of every read
+     * @param onClose Called for every connection closed
+     * @param policy Server thread scheduling policy
+     * @param priority Server thread priority
+     */
+    SocketServer(
+            const std::string &path,
+            int port,
+            Callback callback,
+            CloseCallback onClose,
+            int policy = DEFAULT_RT_THREAD_POLICY,
+            int priority = DEFAULT_RT_THREAD_PRIORITY);
+    virtual ~SocketServer();
+
+    Errors start();
+    Errors stop();
+
+    /**
+     * Sends a message to a connection, from any thread. It is dropped if the
+     * client already has SOCKET_MAX_PENDING_SIZE bytes it did not read.
+     */
+    Errors send(int32_t connectionId, const void* data, size_t size);
+
+    /**
+     * Closes a connection, from any thread. The close callback follows on
+     * the server thread.
+     */
+    void close(int32_t connectionId);
+
+    /**
+     * @return messages dropped for a connection that did not read them
+     */
+    uint64_t getNumDropped(int32_t connectionId) const;
+
+private:
+    struct Connection_t
+    {
+        int fd = -1;
+        SocketTypes type = SOCKET_UNIX;
+
+        // Messages the socket did not take yet, the first one from offset
+        std::mutex mutexOutbound;
+        std::deque<std::vector<uint8_t>> outbound;
+        size_t offset = 0;
+        size_t pendingSize = 0;
+        uint64_t numDropped = 0;
+
+        // Bytes of a TCP stream not yet making a whole message, only
+        // touched by the server thread
+        std::vector<uint8_t> stream;
+    };
+
+    Errors listenUnix();
+    Errors listenTcp();
+    Errors watch(int operation, int fd, int64_t id, uint32_t events);
+
+    static void* threadFunctionHelper(void* object);
+    void running();
+
+    void accept(int listenFd, SocketTypes type);
+    std::shared_ptr<Connection_t> getConnection(int32_t connectionId) const;
+    void closeConnection(int32_t connectionId);
+
+    // Reads what arrived, false once the connection is closed
+    bool receive(int32_t connectionId, Connection_t &connection);
+    bool receiveMessages(Connection_t &connection);
+    bool receiveStream(Connection_t &connection);
+
+    // Writes what the socket takes, with the outbound lock held
+    bool flush(Connection_t &connection);
+
+    std::string m_path;
+    int m_port = 0;
+    Callback m_callback;
+    CloseCallback m_onClose;
+    int m_threadPolicy = 0;
+    int m_threadPriority = 0;
+
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+    int m_unixFd = -1;
+    int m_tcpFd = -1;
+    std::atomic<bool> m_runForEver {false};
+    std::unique_ptr<pthread_t> m_pthread;
+
+    // Messages of the current read, only touched by the server thread
+    std::vector<GenericData_t> m_messages;
+
+    mutable std::mutex m_mutexConnections;
+    std::map<int32_t, std::shared_ptr<Connection_t>> m_connections;
+    int32_t m_nextConnectionId = 0;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_SOCKETSERVER_INC_H_ */
@@ -0,0 +1,80 @@
+/**
+ *
+ * @file: socketTransport.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - What the socket client and server share. Unix domain sockets are
+ * SOCK_SEQPACKET, so every message keeps its boundaries and many of them are
+ * read with one recvmmsg. TCP is a stream, so every message is prefixed with
+ * its length.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_SOCKETTRANSPORT_INC_H_
+#define SRC_LIBS_SOCKETTRANSPORT_INC_H_
+
+//INCLUDES
+#include <string>
+#include <vector>
+#include "eitErrors.h"
+#include "ipcMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int SOCKET_BATCH_SIZE = 32; // messages taken by one recvmmsg
+static const size_t SOCKET_READ_SIZE = 64 * 1024; // bytes taken by one stream read
+static const size_t SOCKET_FRAME_HEADER_SIZE = sizeof(uint32_t); // length prefix on streams
+static const int SOCKET_LISTEN_BACKLOG = 64; // connections waiting to be accepted
+
+//enums-------------------------------------------------------------------------
+enum SocketTypes
+{
+    SOCKET_UNIX,
+    SOCKET_TCP
+};
+
+//functions---------------------------------------------------------------------
+/**
+ * Writes the length prefix of a message sent over a stream
+ * @param size Size of the message
+ * @param header Where the prefix goes, SOCKET_FRAME_HEADER_SIZE bytes
+ */
+void writeFrameHeader(size_t size, uint8_t* header);
+
+/**
+ * Takes the complete messages out of the bytes read from a stream. What is
+ * left of an incomplete message stays in the stream for the next read.
+ * @param stream Bytes read so far
+ * @param messages Where the messages are appended
+ * @return false if the stream is corrupt and should be closed
+ */
+bool readFrames(
+        std::vector<uint8_t> &stream, std::vector<GenericData_t> &messages);
+
+/**
+ * Makes the socket of a connection, non blocking or not
+ * @param type Unix domain or TCP
+ * @param isBlocking Whether reads and writes on it block
+ * @return The socket, -1 if it fails
+ */
+int openSocket(SocketTypes type, bool isBlocking);
+
+/**
+ * Name of an address, for the logs
+ */
+std::string getSocketName(
+        SocketTypes type, const std::string &address, int port);
+} // end of namespace tarsim
+#endif /* SRC_LIBS_SOCKETTRANSPORT_INC_H_ */
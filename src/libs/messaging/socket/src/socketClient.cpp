@@ -0,0 +1,312 @@
+/**
+ * @file: socketClient.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of SocketClient
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "socketClient.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace tarsim {
+
+SocketClient::SocketClient(
+        SocketTypes type, const std::string &address, int port,
+        Callback callback, int policy, int priority):
+        m_type(type),
+        m_address(address),
+        m_port(port),
+        m_callback(callback),
+        m_threadPolicy(policy),
+        m_threadPriority(priority)
+{
+}
+
+SocketClient::~SocketClient()
+{
+    stop();
+}
+
+/**
+ * @brief connects to the server and spawns the receive thread, real-time if
+ * allowed
+ * @return NO_ERR if successful
+ */
+Errors SocketClient::start()
+{
+    if (nullptr != m_pthread.get()) {
+        printf("Failed: Thread already exists\n");
+        return ERR_INVALID;
+    }
+
+    if (NO_ERR != connectToServer()) {
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_runForEver = true;
+    m_pthread = std::unique_ptr<pthread_t>(new pthread_t);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setschedpolicy(&attr, m_threadPolicy);
+    struct sched_param param;
+    param.sched_priority = m_threadPriority;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    int ret = pthread_create(
+            m_pthread.get(), &attr, SocketClient::threadFunctionHelper, this);
+    if (ret) {
+        ret = pthread_create(
+                m_pthread.get(), nullptr, SocketClient::threadFunctionHelper, this);
+        if (ret) {
+            printf("Failed to create thread for socket %s (error = %d)\n",
+                    getName().c_str(), ret);
+            pthread_attr_destroy(&attr);
+            m_pthread.reset();
+            m_runForEver = false;
+            stop();
+            return ERR_FAILED_SPAWNED;
+        }
+        printf("Create non-realtime thread %s\n", getName().c_str());
+    }
+    pthread_attr_destroy(&attr);
+
+    pthread_setname_np(*m_pthread.get(), "TarsimSocket");
+    return NO_ERR;
+}
+
+/**
+ * @brief closes the connection and joins the receive thread
+ */
+Errors SocketClient::stop()
+{
+    m_runForEver = false;
+    if (m_fd >= 0) {
+        // Wakes the receive thread up from its blocking read
+        shutdown(m_fd, SHUT_RDWR);
+    }
+
+    if (nullptr != m_pthread.get()) {
+        pthread_join(*m_pthread.get(), nullptr);
+        m_pthread.reset();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexSend);
+    m_isConnected = false;
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    return NO_ERR;
+}
+
+Errors SocketClient::connectToServer()
+{
+    int fd = openSocket(m_type, true);
+    if (fd < 0) {
+        printf("Failed to create socket (%s)\n", strerror(errno));
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    int ret = -1;
+    if (SOCKET_UNIX == m_type) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (m_address.size() >= sizeof(addr.sun_path)) {
+            printf("Socket path %s is too long\n", m_address.c_str());
+            close(fd);
+            return ERR_INVALID;
+        }
+        strncpy(addr.sun_path, m_address.c_str(), sizeof(addr.sun_path) - 1);
+        ret = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    } else {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_port);
+        if (1 != inet_pton(AF_INET, m_address.c_str(), &addr.sin_addr)) {
+            printf("Invalid address %s\n", m_address.c_str());
+            close(fd);
+            return ERR_INVALID;
+        }
+        ret = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+
+        // Messages are small and latency matters more than packet count
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+
+    if (0 != ret) {
+        printf("Failed to connect to %s (%s)\n",
+                getName().c_str(), strerror(errno));
+        close(fd);
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_fd = fd;
+    m_isConnected = true;
+    return NO_ERR;
+}
+
+Errors SocketClient::send(const void* data, size_t size)
+{
+    if (size < sizeof(MessageHeader_t) || size > sizeof(GenericData_t)) {
+        return ERR_INVALID;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexSend);
+    if (!m_isConnected) {
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint8_t frame[SOCKET_FRAME_HEADER_SIZE + sizeof(GenericData_t)];
+    if (SOCKET_TCP == m_type) {
+        writeFrameHeader(size, frame);
+        memcpy(frame + SOCKET_FRAME_HEADER_SIZE, data, size);
+        bytes = frame;
+        size += SOCKET_FRAME_HEADER_SIZE;
+    }
+
+    // A packet goes whole, a stream may take several writes
+    size_t numSent = 0;
+    while (numSent < size) {
+        ssize_t ret = ::send(m_fd, bytes + numSent, size - numSent, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            printf("Failed to send to %s (%s)\n",
+                    getName().c_str(), strerror(errno));
+            return ERR_MQ_FAILED_SEND;
+        }
+        numSent += ret;
+    }
+    return NO_ERR;
+}
+
+bool SocketClient::isConnected() const
+{
+    return m_isConnected;
+}
+
+std::string SocketClient::getName() const
+{
+    return getSocketName(m_type, m_address, m_port);
+}
+
+void* SocketClient::threadFunctionHelper(void* object)
+{
+    static_cast<SocketClient*>(object)->running();
+    return nullptr;
+}
+
+void SocketClient::running()
+{
+    std::vector<GenericData_t> messages;
+    messages.reserve(SOCKET_BATCH_SIZE);
+    while (m_runForEver) {
+        messages.clear();
+        bool isOpen = (SOCKET_UNIX == m_type) ?
+                receiveMessages(messages) : receiveStream(messages);
+
+        int64_t receiveTimeNs = getMonotonicTimeNs();
+        for (GenericData_t &data: messages) {
+            data.simpleMsg.receiveTimeNs = receiveTimeNs;
+            m_callback(data);
+        }
+
+        if (!isOpen) {
+            break;
+        }
+    }
+
+    if (m_runForEver) {
+        printf("Server closed the connection on %s\n", getName().c_str());
+    }
+    m_isConnected = false;
+}
+
+bool SocketClient::receiveMessages(std::vector<GenericData_t> &messages)
+{
+    messages.resize(SOCKET_BATCH_SIZE);
+    struct mmsghdr headers[SOCKET_BATCH_SIZE];
+    struct iovec vectors[SOCKET_BATCH_SIZE];
+    memset(headers, 0, sizeof(headers));
+    for (int i = 0; i < SOCKET_BATCH_SIZE; i++) {
+        vectors[i].iov_base = &messages[i];
+        vectors[i].iov_len = sizeof(GenericData_t);
+        headers[i].msg_hdr.msg_iov = &vectors[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Blocks for the first message, then takes whatever else is waiting
+    int ret = recvmmsg(m_fd, headers, SOCKET_BATCH_SIZE, MSG_WAITFORONE, nullptr);
+    if (ret < 0) {
+        messages.clear();
+        return EINTR == errno;
+    }
+
+    // A packet of no length is the end of the connection
+    bool isOpen = (ret > 0);
+    size_t numMessages = 0;
+    for (int i = 0; i < ret; i++) {
+        if (0 == headers[i].msg_len) {
+            isOpen = false;
+            break;
+        }
+        if (headers[i].msg_len < sizeof(MessageHeader_t) ||
+            (headers[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+            continue;
+        }
+        if (numMessages != (size_t)i) {
+            messages[numMessages] = messages[i];
+        }
+        numMessages++;
+    }
+    messages.resize(numMessages);
+    return isOpen;
+}
+
+bool SocketClient::receiveStream(std::vector<GenericData_t> &messages)
+{
+    uint8_t buffer[SOCKET_READ_SIZE];
+    ssize_t ret = recv(m_fd, buffer, sizeof(buffer), 0);
+    if (ret <= 0) {
+        return (ret < 0) && (EINTR == errno);
+    }
+
+    m_stream.insert(m_stream.end(), buffer, buffer + ret);
+    if (!readFrames(m_stream, messages)) {
+        printf("Corrupt stream from %s\n", getName().c_str());
+        return false;
+    }
+    return true;
+}
+
+} // end of namespace tarsim
@@ -0,0 +1,585 @@
+/**
+ * @file: socketServer.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of SocketServer
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "socketServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace tarsim {
+namespace {
+// Ids of the epoll events that are not connections
+const int64_t SOCKET_WAKE_ID = -1;
+const int64_t SOCKET_UNIX_LISTEN_ID = -2;
+const int64_t SOCKET_TCP_LISTEN_ID = -3;
+
+bool isWouldBlock(int error)
+{
+    return (EAGAIN == error) || (EWOULDBLOCK == error);
+}
+} // end of anonymous namespace
+
+SocketServer::SocketServer(
+        const std::string &path, int port, Callback callback,
+        CloseCallback onClose, int policy, int priority):
+        m_path(path),
+        m_port(port),
+        m_callback(callback),
+        m_onClose(onClose),
+        m_threadPolicy(policy),
+        m_threadPriority(priority)
+{
+    m_messages.reserve(SOCKET_BATCH_SIZE);
+}
+
+SocketServer::~SocketServer()
+{
+    stop();
+}
+
+/**
+ * @brief listens on the socket and the port, and spawns the server thread,
+ * real-time if allowed
+ * @return NO_ERR if it listens on at least one of them
+ */
+Errors SocketServer::start()
+{
+    if (nullptr != m_pthread.get()) {
+        printf("Failed: Thread already exists\n");
+        return ERR_INVALID;
+    }
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0 ||
+        NO_ERR != watch(EPOLL_CTL_ADD, m_wakeFd, SOCKET_WAKE_ID, EPOLLIN)) {
+        printf("Failed to create epoll (%s)\n", strerror(errno));
+        stop();
+        return ERR_MQ_FAILED_CREATION;
+    }
+
+    listenUnix();
+    listenTcp();
+    if (m_unixFd < 0 && m_tcpFd < 0) {
+        stop();
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    m_runForEver = true;
+    m_pthread = std::unique_ptr<pthread_t>(new pthread_t);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setschedpolicy(&attr, m_threadPolicy);
+    struct sched_param param;
+    param.sched_priority = m_threadPriority;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    int ret = pthread_create(
+            m_pthread.get(), &attr, SocketServer::threadFunctionHelper, this);
+    if (ret) {
+        ret = pthread_create(
+                m_pthread.get(), nullptr, SocketServer::threadFunctionHelper, this);
+        if (ret) {
+            printf("Failed to create socket server thread (error = %d)\n", ret);
+            pthread_attr_destroy(&attr);
+            m_pthread.reset();
+            m_runForEver = false;
+            stop();
+            return ERR_FAILED_SPAWNED;
+        }
+        printf("Create non-realtime thread TarsimSockets\n");
+    }
+    pthread_attr_destroy(&attr);
+
+    pthread_setname_np(*m_pthread.get(), "TarsimSockets");
+    return NO_ERR;
+}
+
+/**
+ * @brief joins the server thread and closes every connection
+ */
+Errors SocketServer::stop()
+{
+    if (nullptr != m_pthread.get()) {
+        m_runForEver = false;
+        uint64_t one = 1;
+        if (write(m_wakeFd, &one, sizeof(one)) < 0) {
+            printf("Failed to wake socket server up (%s)\n", strerror(errno));
+        }
+        pthread_join(*m_pthread.get(), nullptr);
+        m_pthread.reset();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexConnections);
+        for (auto &pair: m_connections) {
+            std::unique_lock<std::mutex> lockOutbound(pair.second->mutexOutbound);
+            ::close(pair.second->fd);
+            pair.second->fd = -1;
+        }
+        m_connections.clear();
+    }
+
+    if (m_unixFd >= 0) {
+        ::close(m_unixFd);
+        m_unixFd = -1;
+        unlink(m_path.c_str());
+    }
+    if (m_tcpFd >= 0) {
+        ::close(m_tcpFd);
+        m_tcpFd = -1;
+    }
+    if (m_wakeFd >= 0) {
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+    if (m_epollFd >= 0) {
+        ::close(m_epollFd);
+        m_epollFd = -1;
+    }
+    return NO_ERR;
+}
+
+Errors SocketServer::listenUnix()
+{
+    if (m_path.empty()) {
+        return NO_ERR;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (m_path.size() >= sizeof(addr.sun_path)) {
+        printf("Socket path %s is too long\n", m_path.c_str());
+        return ERR_INVALID;
+    }
+    strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = openSocket(SOCKET_UNIX, false);
+    if (fd < 0) {
+        printf("Failed to create socket %s (%s)\n",
+                m_path.c_str(), strerror(errno));
+        return ERR_MQ_FAILED_CREATION;
+    }
+
+    // A server that did not exit cleanly leaves its socket behind
+    unlink(m_path.c_str());
+    if (0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+        0 != listen(fd, SOCKET_LISTEN_BACKLOG)) {
+        printf("Failed to listen on %s (%s)\n", m_path.c_str(), strerror(errno));
+        ::close(fd);
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    // Clients of other users must share the group of the simulator, other
+    // local users may not command the robot
+    chmod(m_path.c_str(), 0660);
+
+    if (NO_ERR != watch(EPOLL_CTL_ADD, fd, SOCKET_UNIX_LISTEN_ID, EPOLLIN)) {
+        ::close(fd);
+        unlink(m_path.c_str());
+        return ERR_MQ_FAILED_OPEN;
+    }
+    m_unixFd = fd;
+    return NO_ERR;
+}
+
+Errors SocketServer::listenTcp()
+{
+    if (m_port <= 0) {
+        return NO_ERR;
+    }
+
+    int fd = openSocket(SOCKET_TCP, false);
+    if (fd < 0) {
+        printf("Failed to create socket (%s)\n", strerror(errno));
+        return ERR_MQ_FAILED_CREATION;
+    }
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    // Only local clients, the messages are not authenticated
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+        0 != listen(fd, SOCKET_LISTEN_BACKLOG)) {
+        printf("Failed to listen on port %d (%s)\n", m_port, strerror(errno));
+        ::close(fd);
+        return ERR_MQ_FAILED_OPEN;
+    }
+
+    if (NO_ERR != watch(EPOLL_CTL_ADD, fd, SOCKET_TCP_LISTEN_ID, EPOLLIN)) {
+        ::close(fd);
+        return ERR_MQ_FAILED_OPEN;
+    }
+    m_tcpFd = fd;
+    return NO_ERR;
+}
+
+Errors SocketServer::watch(int operation, int fd, int64_t id, uint32_t events)
+{
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u64 = (uint64_t)id;
+    if (0 != epoll_ctl(m_epollFd, operation, fd, &event)) {
+        printf("Failed to watch socket (%s)\n", strerror(errno));
+        return ERR_SET;
+    }
+    return NO_ERR;
+}
+
+Errors SocketServer::send(int32_t connectionId, const void* data, size_t size)
+{
+    if (size < sizeof(MessageHeader_t) || size > sizeof(GenericData_t)) {
+        return ERR_INVALID;
+    }
+
+    std::shared_ptr<Connection_t> connection = getConnection(connectionId);
+    if (nullptr == connection) {
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    std::unique_lock<std::mutex> lock(connection->mutexOutbound);
+    if (connection->fd < 0) {
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    const uint8_t* frame = static_cast<const uint8_t*>(data);
+    uint8_t buffer[SOCKET_FRAME_HEADER_SIZE + sizeof(GenericData_t)];
+    if (SOCKET_TCP == connection->type) {
+        writeFrameHeader(size, buffer);
+        memcpy(buffer + SOCKET_FRAME_HEADER_SIZE, data, size);
+        frame = buffer;
+        size += SOCKET_FRAME_HEADER_SIZE;
+    }
+
+    // Messages only wait when the ones before them are still waiting
+    if (connection->outbound.empty()) {
+        ssize_t ret = ::send(connection->fd, frame, size,
+                MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret == (ssize_t)size) {
+            return NO_ERR;
+        }
+        if (ret < 0) {
+            if (!isWouldBlock(errno) && EINTR != errno) {
+                return ERR_MQ_FAILED_SEND;
+            }
+            ret = 0;
+        }
+
+        // The rest goes once the client reads
+        connection->outbound.emplace_back(frame, frame + size);
+        connection->offset = ret;
+        connection->pendingSize = size - ret;
+        return watch(EPOLL_CTL_MOD, connection->fd, connectionId,
+                EPOLLIN | EPOLLOUT);
+    }
+
+    if (connection->pendingSize + size > SOCKET_MAX_PENDING_SIZE) {
+        connection->numDropped++;
+        if (1 == connection->numDropped % 1000) {
+            printf("Connection %d is not reading, %d messages were dropped\n",
+                    (int)connectionId, (int)connection->numDropped);
+        }
+        return ERR_MQ_FAILED_SEND;
+    }
+
+    connection->outbound.emplace_back(frame, frame + size);
+    connection->pendingSize += size;
+    return NO_ERR;
+}
+
+void SocketServer::close(int32_t connectionId)
+{
+    std::shared_ptr<Connection_t> connection = getConnection(connectionId);
+    if (nullptr == connection) {
+        return;
+    }
+
+    // The server thread sees the hang up and closes it
+    std::unique_lock<std::mutex> lock(connection->mutexOutbound);
+    if (connection->fd >= 0) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+}
+
+uint64_t SocketServer::getNumDropped(int32_t connectionId) const
+{
+    std::shared_ptr<Connection_t> connection = getConnection(connectionId);
+    if (nullptr == connection) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(connection->mutexOutbound);
+    return connection->numDropped;
+}
+
+void* SocketServer::threadFunctionHelper(void* object)
+{
+    static_cast<SocketServer*>(object)->running();
+    return nullptr;
+}
+
+void SocketServer::running()
+{
+    struct epoll_event events[SOCKET_MAX_EVENTS];
+    while (m_runForEver) {
+        int numEvents = epoll_wait(m_epollFd, events, SOCKET_MAX_EVENTS, -1);
+        if (numEvents < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            printf("Failed to wait for sockets (%s)\n", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < numEvents && m_runForEver; i++) {
+            int64_t id = (int64_t)events[i].data.u64;
+            if (SOCKET_WAKE_ID == id) {
+                continue;
+            } else if (SOCKET_UNIX_LISTEN_ID == id) {
+                accept(m_unixFd, SOCKET_UNIX);
+                continue;
+            } else if (SOCKET_TCP_LISTEN_ID == id) {
+                accept(m_tcpFd, SOCKET_TCP);
+                continue;
+            }
+
+            int32_t connectionId = (int32_t)id;
+            std::shared_ptr<Connection_t> connection =
+                    getConnection(connectionId);
+            if (nullptr == connection) {
+                continue;
+            }
+
+            bool isOpen = true;
+            if (events[i].events & EPOLLOUT) {
+                std::unique_lock<std::mutex> lock(connection->mutexOutbound);
+                isOpen = flush(*connection);
+                if (isOpen && connection->outbound.empty()) {
+                    watch(EPOLL_CTL_MOD, connection->fd, connectionId, EPOLLIN);
+                }
+            }
+
+            if (isOpen && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                isOpen = receive(connectionId, *connection);
+            }
+
+            if (!isOpen) {
+                closeConnection(connectionId);
+            }
+        }
+    }
+}
+
+void SocketServer::accept(int listenFd, SocketTypes type)
+{
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr,
+                SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            if (!isWouldBlock(errno)) {
+                printf("Failed to accept a connection (%s)\n", strerror(errno));
+            }
+            return;
+        }
+
+        if (SOCKET_TCP == type) {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        std::shared_ptr<Connection_t> connection(new Connection_t());
+        connection->fd = fd;
+        connection->type = type;
+
+        int32_t connectionId = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutexConnections);
+            connectionId = m_nextConnectionId++;
+            m_connections[connectionId] = connection;
+        }
+
+        if (NO_ERR != watch(EPOLL_CTL_ADD, fd, connectionId, EPOLLIN)) {
+            std::unique_lock<std::mutex> lock(m_mutexConnections);
+            m_connections.erase(connectionId);
+            ::close(fd);
+        }
+    }
+}
+
+std::shared_ptr<SocketServer::Connection_t> SocketServer::getConnection(
+        int32_t connectionId) const
+{
+    std::unique_lock<std::mutex> lock(m_mutexConnections);
+    auto it = m_connections.find(connectionId);
+    if (it == m_connections.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void SocketServer::closeConnection(int32_t connectionId)
+{
+    std::shared_ptr<Connection_t> connection;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexConnections);
+        auto it = m_connections.find(connectionId);
+        if (it == m_connections.end()) {
+            return;
+        }
+        connection = it->second;
+        m_connections.erase(it);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(connection->mutexOutbound);
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+        ::close(connection->fd);
+        connection->fd = -1;
+        connection->outbound.clear();
+        connection->pendingSize = 0;
+    }
+
+    if (m_onClose) {
+        m_onClose(connectionId);
+    }
+}
+
+bool SocketServer::receive(int32_t connectionId, Connection_t &connection)
+{
+    m_messages.clear();
+    bool isOpen = (SOCKET_UNIX == connection.type) ?
+            receiveMessages(connection) : receiveStream(connection);
+
+    if (!m_messages.empty()) {
+        int64_t receiveTimeNs = getMonotonicTimeNs();
+        for (GenericData_t &data: m_messages) {
+            data.simpleMsg.receiveTimeNs = receiveTimeNs;
+        }
+        m_callback(connectionId, m_messages);
+    }
+    return isOpen;
+}
+
+bool SocketServer::receiveMessages(Connection_t &connection)
+{
+    m_messages.resize(SOCKET_BATCH_SIZE);
+    struct mmsghdr headers[SOCKET_BATCH_SIZE];
+    struct iovec vectors[SOCKET_BATCH_SIZE];
+    memset(headers, 0, sizeof(headers));
+    for (int i = 0; i < SOCKET_BATCH_SIZE; i++) {
+        vectors[i].iov_base = &m_messages[i];
+        vectors[i].iov_len = sizeof(GenericData_t);
+        headers[i].msg_hdr.msg_iov = &vectors[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Everything waiting, up to a batch, in one call
+    int ret = recvmmsg(connection.fd, headers, SOCKET_BATCH_SIZE,
+            MSG_DONTWAIT, nullptr);
+    if (ret < 0) {
+        m_messages.clear();
+        return isWouldBlock(errno) || (EINTR == errno);
+    }
+
+    // A packet of no length is the end of the connection
+    bool isOpen = (ret > 0);
+    size_t numMessages = 0;
+    for (int i = 0; i < ret; i++) {
+        if (0 == headers[i].msg_len) {
+            isOpen = false;
+            break;
+        }
+        if (headers[i].msg_len < sizeof(MessageHeader_t) ||
+            (headers[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+            continue;
+        }
+        if (numMessages != (size_t)i) {
+            m_messages[numMessages] = m_messages[i];
+        }
+        numMessages++;
+    }
+    m_messages.resize(numMessages);
+    return isOpen;
+}
+
+bool SocketServer::receiveStream(Connection_t &connection)
+{
+    uint8_t buffer[SOCKET_READ_SIZE];
+    ssize_t ret = recv(connection.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (ret <= 0) {
+        return (ret < 0) && (isWouldBlock(errno) || (EINTR == errno));
+    }
+
+    connection.stream.insert(connection.stream.end(), buffer, buffer + ret);
+    if (!readFrames(connection.stream, m_messages)) {
+        printf("Corrupt stream on connection %d\n", connection.fd);
+        return false;
+    }
+    return true;
+}
+
+bool SocketServer::flush(Connection_t &connection)
+{
+    while (!connection.outbound.empty()) {
+        std::vector<uint8_t> &frame = connection.outbound.front();
+        ssize_t ret = ::send(connection.fd, frame.data() + connection.offset,
+                frame.size() - connection.offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return isWouldBlock(errno);
+        }
+
+        connection.offset += ret;
+        connection.pendingSize -= ret;
+        if (connection.offset < frame.size()) {
+            continue;
+        }
+        connection.outbound.pop_front();
+        connection.offset = 0;
+    }
+    return true;
+}
+
+} // end of namespace tarsim
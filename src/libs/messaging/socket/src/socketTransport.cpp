@@ -0,0 +1,80 @@
+/**
+ * @file: socketTransport.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of what the socket client and server share
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "socketTransport.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <cstring>
+
+namespace tarsim {
+
+void writeFrameHeader(size_t size, uint8_t* header)
+{
+    uint32_t length = htonl((uint32_t)size);
+    std::memcpy(header, &length, SOCKET_FRAME_HEADER_SIZE);
+}
+
+bool readFrames(
+        std::vector<uint8_t> &stream, std::vector<GenericData_t> &messages)
+{
+    size_t position = 0;
+    while (stream.size() - position >= SOCKET_FRAME_HEADER_SIZE) {
+        uint32_t length = 0;
+        std::memcpy(&length, stream.data() + position, SOCKET_FRAME_HEADER_SIZE);
+        length = ntohl(length);
+        if (length < sizeof(MessageHeader_t) || length > sizeof(GenericData_t)) {
+            return false;
+        }
+
+        if (stream.size() - position - SOCKET_FRAME_HEADER_SIZE < length) {
+            break;
+        }
+
+        position += SOCKET_FRAME_HEADER_SIZE;
+        messages.emplace_back();
+        std::memcpy(&messages.back(), stream.data() + position, length);
+        position += length;
+    }
+
+    stream.erase(stream.begin(), stream.begin() + position);
+    return true;
+}
+
+int openSocket(SocketTypes type, bool isBlocking)
+{
+    int flags = SOCK_CLOEXEC | (isBlocking ? 0 : SOCK_NONBLOCK);
+    if (SOCKET_UNIX == type) {
+        return socket(AF_UNIX, SOCK_SEQPACKET | flags, 0);
+    }
+    return socket(AF_INET, SOCK_STREAM | flags, 0);
+}
+
+std::string getSocketName(
+        SocketTypes type, const std::string &address, int port)
+{
+    if (SOCKET_UNIX == type) {
+        return address;
+    }
+    return address + ":" + std::to_string(port);
+}
+
+} // end of namespace tarsim
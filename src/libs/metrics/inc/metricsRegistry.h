@@ -0,0 +1,181 @@
+/**
+ *
+ * @file: metricsRegistry.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Metrics of the simulator cycle, e.g. forward kinematics and
+ * collision detection times, the jitter of the joint values and dropped
+ * messages. Times are kept in histograms like the latencies, so their
+ * percentiles can be read, and events in counters. The simulator answers
+ * REQUEST_STATISTICS with them and publishes them to a shared memory page
+ * that tools poll without a message.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_METRICSREGISTRY_INC_H_
+#define SRC_LIBS_METRICSREGISTRY_INC_H_
+
+//INCLUDES
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "eitErrors.h"
+#include "latencyRecorder.h"
+#include "simulatorMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int STATISTICS_PAGE_PERIOD_MS = 100; // default period of the page publishes
+static const int STATISTICS_PAGE_NUM_READ_ATTEMPTS = 100; // reads racing a publish before giving up
+
+/**
+ * @return name of a metric, as written in the CSV
+ */
+const char* getMetricName(int32_t metricId);
+
+/**
+ * @return kind of a metric, see MetricKinds
+ */
+MetricKinds getMetricKind(int32_t metricId);
+
+//classes-----------------------------------------------------------------------
+class MetricsRegistry
+{
+public:
+    /**
+     * The metrics of the process, never destroyed
+     */
+    static MetricsRegistry* getInstance();
+
+    /**
+     * Records a sample of a histogram, counters ignore it
+     */
+    void record(MetricIds metricId, int64_t value);
+
+    /**
+     * Adds to a counter, histograms ignore it
+     */
+    void add(MetricIds metricId, int64_t value = 1);
+
+    MetricStatistics_t getStatistics(MetricIds metricId) const;
+
+    /**
+     * @return statistics of every metric, by metric id
+     */
+    std::vector<MetricStatistics_t> getStatistics() const;
+    void reset();
+
+    /**
+     * Creates the shared memory page and publishes the metrics to it
+     * periodically, until stopPublishing
+     * @param name Shared memory object name (without the leading '/')
+     * @param periodMs Period of the publishes
+     * @return ERR_INVALID if the page could not be created
+     */
+    Errors startPublishing(const std::string &name,
+            int periodMs = STATISTICS_PAGE_PERIOD_MS);
+
+    /**
+     * Stops publishing and removes the page
+     */
+    void stopPublishing();
+
+private:
+    struct Metric_t
+    {
+        mutable std::mutex mutexHistogram;
+        LatencyHistogram histogram;
+        int64_t sum = 0;
+        std::atomic<int64_t> total {0};
+    };
+
+    MetricsRegistry() = default;
+    void publishing();
+    void publish();
+
+    std::array<Metric_t, NUM_METRICS> m_metrics;
+
+    std::thread m_thread;
+    std::mutex m_mutexPublishing;
+    std::condition_variable m_cvPublishing;
+    bool m_isPublishing = false;
+    int m_periodMs = STATISTICS_PAGE_PERIOD_MS;
+    std::string m_pageName;
+    StatisticsPage_t* m_page = nullptr;
+};
+
+/**
+ * Reads the metrics a simulator publishes to its shared memory page
+ */
+class StatisticsPageReader
+{
+public:
+    /**
+     * @param name Shared memory object name (without the leading '/')
+     */
+    explicit StatisticsPageReader(const std::string &name);
+    virtual ~StatisticsPageReader();
+
+    /**
+     * @return ERR_INVALID if there is no page or it has another layout
+     */
+    Errors open();
+    void close();
+    bool isOpen() const;
+
+    /**
+     * Copies the metrics of the last publish
+     * @param statistics Statistics of every metric, by metric id
+     * @param publishTimeNs Monotonic time of the publish
+     * @return ERR_INVALID if the page is not open or nothing was published
+     * yet, ERR_GET if every attempt raced a publish
+     */
+    Errors read(std::vector<MetricStatistics_t> &statistics,
+            int64_t &publishTimeNs) const;
+
+private:
+    std::string m_name;
+    const StatisticsPage_t* m_page = nullptr;
+};
+
+/**
+ * Writes metric statistics to a STATISTICS payload: the number of entries,
+ * then every field of each entry
+ */
+void writeMetricStatistics(
+        MessageWriter &writer,
+        const std::vector<MetricStatistics_t> &statistics);
+
+/**
+ * Reads metric statistics written by writeMetricStatistics
+ * @return false if the payload is too short
+ */
+bool readMetricStatistics(
+        MessageReader &reader, std::vector<MetricStatistics_t> &statistics);
+
+/**
+ * Writes metric statistics as CSV, one line per metric
+ * @param fileName File to write, replaced if it exists
+ * @return false if the file could not be written
+ */
+bool writeMetricsCsv(
+        const std::string &fileName,
+        const std::vector<MetricStatistics_t> &statistics);
+} // end of namespace tarsim
+#endif /* SRC_LIBS_METRICSREGISTRY_INC_H_ */
@@ -0,0 +1,380 @@
+/**
+ *
+ * @file: metricsRegistry.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the metrics of the simulator cycle and of their
+ * shared memory page
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "metricsRegistry.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+namespace tarsim {
+const char* getMetricName(int32_t metricId)
+{
+    switch (metricId) {
+        case METRIC_FK_TIME: return "fk_time_ns";
+        case METRIC_COLLISION_TIME: return "collision_time_ns";
+        case METRIC_JOINT_VALUES_INTERVAL: return "joint_values_interval_ns";
+        case METRIC_JOINT_VALUES_JITTER: return "joint_values_jitter_ns";
+        case METRIC_QUEUE_DEPTH: return "queue_depth";
+        case METRIC_RENDER_TIME: return "render_time_ns";
+        case METRIC_DROPPED_REPLIES: return "dropped_replies";
+        case METRIC_CONFLATED_SETPOINTS: return "conflated_setpoints";
+        case METRIC_DROPPED_FRAMES: return "dropped_frames";
+        default: return "unknown";
+    }
+}
+
+MetricKinds getMetricKind(int32_t metricId)
+{
+    switch (metricId) {
+        case METRIC_DROPPED_REPLIES:
+        case METRIC_CONFLATED_SETPOINTS:
+        case METRIC_DROPPED_FRAMES:
+            return METRIC_COUNTER;
+        default:
+            return METRIC_HISTOGRAM;
+    }
+}
+
+MetricsRegistry* MetricsRegistry::getInstance()
+{
+    // Never destroyed, threads may record until the process exits
+    static MetricsRegistry* instance = new MetricsRegistry();
+    return instance;
+}
+
+void MetricsRegistry::record(MetricIds metricId, int64_t value)
+{
+    if (metricId < 0 || metricId >= NUM_METRICS ||
+        METRIC_HISTOGRAM != getMetricKind(metricId) || value < 0) {
+        return;
+    }
+
+    Metric_t &metric = m_metrics[metricId];
+    std::lock_guard<std::mutex> lock(metric.mutexHistogram);
+    metric.histogram.record(value);
+    metric.sum += value;
+}
+
+void MetricsRegistry::add(MetricIds metricId, int64_t value)
+{
+    if (metricId < 0 || metricId >= NUM_METRICS ||
+        METRIC_COUNTER != getMetricKind(metricId)) {
+        return;
+    }
+    m_metrics[metricId].total.fetch_add(value, std::memory_order_relaxed);
+}
+
+MetricStatistics_t MetricsRegistry::getStatistics(MetricIds metricId) const
+{
+    MetricStatistics_t statistics;
+    statistics.metricId = metricId;
+    statistics.kind = getMetricKind(metricId);
+    if (metricId < 0 || metricId >= NUM_METRICS) {
+        return statistics;
+    }
+
+    const Metric_t &metric = m_metrics[metricId];
+    if (METRIC_COUNTER == statistics.kind) {
+        statistics.count = metric.total.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+    std::lock_guard<std::mutex> lock(metric.mutexHistogram);
+    statistics.count = metric.histogram.getCount();
+    if (statistics.count > 0) {
+        statistics.mean = metric.sum / statistics.count;
+    }
+    statistics.p50 = metric.histogram.getPercentile(0.5);
+    statistics.p90 = metric.histogram.getPercentile(0.9);
+    statistics.p99 = metric.histogram.getPercentile(0.99);
+    statistics.p999 = metric.histogram.getPercentile(0.999);
+    statistics.max = metric.histogram.getMax();
+    return statistics;
+}
+
+std::vector<MetricStatistics_t> MetricsRegistry::getStatistics() const
+{
+    std::vector<MetricStatistics_t> statistics;
+    for (int32_t i = 0; i < NUM_METRICS; i++) {
+        statistics.push_back(getStatistics((MetricIds)i));
+    }
+    return statistics;
+}
+
+void MetricsRegistry::reset()
+{
+    for (Metric_t &metric: m_metrics) {
+        {
+            std::lock_guard<std::mutex> lock(metric.mutexHistogram);
+            metric.histogram.reset();
+            metric.sum = 0;
+        }
+        metric.total.store(0, std::memory_order_relaxed);
+    }
+}
+
+Errors MetricsRegistry::startPublishing(const std::string &name, int periodMs)
+{
+    stopPublishing();
+
+    // A page left behind by a simulator that crashed is replaced
+    std::string shmName = "/" + name;
+    shm_unlink(shmName.c_str());
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return ERR_INVALID;
+    }
+    if (ftruncate(fd, sizeof(StatisticsPage_t)) != 0) {
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return ERR_INVALID;
+    }
+    void* p = mmap(nullptr, sizeof(StatisticsPage_t),
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == p) {
+        shm_unlink(shmName.c_str());
+        return ERR_INVALID;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutexPublishing);
+    m_page = new (p) StatisticsPage_t();
+    m_page->periodMs = periodMs;
+    m_pageName = name;
+    m_periodMs = std::max(periodMs, 1);
+    m_isPublishing = true;
+    m_thread = std::thread(&MetricsRegistry::publishing, this);
+    return NO_ERR;
+}
+
+void MetricsRegistry::stopPublishing()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPublishing);
+        m_isPublishing = false;
+    }
+    m_cvPublishing.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutexPublishing);
+    if (nullptr != m_page) {
+        munmap(m_page, sizeof(StatisticsPage_t));
+        m_page = nullptr;
+        shm_unlink(("/" + m_pageName).c_str());
+    }
+}
+
+void MetricsRegistry::publishing()
+{
+    std::unique_lock<std::mutex> lock(m_mutexPublishing);
+    while (m_isPublishing) {
+        publish();
+        m_cvPublishing.wait_for(lock, std::chrono::milliseconds(m_periodMs),
+                [this]() { return !m_isPublishing; });
+    }
+}
+
+void MetricsRegistry::publish()
+{
+    // Gathered before the page is marked, so readers are kept out briefly
+    std::vector<MetricStatistics_t> statistics = getStatistics();
+
+    uint64_t sequence = __atomic_load_n(&m_page->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_page->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < statistics.size(); i++) {
+        m_page->metrics[i] = statistics[i];
+    }
+    m_page->numMetrics = (int32_t)statistics.size();
+    m_page->publishTimeNs = getMonotonicTimeNs();
+
+    __atomic_store_n(&m_page->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+StatisticsPageReader::StatisticsPageReader(const std::string &name) :
+        m_name(name)
+{
+}
+
+StatisticsPageReader::~StatisticsPageReader()
+{
+    close();
+}
+
+Errors StatisticsPageReader::open()
+{
+    close();
+
+    int fd = shm_open(("/" + m_name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return ERR_INVALID;
+    }
+    void* p = mmap(nullptr, sizeof(StatisticsPage_t),
+            PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == p) {
+        return ERR_INVALID;
+    }
+
+    const StatisticsPage_t* page = static_cast<const StatisticsPage_t*>(p);
+    if (STATISTICS_PAGE_MAGIC != page->magic ||
+        STATISTICS_PAGE_VERSION != page->version) {
+        munmap(p, sizeof(StatisticsPage_t));
+        return ERR_INVALID;
+    }
+    m_page = page;
+    return NO_ERR;
+}
+
+void StatisticsPageReader::close()
+{
+    if (nullptr != m_page) {
+        munmap(const_cast<StatisticsPage_t*>(m_page), sizeof(StatisticsPage_t));
+        m_page = nullptr;
+    }
+}
+
+bool StatisticsPageReader::isOpen() const
+{
+    return nullptr != m_page;
+}
+
+Errors StatisticsPageReader::read(
+        std::vector<MetricStatistics_t> &statistics,
+        int64_t &publishTimeNs) const
+{
+    if (nullptr == m_page) {
+        return ERR_INVALID;
+    }
+
+    StatisticsPage_t copy;
+    for (int i = 0; i < STATISTICS_PAGE_NUM_READ_ATTEMPTS; i++) {
+        uint64_t before = __atomic_load_n(&m_page->sequence, __ATOMIC_ACQUIRE);
+        if (0 == before) {
+            return ERR_INVALID;
+        }
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+
+        std::memcpy(&copy, m_page, sizeof(copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&m_page->sequence, __ATOMIC_RELAXED) != before) {
+            continue;
+        }
+
+        int32_t numMetrics = std::min(std::max(copy.numMetrics, 0),
+                (int32_t)NUM_METRICS);
+        statistics.assign(copy.metrics, copy.metrics + numMetrics);
+        publishTimeNs = copy.publishTimeNs;
+        return NO_ERR;
+    }
+    return ERR_GET;
+}
+
+void writeMetricStatistics(
+        MessageWriter &writer,
+        const std::vector<MetricStatistics_t> &statistics)
+{
+    writer.write((int32_t)statistics.size());
+    for (const MetricStatistics_t &entry: statistics) {
+        writer.write(entry.metricId);
+        writer.write(entry.kind);
+        writer.write(entry.count);
+        writer.write(entry.mean);
+        writer.write(entry.p50);
+        writer.write(entry.p90);
+        writer.write(entry.p99);
+        writer.write(entry.p999);
+        writer.write(entry.max);
+    }
+}
+
+bool readMetricStatistics(
+        MessageReader &reader, std::vector<MetricStatistics_t> &statistics)
+{
+    int32_t numEntries = 0;
+    if (!reader.read(numEntries) || numEntries < 0) {
+        return false;
+    }
+
+    statistics.clear();
+    for (int32_t i = 0; i < numEntries; i++) {
+        MetricStatistics_t entry;
+        if (!reader.read(entry.metricId) ||
+            !reader.read(entry.kind) ||
+            !reader.read(entry.count) ||
+            !reader.read(entry.mean) ||
+            !reader.read(entry.p50) ||
+            !reader.read(entry.p90) ||
+            !reader.read(entry.p99) ||
+            !reader.read(entry.p999) ||
+            !reader.read(entry.max)) {
+            return false;
+        }
+        statistics.push_back(entry);
+    }
+    return true;
+}
+
+bool writeMetricsCsv(
+        const std::string &fileName,
+        const std::vector<MetricStatistics_t> &statistics)
+{
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (nullptr == file) {
+        printf("Failed to open %s\n", fileName.c_str());
+        return false;
+    }
+
+    fprintf(file, "metric,kind,count,mean,p50,p90,p99,p99_9,max\n");
+    for (const MetricStatistics_t &entry: statistics) {
+        fprintf(file, "%s,%s,%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64
+                ",%" PRId64 ",%" PRId64 ",%" PRId64 "\n",
+                getMetricName(entry.metricId),
+                METRIC_COUNTER == entry.kind ? "counter" : "histogram",
+                entry.count, entry.mean, entry.p50, entry.p90,
+                entry.p99, entry.p999, entry.max);
+    }
+
+    bool isWritten = !ferror(file);
+    if (0 != fclose(file)) {
+        isWritten = false;
+    }
+    if (!isWritten) {
+        printf("Failed to write %s\n", fileName.c_str());
+    }
+    return isWritten;
+}
+} // end of namespace tarsim
@@ -118,6 +118,11 @@ Node::Node(
             m_bbs.push_back(bb);
         }
     }
+
+    for (size_t i = 0; i < m_bbs.size(); i++) {
+        m_bbs[i]->setCollisionFilter(
+                m_rigidBody.collision_group(), m_rigidBody.collision_mask());
+    }
 }
 
 Node::~Node()
@@ -503,14 +508,16 @@ Errors Node::mateNode()
 
 }
 
-Errors Node::setTargetJointValue(const double &value)
+Errors Node::setTargetJointValue(const double &value, bool isRateLimited)
 {
     Errors error = NO_ERR;
-    m_timePrevious = m_time;
-    m_time = std::chrono::high_resolution_clock::now();
-
     std::unique_lock<std::mutex> lock(m_mutexTargetJointValue);
-    m_jointValuePrevious = m_targetJointValue;
+    if (isRateLimited) {
+        m_timePrevious = m_time;
+        m_time = std::chrono::high_resolution_clock::now();
+        m_jointValuePrevious = m_targetJointValue;
+    }
+
     m_targetJointValue = value;
     if (m_mateToParent.is_limited()) {
         if (m_targetJointValue > m_mateToParent.max()) {
@@ -521,6 +528,11 @@ Errors Node::setTargetJointValue(const double &value)
             error = ERR_JOINT_POSITION_LIMIT;
         }
     }
+
+    if (!isRateLimited) {
+        return error;
+    }
+
     std::chrono::duration<double> time_span =
             std::chrono::duration_cast<std::chrono::duration<double>>(m_time - m_timePrevious);
     double dt = 1000.0 * time_span.count();
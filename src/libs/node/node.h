@@ -85,7 +85,13 @@ public:
 
     void setTargetXfm(const Matrix4d &m);
 
-    Errors setTargetJointValue(const double &value);
+    /**
+     * Sets the joint value to move to, within the position limits of the
+     * mate, and within its velocity and acceleration limits since the
+     * previous value if isRateLimited. Offline queries that are not a motion
+     * in time set it without rate limits.
+     */
+    Errors setTargetJointValue(const double &value, bool isRateLimited = true);
     double getTargetJointValue() const;
 
     void setCurrentJointValue(const double &value);
@@ -82,6 +82,12 @@ Object::Object(
             m_bbs.push_back(bb);
         }
     }
+
+    for (size_t i = 0; i < m_bbs.size(); i++) {
+        m_bbs[i]->setCollisionFilter(
+                m_externalObject.collision_group(),
+                m_externalObject.collision_mask());
+    }
 }
 
 Object::~Object()
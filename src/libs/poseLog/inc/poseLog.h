@@ -0,0 +1,153 @@
+/**
+ *
+ * @file: poseLog.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - A pose log keeps what the simulator computed in every forward
+ * kinematics cycle, i.e. the joint values, the object frames, the tool and
+ * the collisions, instead of the pixels they were rendered to. It can be
+ * re-rendered offline at any resolution and from any camera.
+ *
+ * The file is a header, then blocks of records, then an index of the blocks:
+ *
+ *   PoseLogHeader_t
+ *   PoseLogBlockHeader_t, zlib compressed records   (repeated)
+ *   PoseLogIndexEntry_t                             (one per block)
+ *   PoseLogTrailer_t
+ *
+ * Each record is delta encoded against the one before it in its block, and
+ * the first record of a block against an empty one, so any block is decoded
+ * on its own. A file cut short, e.g. by a crash, has no index; its blocks are
+ * then found by walking them. Numbers are stored in host byte order.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_POSELOG_INC_H_
+#define SRC_LIBS_POSELOG_INC_H_
+
+//INCLUDES
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include "simulatorMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const uint32_t POSE_LOG_MAGIC = 0x474c5054; // "TPLG"
+static const uint32_t POSE_LOG_VERSION = 1;
+static const uint32_t POSE_LOG_BLOCK_MAGIC = 0x424c5054; // "TPLB"
+static const uint32_t POSE_LOG_INDEX_MAGIC = 0x494c5054; // "TPLI"
+static const uint32_t POSE_LOG_RECORDS_PER_BLOCK = 256; // granularity of random access
+static const size_t POSE_LOG_DEFAULT_QUEUE_SIZE = 4096; // records waiting for the writer
+static const int POSE_LOG_FLUSH_PERIOD_MS = 1000; // longest a record waits for its block
+
+//structs-----------------------------------------------------------------------
+/**
+ * What a forward kinematics cycle computed. The frames of the rigid bodies
+ * are left out, they follow from the joint values.
+ */
+struct PoseRecord_t
+{
+    int64_t timeNs = 0; // Monotonic time of the cycle
+    uint32_t counter = 0; // Kinematics counter
+    std::map<int, double> jointValues; // By joint index
+    std::map<int, Eigen::Matrix4d> objectFrames; // By object index
+    std::string toolName; // Tool file, empty if no tool is installed
+    std::map<int32_t, Collision> collisions; // By robot link
+};
+
+struct PoseLogHeader_t
+{
+    uint32_t magic = POSE_LOG_MAGIC;
+    uint32_t version = POSE_LOG_VERSION;
+    int64_t startWallTimeNs = 0; // Wall clock time the log was started
+    int64_t startTimeNs = 0; // Monotonic time the log was started
+    uint32_t recordsPerBlock = POSE_LOG_RECORDS_PER_BLOCK;
+    uint32_t reserved = 0;
+};
+
+struct PoseLogBlockHeader_t
+{
+    uint32_t magic = POSE_LOG_BLOCK_MAGIC;
+    uint32_t numRecords = 0;
+    uint64_t firstRecord = 0; // Index of the first record in the log
+    int64_t firstTimeNs = 0;
+    int64_t lastTimeNs = 0;
+    uint32_t rawSize = 0; // Size of the encoded records
+    uint32_t compressedSize = 0; // Size of the block data that follows
+};
+
+struct PoseLogIndexEntry_t
+{
+    int64_t offset = 0; // Offset of the block header in the file
+    uint64_t firstRecord = 0;
+    int64_t firstTimeNs = 0;
+    int64_t lastTimeNs = 0;
+    uint32_t numRecords = 0;
+    uint32_t reserved = 0;
+};
+
+struct PoseLogTrailer_t
+{
+    uint32_t magic = POSE_LOG_INDEX_MAGIC;
+    uint32_t numBlocks = 0;
+    int64_t indexOffset = 0; // Offset of the first index entry in the file
+};
+
+//classes-----------------------------------------------------------------------
+/**
+ * Encodes records as the difference to the record before them. Integers
+ * are zigzag varints of their change. Doubles are varints of their bits
+ * XOR the bits of the value before, which is small when the value moved
+ * little, and a single zero byte when it did not move.
+ */
+class PoseRecordEncoder
+{
+public:
+    /**
+     * Starts over from an empty record, e.g. at the start of a block
+     */
+    void reset();
+
+    /**
+     * Appends the record to the data
+     */
+    void encode(const PoseRecord_t &record, std::vector<uint8_t> &data);
+
+private:
+    PoseRecord_t m_previous;
+};
+
+class PoseRecordDecoder
+{
+public:
+    /**
+     * Starts over from an empty record, e.g. at the start of a block
+     */
+    void reset();
+
+    /**
+     * Decodes a record and moves p past it
+     * @return false if the data is cut short or invalid
+     */
+    bool decode(const uint8_t* &p, const uint8_t* end, PoseRecord_t &record);
+
+private:
+    PoseRecord_t m_previous;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_POSELOG_INC_H_ */
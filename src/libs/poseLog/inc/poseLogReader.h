@@ -0,0 +1,91 @@
+/**
+ *
+ * @file: poseLogReader.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Reads a pose log by record index or by time. Only the block of
+ * the record read is decompressed, and it is kept for the records after it.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_POSELOGREADER_INC_H_
+#define SRC_LIBS_POSELOGREADER_INC_H_
+
+//INCLUDES
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "eitErrors.h"
+#include "poseLog.h"
+
+namespace tarsim {
+//classes-----------------------------------------------------------------------
+class PoseLogReader
+{
+public:
+    PoseLogReader() = default;
+    virtual ~PoseLogReader();
+
+    /**
+     * Opens a log and reads its index. A log without an index, e.g. of a
+     * simulator that crashed, is indexed by walking its blocks, up to the
+     * last complete one.
+     * @return ERR_INVALID if the file is not a pose log
+     */
+    Errors open(const std::string &fileName);
+    void close();
+    bool isOpen() const;
+
+    const PoseLogHeader_t& getHeader() const;
+    uint64_t getNumRecords() const;
+
+    /**
+     * Monotonic times of the first and last records, as in the records
+     */
+    int64_t getStartTimeNs() const;
+    int64_t getEndTimeNs() const;
+
+    /**
+     * @return index of the last record at or before the time, the first
+     * record if the time is before it
+     */
+    uint64_t findRecord(int64_t timeNs);
+
+    /**
+     * @return ERR_INVALID if there is no such record, ERR_GET if its block
+     * could not be read
+     */
+    Errors read(uint64_t index, PoseRecord_t &record);
+
+private:
+    Errors readIndex();
+    Errors walkBlocks();
+    Errors loadBlock(size_t block);
+    size_t findBlock(uint64_t index) const;
+
+    FILE* m_file = nullptr;
+    PoseLogHeader_t m_header;
+    std::vector<PoseLogIndexEntry_t> m_index;
+    uint64_t m_numRecords = 0;
+
+    // The block decoded last
+    size_t m_block = 0;
+    bool m_isBlockLoaded = false;
+    std::vector<PoseRecord_t> m_records;
+    std::vector<uint8_t> m_compressed;
+    std::vector<uint8_t> m_raw;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_POSELOGREADER_INC_H_ */
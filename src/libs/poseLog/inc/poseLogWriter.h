@@ -0,0 +1,110 @@
+/**
+ *
+ * @file: poseLogWriter.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Writes a pose log from a thread of its own. The kinematics cycle
+ * only queues its record; when the queue is full, the record is dropped and
+ * counted rather than the cycle waiting for the disk.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_POSELOGWRITER_INC_H_
+#define SRC_LIBS_POSELOGWRITER_INC_H_
+
+//INCLUDES
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "eitErrors.h"
+#include "poseLog.h"
+
+namespace tarsim {
+//structs-----------------------------------------------------------------------
+struct PoseLogStatistics_t
+{
+    uint64_t numAppended = 0; // Records queued to the writer
+    uint64_t numDropped = 0;  // Records dropped since the queue was full
+    uint64_t numWritten = 0;  // Records written to the file
+    uint64_t numBytes = 0;    // Size of the file
+};
+
+//classes-----------------------------------------------------------------------
+class PoseLogWriter
+{
+public:
+    /**
+     * @param fileName File to write, replaced if it exists
+     * @param queueSize How many records may wait for the writer
+     */
+    explicit PoseLogWriter(const std::string &fileName,
+            size_t queueSize = POSE_LOG_DEFAULT_QUEUE_SIZE);
+
+    /**
+     * Stops the writer if it was not stopped
+     */
+    virtual ~PoseLogWriter();
+
+    /**
+     * Creates the file and starts the writer
+     * @return ERR_INVALID if the file could not be created
+     */
+    Errors start();
+
+    /**
+     * Writes the records still queued and the index, then closes the file
+     */
+    void stop();
+
+    /**
+     * Queues a record, never blocks
+     */
+    void append(const std::shared_ptr<const PoseRecord_t> &record);
+
+    PoseLogStatistics_t getStatistics() const;
+
+private:
+    void writing();
+    void addRecord(const PoseRecord_t &record);
+    Errors writeBlock();
+    Errors writeIndex();
+
+    std::string m_fileName;
+    size_t m_queueSize = POSE_LOG_DEFAULT_QUEUE_SIZE;
+    std::thread m_thread;
+
+    std::deque<std::shared_ptr<const PoseRecord_t>> m_queue;
+    bool m_isWriting = false;
+    PoseLogStatistics_t m_statistics;
+    mutable std::mutex m_mutexRecords;
+    std::condition_variable m_cvRecords;
+
+    // Only the writer thread uses these
+    FILE* m_file = nullptr;
+    bool m_hasFailed = false;
+    PoseRecordEncoder m_encoder;
+    PoseLogBlockHeader_t m_block;
+    std::vector<uint8_t> m_raw;
+    std::vector<uint8_t> m_compressed;
+    std::vector<PoseLogIndexEntry_t> m_index;
+    int64_t m_blockStartTimeNs = 0;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_POSELOGWRITER_INC_H_ */
@@ -0,0 +1,270 @@
+/**
+ *
+ * @file: poseLog.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the delta encoding of the pose log records
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "poseLog.h"
+#include <cstring>
+
+namespace tarsim {
+namespace {
+// Rows of a frame that are stored, the last one is always 0 0 0 1
+const int FRAME_ROWS = 3;
+
+void writeVarint(std::vector<uint8_t> &data, uint64_t value)
+{
+    while (value >= 0x80) {
+        data.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back((uint8_t)value);
+}
+
+bool readVarint(const uint8_t* &p, const uint8_t* end, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (0 == (byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeSigned(std::vector<uint8_t> &data, int64_t value)
+{
+    writeVarint(data, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+bool readSigned(const uint8_t* &p, const uint8_t* end, int64_t &value)
+{
+    uint64_t zigzag = 0;
+    if (!readVarint(p, end, zigzag)) {
+        return false;
+    }
+    value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+    return true;
+}
+
+inline uint64_t toBits(double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double fromBits(uint64_t bits)
+{
+    double value = 0.0;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void writeDouble(std::vector<uint8_t> &data, double value, double previous)
+{
+    writeVarint(data, toBits(value) ^ toBits(previous));
+}
+
+bool readDouble(const uint8_t* &p, const uint8_t* end,
+        double previous, double &value)
+{
+    uint64_t bits = 0;
+    if (!readVarint(p, end, bits)) {
+        return false;
+    }
+    value = fromBits(bits ^ toBits(previous));
+    return true;
+}
+
+template<typename Value>
+const Value* findPrevious(const std::map<int, Value> &previous, int index)
+{
+    typename std::map<int, Value>::const_iterator it = previous.find(index);
+    return (it == previous.end()) ? nullptr : &it->second;
+}
+} // end of anonymous namespace
+
+void PoseRecordEncoder::reset()
+{
+    m_previous = PoseRecord_t();
+}
+
+void PoseRecordEncoder::encode(
+        const PoseRecord_t &record, std::vector<uint8_t> &data)
+{
+    writeSigned(data, record.timeNs - m_previous.timeNs);
+    writeSigned(data, (int64_t)record.counter - (int64_t)m_previous.counter);
+
+    // Indices are written as the step from the one before, mostly 1
+    writeVarint(data, record.jointValues.size());
+    int previousIndex = 0;
+    for (const std::pair<const int, double> &pair: record.jointValues) {
+        writeSigned(data, (int64_t)pair.first - previousIndex);
+        previousIndex = pair.first;
+        const double* previous = findPrevious(m_previous.jointValues, pair.first);
+        writeDouble(data, pair.second, previous ? *previous : 0.0);
+    }
+
+    writeVarint(data, record.objectFrames.size());
+    previousIndex = 0;
+    for (const std::pair<const int, Eigen::Matrix4d> &pair: record.objectFrames) {
+        writeSigned(data, (int64_t)pair.first - previousIndex);
+        previousIndex = pair.first;
+        const Eigen::Matrix4d* previous =
+                findPrevious(m_previous.objectFrames, pair.first);
+        for (int i = 0; i < FRAME_ROWS; i++) {
+            for (int j = 0; j < 4; j++) {
+                writeDouble(data, pair.second(i, j),
+                        previous ? (*previous)(i, j) : 0.0);
+            }
+        }
+    }
+
+    // The tool rarely changes, its name is written only when it does
+    if (record.toolName != m_previous.toolName) {
+        writeVarint(data, 1);
+        writeVarint(data, record.toolName.size());
+        data.insert(data.end(), record.toolName.begin(), record.toolName.end());
+    } else {
+        writeVarint(data, 0);
+    }
+
+    writeVarint(data, record.collisions.size());
+    for (const std::pair<const int32_t, Collision> &pair: record.collisions) {
+        const Collision &collision = pair.second;
+        writeSigned(data, collision.robotLink);
+        writeVarint(data, collision.numCollisions);
+        for (int32_t i = 0; i < collision.numCollisions; i++) {
+            writeSigned(data, collision.rigidBody[i]);
+            data.push_back(collision.isSelfCollision[i] ? 1 : 0);
+        }
+    }
+
+    m_previous = record;
+}
+
+void PoseRecordDecoder::reset()
+{
+    m_previous = PoseRecord_t();
+}
+
+bool PoseRecordDecoder::decode(
+        const uint8_t* &p, const uint8_t* end, PoseRecord_t &record)
+{
+    int64_t delta = 0;
+    if (!readSigned(p, end, delta)) {
+        return false;
+    }
+    record.timeNs = m_previous.timeNs + delta;
+    if (!readSigned(p, end, delta)) {
+        return false;
+    }
+    record.counter = (uint32_t)((int64_t)m_previous.counter + delta);
+
+    uint64_t size = 0;
+    if (!readVarint(p, end, size) || size > (uint64_t)(end - p)) {
+        return false;
+    }
+    record.jointValues.clear();
+    int64_t index = 0;
+    for (uint64_t k = 0; k < size; k++) {
+        double value = 0.0;
+        if (!readSigned(p, end, delta)) {
+            return false;
+        }
+        index += delta;
+        const double* previous = findPrevious(m_previous.jointValues, (int)index);
+        if (!readDouble(p, end, previous ? *previous : 0.0, value)) {
+            return false;
+        }
+        record.jointValues[(int)index] = value;
+    }
+
+    if (!readVarint(p, end, size) || size > (uint64_t)(end - p)) {
+        return false;
+    }
+    record.objectFrames.clear();
+    index = 0;
+    for (uint64_t k = 0; k < size; k++) {
+        if (!readSigned(p, end, delta)) {
+            return false;
+        }
+        index += delta;
+        const Eigen::Matrix4d* previous =
+                findPrevious(m_previous.objectFrames, (int)index);
+        Eigen::Matrix4d xfm = Eigen::Matrix4d::Identity();
+        for (int i = 0; i < FRAME_ROWS; i++) {
+            for (int j = 0; j < 4; j++) {
+                if (!readDouble(p, end,
+                        previous ? (*previous)(i, j) : 0.0, xfm(i, j))) {
+                    return false;
+                }
+            }
+        }
+        record.objectFrames[(int)index] = xfm;
+    }
+
+    uint64_t isToolChanged = 0;
+    if (!readVarint(p, end, isToolChanged)) {
+        return false;
+    }
+    if (isToolChanged) {
+        if (!readVarint(p, end, size) || size > (uint64_t)(end - p)) {
+            return false;
+        }
+        record.toolName.assign((const char*)p, size);
+        p += size;
+    } else {
+        record.toolName = m_previous.toolName;
+    }
+
+    if (!readVarint(p, end, size) || size > (uint64_t)(end - p)) {
+        return false;
+    }
+    record.collisions.clear();
+    for (uint64_t k = 0; k < size; k++) {
+        Collision collision;
+        uint64_t numCollisions = 0;
+        if (!readSigned(p, end, delta) ||
+            !readVarint(p, end, numCollisions) ||
+            numCollisions > (uint64_t)MAX_COLLISIONS) {
+            return false;
+        }
+        collision.robotLink = (int32_t)delta;
+        collision.numCollisions = (int32_t)numCollisions;
+        for (int32_t i = 0; i < collision.numCollisions; i++) {
+            if (!readSigned(p, end, delta) || p >= end) {
+                return false;
+            }
+            collision.rigidBody[i] = (int32_t)delta;
+            collision.isSelfCollision[i] = (0 != *p++);
+        }
+        record.collisions[collision.robotLink] = collision;
+    }
+
+    m_previous = record;
+    return true;
+}
+} // end of namespace tarsim
@@ -0,0 +1,258 @@
+/**
+ *
+ * @file: poseLogReader.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the pose log reader
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "poseLogReader.h"
+#include <zlib.h>
+#include <algorithm>
+
+namespace tarsim {
+PoseLogReader::~PoseLogReader()
+{
+    close();
+}
+
+Errors PoseLogReader::open(const std::string &fileName)
+{
+    close();
+
+    m_file = fopen(fileName.c_str(), "rb");
+    if (nullptr == m_file) {
+        return ERR_INVALID;
+    }
+
+    if (fread(&m_header, sizeof(m_header), 1, m_file) != 1 ||
+        POSE_LOG_MAGIC != m_header.magic ||
+        POSE_LOG_VERSION != m_header.version) {
+        close();
+        return ERR_INVALID;
+    }
+
+    if (NO_ERR != readIndex() && NO_ERR != walkBlocks()) {
+        close();
+        return ERR_INVALID;
+    }
+
+    m_numRecords = 0;
+    if (!m_index.empty()) {
+        m_numRecords = m_index.back().firstRecord + m_index.back().numRecords;
+    }
+    return NO_ERR;
+}
+
+void PoseLogReader::close()
+{
+    if (nullptr != m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_header = PoseLogHeader_t();
+    m_index.clear();
+    m_numRecords = 0;
+    m_isBlockLoaded = false;
+    m_records.clear();
+}
+
+bool PoseLogReader::isOpen() const
+{
+    return nullptr != m_file;
+}
+
+const PoseLogHeader_t& PoseLogReader::getHeader() const
+{
+    return m_header;
+}
+
+uint64_t PoseLogReader::getNumRecords() const
+{
+    return m_numRecords;
+}
+
+int64_t PoseLogReader::getStartTimeNs() const
+{
+    return m_index.empty() ? m_header.startTimeNs : m_index.front().firstTimeNs;
+}
+
+int64_t PoseLogReader::getEndTimeNs() const
+{
+    return m_index.empty() ? m_header.startTimeNs : m_index.back().lastTimeNs;
+}
+
+uint64_t PoseLogReader::findRecord(int64_t timeNs)
+{
+    if (m_index.empty()) {
+        return 0;
+    }
+
+    // The last block starting at or before the time
+    std::vector<PoseLogIndexEntry_t>::const_iterator it = std::upper_bound(
+            m_index.begin(), m_index.end(), timeNs,
+            [](int64_t time, const PoseLogIndexEntry_t &entry) {
+                return time < entry.firstTimeNs; });
+    if (it == m_index.begin()) {
+        return 0;
+    }
+    --it;
+    // An empty block ends after the record before it
+    if (0 == it->numRecords) {
+        return (it->firstRecord > 0) ? it->firstRecord - 1 : 0;
+    }
+    if (timeNs >= it->lastTimeNs) {
+        return it->firstRecord + it->numRecords - 1;
+    }
+
+    size_t block = it - m_index.begin();
+    if (NO_ERR != loadBlock(block)) {
+        return it->firstRecord;
+    }
+    std::vector<PoseRecord_t>::const_iterator record = std::upper_bound(
+            m_records.begin(), m_records.end(), timeNs,
+            [](int64_t time, const PoseRecord_t &r) {
+                return time < r.timeNs; });
+    return it->firstRecord + std::max<ptrdiff_t>(
+            record - m_records.begin() - 1, 0);
+}
+
+Errors PoseLogReader::read(uint64_t index, PoseRecord_t &record)
+{
+    if (index >= m_numRecords) {
+        return ERR_INVALID;
+    }
+
+    size_t block = findBlock(index);
+    if (NO_ERR != loadBlock(block)) {
+        return ERR_GET;
+    }
+    uint64_t offset = index - m_index[block].firstRecord;
+    if (index < m_index[block].firstRecord || offset >= m_records.size()) {
+        return ERR_GET;
+    }
+    record = m_records[offset];
+    return NO_ERR;
+}
+
+Errors PoseLogReader::readIndex()
+{
+    PoseLogTrailer_t trailer;
+    if (0 != fseek(m_file, -(long)sizeof(trailer), SEEK_END) ||
+        fread(&trailer, sizeof(trailer), 1, m_file) != 1 ||
+        POSE_LOG_INDEX_MAGIC != trailer.magic ||
+        trailer.indexOffset < (int64_t)sizeof(PoseLogHeader_t)) {
+        return ERR_INVALID;
+    }
+
+    m_index.resize(trailer.numBlocks);
+    if (0 != fseek(m_file, trailer.indexOffset, SEEK_SET) ||
+        (trailer.numBlocks > 0 && fread(m_index.data(),
+                sizeof(PoseLogIndexEntry_t), m_index.size(), m_file) !=
+                        m_index.size())) {
+        m_index.clear();
+        return ERR_INVALID;
+    }
+    for (const PoseLogIndexEntry_t &entry: m_index) {
+        if (entry.numRecords > POSE_LOG_RECORDS_PER_BLOCK) {
+            m_index.clear();
+            return ERR_INVALID;
+        }
+    }
+    return NO_ERR;
+}
+
+Errors PoseLogReader::walkBlocks()
+{
+    m_index.clear();
+    int64_t offset = sizeof(PoseLogHeader_t);
+    PoseLogBlockHeader_t block;
+    while (0 == fseek(m_file, offset, SEEK_SET) &&
+           fread(&block, sizeof(block), 1, m_file) == 1 &&
+           POSE_LOG_BLOCK_MAGIC == block.magic &&
+           block.numRecords <= POSE_LOG_RECORDS_PER_BLOCK) {
+        // A block cut short ends the log
+        int64_t next = offset + sizeof(block) + block.compressedSize;
+        if (0 != fseek(m_file, 0, SEEK_END) || ftell(m_file) < next) {
+            break;
+        }
+
+        PoseLogIndexEntry_t entry;
+        entry.offset = offset;
+        entry.firstRecord = block.firstRecord;
+        entry.firstTimeNs = block.firstTimeNs;
+        entry.lastTimeNs = block.lastTimeNs;
+        entry.numRecords = block.numRecords;
+        m_index.push_back(entry);
+        offset = next;
+    }
+    return NO_ERR;
+}
+
+size_t PoseLogReader::findBlock(uint64_t index) const
+{
+    std::vector<PoseLogIndexEntry_t>::const_iterator it = std::upper_bound(
+            m_index.begin(), m_index.end(), index,
+            [](uint64_t i, const PoseLogIndexEntry_t &entry) {
+                return i < entry.firstRecord; });
+    return (it == m_index.begin()) ? 0 : (it - m_index.begin() - 1);
+}
+
+Errors PoseLogReader::loadBlock(size_t block)
+{
+    if (m_isBlockLoaded && m_block == block) {
+        return NO_ERR;
+    }
+    m_isBlockLoaded = false;
+
+    PoseLogBlockHeader_t header;
+    if (block >= m_index.size() ||
+        0 != fseek(m_file, m_index[block].offset, SEEK_SET) ||
+        fread(&header, sizeof(header), 1, m_file) != 1 ||
+        POSE_LOG_BLOCK_MAGIC != header.magic ||
+        header.numRecords > POSE_LOG_RECORDS_PER_BLOCK ||
+        header.numRecords != m_index[block].numRecords ||
+        header.firstRecord != m_index[block].firstRecord) {
+        return ERR_GET;
+    }
+
+    m_compressed.resize(header.compressedSize);
+    m_raw.resize(header.rawSize);
+    uLongf rawSize = header.rawSize;
+    if (fread(m_compressed.data(), 1, m_compressed.size(), m_file) !=
+            m_compressed.size() ||
+        Z_OK != uncompress(m_raw.data(), &rawSize,
+                m_compressed.data(), (uLong)m_compressed.size()) ||
+        rawSize != header.rawSize) {
+        return ERR_GET;
+    }
+
+    PoseRecordDecoder decoder;
+    const uint8_t* p = m_raw.data();
+    const uint8_t* end = p + m_raw.size();
+    m_records.resize(header.numRecords);
+    for (PoseRecord_t &record: m_records) {
+        if (!decoder.decode(p, end, record)) {
+            return ERR_GET;
+        }
+    }
+
+    m_block = block;
+    m_isBlockLoaded = true;
+    return NO_ERR;
+}
+} // end of namespace tarsim
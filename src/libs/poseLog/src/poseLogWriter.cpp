@@ -0,0 +1,267 @@
+/**
+ *
+ * @file: poseLogWriter.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the pose log writer
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "poseLogWriter.h"
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+#include "ipcMessages.h"
+#include "logClient.h"
+#include "traceRecorder.h"
+
+namespace tarsim {
+PoseLogWriter::PoseLogWriter(const std::string &fileName, size_t queueSize) :
+        m_fileName(fileName),
+        m_queueSize(std::max<size_t>(queueSize, 1))
+{
+}
+
+PoseLogWriter::~PoseLogWriter()
+{
+    stop();
+}
+
+Errors PoseLogWriter::start()
+{
+    if (m_thread.joinable()) {
+        return ERR_INVALID;
+    }
+
+    m_file = fopen(m_fileName.c_str(), "wb");
+    if (nullptr == m_file) {
+        LOG_FAILURE("Failed to create the pose log %s", m_fileName.c_str());
+        return ERR_INVALID;
+    }
+
+    PoseLogHeader_t header;
+    header.startWallTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    header.startTimeNs = getMonotonicTimeNs();
+    if (fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        LOG_FAILURE("Failed to write the pose log %s", m_fileName.c_str());
+        fclose(m_file);
+        m_file = nullptr;
+        return ERR_INVALID;
+    }
+
+    m_hasFailed = false;
+    m_encoder.reset();
+    m_block = PoseLogBlockHeader_t();
+    m_raw.clear();
+    m_index.clear();
+    {
+        std::unique_lock<std::mutex> lock(m_mutexRecords);
+        m_statistics = PoseLogStatistics_t();
+        m_statistics.numBytes = sizeof(header);
+        m_isWriting = true;
+    }
+
+    try {
+        m_thread = std::thread(&PoseLogWriter::writing, this);
+    } catch (...) {
+        std::unique_lock<std::mutex> lock(m_mutexRecords);
+        m_isWriting = false;
+        fclose(m_file);
+        m_file = nullptr;
+        return ERR_FAILED_SPAWNED;
+    }
+    return NO_ERR;
+}
+
+void PoseLogWriter::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexRecords);
+        m_isWriting = false;
+    }
+    m_cvRecords.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void PoseLogWriter::append(const std::shared_ptr<const PoseRecord_t> &record)
+{
+    if (!record) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexRecords);
+        if (!m_isWriting) {
+            return;
+        }
+        if (m_queue.size() >= m_queueSize) {
+            m_statistics.numDropped++;
+            if (1 == m_statistics.numDropped % 1000) {
+                LOG_WARNING("%llu pose log records were dropped, the writer "
+                        "falls behind", (unsigned long long)m_statistics.numDropped);
+            }
+            return;
+        }
+        m_queue.push_back(record);
+        m_statistics.numAppended++;
+    }
+    m_cvRecords.notify_one();
+}
+
+PoseLogStatistics_t PoseLogWriter::getStatistics() const
+{
+    std::unique_lock<std::mutex> lock(m_mutexRecords);
+    return m_statistics;
+}
+
+void PoseLogWriter::writing()
+{
+    TraceRecorder::setThreadName("poseLog");
+
+    std::vector<std::shared_ptr<const PoseRecord_t>> records;
+    std::unique_lock<std::mutex> lock(m_mutexRecords);
+    while (true) {
+        m_cvRecords.wait_for(lock,
+                std::chrono::milliseconds(POSE_LOG_FLUSH_PERIOD_MS),
+                [this]() { return !m_queue.empty() || !m_isWriting; });
+        bool isStopping = !m_isWriting;
+        records.assign(m_queue.begin(), m_queue.end());
+        m_queue.clear();
+        lock.unlock();
+
+        for (const std::shared_ptr<const PoseRecord_t> &record: records) {
+            addRecord(*record);
+        }
+        records.clear();
+
+        // A block that waited long enough is written partly filled, so a
+        // crash loses little
+        if (m_block.numRecords > 0 && (isStopping ||
+            getMonotonicTimeNs() - m_blockStartTimeNs >=
+                    (int64_t)POSE_LOG_FLUSH_PERIOD_MS * 1000000)) {
+            writeBlock();
+        }
+
+        lock.lock();
+        if (isStopping && m_queue.empty()) {
+            break;
+        }
+    }
+    lock.unlock();
+
+    writeIndex();
+    if (0 != fclose(m_file)) {
+        m_hasFailed = true;
+    }
+    m_file = nullptr;
+
+    PoseLogStatistics_t statistics = getStatistics();
+    if (m_hasFailed) {
+        LOG_FAILURE("Failed to write the pose log %s", m_fileName.c_str());
+    }
+    LOG_INFO("Logged %llu poses to %s in %llu bytes, %llu dropped",
+            (unsigned long long)statistics.numWritten, m_fileName.c_str(),
+            (unsigned long long)statistics.numBytes,
+            (unsigned long long)statistics.numDropped);
+}
+
+void PoseLogWriter::addRecord(const PoseRecord_t &record)
+{
+    if (0 == m_block.numRecords) {
+        m_encoder.reset();
+        m_raw.clear();
+        m_block.firstTimeNs = record.timeNs;
+        m_blockStartTimeNs = getMonotonicTimeNs();
+    }
+    m_encoder.encode(record, m_raw);
+    m_block.lastTimeNs = record.timeNs;
+    m_block.numRecords++;
+
+    if (m_block.numRecords >= POSE_LOG_RECORDS_PER_BLOCK) {
+        writeBlock();
+    }
+}
+
+Errors PoseLogWriter::writeBlock()
+{
+    TRACE_SCOPE("PoseLogWriter::writeBlock");
+    uint32_t numRecords = m_block.numRecords;
+    uint64_t firstRecord = m_block.firstRecord;
+
+    // The next block follows, whether or not this one made it to the disk
+    PoseLogBlockHeader_t block = m_block;
+    m_block = PoseLogBlockHeader_t();
+    m_block.firstRecord = firstRecord + numRecords;
+    if (m_hasFailed) {
+        return ERR_INVALID;
+    }
+
+    uLongf compressedSize = compressBound((uLong)m_raw.size());
+    m_compressed.resize(compressedSize);
+    if (Z_OK != compress2(m_compressed.data(), &compressedSize,
+            m_raw.data(), (uLong)m_raw.size(), Z_DEFAULT_COMPRESSION)) {
+        m_hasFailed = true;
+        return ERR_INVALID;
+    }
+    block.rawSize = (uint32_t)m_raw.size();
+    block.compressedSize = (uint32_t)compressedSize;
+
+    PoseLogIndexEntry_t entry;
+    entry.offset = ftell(m_file);
+    entry.firstRecord = block.firstRecord;
+    entry.firstTimeNs = block.firstTimeNs;
+    entry.lastTimeNs = block.lastTimeNs;
+    entry.numRecords = block.numRecords;
+
+    if (fwrite(&block, sizeof(block), 1, m_file) != 1 ||
+        fwrite(m_compressed.data(), 1, compressedSize, m_file) != compressedSize ||
+        0 != fflush(m_file)) {
+        m_hasFailed = true;
+        return ERR_INVALID;
+    }
+    m_index.push_back(entry);
+
+    std::unique_lock<std::mutex> lock(m_mutexRecords);
+    m_statistics.numWritten += numRecords;
+    m_statistics.numBytes += sizeof(block) + compressedSize;
+    return NO_ERR;
+}
+
+Errors PoseLogWriter::writeIndex()
+{
+    if (m_hasFailed) {
+        return ERR_INVALID;
+    }
+
+    PoseLogTrailer_t trailer;
+    trailer.numBlocks = (uint32_t)m_index.size();
+    trailer.indexOffset = ftell(m_file);
+    if ((!m_index.empty() && fwrite(m_index.data(), sizeof(PoseLogIndexEntry_t),
+            m_index.size(), m_file) != m_index.size()) ||
+        fwrite(&trailer, sizeof(trailer), 1, m_file) != 1) {
+        m_hasFailed = true;
+        return ERR_INVALID;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutexRecords);
+    m_statistics.numBytes +=
+            m_index.size() * sizeof(PoseLogIndexEntry_t) + sizeof(trailer);
+    return NO_ERR;
+}
+} // end of namespace tarsim
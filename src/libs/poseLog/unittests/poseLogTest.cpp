@@ -0,0 +1,209 @@
+/**
+ *
+ * @file: poseLogTest.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Checks that records come back unchanged from the codec and from a
+ * pose log file, and that data cut short is refused
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "poseLog.h"
+#include "poseLogReader.h"
+#include "poseLogWriter.h"
+
+using namespace tarsim;
+
+namespace {
+static const uint32_t NUM_RECORDS = 2 * POSE_LOG_RECORDS_PER_BLOCK + 10;
+
+int g_numFailures = 0;
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        printf("Failed: %s\n", what);
+        g_numFailures++;
+    }
+}
+
+/**
+ * A robot of three joints moving a little every cycle, an object that moves
+ * every other cycle, a tool installed half way and a collision now and then
+ */
+PoseRecord_t makeRecord(uint32_t i)
+{
+    PoseRecord_t record;
+    record.timeNs = 1000000000LL + (int64_t)i * 4000000LL;
+    record.counter = i;
+    for (int joint = 0; joint < 3; joint++) {
+        record.jointValues[joint] = 0.001 * i * (joint + 1) - 0.5;
+    }
+    record.jointValues[7] = -1.25;
+
+    Eigen::Matrix4d xfm = Eigen::Matrix4d::Identity();
+    xfm(0, 3) = 0.1 * (i / 2);
+    xfm(1, 3) = -2.0;
+    record.objectFrames[2] = xfm;
+
+    if (i >= NUM_RECORDS / 2) {
+        record.toolName = "gripper.prototxt";
+    }
+
+    if (0 == i % 5) {
+        Collision collision;
+        collision.robotLink = 4;
+        collision.numCollisions = 2;
+        collision.rigidBody[0] = 1;
+        collision.isSelfCollision[0] = true;
+        collision.rigidBody[1] = -3;
+        collision.isSelfCollision[1] = false;
+        record.collisions[collision.robotLink] = collision;
+    }
+    return record;
+}
+
+bool isEqual(const PoseRecord_t &a, const PoseRecord_t &b)
+{
+    if (a.timeNs != b.timeNs || a.counter != b.counter ||
+        a.jointValues != b.jointValues || a.toolName != b.toolName ||
+        a.objectFrames.size() != b.objectFrames.size() ||
+        a.collisions.size() != b.collisions.size()) {
+        return false;
+    }
+    for (const std::pair<const int, Eigen::Matrix4d> &pair: a.objectFrames) {
+        auto it = b.objectFrames.find(pair.first);
+        if (it == b.objectFrames.end() || it->second != pair.second) {
+            return false;
+        }
+    }
+    for (const std::pair<const int32_t, Collision> &pair: a.collisions) {
+        auto it = b.collisions.find(pair.first);
+        if (it == b.collisions.end() ||
+            it->second.robotLink != pair.second.robotLink ||
+            it->second.numCollisions != pair.second.numCollisions) {
+            return false;
+        }
+        for (int32_t i = 0; i < pair.second.numCollisions; i++) {
+            if (it->second.rigidBody[i] != pair.second.rigidBody[i] ||
+                it->second.isSelfCollision[i] !=
+                        pair.second.isSelfCollision[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void checkCodec()
+{
+    PoseRecordEncoder encoder;
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < NUM_RECORDS; i++) {
+        encoder.encode(makeRecord(i), data);
+    }
+
+    PoseRecordDecoder decoder;
+    const uint8_t* p = data.data();
+    const uint8_t* end = p + data.size();
+    bool isDecoded = true;
+    bool isUnchanged = true;
+    for (uint32_t i = 0; i < NUM_RECORDS && isDecoded; i++) {
+        PoseRecord_t record;
+        isDecoded = decoder.decode(p, end, record);
+        isUnchanged = isUnchanged && isEqual(makeRecord(i), record);
+    }
+    check(isDecoded, "codec, decode");
+    check(isUnchanged, "codec, records unchanged");
+    check(p == end, "codec, all data decoded");
+
+    // A record cut short in any place is refused
+    encoder.reset();
+    data.clear();
+    encoder.encode(makeRecord(NUM_RECORDS - 1), data);
+    bool isRefused = true;
+    for (size_t size = 0; size < data.size(); size++) {
+        decoder.reset();
+        PoseRecord_t record;
+        p = data.data();
+        isRefused = isRefused && !decoder.decode(p, data.data() + size, record);
+    }
+    check(isRefused, "codec, data cut short refused");
+}
+
+void checkFile(const std::string &fileName)
+{
+    {
+        PoseLogWriter writer(fileName);
+        check(NO_ERR == writer.start(), "file, start writer");
+        for (uint32_t i = 0; i < NUM_RECORDS; i++) {
+            writer.append(std::make_shared<const PoseRecord_t>(makeRecord(i)));
+        }
+        writer.stop();
+        check(NUM_RECORDS == writer.getStatistics().numWritten,
+                "file, all records written");
+    }
+
+    PoseLogReader reader;
+    check(NO_ERR == reader.open(fileName), "file, open");
+    check(NUM_RECORDS == reader.getNumRecords(), "file, number of records");
+
+    bool isUnchanged = true;
+    for (uint32_t i = 0; i < NUM_RECORDS; i++) {
+        PoseRecord_t record;
+        isUnchanged = isUnchanged && NO_ERR == reader.read(i, record) &&
+                isEqual(makeRecord(i), record);
+    }
+    check(isUnchanged, "file, records unchanged");
+
+    PoseRecord_t record;
+    check(NO_ERR != reader.read(NUM_RECORDS, record), "file, read past end");
+
+    uint32_t i = POSE_LOG_RECORDS_PER_BLOCK + 3;
+    check(i == reader.findRecord(makeRecord(i).timeNs), "file, find record");
+    check(i == reader.findRecord(makeRecord(i).timeNs + 1),
+            "file, find record between records");
+    check(0 == reader.findRecord(0), "file, find before start");
+    check(NUM_RECORDS - 1 == reader.findRecord(makeRecord(NUM_RECORDS).timeNs),
+            "file, find after end");
+}
+} // end of anonymous namespace
+
+/**
+ * @brief round trips records through the codec and through a pose log file
+ * @return EXIT_SUCCESS if every check passed
+ */
+int main()
+{
+    std::string fileName = "/tmp/poseLogTest" + std::to_string(getpid());
+
+    checkCodec();
+    checkFile(fileName);
+    remove(fileName.c_str());
+
+    if (0 != g_numFailures) {
+        printf("%d checks failed\n", g_numFailures);
+        return EXIT_FAILURE;
+    }
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/**
+ *
+ * @file: frameRecorder.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Records frames read back by the graphics loop. Frames are read
+ * into a fixed pool of buffers and queued to encoder threads, which write
+ * them as PNG files or as a raw or Y4M stream to a file or a pipe. The
+ * graphics loop never waits for an encoder: when every buffer is taken, the
+ * frame is dropped and counted.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_FRAMERECORDER_INC_H_
+#define SRC_LIBS_FRAMERECORDER_INC_H_
+
+//INCLUDES
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "eitErrors.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const size_t RECORDING_DEFAULT_QUEUE_SIZE = 8; // frames waiting for an encoder
+static const int RECORDING_DEFAULT_NUM_ENCODERS = 2; // PNG encoder threads
+static const int RECORDING_DEFAULT_FRAME_RATE = 25; // frames per second in the Y4M header
+static const int RECORDING_DEFAULT_PNG_COMPRESSION_LEVEL = 1; // zlib level, fastest
+
+//enums-------------------------------------------------------------------------
+enum RecordingFormats
+{
+    RECORDING_PNG, // One PNG file per frame
+    RECORDING_RAW, // rgb24 frames, rows top down, one after the other
+    RECORDING_Y4M, // YUV4MPEG2 stream, 4:2:0
+};
+
+//structs-----------------------------------------------------------------------
+struct FrameRecorderConfig_t
+{
+    RecordingFormats format = RECORDING_PNG;
+
+    // Folder for PNG, file or named pipe for streams, or a command to pipe
+    // the stream into if it starts with '|'
+    std::string output;
+    size_t queueSize = RECORDING_DEFAULT_QUEUE_SIZE;
+    int numEncoders = RECORDING_DEFAULT_NUM_ENCODERS;
+    int frameRate = RECORDING_DEFAULT_FRAME_RATE;
+    int pngCompressionLevel = RECORDING_DEFAULT_PNG_COMPRESSION_LEVEL;
+};
+
+/**
+ * A frame as read back from OpenGL: RGB, rows bottom up
+ */
+struct RecordedFrame_t
+{
+    std::vector<uint8_t> pixels;
+    int32_t width = 0;
+    int32_t height = 0;
+    uint32_t frameNumber = 0;
+};
+
+struct RecordingStatistics_t
+{
+    uint64_t numCaptured = 0; // Frames handed to the encoders
+    uint64_t numDropped = 0;  // Frames dropped since every buffer was taken
+    uint64_t numWritten = 0;  // Frames encoded and written
+    uint64_t numFailed = 0;   // Frames that could not be written
+};
+
+//classes-----------------------------------------------------------------------
+class FrameRecorder
+{
+public:
+    explicit FrameRecorder(const FrameRecorderConfig_t &config);
+
+    /**
+     * Waits for the frames still queued to be written
+     */
+    virtual ~FrameRecorder();
+
+    /**
+     * Allocates the buffers and starts the encoders. A stream is opened by
+     * its encoder, so a named pipe may wait for its reader.
+     */
+    Errors start();
+
+    /**
+     * Lets the encoders write the frames still queued and end, without
+     * waiting for them
+     */
+    void stop();
+
+    /**
+     * Waits for the encoders to end, after stop
+     */
+    void join();
+
+    /**
+     * Takes a free buffer for a frame. The buffer is sized for the frame, and
+     * keeps its memory from one frame to the next.
+     * @param shouldWait Whether to wait for the encoders to free a buffer,
+     * for offline rendering that must not drop frames
+     * @return nullptr if every buffer is taken and it should not wait, or
+     * the frame size differs from the one of the stream; the frame is
+     * counted as dropped
+     */
+    RecordedFrame_t* acquire(int32_t width, int32_t height,
+            bool shouldWait = false);
+
+    /**
+     * Queues a frame taken with acquire to the encoders
+     */
+    void submit(RecordedFrame_t* frame);
+
+    /**
+     * Gives a frame taken with acquire back without recording it
+     */
+    void release(RecordedFrame_t* frame);
+
+    RecordingStatistics_t getStatistics() const;
+    const FrameRecorderConfig_t& getConfig() const;
+
+private:
+    void encoding();
+    Errors writePng(const RecordedFrame_t &frame,
+            std::vector<uint8_t> &scratch);
+    Errors writeStream(const RecordedFrame_t &frame,
+            std::vector<uint8_t> &scratch);
+    Errors openStream();
+    void closeStream();
+    void recycle(RecordedFrame_t* frame, Errors error);
+
+    FrameRecorderConfig_t m_config;
+    std::vector<std::unique_ptr<RecordedFrame_t>> m_frames;
+    std::vector<std::thread> m_encoders;
+
+    std::vector<RecordedFrame_t*> m_free;
+    std::deque<RecordedFrame_t*> m_queue;
+    bool m_isRecording = false;
+    int m_numEncodersRunning = 0;
+    int32_t m_streamWidth = 0;
+    int32_t m_streamHeight = 0;
+    RecordingStatistics_t m_statistics;
+    mutable std::mutex m_mutexFrames;
+    std::condition_variable m_cvFrames;
+    std::condition_variable m_cvFree;
+
+    // Only the stream encoder uses the stream
+    FILE* m_stream = nullptr;
+    bool m_isPipe = false;
+    bool m_hasStreamFailed = false;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_FRAMERECORDER_INC_H_ */
@@ -0,0 +1,474 @@
+/**
+ *
+ * @file: frameRecorder.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the frame recorder, its buffer pool and its
+ * PNG, raw and Y4M encoders
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "frameRecorder.h"
+#include <pthread.h>
+#include <signal.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include "logClient.h"
+#include "metricsRegistry.h"
+#include "traceRecorder.h"
+
+namespace tarsim {
+namespace {
+const uint8_t PNG_SIGNATURE[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+void writeBigEndian(uint8_t* p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+bool writePngChunk(FILE* file, const char* type,
+        const uint8_t* data, uint32_t size)
+{
+    uint8_t header[8];
+    writeBigEndian(header, size);
+    memcpy(header + 4, type, 4);
+    uint8_t crc[4];
+    uLong value = crc32(0L, (const Bytef*)type, 4);
+    if (size > 0) {
+        value = crc32(value, data, size);
+    }
+    writeBigEndian(crc, (uint32_t)value);
+
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+            (0 == size || fwrite(data, 1, size, file) == size) &&
+            fwrite(crc, 1, sizeof(crc), file) == sizeof(crc);
+}
+
+// BT.601 in limited range, which Y4M readers assume
+inline uint8_t toY(int r, int g, int b)
+{
+    return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t toU(int r, int g, int b)
+{
+    return (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t toV(int r, int g, int b)
+{
+    return (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+} // end of anonymous namespace
+
+FrameRecorder::FrameRecorder(const FrameRecorderConfig_t &config) :
+        m_config(config)
+{
+    m_config.queueSize = std::max<size_t>(m_config.queueSize, 1);
+    m_config.numEncoders = RECORDING_PNG == m_config.format ?
+            std::max(m_config.numEncoders, 1) : 1;
+    m_config.frameRate = std::max(m_config.frameRate, 1);
+    m_config.pngCompressionLevel =
+            std::min(std::max(m_config.pngCompressionLevel, 1), 9);
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+    join();
+}
+
+Errors FrameRecorder::start()
+{
+    if (m_config.output.empty() || !m_encoders.empty()) {
+        return ERR_INVALID;
+    }
+
+    // Every encoder holds a frame besides the queued ones
+    size_t numFrames = m_config.queueSize + m_config.numEncoders;
+    std::unique_lock<std::mutex> lock(m_mutexFrames);
+    for (size_t i = 0; i < numFrames; i++) {
+        m_frames.emplace_back(new RecordedFrame_t());
+        m_free.push_back(m_frames.back().get());
+    }
+    m_isRecording = true;
+
+    try {
+        for (int i = 0; i < m_config.numEncoders; i++) {
+            m_encoders.push_back(std::thread(&FrameRecorder::encoding, this));
+            m_numEncodersRunning++;
+        }
+    } catch (...) {
+        m_isRecording = false;
+        return ERR_FAILED_SPAWNED;
+    }
+    return NO_ERR;
+}
+
+void FrameRecorder::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrames);
+        m_isRecording = false;
+    }
+    m_cvFrames.notify_all();
+    m_cvFree.notify_all();
+}
+
+void FrameRecorder::join()
+{
+    for (std::thread &encoder: m_encoders) {
+        if (encoder.joinable()) {
+            encoder.join();
+        }
+    }
+}
+
+RecordedFrame_t* FrameRecorder::acquire(
+        int32_t width, int32_t height, bool shouldWait)
+{
+    if (width <= 0 || height <= 0) {
+        return nullptr;
+    }
+
+    RecordedFrame_t* frame = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrames);
+        if (shouldWait) {
+            m_cvFree.wait(lock, [this]() {
+                return !m_free.empty() || !m_isRecording; });
+        }
+        if (!m_isRecording) {
+            return nullptr;
+        }
+
+        // A stream keeps the size of its first frame
+        bool isSameSize = true;
+        if (RECORDING_PNG != m_config.format) {
+            if (0 == m_streamWidth) {
+                m_streamWidth = width;
+                m_streamHeight = height;
+            }
+            isSameSize = (m_streamWidth == width && m_streamHeight == height);
+        }
+
+        if (m_free.empty() || !isSameSize) {
+            m_statistics.numDropped++;
+            MetricsRegistry::getInstance()->add(METRIC_DROPPED_FRAMES);
+            if (1 == m_statistics.numDropped % 100) {
+                LOG_WARNING("%llu recorded frames were dropped, %s",
+                        (unsigned long long)m_statistics.numDropped,
+                        isSameSize ? "the encoders fall behind" :
+                                "the window size changed");
+            }
+            return nullptr;
+        }
+        frame = m_free.back();
+        m_free.pop_back();
+    }
+
+    // Only grows the first frames, the memory is kept afterwards
+    frame->width = width;
+    frame->height = height;
+    frame->pixels.resize((size_t)width * height * 3);
+    return frame;
+}
+
+void FrameRecorder::submit(RecordedFrame_t* frame)
+{
+    if (nullptr == frame) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrames);
+        m_queue.push_back(frame);
+        m_statistics.numCaptured++;
+    }
+    m_cvFrames.notify_one();
+}
+
+void FrameRecorder::release(RecordedFrame_t* frame)
+{
+    if (nullptr == frame) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrames);
+        m_free.push_back(frame);
+    }
+    m_cvFree.notify_one();
+}
+
+RecordingStatistics_t FrameRecorder::getStatistics() const
+{
+    std::unique_lock<std::mutex> lock(m_mutexFrames);
+    return m_statistics;
+}
+
+const FrameRecorderConfig_t& FrameRecorder::getConfig() const
+{
+    return m_config;
+}
+
+void FrameRecorder::recycle(RecordedFrame_t* frame, Errors error)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrames);
+        m_free.push_back(frame);
+        if (NO_ERR == error) {
+            m_statistics.numWritten++;
+        } else {
+            m_statistics.numFailed++;
+        }
+    }
+    m_cvFree.notify_one();
+}
+
+void FrameRecorder::encoding()
+{
+    // A reader closing the pipe fails the write instead of ending the process
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    TraceRecorder::setThreadName("recorder");
+
+    // Encoded data, kept from one frame to the next
+    std::vector<uint8_t> scratch;
+    while (true) {
+        RecordedFrame_t* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutexFrames);
+            m_cvFrames.wait(lock, [this]() {
+                return !m_queue.empty() || !m_isRecording; });
+            if (m_queue.empty()) {
+                break;
+            }
+            frame = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        Errors error = NO_ERR;
+        {
+            TRACE_SCOPE("FrameRecorder::encode");
+            error = (RECORDING_PNG == m_config.format) ?
+                    writePng(*frame, scratch) : writeStream(*frame, scratch);
+        }
+        recycle(frame, error);
+    }
+
+    if (RECORDING_PNG != m_config.format) {
+        closeStream();
+    }
+
+    // The last encoder to end sums the recording up
+    std::unique_lock<std::mutex> lock(m_mutexFrames);
+    if (0 == --m_numEncodersRunning) {
+        LOG_INFO("Recorded %llu frames to %s, %llu dropped, %llu failed",
+                (unsigned long long)m_statistics.numWritten,
+                m_config.output.c_str(),
+                (unsigned long long)m_statistics.numDropped,
+                (unsigned long long)m_statistics.numFailed);
+    }
+}
+
+Errors FrameRecorder::writePng(
+        const RecordedFrame_t &frame, std::vector<uint8_t> &scratch)
+{
+    const uint32_t rowSize = (uint32_t)frame.width * 3;
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (Z_OK != deflateInit(&stream, m_config.pngCompressionLevel)) {
+        return ERR_INVALID;
+    }
+    scratch.resize(deflateBound(&stream, (uLong)(rowSize + 1) * frame.height));
+    stream.next_out = scratch.data();
+    stream.avail_out = (uInt)scratch.size();
+
+    // Rows go top down, each after a filter byte of none
+    uint8_t filter = 0;
+    int ret = Z_OK;
+    for (int32_t y = frame.height - 1; y >= 0 && Z_OK == ret; y--) {
+        stream.next_in = &filter;
+        stream.avail_in = 1;
+        ret = deflate(&stream, Z_NO_FLUSH);
+        if (Z_OK != ret) {
+            break;
+        }
+        stream.next_in = const_cast<Bytef*>(
+                frame.pixels.data() + (size_t)y * rowSize);
+        stream.avail_in = rowSize;
+        ret = deflate(&stream, Z_NO_FLUSH);
+    }
+    if (Z_OK == ret) {
+        ret = deflate(&stream, Z_FINISH);
+    }
+    uint32_t compressedSize = (uint32_t)stream.total_out;
+    deflateEnd(&stream);
+    if (Z_STREAM_END != ret) {
+        return ERR_INVALID;
+    }
+
+    std::string fileName = m_config.output;
+    if ('/' != fileName.back()) {
+        fileName += "/";
+    }
+    fileName += "frame_" + std::to_string(frame.frameNumber) + ".png";
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (nullptr == file) {
+        return ERR_INVALID;
+    }
+
+    uint8_t header[13];
+    writeBigEndian(header, (uint32_t)frame.width);
+    writeBigEndian(header + 4, (uint32_t)frame.height);
+    header[8] = 8;  // bits per channel
+    header[9] = 2;  // RGB
+    header[10] = 0; // deflate
+    header[11] = 0; // adaptive filtering
+    header[12] = 0; // not interlaced
+
+    bool isWritten =
+            fwrite(PNG_SIGNATURE, 1, sizeof(PNG_SIGNATURE), file) ==
+                    sizeof(PNG_SIGNATURE) &&
+            writePngChunk(file, "IHDR", header, sizeof(header)) &&
+            writePngChunk(file, "IDAT", scratch.data(), compressedSize) &&
+            writePngChunk(file, "IEND", nullptr, 0);
+    isWritten = (0 == fclose(file)) && isWritten;
+    return isWritten ? NO_ERR : ERR_INVALID;
+}
+
+Errors FrameRecorder::openStream()
+{
+    if (nullptr != m_stream) {
+        return NO_ERR;
+    }
+    if (m_hasStreamFailed) {
+        return ERR_INVALID;
+    }
+
+    m_isPipe = ('|' == m_config.output[0]);
+    if (m_isPipe) {
+        m_stream = popen(m_config.output.c_str() + 1, "w");
+    } else {
+        m_stream = fopen(m_config.output.c_str(), "wb");
+    }
+    if (nullptr == m_stream) {
+        m_hasStreamFailed = true;
+        LOG_FAILURE("Failed to open %s to record", m_config.output.c_str());
+        return ERR_INVALID;
+    }
+
+    int32_t width = 0;
+    int32_t height = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFrames);
+        width = m_streamWidth;
+        height = m_streamHeight;
+    }
+
+    if (RECORDING_Y4M == m_config.format) {
+        // 4:2:0 needs even sizes, the last row or column is cut otherwise
+        if (fprintf(m_stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+                width & ~1, height & ~1, m_config.frameRate) < 0) {
+            return ERR_INVALID;
+        }
+        LOG_INFO("Recording %dx%d Y4M frames to %s",
+                width & ~1, height & ~1, m_config.output.c_str());
+    } else {
+        LOG_INFO("Recording %dx%d rgb24 frames to %s",
+                width, height, m_config.output.c_str());
+    }
+    return NO_ERR;
+}
+
+void FrameRecorder::closeStream()
+{
+    if (nullptr == m_stream) {
+        return;
+    }
+
+    if (m_isPipe) {
+        pclose(m_stream);
+    } else {
+        fclose(m_stream);
+    }
+    m_stream = nullptr;
+}
+
+Errors FrameRecorder::writeStream(
+        const RecordedFrame_t &frame, std::vector<uint8_t> &scratch)
+{
+    if (NO_ERR != openStream()) {
+        return ERR_INVALID;
+    }
+
+    const size_t rowSize = (size_t)frame.width * 3;
+    if (RECORDING_RAW == m_config.format) {
+        for (int32_t y = frame.height - 1; y >= 0; y--) {
+            if (fwrite(frame.pixels.data() + (size_t)y * rowSize, 1, rowSize,
+                    m_stream) != rowSize) {
+                return ERR_INVALID;
+            }
+        }
+        return NO_ERR;
+    }
+
+    // Planes of Y, then U and V of every 2x2 block
+    const int32_t width = frame.width & ~1;
+    const int32_t height = frame.height & ~1;
+    const size_t numPixels = (size_t)width * height;
+    scratch.resize(numPixels + numPixels / 2);
+    uint8_t* yPlane = scratch.data();
+    uint8_t* uPlane = yPlane + numPixels;
+    uint8_t* vPlane = uPlane + numPixels / 4;
+    for (int32_t y = 0; y < height; y += 2) {
+        // Top down, the frame is bottom up
+        const uint8_t* row0 =
+                frame.pixels.data() + (size_t)(frame.height - 1 - y) * rowSize;
+        const uint8_t* row1 = row0 - rowSize;
+        uint8_t* y0 = yPlane + (size_t)y * width;
+        uint8_t* y1 = y0 + width;
+        uint8_t* u = uPlane + (size_t)(y / 2) * (width / 2);
+        uint8_t* v = vPlane + (size_t)(y / 2) * (width / 2);
+        for (int32_t x = 0; x < width; x += 2) {
+            const uint8_t* p[4] = {row0 + x * 3, row0 + x * 3 + 3,
+                    row1 + x * 3, row1 + x * 3 + 3};
+            y0[x] = toY(p[0][0], p[0][1], p[0][2]);
+            y0[x + 1] = toY(p[1][0], p[1][1], p[1][2]);
+            y1[x] = toY(p[2][0], p[2][1], p[2][2]);
+            y1[x + 1] = toY(p[3][0], p[3][1], p[3][2]);
+            int r = (p[0][0] + p[1][0] + p[2][0] + p[3][0] + 2) / 4;
+            int g = (p[0][1] + p[1][1] + p[2][1] + p[3][1] + 2) / 4;
+            int b = (p[0][2] + p[1][2] + p[2][2] + p[3][2] + 2) / 4;
+            u[x / 2] = toU(r, g, b);
+            v[x / 2] = toV(r, g, b);
+        }
+    }
+
+    if (fputs("FRAME\n", m_stream) < 0 ||
+        fwrite(scratch.data(), 1, scratch.size(), m_stream) != scratch.size()) {
+        return ERR_INVALID;
+    }
+    return NO_ERR;
+}
+} // end of namespace tarsim
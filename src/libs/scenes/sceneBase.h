@@ -65,6 +65,13 @@ public:
     virtual vtkSmartPointer<vtkCamera> getCamera() {return m_camera;}
 
     virtual Errors update(bool dimsChanged = false) {return NO_ERR;}
+
+    /**
+     * Whether the scene changes on its own, e.g. with time, and has to be
+     * updated though neither the pose, the visibilities nor the window size
+     * changed
+     */
+    virtual bool needsUpdate() {return false;}
     virtual Errors updateCamera();
     virtual Errors updateCamera(
         float position[3],
@@ -89,6 +89,20 @@ Errors SceneFaults::update(bool dimsChanged)
     return NO_ERR;
 }
 
+bool SceneFaults::needsUpdate()
+{
+    // A message is shown for the display duration, then the next one or none
+    if (FAULT_LEVEL_NOFAULT == m_statusMessage.faultLevel &&
+        !m_gui->hasStatusMessages()) {
+        return false;
+    }
+
+    std::chrono::duration<double> time_span =
+        std::chrono::duration_cast<std::chrono::duration<double>>(
+            std::chrono::high_resolution_clock::now() - m_prevUpdateTime);
+    return time_span.count() > m_updateDuration;
+}
+
 Errors SceneFaults::addActorsToScene()
 {
     if (NO_ERR != addActorCircleToScene()) {
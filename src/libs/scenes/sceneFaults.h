@@ -44,6 +44,7 @@ public:
     virtual ~SceneFaults() = default;
 
     Errors update(bool dimsChanged = false) override;
+    bool needsUpdate() override;
     // MEMBERS
 
 private:
@@ -20,6 +20,7 @@
 #include "sceneRobot.h"
 #include "gui.h"
 #include "logClient.h"
+#include "traceRecorder.h"
 #include "vtkTransform.h"
 #include "vtkProperty.h"
 #include "vtkCaptionActor2D.h"
@@ -88,6 +89,8 @@ SceneRobot::SceneRobot(Gui* gui, Node* root):
 
 Errors SceneRobot::update(bool dimsChanged)
 {
+    TRACE_SCOPE("SceneRobot::update");
+
     // Update frames visibility
     bool frameVisibility = m_gui->getFramesVisibility();
     if (m_frameVisibility != frameVisibility) {
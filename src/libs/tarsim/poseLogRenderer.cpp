@@ -0,0 +1,217 @@
+/**
+ * @file: poseLogRenderer.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the offline renderer of pose logs
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ */
+
+//INCLUDES
+#include "poseLogRenderer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include "configParser.h"
+#include "kinematics.h"
+#include "gui.h"
+#include "node.h"
+#include "threadQueue.h"
+#include "win.pb.h"
+#include "rbs.pb.h"
+
+namespace tarsim {
+PoseLogRenderer::PoseLogRenderer(const PoseLogRendererConfig_t &config) :
+        m_config(config)
+{
+    if (m_config.width <= 0 || m_config.height <= 0) {
+        throw std::invalid_argument("Invalid frame size");
+    }
+
+    if (NO_ERR != m_reader.open(m_config.poseLogFileName)) {
+        throw std::invalid_argument("Failed to open the pose log");
+    }
+
+    try {
+        m_cp = new ConfigParser(m_config.configFolderName);
+
+        // The collisions come from the log
+        m_cp->getRbs()->mutable_collision_detection()->set_is_active(false);
+
+        // The robot scene fills the frame
+        SIM::Window* win = m_cp->getWin();
+        win->mutable_window_size()->set_width(m_config.width);
+        win->mutable_window_size()->set_height(m_config.height);
+        SIM::ViewPort* viewPort = win->mutable_robot_scene()->mutable_view_port();
+        viewPort->set_x_min(0.0);
+        viewPort->set_y_min(0.0);
+        viewPort->set_x_max(1.0);
+        viewPort->set_y_max(1.0);
+
+        m_kin = new Kinematics(m_cp);
+        m_gui = new Gui(m_cp, m_kin, true);
+    } catch (...) {
+        delete m_kin;
+        m_kin = nullptr;
+        delete m_cp;
+        m_cp = nullptr;
+        throw std::invalid_argument("Failed to construct the robot");
+    }
+
+    for (int i = JOINT_VALUES; i <= SPEED; i++) {
+        m_gui->getRenderWindow()->RemoveRenderer(
+                m_gui->getSceneRenderer((SCENES)i));
+    }
+
+    if (m_config.hasCamera) {
+        m_kin->getCameraDataQueue()->push(m_config.camera);
+    }
+}
+
+PoseLogRenderer::~PoseLogRenderer()
+{
+    delete m_gui;
+    m_gui = nullptr;
+
+    delete m_kin;
+    m_kin = nullptr;
+
+    delete m_cp;
+    m_cp = nullptr;
+}
+
+Errors PoseLogRenderer::run()
+{
+    if (m_reader.getNumRecords() == 0) {
+        return ERR_INVALID;
+    }
+
+    FrameRecorder recorder(m_config.recording);
+    if (NO_ERR != recorder.start()) {
+        return ERR_INVALID;
+    }
+
+    int64_t firstTimeNs = m_reader.getStartTimeNs();
+    int64_t startTimeNs = firstTimeNs + (int64_t)(m_config.startTime * 1e9);
+    int64_t endTimeNs = m_reader.getEndTimeNs();
+    if (m_config.endTime >= 0.0) {
+        endTimeNs = std::min(endTimeNs,
+                firstTimeNs + (int64_t)(m_config.endTime * 1e9));
+    }
+    int64_t periodNs = 1000000000LL / recorder.getConfig().frameRate;
+
+    Errors error = NO_ERR;
+    uint64_t previousIndex = m_reader.getNumRecords();
+    PoseRecord_t record;
+    for (int64_t timeNs = startTimeNs; timeNs <= endTimeNs; timeNs += periodNs) {
+        // Frames between two records show the earlier one
+        uint64_t index = m_reader.findRecord(timeNs);
+        if (index != previousIndex) {
+            if (NO_ERR != m_reader.read(index, record) ||
+                NO_ERR != applyRecord(record)) {
+                error = ERR_INVALID;
+                break;
+            }
+            previousIndex = index;
+        }
+
+        m_gui->update();
+        m_gui->getRenderWindow()->Render();
+        if (NO_ERR != m_gui->captureFrame(&recorder, true)) {
+            error = ERR_INVALID;
+            break;
+        }
+    }
+
+    // Waits for the encoders to write every frame
+    recorder.stop();
+    recorder.join();
+    m_statistics = recorder.getStatistics();
+
+    if (NO_ERR == error && m_statistics.numFailed > 0) {
+        error = ERR_INVALID;
+    }
+    return error;
+}
+
+RecordingStatistics_t PoseLogRenderer::getStatistics() const
+{
+    return m_statistics;
+}
+
+const PoseLogReader& PoseLogRenderer::getReader() const
+{
+    return m_reader;
+}
+
+Errors PoseLogRenderer::applyRecord(const PoseRecord_t &record)
+{
+    for (const std::pair<const int, double> &pair: record.jointValues) {
+        Node* node = m_cp->getNodeOfMate(pair.first);
+        if (nullptr != node) {
+            node->setTargetJointValue(pair.second, false);
+        }
+    }
+
+    if (record.toolName != m_toolName) {
+        if (NO_ERR != m_gui->removeTool()) {
+            return ERR_INVALID;
+        }
+        if (!record.toolName.empty()) {
+            if (NO_ERR != m_cp->loadTool(record.toolName) ||
+                NO_ERR != m_kin->installTool() ||
+                NO_ERR != m_gui->installTool(m_cp->getTool())) {
+                return ERR_INVALID;
+            }
+        }
+        m_toolName = record.toolName;
+    }
+
+    GuiStatusMessage_t status;
+    std::map<int32_t, Collision> collisions;
+    if (NO_ERR != m_kin->executeForwardKinematics(status, collisions)) {
+        return ERR_INVALID;
+    }
+
+    // Objects may have been moved by the user rather than by a rigid body
+    for (const std::pair<const int, Matrix4d> &pair: record.objectFrames) {
+        m_kin->setObjectFrame(pair.first, pair.second);
+    }
+
+    clearCollisions(m_cp->getRoot());
+    for (const std::pair<const int32_t, Collision> &pair: record.collisions) {
+        const Collision &collision = pair.second;
+        Node* node = m_cp->getNodeOfRigidBody(collision.robotLink);
+        if (nullptr != node) {
+            node->setIsCollisionDetected(true);
+        }
+        for (int32_t i = 0; i < collision.numCollisions; i++) {
+            if (!collision.isSelfCollision[i]) {
+                continue;
+            }
+            node = m_cp->getNodeOfRigidBody(collision.rigidBody[i]);
+            if (nullptr != node) {
+                node->setIsCollisionDetected(true);
+            }
+        }
+    }
+    return NO_ERR;
+}
+
+void PoseLogRenderer::clearCollisions(Node* node)
+{
+    node->setIsCollisionDetected(false);
+    for (size_t i = 0; i < node->getChildren().size(); i++) {
+        clearCollisions(node->getChildren().at(i));
+    }
+}
+} // end of namespace tarsim
@@ -0,0 +1,98 @@
+/**
+* @file: poseLogRenderer.h
+*
+* @Created on: Oct 19, 2026
+* @Author: Kamran Shamaei
+*
+*
+* @brief - Renders a pose log offline. It builds the robot of a config folder
+* like Tarsim does, but with an offscreen window of the size asked for, no
+* server and no collision detection. Every frame it poses the robot as the
+* log was at the time of the frame, renders the robot scene only and
+* records it, as fast as it renders rather than at the pace of the log.
+*
+* @copyright Copyright Kamran Shamaei
+* All Rights Reserved.
+*
+* This file is subject to the terms and conditions defined in
+* file 'LICENSE', which is part of this source code package.
+*/
+#ifndef POSE_LOG_RENDERER_H
+#define POSE_LOG_RENDERER_H
+
+#include <string>
+#include "eitErrors.h"
+#include "simulatorMessages.h"
+#include "frameRecorder.h"
+#include "poseLogReader.h"
+
+namespace tarsim {
+class Gui;
+class ConfigParser;
+class Kinematics;
+class Node;
+
+struct PoseLogRendererConfig_t
+{
+    std::string configFolderName;
+    std::string poseLogFileName;
+
+    /**
+     * Format and output of the frames. Its frame rate is the one the log is
+     * sampled at, in frames per second of the log.
+     */
+    FrameRecorderConfig_t recording;
+
+    int32_t width = 1280;
+    int32_t height = 720;
+
+    /**
+     * Part of the log to render, in seconds from its first record. A negative
+     * end time renders to the end of the log.
+     */
+    double startTime = 0.0;
+    double endTime = -1.0;
+
+    /**
+     * Camera of the robot scene, the one of the config if not set
+     */
+    bool hasCamera = false;
+    Camera_t camera;
+};
+
+class PoseLogRenderer
+{
+public:
+    /**
+     * Opens the log and builds the robot
+     * @throw std::invalid_argument if the log or the config cannot be read
+     */
+    explicit PoseLogRenderer(const PoseLogRendererConfig_t &config);
+    virtual ~PoseLogRenderer();
+
+    /**
+     * Renders and records every frame, and returns when they are written
+     */
+    Errors run();
+
+    /**
+     * Frames recorded by the last run
+     */
+    RecordingStatistics_t getStatistics() const;
+
+    const PoseLogReader& getReader() const;
+
+private:
+    Errors applyRecord(const PoseRecord_t &record);
+    void clearCollisions(Node* node);
+
+    PoseLogRendererConfig_t m_config;
+    PoseLogReader m_reader;
+    ConfigParser* m_cp = nullptr;
+    Kinematics* m_kin = nullptr;
+    Gui* m_gui = nullptr;
+    std::string m_toolName = "";
+    RecordingStatistics_t m_statistics;
+};
+} // end of namespace tarsim
+#endif /* POSE_LOG_RENDERER_H */
@@ -26,6 +26,7 @@
 #include "logServer.h"
 #include "logClient.h"
 #include "fileSystem.h"
+#include "metricsRegistry.h"
 
 namespace tarsim {
 // FORWARD DECLARATIONS
@@ -34,7 +35,7 @@ namespace tarsim {
 // NAMESPACES AND STRUCTS
 // CLASS DEFINITION
 Tarsim::Tarsim(const std::string &configFolderName,
-        int policy, int priority, unsigned int msgPriority)
+        int policy, int priority, unsigned int msgPriority, bool isOffScreen)
 {
     int ret = 0;
     ret = std::system("rm -f /dev/mqueue/Tarsim*");
@@ -66,7 +67,7 @@ Tarsim::Tarsim(const std::string &configFolderName,
       m_kin = new Kinematics(m_cp);
 
       // 3. Instantiate the gui
-      m_gui = new Gui(m_cp, m_kin);
+      m_gui = new Gui(m_cp, m_kin, isOffScreen);
 
       // 4. Instantiate the server
       m_srv = new EitServer(m_cp, m_kin, m_gui, policy, priority, msgPriority);
@@ -76,10 +77,18 @@ Tarsim::Tarsim(const std::string &configFolderName,
     } catch (...) {
       throw std::invalid_argument("Failed to construct tarsim");
     }
+
+    // Tools poll the metrics from /dev/shm, the simulator runs without them
+    if (NO_ERR != MetricsRegistry::getInstance()->startPublishing(
+            TarsimStatisticsPageName)) {
+      LOG_WARNING("Failed to publish the statistics to shared memory");
+    }
 }
 
 Tarsim::~Tarsim()
 {
+  MetricsRegistry::getInstance()->stopPublishing();
+
   delete m_logServer;
   m_logServer = nullptr;
 
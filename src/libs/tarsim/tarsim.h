@@ -54,11 +54,14 @@ public:
      * non-realtime value of 0)
      * @param priority The realtime thread priority (if fails, it just used
      * non-realtime value of 0)
+     * @param isOffScreen Whether to render offscreen, without a screen, every
+     * time the pose changes (also set by is_offscreen in the window config)
      */
     Tarsim(const std::string &configFolderName,
             int policy = DEFAULT_RT_THREAD_POLICY,
             int priority = DEFAULT_RT_THREAD_PRIORITY,
-            unsigned int msgPriority = DEFAULT_MSG_PRIORITY);
+            unsigned int msgPriority = DEFAULT_MSG_PRIORITY,
+            bool isOffScreen = false);
 
     /**
      * Destructor
@@ -66,7 +69,8 @@ public:
     virtual ~Tarsim();
 
     /**
-     * Starts the simulator GUI, it is a blocking call.
+     * Starts the simulator GUI, it is a blocking call. Offscreen, it renders
+     * every time the pose changes until destroyed.
      */
     void start();
 
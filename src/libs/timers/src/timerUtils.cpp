@@ -87,7 +87,7 @@ Errors TimerUtils::FireTimer(int32_t timeMs, NotifyMethod notification)
             {
                 LOG_FAILURE("Server %s is not connected\n",m_queName.c_str());
             }
-            else if (m_caller->send(&m, sizeof(m), 0))
+            else if (m_caller->send(&m, sizeof(m), DEFAULT_MSG_PRIORITY))
             {
                 LOG_FAILURE("Failed to send timer message to %s\n",m_queName.c_str());
             }
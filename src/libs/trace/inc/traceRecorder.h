@@ -0,0 +1,123 @@
+/**
+ *
+ * @file: traceRecorder.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Scoped trace spans of the simulator cycle, e.g. message dispatch,
+ * kinematics, collision detection and rendering. Spans are kept per thread,
+ * the most recent TRACE_NUM_EVENTS_PER_THREAD of each, and written on demand
+ * as Chrome Trace JSON, which chrome://tracing and ui.perfetto.dev open.
+ * While tracing is stopped a span costs a relaxed atomic load.
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_TRACERECORDER_INC_H_
+#define SRC_LIBS_TRACERECORDER_INC_H_
+
+//INCLUDES
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "ipcMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const size_t TRACE_NUM_EVENTS_PER_THREAD = 16384; // older spans are overwritten
+
+//defines-----------------------------------------------------------------------
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Traces the rest of the enclosing scope, name must be a literal
+#define TRACE_SCOPE(name) \
+    tarsim::TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+//structs-----------------------------------------------------------------------
+struct TraceEvent_t
+{
+    const char* name = nullptr;
+    int64_t startNs = 0;
+    int64_t durationNs = 0;
+};
+
+//classes-----------------------------------------------------------------------
+class TraceRecorder
+{
+public:
+    static bool isEnabled()
+    {
+        return m_isEnabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts tracing over, the spans recorded so far are discarded
+     */
+    static void start();
+    static void stop();
+
+    /**
+     * Names the calling thread in the trace
+     */
+    static void setThreadName(const std::string &name);
+
+    /**
+     * Records a span of the calling thread
+     * @param name Literal naming the span
+     * @param startNs Monotonic time the span started
+     * @param endNs Monotonic time the span ended
+     */
+    static void record(const char* name, int64_t startNs, int64_t endNs);
+
+    /**
+     * Writes the spans of every thread as Chrome Trace JSON
+     * @param fileName File to write, replaced if it exists
+     * @param numEvents Number of spans written
+     * @return false if the file could not be written
+     */
+    static bool writeChromeTrace(const std::string &fileName, size_t &numEvents);
+
+private:
+    static std::atomic<bool> m_isEnabled;
+};
+
+/**
+ * Records the span from its construction to its destruction, if tracing was
+ * on when it was constructed
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) :
+        m_name(name),
+        m_startNs(TraceRecorder::isEnabled() ? getMonotonicTimeNs() : -1)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (m_startNs >= 0) {
+            TraceRecorder::record(m_name, m_startNs, getMonotonicTimeNs());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_startNs;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_TRACERECORDER_INC_H_ */
@@ -0,0 +1,193 @@
+/**
+ *
+ * @file: traceRecorder.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of the per-thread trace buffers and their Chrome
+ * Trace JSON export
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "traceRecorder.h"
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tarsim {
+namespace {
+/**
+ * Spans of one thread. Only the thread itself and the export take the
+ * mutex, so the thread finds it free unless its spans are being copied.
+ */
+struct TraceBuffer
+{
+    std::mutex mutexEvents;
+    std::vector<TraceEvent_t> events;
+    size_t next = 0;
+    bool isWrapped = false;
+    int32_t tid = 0;
+    std::string threadName;
+};
+
+std::mutex g_mutexBuffers;
+std::vector<std::shared_ptr<TraceBuffer>> g_buffers;
+
+std::shared_ptr<TraceBuffer> addBuffer()
+{
+    std::shared_ptr<TraceBuffer> buffer = std::make_shared<TraceBuffer>();
+    buffer->events.resize(TRACE_NUM_EVENTS_PER_THREAD);
+    buffer->tid = (int32_t)syscall(SYS_gettid);
+    std::lock_guard<std::mutex> lock(g_mutexBuffers);
+    g_buffers.push_back(buffer);
+    return buffer;
+}
+
+TraceBuffer* getThreadBuffer()
+{
+    static thread_local std::shared_ptr<TraceBuffer> buffer = addBuffer();
+    return buffer.get();
+}
+
+void writeJsonString(FILE* file, const std::string &s)
+{
+    fputc('"', file);
+    for (char c: s) {
+        if ('"' == c || '\\' == c) {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if ((unsigned char)c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+} // end of anonymous namespace
+
+std::atomic<bool> TraceRecorder::m_isEnabled(false);
+
+void TraceRecorder::start()
+{
+    std::lock_guard<std::mutex> lock(g_mutexBuffers);
+    for (auto it = g_buffers.begin(); it != g_buffers.end();) {
+        // Buffers only the list holds belong to threads that ended
+        if (it->use_count() == 1) {
+            it = g_buffers.erase(it);
+            continue;
+        }
+        std::lock_guard<std::mutex> lockEvents((*it)->mutexEvents);
+        (*it)->next = 0;
+        (*it)->isWrapped = false;
+        ++it;
+    }
+    m_isEnabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::stop()
+{
+    m_isEnabled.store(false, std::memory_order_relaxed);
+}
+
+void TraceRecorder::setThreadName(const std::string &name)
+{
+    TraceBuffer* buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutexEvents);
+    buffer->threadName = name;
+}
+
+void TraceRecorder::record(const char* name, int64_t startNs, int64_t endNs)
+{
+    TraceBuffer* buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutexEvents);
+    TraceEvent_t &event = buffer->events[buffer->next];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    if (++buffer->next == buffer->events.size()) {
+        buffer->next = 0;
+        buffer->isWrapped = true;
+    }
+}
+
+bool TraceRecorder::writeChromeTrace(
+        const std::string &fileName, size_t &numEvents)
+{
+    numEvents = 0;
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (nullptr == file) {
+        return false;
+    }
+
+    int pid = getpid();
+    bool isFirst = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    // The file is written without holding a lock the traced threads take
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_mutexBuffers);
+        buffers = g_buffers;
+    }
+
+    std::vector<TraceEvent_t> events;
+    events.reserve(TRACE_NUM_EVENTS_PER_THREAD);
+    for (const std::shared_ptr<TraceBuffer> &buffer: buffers) {
+        std::string threadName;
+        events.clear();
+        {
+            std::lock_guard<std::mutex> lockEvents(buffer->mutexEvents);
+            threadName = buffer->threadName;
+            // Oldest first
+            size_t size = buffer->isWrapped ?
+                    buffer->events.size() : buffer->next;
+            size_t first = buffer->isWrapped ? buffer->next : 0;
+            for (size_t i = 0; i < size; i++) {
+                events.push_back(
+                        buffer->events[(first + i) % buffer->events.size()]);
+            }
+        }
+
+        if (threadName.empty()) {
+            threadName = "thread " + std::to_string(buffer->tid);
+        }
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                "\"tid\":%d,\"args\":{\"name\":", isFirst ? "" : ",",
+                pid, buffer->tid);
+        writeJsonString(file, threadName);
+        fprintf(file, "}}");
+        isFirst = false;
+
+        for (const TraceEvent_t &event: events) {
+            fprintf(file, ",\n{\"name\":");
+            writeJsonString(file, event.name);
+            fprintf(file, ",\"cat\":\"tarsim\",\"ph\":\"X\",\"pid\":%d,"
+                    "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    pid, buffer->tid,
+                    event.startNs / 1000.0, event.durationNs / 1000.0);
+            numEvents++;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    bool isSuccessful = !ferror(file);
+    isSuccessful = (0 == fclose(file)) && isSuccessful;
+    return isSuccessful;
+}
+} // end of namespace tarsim
@@ -0,0 +1,111 @@
+/**
+ *
+ * @file: trajectory.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Joint trajectory through timestamped waypoints, interpolated with
+ * cubic or quintic Hermite splines and stretched in time where it would
+ * exceed the joint velocity and acceleration limits
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_TRAJECTORY_INC_H_
+#define SRC_LIBS_TRAJECTORY_INC_H_
+
+//INCLUDES
+#include <vector>
+#include "eitErrors.h"
+#include "simulatorMessages.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int TRAJECTORY_LIMIT_SAMPLES = 32; // samples per segment to find peak rates
+static const int TRAJECTORY_LIMIT_ITERATIONS = 10; // passes to settle the time stretching
+
+/**
+ * Velocity and acceleration limits of a joint, in units per ms and per ms^2
+ * like the mate limits
+ */
+struct JointLimits_t
+{
+    bool isVelocityLimited = false;
+    double minVelocity = 0.0;
+    double maxVelocity = 0.0;
+    bool isAccelerationLimited = false;
+    double minAcceleration = 0.0;
+    double maxAcceleration = 0.0;
+};
+
+class Trajectory
+{
+public:
+    /**
+     * Constructor
+     * @param id Id given by the client
+     * @param interpolation Spline used between waypoints
+     * @param indices Joint (mate) index of every column of the waypoints
+     */
+    Trajectory(
+            int32_t id,
+            TrajectoryInterpolations interpolation,
+            const std::vector<int32_t> &indices);
+    virtual ~Trajectory();
+
+    /**
+     * Appends a waypoint. Times must be strictly increasing.
+     * @param time Time of the waypoint in ms
+     * @param positions One position per joint
+     */
+    Errors addWaypoint(double time, const std::vector<double> &positions);
+
+    /**
+     * Computes the spline and stretches the segments that exceed the limits.
+     * It must be called once all waypoints are added.
+     * @param limits Limits of every joint, in the order of the indices
+     */
+    Errors finalize(const std::vector<JointLimits_t> &limits);
+
+    /**
+     * Evaluates the joint positions at a time, clamped to the trajectory
+     * @param time Time in ms since the start of the trajectory
+     * @param positions The joint positions
+     * @return The segment the time falls in
+     */
+    int32_t evaluate(double time, std::vector<double> &positions) const;
+
+    int32_t getId() const;
+    const std::vector<int32_t>& getIndices() const;
+    int32_t getNumSegments() const;
+    double getDuration() const;
+
+private:
+    void computeTangents();
+    void evaluateSegment(
+            size_t segment, double s, std::vector<double> &positions) const;
+    double getSegmentScale(
+            size_t segment, const std::vector<JointLimits_t> &limits) const;
+
+    int32_t m_id = 0;
+    TrajectoryInterpolations m_interpolation = INTERPOLATION_CUBIC;
+    std::vector<int32_t> m_indices;
+
+    // Waypoint times, rebased to start at zero once finalized
+    std::vector<double> m_times;
+    std::vector<std::vector<double>> m_positions;
+    std::vector<std::vector<double>> m_velocities;
+    std::vector<std::vector<double>> m_accelerations;
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_TRAJECTORY_INC_H_ */
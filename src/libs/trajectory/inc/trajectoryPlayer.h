@@ -0,0 +1,106 @@
+/**
+ *
+ * @file: trajectoryPlayer.h
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Thread that plays a trajectory back in real time, handing the
+ * interpolated joint positions to a callback every control cycle
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+#ifndef SRC_LIBS_TRAJECTORYPLAYER_INC_H_
+#define SRC_LIBS_TRAJECTORYPLAYER_INC_H_
+
+//INCLUDES
+#include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "trajectory.h"
+
+namespace tarsim {
+//consts------------------------------------------------------------------------
+static const int TRAJECTORY_PLAYER_POLL_MS = 100; // how often an idle thread checks for stop
+
+class TrajectoryPlayer
+{
+public:
+    /**
+     * Called every cycle with the positions of the joints of the trajectory,
+     * the time since its start in ms and the current segment. isDone is set
+     * on the last call of a trajectory that played to its end.
+     */
+    typedef std::function<void(
+            const Trajectory &trajectory,
+            const std::vector<double> &positions,
+            double time, int32_t segment, bool isDone)> Callback;
+
+    /**
+     * Constructor
+     * @param callback Called on the player thread every cycle
+     * @param policy Player thread scheduling policy
+     * @param priority Player thread priority
+     */
+    TrajectoryPlayer(
+            Callback callback,
+            int policy = DEFAULT_RT_THREAD_POLICY,
+            int priority = DEFAULT_RT_THREAD_PRIORITY);
+    virtual ~TrajectoryPlayer();
+
+    Errors start();
+    Errors stop();
+
+    /**
+     * Plays a trajectory, replacing the one playing if any. It never waits
+     * for the player thread, so it can be called while holding a lock the
+     * callback takes.
+     * @param trajectory Finalized trajectory
+     * @param cycleMs Control cycle in ms
+     */
+    Errors play(std::shared_ptr<const Trajectory> trajectory, double cycleMs);
+
+    /**
+     * Stops the trajectory playing, if any, without waiting for the thread
+     * @return Whether a trajectory was playing
+     */
+    bool abort();
+
+    bool isPlaying() const;
+
+private:
+    static void* threadFunctionHelper(void* object);
+    void running();
+    void playing(
+            std::shared_ptr<const Trajectory> trajectory,
+            double cycleMs, uint64_t generation);
+
+    Callback m_callback;
+    int m_threadPolicy = 0;
+    int m_threadPriority = 0;
+    std::atomic<bool> m_runForEver {false};
+    std::unique_ptr<pthread_t> m_pthread;
+
+    // Trajectory to play. The generation changes with every play or abort
+    // so a trajectory that was replaced stops at its next cycle.
+    mutable std::mutex m_mutexTrajectory;
+    std::condition_variable m_cvTrajectory;
+    std::shared_ptr<const Trajectory> m_trajectory;
+    double m_cycleMs = 1.0;
+    std::atomic<uint64_t> m_generation {0};
+};
+} // end of namespace tarsim
+#endif /* SRC_LIBS_TRAJECTORYPLAYER_INC_H_ */
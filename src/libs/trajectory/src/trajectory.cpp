@@ -0,0 +1,253 @@
+/**
+ *
+ * @file: trajectory.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of Trajectory
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "trajectory.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tarsim {
+
+namespace {
+/**
+ * How far a rate is beyond its limit, as a ratio. Limits that do not apply
+ * to the sign of the rate are ignored.
+ */
+double getLimitRatio(double rate, double minRate, double maxRate)
+{
+    if (rate > 0.0 && maxRate > 0.0) {
+        return rate / maxRate;
+    } else if (rate < 0.0 && minRate < 0.0) {
+        return rate / minRate;
+    }
+    return 0.0;
+}
+} // end of anonymous namespace
+
+Trajectory::Trajectory(
+        int32_t id,
+        TrajectoryInterpolations interpolation,
+        const std::vector<int32_t> &indices):
+        m_id(id),
+        m_interpolation(interpolation),
+        m_indices(indices)
+{
+}
+
+Trajectory::~Trajectory()
+{
+}
+
+Errors Trajectory::addWaypoint(
+        double time, const std::vector<double> &positions)
+{
+    if (positions.size() != m_indices.size()) {
+        return ERR_INVALID;
+    }
+
+    if (!m_times.empty() && time <= m_times.back()) {
+        return ERR_INVALID;
+    }
+
+    m_times.push_back(time);
+    m_positions.push_back(positions);
+    return NO_ERR;
+}
+
+Errors Trajectory::finalize(const std::vector<JointLimits_t> &limits)
+{
+    if (m_times.empty() || limits.size() != m_indices.size()) {
+        return ERR_INVALID;
+    }
+
+    double start = m_times.front();
+    for (double &time: m_times) {
+        time -= start;
+    }
+
+    computeTangents();
+
+    // Stretching a segment changes the tangents of its neighbours, so repeat
+    // until no segment needs it
+    for (int iteration = 0; iteration < TRAJECTORY_LIMIT_ITERATIONS;
+            iteration++) {
+        std::vector<double> scales(m_times.size() - 1, 1.0);
+        bool isStretched = false;
+        for (size_t i = 0; i + 1 < m_times.size(); i++) {
+            scales[i] = getSegmentScale(i, limits);
+            if (scales[i] > 1.0) {
+                isStretched = true;
+            }
+        }
+
+        if (!isStretched) {
+            break;
+        }
+
+        std::vector<double> times(m_times.size(), 0.0);
+        for (size_t i = 0; i + 1 < m_times.size(); i++) {
+            times[i + 1] = times[i] + scales[i] * (m_times[i + 1] - m_times[i]);
+        }
+        m_times.swap(times);
+        computeTangents();
+    }
+    return NO_ERR;
+}
+
+void Trajectory::computeTangents()
+{
+    size_t numWaypoints = m_times.size();
+    size_t numJoints = m_indices.size();
+    m_velocities.assign(numWaypoints, std::vector<double>(numJoints, 0.0));
+    m_accelerations.assign(numWaypoints, std::vector<double>(numJoints, 0.0));
+
+    // The trajectory starts and ends at rest, interior waypoints use the
+    // weighted slopes of their two segments
+    for (size_t i = 1; i + 1 < numWaypoints; i++) {
+        double h0 = m_times[i] - m_times[i - 1];
+        double h1 = m_times[i + 1] - m_times[i];
+        for (size_t j = 0; j < numJoints; j++) {
+            double slope0 = (m_positions[i][j] - m_positions[i - 1][j]) / h0;
+            double slope1 = (m_positions[i + 1][j] - m_positions[i][j]) / h1;
+            m_velocities[i][j] = (h1 * slope0 + h0 * slope1) / (h0 + h1);
+            m_accelerations[i][j] = 2.0 * (slope1 - slope0) / (h0 + h1);
+        }
+    }
+}
+
+void Trajectory::evaluateSegment(
+        size_t segment, double s, std::vector<double> &positions) const
+{
+    double h = m_times[segment + 1] - m_times[segment];
+    const std::vector<double> &p0 = m_positions[segment];
+    const std::vector<double> &p1 = m_positions[segment + 1];
+    const std::vector<double> &v0 = m_velocities[segment];
+    const std::vector<double> &v1 = m_velocities[segment + 1];
+
+    double s2 = s * s;
+    double s3 = s2 * s;
+    positions.resize(m_indices.size());
+    if (INTERPOLATION_QUINTIC == m_interpolation) {
+        const std::vector<double> &a0 = m_accelerations[segment];
+        const std::vector<double> &a1 = m_accelerations[segment + 1];
+        double s4 = s3 * s;
+        double s5 = s4 * s;
+        double hp0 = 1.0 - 10.0 * s3 + 15.0 * s4 - 6.0 * s5;
+        double hv0 = s - 6.0 * s3 + 8.0 * s4 - 3.0 * s5;
+        double ha0 = 0.5 * s2 - 1.5 * s3 + 1.5 * s4 - 0.5 * s5;
+        double ha1 = 0.5 * s3 - s4 + 0.5 * s5;
+        double hv1 = -4.0 * s3 + 7.0 * s4 - 3.0 * s5;
+        double hp1 = 10.0 * s3 - 15.0 * s4 + 6.0 * s5;
+        for (size_t j = 0; j < positions.size(); j++) {
+            positions[j] = hp0 * p0[j] + hv0 * h * v0[j] +
+                    ha0 * h * h * a0[j] + ha1 * h * h * a1[j] +
+                    hv1 * h * v1[j] + hp1 * p1[j];
+        }
+    } else {
+        double hp0 = 2.0 * s3 - 3.0 * s2 + 1.0;
+        double hv0 = s3 - 2.0 * s2 + s;
+        double hp1 = -2.0 * s3 + 3.0 * s2;
+        double hv1 = s3 - s2;
+        for (size_t j = 0; j < positions.size(); j++) {
+            positions[j] = hp0 * p0[j] + hv0 * h * v0[j] +
+                    hp1 * p1[j] + hv1 * h * v1[j];
+        }
+    }
+}
+
+double Trajectory::getSegmentScale(
+        size_t segment, const std::vector<JointLimits_t> &limits) const
+{
+    double dt = (m_times[segment + 1] - m_times[segment]) /
+            TRAJECTORY_LIMIT_SAMPLES;
+
+    std::vector<std::vector<double>> samples(TRAJECTORY_LIMIT_SAMPLES + 1);
+    for (int k = 0; k <= TRAJECTORY_LIMIT_SAMPLES; k++) {
+        evaluateSegment(segment, (double)k / TRAJECTORY_LIMIT_SAMPLES,
+                samples[k]);
+    }
+
+    // Velocity shrinks with the stretch and acceleration with its square
+    double velocityRatio = 0.0;
+    double accelerationRatio = 0.0;
+    for (size_t j = 0; j < m_indices.size(); j++) {
+        double velocityPrevious = 0.0;
+        for (int k = 0; k < TRAJECTORY_LIMIT_SAMPLES; k++) {
+            double velocity = (samples[k + 1][j] - samples[k][j]) / dt;
+            if (limits[j].isVelocityLimited) {
+                velocityRatio = std::max(velocityRatio, getLimitRatio(
+                        velocity, limits[j].minVelocity,
+                        limits[j].maxVelocity));
+            }
+
+            if (k > 0 && limits[j].isAccelerationLimited) {
+                double acceleration = (velocity - velocityPrevious) / dt;
+                accelerationRatio = std::max(accelerationRatio, getLimitRatio(
+                        acceleration, limits[j].minAcceleration,
+                        limits[j].maxAcceleration));
+            }
+            velocityPrevious = velocity;
+        }
+    }
+
+    double scale = std::max(velocityRatio, std::sqrt(accelerationRatio));
+    return std::max(1.0, scale);
+}
+
+int32_t Trajectory::evaluate(double time, std::vector<double> &positions) const
+{
+    if (m_times.size() < 2) {
+        positions = m_positions.empty() ?
+                std::vector<double>(m_indices.size(), 0.0) : m_positions.front();
+        return 0;
+    }
+
+    time = std::min(std::max(time, 0.0), m_times.back());
+    size_t segment = std::upper_bound(
+            m_times.begin(), m_times.end(), time) - m_times.begin();
+    segment = std::min(std::max(segment, (size_t)1), m_times.size() - 1) - 1;
+
+    double h = m_times[segment + 1] - m_times[segment];
+    evaluateSegment(segment, (time - m_times[segment]) / h, positions);
+    return (int32_t)segment;
+}
+
+int32_t Trajectory::getId() const
+{
+    return m_id;
+}
+
+const std::vector<int32_t>& Trajectory::getIndices() const
+{
+    return m_indices;
+}
+
+int32_t Trajectory::getNumSegments() const
+{
+    return std::max(0, (int32_t)m_times.size() - 1);
+}
+
+double Trajectory::getDuration() const
+{
+    return m_times.empty() ? 0.0 : m_times.back();
+}
+
+} // end of namespace tarsim
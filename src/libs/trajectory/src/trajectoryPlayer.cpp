@@ -0,0 +1,201 @@
+/**
+ *
+ * @file: trajectoryPlayer.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Implementation of TrajectoryPlayer
+ * <Requirement Doc Reference>
+ * <Design Doc Reference>
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ *
+ *
+ */
+
+//INCLUDES
+#include "trajectoryPlayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace tarsim {
+
+TrajectoryPlayer::TrajectoryPlayer(Callback callback, int policy, int priority):
+        m_callback(callback),
+        m_threadPolicy(policy),
+        m_threadPriority(priority)
+{
+}
+
+TrajectoryPlayer::~TrajectoryPlayer()
+{
+    stop();
+}
+
+Errors TrajectoryPlayer::start()
+{
+    if (nullptr != m_pthread.get()) {
+        printf("Failed: Thread already exists\n");
+        return ERR_INVALID;
+    }
+
+    m_runForEver = true;
+    m_pthread = std::unique_ptr<pthread_t>(new pthread_t);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setschedpolicy(&attr, m_threadPolicy);
+    struct sched_param param;
+    param.sched_priority = m_threadPriority;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    int ret = pthread_create(
+            m_pthread.get(), &attr, TrajectoryPlayer::threadFunctionHelper, this);
+    if (ret) {
+        ret = pthread_create(m_pthread.get(), nullptr,
+                TrajectoryPlayer::threadFunctionHelper, this);
+        if (ret) {
+            printf("Failed to create trajectory player thread (error = %d)\n",
+                    ret);
+            pthread_attr_destroy(&attr);
+            m_pthread.reset();
+            m_runForEver = false;
+            return ERR_FAILED_SPAWNED;
+        }
+        printf("Create non-realtime thread trajectoryPlayer\n");
+    }
+    pthread_attr_destroy(&attr);
+
+    pthread_setname_np(*m_pthread.get(), "trajectoryPlayer");
+    return NO_ERR;
+}
+
+Errors TrajectoryPlayer::stop()
+{
+    if (nullptr == m_pthread.get()) {
+        return NO_ERR;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexTrajectory);
+        m_runForEver = false;
+    }
+    m_cvTrajectory.notify_all();
+
+    pthread_join(*m_pthread.get(), nullptr);
+    m_pthread.reset();
+    return NO_ERR;
+}
+
+Errors TrajectoryPlayer::play(
+        std::shared_ptr<const Trajectory> trajectory, double cycleMs)
+{
+    if (nullptr == trajectory || cycleMs <= 0.0) {
+        return ERR_INVALID;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutexTrajectory);
+        m_trajectory = trajectory;
+        m_cycleMs = cycleMs;
+        m_generation++;
+    }
+    m_cvTrajectory.notify_all();
+    return NO_ERR;
+}
+
+bool TrajectoryPlayer::abort()
+{
+    std::unique_lock<std::mutex> lock(m_mutexTrajectory);
+    bool wasPlaying = (nullptr != m_trajectory);
+    m_trajectory.reset();
+    m_generation++;
+    return wasPlaying;
+}
+
+bool TrajectoryPlayer::isPlaying() const
+{
+    std::unique_lock<std::mutex> lock(m_mutexTrajectory);
+    return nullptr != m_trajectory;
+}
+
+void* TrajectoryPlayer::threadFunctionHelper(void* object)
+{
+    static_cast<TrajectoryPlayer*>(object)->running();
+    return nullptr;
+}
+
+void TrajectoryPlayer::running()
+{
+    while (m_runForEver) {
+        std::shared_ptr<const Trajectory> trajectory;
+        double cycleMs = 1.0;
+        uint64_t generation = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutexTrajectory);
+            m_cvTrajectory.wait_for(lock,
+                    std::chrono::milliseconds(TRAJECTORY_PLAYER_POLL_MS),
+                    [this]() { return nullptr != m_trajectory || !m_runForEver; });
+            if (nullptr == m_trajectory) {
+                continue;
+            }
+            trajectory = m_trajectory;
+            cycleMs = m_cycleMs;
+            generation = m_generation;
+        }
+
+        playing(trajectory, cycleMs, generation);
+
+        std::unique_lock<std::mutex> lock(m_mutexTrajectory);
+        if (generation == m_generation) {
+            m_trajectory.reset();
+        }
+    }
+}
+
+void TrajectoryPlayer::playing(
+        std::shared_ptr<const Trajectory> trajectory,
+        double cycleMs, uint64_t generation)
+{
+    // Cycles are scheduled on absolute times so they do not drift, and the
+    // trajectory time follows the clock so a late cycle catches up
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    long cycleNs = (long)(cycleMs * 1e6);
+    double duration = trajectory->getDuration();
+    std::vector<double> positions;
+
+    while (m_runForEver && generation == m_generation) {
+        double time = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        bool isDone = time >= duration;
+        time = std::min(time, duration);
+        int32_t segment = trajectory->evaluate(time, positions);
+
+        m_callback(*trajectory, positions, time, segment, isDone);
+        if (isDone) {
+            return;
+        }
+
+        next.tv_nsec += cycleNs;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+    }
+}
+
+} // end of namespace tarsim
@@ -0,0 +1,155 @@
+/**
+ * @file: replayApp.cpp
+ *
+ * @Created on: Oct 19, 2026
+ * @Author: Kamran Shamaei
+ *
+ *
+ * @brief - Renders a pose log recorded by the simulator to images or a video,
+ * offscreen and as fast as it renders
+ *
+ * @copyright Copyright Kamran Shamaei
+ * All Rights Reserved.
+ *
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of this source code package.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "poseLogRenderer.h"
+
+void print_usage() {
+    printf("\nTarsim Replay Usage Options: \n"
+            "-c /path/to/config/folder   [Default = None. Must be provided]\n"
+            "-i /path/to/pose/log        [Default = None. Must be provided]\n"
+            "-o output                   [Default = None. Must be provided] \n"
+            "                            Folder for png, file, named pipe or\n"
+            "                            |command for raw and y4m\n"
+            "-f png|raw|y4m              [Default = png] \n"
+            "-s widthxheight             [Default = %dx%d] \n"
+            "-r frames_per_second        [Default = %d] \n"
+            "-b start_time_s             [Default = start of the log] \n"
+            "-e end_time_s               [Default = end of the log] \n"
+            "-p px,py,pz,fx,fy,fz,ux,uy,uz\n"
+            "                            Camera position, focal point and\n"
+            "                            view up [Default = the config one]\n"
+            "-n number_of_png_encoders   [Default = %d] \n\n",
+            1280, 720,
+            tarsim::RECORDING_DEFAULT_FRAME_RATE,
+            tarsim::RECORDING_DEFAULT_NUM_ENCODERS);
+}
+
+bool parseCamera(const char* text, tarsim::Camera_t &camera)
+{
+    float v[9];
+    if (9 != sscanf(text, "%f,%f,%f,%f,%f,%f,%f,%f,%f",
+            &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8])) {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        camera.position[i] = v[i];
+        camera.focalPoint[i] = v[3 + i];
+        camera.viewUp[i] = v[6 + i];
+    }
+    camera.clippingRange[0] = 0.01f;
+    camera.clippingRange[1] = 1000.0f;
+    return true;
+}
+
+/*
+ * @brief renders a pose log.
+ * @param argc - number of arguments
+ * @param argv - list of arguments
+ * @return EXIT_SUCCESS
+ */
+int main(int argc, char **argv)
+{
+    int option = 0;
+    tarsim::PoseLogRendererConfig_t config;
+
+    while ((option = getopt(argc, argv,"c:i:o:f:s:r:b:e:p:n:h")) != -1) {
+        switch (option) {
+             case 'c' : config.configFolderName = std::string(optarg);
+                 break;
+             case 'i' : config.poseLogFileName = std::string(optarg);
+                 break;
+             case 'o' : config.recording.output = std::string(optarg);
+                 break;
+             case 'f' :
+                 if (0 == strcmp(optarg, "raw")) {
+                     config.recording.format = tarsim::RECORDING_RAW;
+                 } else if (0 == strcmp(optarg, "y4m")) {
+                     config.recording.format = tarsim::RECORDING_Y4M;
+                 } else {
+                     config.recording.format = tarsim::RECORDING_PNG;
+                 }
+                 break;
+             case 's' :
+                 if (2 != sscanf(optarg, "%dx%d", &config.width, &config.height)) {
+                     print_usage();
+                     exit(EXIT_FAILURE);
+                 }
+                 break;
+             case 'r' : config.recording.frameRate = atoi(optarg);
+                 break;
+             case 'b' : config.startTime = atof(optarg);
+                 break;
+             case 'e' : config.endTime = atof(optarg);
+                 break;
+             case 'p' :
+                 if (!parseCamera(optarg, config.camera)) {
+                     print_usage();
+                     exit(EXIT_FAILURE);
+                 }
+                 config.hasCamera = true;
+                 break;
+             case 'n' : config.recording.numEncoders = atoi(optarg);
+                 break;
+             case 'h' :
+             default: print_usage();
+                 exit(EXIT_FAILURE);
+        }
+    }
+
+    if (config.configFolderName.empty() || config.poseLogFileName.empty() ||
+        config.recording.output.empty()) {
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    tarsim::PoseLogRenderer* renderer = nullptr;
+    try {
+      renderer = new tarsim::PoseLogRenderer(config);
+    } catch (const std::invalid_argument& e) {
+      printf("Error: %s\n", e.what());
+      printf("For instructions, run with -h option\n");
+      return EXIT_FAILURE;
+    }
+
+    const tarsim::PoseLogReader &reader = renderer->getReader();
+    printf("Rendering %llu poses over %.3f s\n",
+            (unsigned long long)reader.getNumRecords(),
+            (reader.getEndTimeNs() - reader.getStartTimeNs()) * 1e-9);
+
+    auto start = std::chrono::steady_clock::now();
+    tarsim::Errors error = renderer->run();
+    double duration = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    tarsim::RecordingStatistics_t statistics = renderer->getStatistics();
+    printf("Wrote %llu frames to %s in %.3f s, %llu failed\n",
+            (unsigned long long)statistics.numWritten,
+            config.recording.output.c_str(), duration,
+            (unsigned long long)statistics.numFailed);
+
+    delete renderer;
+    renderer = nullptr;
+
+    return (tarsim::NO_ERR == error) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -34,7 +34,8 @@ void print_usage() {
             "-c /path/to/config/folder   [Default = None. Must be provided]\n"
             "-l realtime_thread_policy   [Default = %d] \n"
             "-r realtime_thread_priority [Default = %d] \n"
-            "-m message_priority         [Default = %d] \n\n",
+            "-m message_priority         [Default = %d] \n"
+            "-x                          Render offscreen, without a screen\n\n",
             tarsim::DEFAULT_RT_THREAD_POLICY,
             tarsim::DEFAULT_RT_THREAD_PRIORITY,
             tarsim::DEFAULT_MSG_PRIORITY);
@@ -53,10 +54,11 @@ int main(int argc, char **argv)
     int policy = tarsim::DEFAULT_RT_THREAD_POLICY;
     int priority = tarsim::DEFAULT_RT_THREAD_PRIORITY;
     unsigned int msgPriority = tarsim::DEFAULT_MSG_PRIORITY;
+    bool isOffScreen = false;
 
     //Specifying the expected options
     //The two options l and b expect numbers as argument
-    while ((option = getopt(argc, argv,"c:l:r:m:h")) != -1) {
+    while ((option = getopt(argc, argv,"c:l:r:m:xh")) != -1) {
         switch (option) {
              case 'c' : configFolderName = std::string(optarg);
                  break;
@@ -66,6 +68,8 @@ int main(int argc, char **argv)
                  break;
              case 'm' : msgPriority = atoi(optarg);
                   break;
+             case 'x' : isOffScreen = true;
+                  break;
              case 'h' :
              default: print_usage();
                  exit(EXIT_FAILURE);
@@ -79,7 +83,8 @@ int main(int argc, char **argv)
     sigaction(SIGINT, &sigIntHandler, nullptr);
 
     try {
-      sim = new tarsim::Tarsim(configFolderName, policy, priority, msgPriority);
+      sim = new tarsim::Tarsim(
+              configFolderName, policy, priority, msgPriority, isOffScreen);
       sim->start();
     } catch (const std::invalid_argument& e) {
       printf("Error: %s\n", e.what());